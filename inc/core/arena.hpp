@@ -0,0 +1,73 @@
+#ifndef H_ARENA
+#define H_ARENA
+
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <vector>
+#include <algorithm>
+
+#include "core/span.hpp"
+
+class Arena{
+public:
+  template<typename T>
+  static T * Allocate(std::size_t n);
+
+  template<typename T, typename Iterator>
+  static Span<T> Copy(Iterator first, Iterator last);
+
+  static void Reset();
+  static std::size_t Capacity();
+
+private:
+  //! Memory owned by one thread
+  struct Blocks{
+    std::vector<std::unique_ptr<char[]> > data_;//!<Start of each block
+    std::vector<std::size_t> sizes_;//!<Size of each block in bytes
+    std::size_t current_;//!<Index of block currently being filled
+    std::size_t used_;//!<Bytes used in current block
+  };
+
+  static const std::size_t kBlockSize = 64*1024;//!<Minimum size of a block in bytes
+
+  Arena() = delete;
+
+  static void * AllocateBytes(std::size_t bytes);
+  static Blocks & ThreadBlocks();
+};
+
+/*!\brief Get uninitialized storage valid until the calling thread's next
+  Reset()
+
+  \tparam T Trivially destructible element type
+
+  \param[in] n Number of elements
+
+  \return Pointer to storage for n elements
+*/
+template<typename T>
+T * Arena::Allocate(std::size_t n){
+  return static_cast<T*>(AllocateBytes(n*sizeof(T)));
+}
+
+/*!\brief Copy a range into storage valid until the calling thread's next
+  Reset()
+
+  \tparam T Element type of the copy, converted from the range's elements
+
+  \param[in] first Start of range
+
+  \param[in] last End of range
+
+  \return View of the copy
+*/
+template<typename T, typename Iterator>
+Span<T> Arena::Copy(Iterator first, Iterator last){
+  std::size_t n = static_cast<std::size_t>(std::distance(first, last));
+  T *out = Allocate<T>(n);
+  std::copy(first, last, out);
+  return Span<T>(out, n);
+}
+
+#endif
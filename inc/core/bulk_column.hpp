@@ -0,0 +1,189 @@
+#ifndef H_BULK_COLUMN
+#define H_BULK_COLUMN
+
+#include <cstddef>
+#include <cstring>
+#include <vector>
+#include <memory>
+
+#include "TBranch.h"
+#include "TBasket.h"
+#include "TBufferFile.h"
+
+#include "core/trace.hpp"
+
+class BulkColumnBase{
+public:
+  BulkColumnBase();
+  BulkColumnBase(const BulkColumnBase &) = delete;
+  BulkColumnBase & operator=(const BulkColumnBase &) = delete;
+  BulkColumnBase(BulkColumnBase &&) = default;
+  BulkColumnBase & operator=(BulkColumnBase &&) = default;
+  ~BulkColumnBase() = default;
+
+protected:
+  bool Contains(int tree_number, long entry) const;
+  bool FindBasket(TBranch &branch, int tree_number, long entry);
+  std::size_t Index(long entry) const;
+
+  static bool GetVectorElements(const char *begin, const char *end, std::size_t element_size,
+                                const char *&elements, std::size_t &num_elements);
+  static void FromBigEndian(const char *data, std::size_t size, void *value);
+
+  int tree_number_;//!<Index in TChain of tree from which buffered basket was read
+  int basket_;//!<Index in branch of buffered basket
+  long first_entry_;//!<First entry in buffered basket (inclusive)
+  long last_entry_;//!<Last entry in buffered basket (exclusive)
+};
+
+/*!\brief Buffer holding one basket of a scalar branch as a contiguous array
+
+  \tparam T Type of branch (int, float, bool, etc.)
+*/
+template<typename T>
+class BulkColumn: public BulkColumnBase{
+public:
+  BulkColumn(): BulkColumnBase(), values_(), buffer_(), supported_(true){}
+  BulkColumn(BulkColumn &&) = default;
+  BulkColumn & operator=(BulkColumn &&) = default;
+  ~BulkColumn() = default;
+
+  bool Read(TBranch &branch, int tree_number, long entry, T &value);
+
+private:
+  std::vector<T> values_;//!<Value for each entry in basket
+  std::unique_ptr<TBufferFile> buffer_;//!<Buffer into which ROOT deserializes baskets
+  bool supported_;//!<Flag if ROOT can bulk read this branch
+};
+
+/*!\brief Buffer holding one basket of a vector branch as offsets into a
+  contiguous array of values
+
+  \tparam T Type of vector elements (int, float, bool, etc.)
+*/
+template<typename T>
+class BulkColumn<std::vector<T> >: public BulkColumnBase{
+public:
+  BulkColumn(): BulkColumnBase(), offsets_(), values_(), supported_(true){}
+  BulkColumn(BulkColumn &&) = default;
+  BulkColumn & operator=(BulkColumn &&) = default;
+  ~BulkColumn() = default;
+
+  bool Read(TBranch &branch, int tree_number, long entry,
+            std::vector<T> * const &object);
+
+private:
+  std::vector<std::size_t> offsets_;//!<Start of each entry in values_, followed by values_.size()
+  std::vector<T> values_;//!<Elements of all entries in basket, concatenated
+  bool supported_;//!<Flag if the baskets of this branch can be decoded directly
+};
+
+/*!\brief Copy value of branch for an entry, reading its whole basket if needed
+
+  Uses ROOT's bulk interface to deserialize all entries of the basket
+  containing entry with a single call.
+
+  \param[in,out] branch Branch to read from
+
+  \param[in] tree_number Index in TChain of tree owning branch
+
+  \param[in] entry Entry number within tree
+
+  \param[out] value Set to value of branch for entry
+
+  \return True if value was set. False if branch does not support bulk reading,
+  in which case the caller must read the entry itself.
+*/
+template<typename T>
+bool BulkColumn<T>::Read(TBranch &branch, int tree_number, long entry, T &value){
+  if(!supported_) return false;
+  if(!Contains(tree_number, entry)){
+    if(!FindBasket(branch, tree_number, entry)) return false;
+    Trace::Span span("ReadBasket");
+    if(!buffer_) buffer_.reset(new TBufferFile(TBuffer::kWrite, 32*1024));
+    buffer_->SetBufferOffset(0);
+    int num_read = branch.GetBulkRead().GetBulkEntries(first_entry_, *buffer_);
+    if(num_read < last_entry_-first_entry_){
+      supported_ = false;
+      tree_number_ = -1;
+      return false;
+    }
+    const char *data = buffer_->GetCurrent();
+    values_.resize(static_cast<std::size_t>(last_entry_-first_entry_));
+    for(std::size_t i = 0; i < values_.size(); ++i){
+      T raw;
+      std::memcpy(&raw, data+i*sizeof(T), sizeof(T));
+      values_[i] = raw;
+    }
+  }
+  value = values_[Index(entry)];
+  return true;
+}
+
+/*!\brief Copy value of branch for an entry, decoding its whole basket if
+  needed
+
+  ROOT has no bulk interface for vector branches, so the serialized entries of
+  the basket containing entry are decoded directly from the basket's buffer
+  into offsets and values, without going through the streamer once per entry.
+  The basket is only read when an entry in it is first requested, so branches
+  that are never used are never read.
+
+  \param[in,out] branch Branch to read from
+
+  \param[in] tree_number Index in TChain of tree owning branch
+
+  \param[in] entry Entry number within tree
+
+  \param[in] object Vector address registered with branch. Set to contents
+  of branch for entry.
+
+  \return True if object was set. False if the basket does not have the
+  expected layout or object is not allocated yet, in which case the caller must
+  read the entry itself.
+*/
+template<typename T>
+bool BulkColumn<std::vector<T> >::Read(TBranch &branch, int tree_number, long entry,
+                                       std::vector<T> * const &object){
+  if(!supported_ || object == nullptr) return false;
+  if(!Contains(tree_number, entry)){
+    if(!FindBasket(branch, tree_number, entry)) return false;
+    Trace::Span span("ReadBasket");
+    tree_number_ = -1;
+    TBasket *basket = branch.GetBasket(basket_);
+    if(basket == nullptr) return false;
+    const Int_t *entry_offsets = basket->GetEntryOffset();
+    const TBuffer *buffer = basket->GetBufferRef();
+    long num_entries = last_entry_-first_entry_;
+    if(entry_offsets == nullptr || basket->GetDisplacement() != nullptr
+       || buffer == nullptr || basket->GetNevBuf() != num_entries){
+      supported_ = false;
+      return false;
+    }
+    const char *data = buffer->Buffer();
+    offsets_.assign(1, 0);
+    values_.clear();
+    for(long ientry = 0; ientry < num_entries; ++ientry){
+      const char *begin = data+entry_offsets[ientry];
+      const char *end = data+(ientry+1 < num_entries ? entry_offsets[ientry+1] : basket->GetLast());
+      const char *elements = nullptr;
+      std::size_t num_elements = 0;
+      if(!GetVectorElements(begin, end, sizeof(T), elements, num_elements)){
+        supported_ = false;
+        return false;
+      }
+      for(std::size_t i = 0; i < num_elements; ++i){
+        T value;
+        FromBigEndian(elements+i*sizeof(T), sizeof(T), &value);
+        values_.push_back(value);
+      }
+      offsets_.push_back(values_.size());
+    }
+    tree_number_ = tree_number;
+  }
+  std::size_t index = Index(entry);
+  object->assign(values_.cbegin()+offsets_[index], values_.cbegin()+offsets_[index+1]);
+  return true;
+}
+
+#endif
@@ -0,0 +1,122 @@
+#ifndef H_BYTECODE
+#define H_BYTECODE
+
+#include <cstddef>
+#include <vector>
+#include <map>
+#include <utility>
+#include <functional>
+
+#include "core/named_func.hpp"
+
+class Bytecode{
+public:
+  explicit Bytecode(const NamedFunc &func);
+  Bytecode(const Bytecode &) = default;
+  Bytecode & operator=(const Bytecode &) = default;
+  Bytecode(Bytecode &&) = default;
+  Bytecode & operator=(Bytecode &&) = default;
+  ~Bytecode() = default;
+
+  bool IsScalar() const;
+  bool IsVector() const;
+  std::size_t NumInstructions() const;
+
+  NamedFunc::ScalarType GetScalar(const Baby &b) const;
+  TypedSpan GetTyped(const Baby &b) const;
+
+private:
+  //! Class of a register, selected for scalars by NamedFunc::ResultType()
+  enum class Reg{boolean, integer, real, vector};
+
+  //! Kind of instruction. Scalar operations have their own codes for each
+  //! register class so that each is dispatched with a single jump. Codes
+  //! before Code::call_vector produce a scalar, those before Code::load_int a
+  //! real, and those from Code::load_bool a bool.
+  enum class Code{load, negate, int_to_real, bool_to_real,
+      plus, minus, multiplies, divides, modulus, subscript,
+      load_int, real_to_int, bool_to_int, subscript_int,
+      load_bool, truth, int_truth, logical_not,
+      equal_to, not_equal_to, greater, less, greater_equal, less_equal,
+      equal_to_int, not_equal_to_int, greater_int, less_int, greater_equal_int, less_equal_int,
+      subscript_bool, call_vector, unary_vector, binary_vector,
+      jump_if_none, jump_if_all};
+
+  //! Condition on the bool result of an instruction for jumping
+  enum class Jump{never, if_false, if_true};
+
+  //! Number of real registers of programs run with registers on the stack
+  static const std::size_t kStackScalars = 32;
+
+  //! Number of integer registers of programs run with registers on the stack
+  static const std::size_t kStackIntegers = 16;
+
+  //! Number of bool registers of programs run with registers on the stack
+  static const std::size_t kStackBooleans = 32;
+
+  //! Number of vector registers of programs run with registers on the stack
+  static const std::size_t kStackVectors = 8;
+
+  struct Instruction{
+    Code code_;//!<Kind of instruction
+    NamedFunc::Op op_;//!<Operation applied by vector instructions
+    Jump jump_;//!<Condition on the bool result for continuing at Instruction::target_
+    bool vector_a_;//!<Flag if Instruction::a_ is a vector register
+    bool vector_b_;//!<Flag if Instruction::b_ is a vector register
+    bool real_b_;//!<Flag if Instruction::b_ is a real rather than an integer register. Used only by subscripts.
+    std::size_t out_;//!<Register receiving the result
+    std::size_t a_;//!<First operand register, or index of vector callable
+    std::size_t b_;//!<Second operand register
+    std::size_t call_a_;//!<One plus index of scalar callable filling register Instruction::a_ first. 0 if none.
+    std::size_t call_b_;//!<One plus index of scalar callable filling register Instruction::b_ first. 0 if none.
+    std::size_t target_;//!<Instruction at which to continue when jumping
+  };
+
+  Bytecode() = delete;
+
+  std::vector<Instruction> code_;//!<Instructions in order of execution
+  std::vector<std::pair<std::size_t, NamedFunc::ScalarType> > constants_;//!<Real registers set before running: constants, and operands skipped by jumps
+  std::vector<std::pair<std::size_t, long> > int_constants_;//!<Integer registers set before running
+  std::vector<std::pair<std::size_t, bool> > bool_constants_;//!<Bool registers set before running: constants, and results of && and || chains if short-circuited
+  std::vector<std::function<NamedFunc::ScalarFunc> > scalar_calls_;//!<Leaves returning a scalar
+  std::vector<std::function<NamedFunc::TypedFunc> > vector_calls_;//!<Leaves returning a vector
+  std::size_t num_scalars_;//!<Number of real registers
+  std::size_t num_integers_;//!<Number of integer registers
+  std::size_t num_booleans_;//!<Number of bool registers
+  std::size_t num_vectors_;//!<Number of vector registers
+  std::size_t result_;//!<Register holding the result once the program finishes
+  Reg result_reg_;//!<Class of Bytecode::result_
+
+  std::map<std::vector<std::size_t>, std::size_t> nodes_;//!<Node index of each (operation, leaf id, operand nodes). Used only while compiling.
+  std::map<std::pair<std::size_t, Reg>, std::size_t> registers_;//!<Register of each class already holding each node where emitted. Used only while compiling.
+  std::size_t fence_;//!<Position of latest jump target. Earlier instructions cannot be merged. Used only while compiling.
+
+  std::size_t Emit(const NamedFunc &func, Reg reg);
+  std::size_t EmitNode(const NamedFunc &func, Reg reg);
+  void EmitLogical(const NamedFunc &func, std::size_t out);
+  std::size_t Convert(Reg from, std::size_t reg, Reg to);
+  std::size_t NewRegister(Reg reg);
+  void Preset(Reg reg, std::size_t out, NamedFunc::ScalarType value, bool first = false);
+  std::size_t Intern(const NamedFunc &func);
+  std::size_t Add(Code code, NamedFunc::Op op, bool vector_a, bool vector_b,
+                  std::size_t out, std::size_t a, std::size_t b);
+  std::size_t AddJump(std::size_t reg, Jump jump);
+  void SetTargets(const std::vector<std::size_t> &jumps);
+  std::size_t TakeCall(std::size_t reg, Reg reg_class);
+  static Reg Natural(const NamedFunc &func);
+  static Reg OfType(NamedFunc::Type type);
+  static Reg Output(Code code);
+  static Code LoadCode(Reg reg);
+  static Code ScalarCode(NamedFunc::Op op, Reg reg);
+
+  NamedFunc::ScalarType Operand(std::size_t reg, std::size_t call,
+                                const Baby &b, NamedFunc::ScalarType *s) const;
+  long IntOperand(std::size_t reg, std::size_t call, const Baby &b, long *n) const;
+  bool BoolOperand(std::size_t reg, std::size_t call, const Baby &b, bool *p) const;
+  std::size_t Index(const Instruction &in, const Baby &b, NamedFunc::ScalarType *s, long *n) const;
+  NamedFunc::ScalarType Result(const NamedFunc::ScalarType *s, const long *n, const bool *p) const;
+  void Run(const Baby &b, NamedFunc::ScalarType *s, long *n, bool *p, TypedSpan *v) const;
+  void RunVector(const Instruction &in, NamedFunc::ScalarType *s, TypedSpan *v) const;
+};
+
+#endif
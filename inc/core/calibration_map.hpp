@@ -0,0 +1,40 @@
+#ifndef H_CALIBRATION_MAP
+#define H_CALIBRATION_MAP
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+class TH1;
+class TAxis;
+
+class CalibrationMap{
+public:
+  explicit CalibrationMap(const TH1 &hist);
+  CalibrationMap(const CalibrationMap &) = default;
+  CalibrationMap & operator=(const CalibrationMap &) = default;
+  CalibrationMap(CalibrationMap &&) = default;
+  CalibrationMap & operator=(CalibrationMap &&) = default;
+  ~CalibrationMap() = default;
+
+  static const CalibrationMap & Get(const std::string &file_name,
+                                    const std::string &hist_name);
+
+  std::size_t Dimension() const;
+
+  std::size_t FindBin(double x, double y = 0., double z = 0.) const;
+  double Value(double x, double y = 0., double z = 0.) const;
+  double Error(double x, double y = 0., double z = 0.) const;
+
+private:
+  CalibrationMap() = delete;
+
+  std::vector<std::vector<double> > edges_;//!<Bin edges along each axis, including upper edge of last bin
+  std::vector<double> values_;//!<Bin contents, indexed like TH1::GetBin() (including under- and overflow)
+  std::vector<double> errors_;//!<Bin errors, indexed like CalibrationMap::values_
+
+  static std::vector<double> GetEdges(const TAxis &axis);
+  static std::size_t FindAxisBin(const std::vector<double> &edges, double x);
+};
+
+#endif
@@ -5,6 +5,7 @@
 #include <set>
 #include <vector>
 #include <ostream>
+#include <istream>
 #include <random>
 
 #include "TH2D.h"
@@ -41,6 +42,10 @@ namespace Clustering{
                          long max_points = -1);
 
     void AddPoint(float x, float y, float w);
+    void Merge(const Clusterizer &other);
+
+    void Write(std::ostream &out) const;
+    bool Read(std::istream &in);
     
     void SetPoints(const std::vector<Point> &points);
     void SetPoints(const TH2D &h);
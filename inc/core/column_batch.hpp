@@ -0,0 +1,48 @@
+#ifndef H_COLUMN_BATCH
+#define H_COLUMN_BATCH
+
+#include <cstddef>
+#include <vector>
+#include <map>
+#include <memory>
+
+#include "core/named_func.hpp"
+
+class ColumnBatch{
+public:
+  explicit ColumnBatch(std::size_t max_size = 256);
+  ColumnBatch(const ColumnBatch &) = default;
+  ColumnBatch & operator=(const ColumnBatch &) = default;
+  ColumnBatch(ColumnBatch &&) = default;
+  ColumnBatch & operator=(ColumnBatch &&) = default;
+  ~ColumnBatch() = default;
+
+  static bool IsColumnar(const NamedFunc &func);
+
+  std::size_t Add(const NamedFunc &func);
+
+  void Fill(Baby &baby, long first_entry, long last_entry);
+
+  std::size_t Size() const;
+  std::size_t MaxSize() const;
+
+  const NamedFunc::VectorType & Column(std::size_t column) const;
+
+private:
+  struct Node{
+    NamedFunc::Op op_;//!<Operation applied to operands, or leaf type
+    std::vector<std::size_t> operands_;//!<Indices of operand nodes
+    std::shared_ptr<const NamedFunc> leaf_;//!<Function evaluated entry by entry if node is a leaf
+  };
+
+  std::vector<Node> nodes_;//!<Nodes in order of evaluation (operands before results)
+  std::vector<NamedFunc::VectorType> columns_;//!<Result of each node for each entry in block
+  std::map<std::vector<std::size_t>, std::size_t> node_ids_;//!<Node index for each (operation, leaf id, operand nodes)
+  std::vector<std::size_t> leaves_;//!<Indices of nodes evaluated entry by entry
+  std::size_t max_size_;//!<Maximum number of entries in a block
+  std::size_t size_;//!<Number of entries in current block
+
+  void Compute(std::size_t inode);
+};
+
+#endif
@@ -14,11 +14,20 @@ class EventScan final : public Figure{
   class SingleScan final : public Figure::FigureComponent{
  public:
    SingleScan(const EventScan &event_scan,
-              const std::shared_ptr<Process> &process);
+              const std::shared_ptr<Process> &process,
+              bool write_to_file = true);
    ~SingleScan() = default;
 
    void RecordEvent(const Baby &baby) final;
 
+   std::unique_ptr<FigureComponent> Shadow() const final;
+   void Merge(const FigureComponent &shadow) final;
+
+   void WritePartial(std::ostream &out) const final;
+   bool ReadPartial(std::istream &in) final;
+
+   std::vector<NamedFunc*> GetFunctions() final;
+
    void Precision(unsigned precision);
 
  private:
@@ -30,9 +39,13 @@ class EventScan final : public Figure{
 
    std::ofstream out_;//!<File to which results are printed
    NamedFunc full_cut_;//!<Cached scan&&process cut
-   NamedFunc::VectorType cut_vector_;//!<Cut results (to avoid creating new vector each event)
-   std::vector<NamedFunc::VectorType> val_vectors_;//!<Values for each column (to avoid creating new vectors each event)
-   std::size_t row_;
+   TypedSpan cut_vector_;//!<Cut results for current event
+   std::vector<TypedSpan> val_vectors_;//!<Values for each column for current event
+   std::size_t row_;//!<Number of events written to file so far
+   bool write_to_file_;//!<If false, buffer events in events_ instead of writing them
+   std::vector<std::vector<std::string> > events_;//!<Formatted columns for each instance of each buffered event
+
+   void WriteEvent(const std::vector<std::string> &instances);
  };
 
  EventScan(const std::string &name,
@@ -51,6 +64,8 @@ class EventScan final : public Figure{
 
  FigureComponent * GetComponent(const Process *process) final;
 
+ std::vector<NamedFunc*> GetFunctions() final;
+
  unsigned Precision() const;
  EventScan & Precision(unsigned precision);
 
@@ -4,10 +4,14 @@
 #include <memory>
 #include <vector>
 #include <mutex>
+#include <string>
+#include <istream>
+#include <ostream>
 
 #include "core/process.hpp"
 #include "core/baby.hpp"
 #include "core/named_func.hpp"
+#include "core/column_batch.hpp"
 
 class Figure{
 public:
@@ -19,9 +23,21 @@ public:
 
     virtual void RecordEvent(const Baby &baby) = 0;
 
+    virtual std::unique_ptr<FigureComponent> Shadow() const = 0;
+    virtual void Merge(const FigureComponent &shadow) = 0;
+
+    virtual std::vector<NamedFunc*> GetFunctions() = 0;
+
+    virtual bool AddColumns(ColumnBatch &batch);
+    virtual void RecordColumns(const ColumnBatch &batch);
+
+    virtual std::string Definition() const;
+    virtual void WritePartial(std::ostream &out) const;
+    virtual bool ReadPartial(std::istream &in);
+
     const Figure& figure_;//!<Reference to figure containing this component
     std::shared_ptr<Process> process_;//!<Process associated to this part of the figure
-    std::mutex mutex_;
+    std::mutex mutex_;//!<Guards merging of shadow components into this one
 
   private:
     FigureComponent() = delete;
@@ -44,6 +60,8 @@ public:
   virtual std::set<const Process*> GetProcesses() const = 0;
 
   virtual FigureComponent * GetComponent(const Process *process) = 0;
+
+  virtual std::vector<NamedFunc*> GetFunctions() = 0;
 };
 
 #endif
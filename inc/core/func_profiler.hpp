@@ -0,0 +1,34 @@
+#ifndef H_FUNC_PROFILER
+#define H_FUNC_PROFILER
+
+#include <cstddef>
+#include <string>
+#include <ostream>
+
+class FuncProfiler{
+public:
+  class Scope{
+  public:
+    explicit Scope(std::size_t index);
+    Scope(const Scope &) = delete;
+    Scope & operator=(const Scope &) = delete;
+    Scope(Scope &&) = delete;
+    Scope & operator=(Scope &&) = delete;
+    ~Scope();
+
+  private:
+    std::size_t index_;//!<Index of profiled function
+    bool timed_;//!<Flag if this call is one of the sampled calls
+  };
+
+  static std::size_t Register(const std::string &name);
+  static void AddUse(std::size_t index, const std::string &user);
+
+  static void Start(std::size_t sample_period = 16);
+  static void Print(std::ostream &out, std::size_t max_rows);
+
+private:
+  FuncProfiler() = delete;
+};
+
+#endif
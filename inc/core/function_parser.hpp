@@ -27,6 +27,8 @@ public:
   Token ResolveAsToken() const;
   NamedFunc ResolveAsNamedFunc() const;
 
+  static NamedFunc Register(const NamedFunc &func, const std::string &name = "");
+
 private:
   std::string input_string_;//!<String being parsed
   mutable std::vector<Token> tokens_;//!<List of tokens generated in parsing process
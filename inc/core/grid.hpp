@@ -0,0 +1,41 @@
+#ifndef H_GRID
+#define H_GRID
+
+#include <cstddef>
+#include <algorithm>
+#include <vector>
+#include <string>
+#include <unordered_map>
+
+#include "core/named_func.hpp"
+
+class Baby;
+
+namespace Grid{
+  //! Values of the grid keys (e.g. mass_stop, mass_lsp) for one grid point
+  using Point = std::vector<NamedFunc::ScalarType>;
+
+  struct PointHash{
+    std::size_t operator()(const Point &point) const;
+  };
+
+  template<typename T>
+  using Map = std::unordered_map<Point, T, PointHash>;
+
+  Point Evaluate(const std::vector<NamedFunc> &keys, const Baby &baby);
+
+  template<typename T>
+  std::vector<Point> SortedPoints(const Map<T> &map){
+    std::vector<Point> points;
+    points.reserve(map.size());
+    for(const auto &entry: map){
+      points.push_back(entry.first);
+    }
+    std::sort(points.begin(), points.end());
+    return points;
+  }
+
+  std::string ToString(const Point &point);
+}
+
+#endif
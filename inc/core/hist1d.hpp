@@ -19,6 +19,7 @@
 #include "core/process.hpp"
 #include "core/axis.hpp"
 #include "core/plot_opt.hpp"
+#include "core/grid.hpp"
 
 class Hist1D final: public Figure{
 public:
@@ -30,10 +31,23 @@ public:
     ~SingleHist1D() = default;
 
     TH1D raw_hist_;//!<Histogram storing distribution before stacking and luminosity weighting
+    Grid::Map<TH1D> grid_hists_;//!<Unweighted histogram for each grid point if the process has a grid
     mutable TH1D scaled_hist_;//!<Kludge. Mutable storage of scaled and stacked histogram
 
     void RecordEvent(const Baby &baby) final;
 
+    std::unique_ptr<FigureComponent> Shadow() const final;
+    void Merge(const FigureComponent &shadow) final;
+
+    std::vector<NamedFunc*> GetFunctions() final;
+
+    bool AddColumns(ColumnBatch &batch) final;
+    void RecordColumns(const ColumnBatch &batch) final;
+
+    std::string Definition() const final;
+    void WritePartial(std::ostream &out) const final;
+    bool ReadPartial(std::istream &in) final;
+
     double GetMax(double max_bound = std::numeric_limits<double>::infinity(),
                   bool include_error_bar = false,
                   bool include_overflow = false) const;
@@ -49,7 +63,8 @@ public:
     SingleHist1D& operator=(SingleHist1D &&) = delete;
 
     NamedFunc proc_and_hist_cut_;
-    NamedFunc::VectorType cut_vector_, wgt_vector_, val_vector_;
+    TypedSpan cut_vector_, wgt_vector_, val_vector_;
+    std::size_t cut_column_, wgt_column_, val_column_;//!<Columns of cut, weight, and value in batch from AddColumns()
   };
 
   Hist1D(const Axis &xaxis, const NamedFunc &cut,
@@ -66,6 +81,11 @@ public:
 
   FigureComponent * GetComponent(const Process *process) final;
 
+  std::vector<NamedFunc*> GetFunctions() final;
+
+  std::vector<Grid::Point> GridPoints(const Process *process) const;
+  TH1D GridHist(const Process *process, const Grid::Point &point) const;
+
   std::string Name() const;
   std::string Title() const;
 
@@ -148,7 +168,7 @@ private:
 
   void GetTitleSize(double &width, double &height, bool in_pixels) const;
 
-  const std::vector<std::unique_ptr<SingleHist1D> >& GetComponentList(const Process *process);
+  const std::vector<std::unique_ptr<SingleHist1D> >& GetComponentList(const Process *process) const;
 };
 
 #endif
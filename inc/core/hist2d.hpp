@@ -25,6 +25,15 @@ public:
 
     void RecordEvent(const Baby &baby);
 
+    std::unique_ptr<FigureComponent> Shadow() const override;
+    void Merge(const FigureComponent &shadow) override;
+
+    std::string Definition() const override;
+    void WritePartial(std::ostream &out) const override;
+    bool ReadPartial(std::istream &in) override;
+
+    std::vector<NamedFunc*> GetFunctions() override;
+
   private:
     SingleHist2D() = delete;
     SingleHist2D(const SingleHist2D &) = delete;
@@ -33,7 +42,7 @@ public:
     SingleHist2D& operator=(SingleHist2D &&) = delete;
 
     NamedFunc proc_and_hist_cut_;
-    NamedFunc::VectorType cut_vector_, wgt_vector_, xval_vector_, yval_vector_;
+    TypedSpan cut_vector_, wgt_vector_, xval_vector_, yval_vector_;
   };
 
   Hist2D(const Axis &xaxis, const Axis &yaxis, const NamedFunc &cut,
@@ -50,6 +59,8 @@ public:
 
   FigureComponent * GetComponent(const Process *process) override;
 
+  std::vector<NamedFunc*> GetFunctions() override;
+
   std::string Name() const;
 
   Hist2D & Weight(const NamedFunc &weight);
@@ -0,0 +1,54 @@
+#ifndef H_JIT_COMPILER
+#define H_JIT_COMPILER
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+
+#include "core/named_func.hpp"
+
+class JitCompiler{
+public:
+  explicit JitCompiler(const std::string &command,
+                       const std::string &include_dir = "inc");
+  JitCompiler(const JitCompiler &) = delete;
+  JitCompiler & operator=(const JitCompiler &) = delete;
+  JitCompiler(JitCompiler &&) = default;
+  JitCompiler & operator=(JitCompiler &&) = default;
+  ~JitCompiler() = default;
+
+  bool Add(NamedFunc &func);
+  std::size_t Build();
+
+  static std::string DefaultCommand();
+
+private:
+  //! Signature of generated functions: Baby, scalar callables, vector callables
+  using Native = NamedFunc::ScalarType (*)(const Baby &,
+                                          const std::function<NamedFunc::ScalarFunc> *,
+                                          const std::function<NamedFunc::TypedFunc> *);
+
+  //! Callable swapped in when the library is built
+  struct Slot{
+    std::function<NamedFunc::ScalarFunc> function_;//!<Native function once built, interpreted function before
+    std::vector<std::function<NamedFunc::ScalarFunc> > scalar_calls_;//!<Subexpressions called through their own callable returning a scalar
+    std::vector<std::function<NamedFunc::TypedFunc> > vector_calls_;//!<Subexpressions called through their own callable returning a vector
+    std::string body_;//!<C++ expression computing the result
+  };
+
+  JitCompiler() = delete;
+
+  std::string command_;//!<Shell command compiling a shared library, or "cling"
+  std::string include_dir_;//!<Directory containing core/baby.hpp
+  std::vector<std::shared_ptr<Slot> > slots_;//!<Functions to compile
+
+  static std::string Translate(const NamedFunc &func, Slot &slot, NamedFunc::Type &type);
+  static std::string Symbol(std::size_t index);
+  std::string Source() const;
+  bool BuildWithCling(const std::string &source, std::vector<Native> &natives) const;
+  bool BuildWithCommand(const std::string &source, std::vector<Native> &natives) const;
+};
+
+#endif
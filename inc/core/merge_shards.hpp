@@ -0,0 +1,6 @@
+#ifndef H_MERGE_SHARDS
+#define H_MERGE_SHARDS
+
+void GetOptions(int argc, char *argv[]);
+
+#endif
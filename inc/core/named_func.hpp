@@ -5,22 +5,38 @@
 #include <functional>
 #include <ostream>
 #include <vector>
+#include <memory>
+#include <set>
 
 #include "TString.h"
 
 #include "core/baby.hpp"
+#include "core/span.hpp"
+#include "core/typed_span.hpp"
 
 class NamedFunc{
 public:
   using ScalarType = double;
   using VectorType = std::vector<ScalarType>;
+  using VectorView = Span<ScalarType>;
   using ScalarFunc = ScalarType(const Baby &);
   using VectorFunc = VectorType(const Baby &);
+  using ViewFunc = VectorView(const Baby &);
+  using TypedFunc = TypedSpan(const Baby &);
+  using Type = TypedSpan::Type;
+
+  //! Operation producing a NamedFunc from its operands
+  enum class Op{function, variable, constant,
+      plus, minus, multiplies, divides, modulus, negate,
+      equal_to, not_equal_to, greater, less, greater_equal, less_equal,
+      logical_and, logical_or, logical_not, subscript};
 
   NamedFunc(const std::string &name,
             const std::function<ScalarFunc> &function);
   NamedFunc(const std::string &name,
             const std::function<VectorFunc> &function);
+  NamedFunc(const std::string &name,
+            const std::function<TypedFunc> &function);
   NamedFunc(const std::string &function);
   NamedFunc(const char *function);
   NamedFunc(const TString &function);
@@ -38,14 +54,48 @@ public:
 
   NamedFunc & Function(const std::function<ScalarFunc> &function);
   NamedFunc & Function(const std::function<VectorFunc> &function);
+  NamedFunc & Function(const std::function<TypedFunc> &function);
   const std::function<ScalarFunc> & ScalarFunction() const;
-  const std::function<VectorFunc> & VectorFunction() const;
+  const std::function<TypedFunc> & TypedFunction() const;
+
+  const std::string & Variable() const;
+  NamedFunc & Variable(const std::string &var_name);
+
+  Op Operation() const;
+  const std::vector<std::shared_ptr<const NamedFunc> > & Operands() const;
+  std::size_t Id() const;
+  ScalarType Constant() const;
+  bool Opaque() const;
+
+  bool FileInvariant() const;
+  NamedFunc & FileInvariant(bool file_invariant);
+
+  bool Pure() const;
+  NamedFunc & Pure(bool pure);
+
+  const std::string & Version() const;
+  NamedFunc & Version(const std::string &version);
+  std::string Definition() const;
+
+  Type ResultType() const;
+  NamedFunc & ResultType(Type type);
+
+  bool AddBranches(std::set<std::string> &branches) const;
+  NamedFunc & Branches(const std::set<std::string> &branches);
+
+  NamedFunc & Memoize(std::size_t slot);
+  NamedFunc & Profile(std::size_t index);
+  NamedFunc & ReorderAnd(long learn_calls);
+  NamedFunc & Compile();
+  NamedFunc & Substitute(const std::function<ScalarFunc> &f);
 
   bool IsScalar() const;
   bool IsVector() const;
 
   ScalarType GetScalar(const Baby &b) const;
   VectorType GetVector(const Baby &b) const;
+  VectorView GetView(const Baby &b) const;
+  TypedSpan GetTyped(const Baby &b) const;
 
   NamedFunc & operator += (const NamedFunc &func);
   NamedFunc & operator -= (const NamedFunc &func);
@@ -55,13 +105,30 @@ public:
 
   NamedFunc operator [] (const NamedFunc &func) const;
 
+  static NamedFunc Apply(Op op, const NamedFunc &a);
+  static NamedFunc Apply(Op op, const NamedFunc &a, const NamedFunc &b);
+
 private:
   NamedFunc() = delete;
   std::string name_;//!<String representation of the function
-  std::function<ScalarFunc> scalar_func_;//<!Scalar function. Cannot be valid at same time as NamedFunc::vector_func_.
-  std::function<VectorFunc> vector_func_;//<!Vector function. Cannot be valid at same time as NamedFunc::scalar_func_.
+  std::function<ScalarFunc> scalar_func_;//<!Scalar function. Cannot be valid at same time as NamedFunc::typed_func_.
+  std::function<TypedFunc> typed_func_;//<!Vector function, returning a view of Baby storage or Arena in its native element type. Cannot be valid at same time as NamedFunc::scalar_func_.
+  Op op_;//!<Operation applied to NamedFunc::operands_ to obtain this function
+  std::vector<std::shared_ptr<const NamedFunc> > operands_;//!<Operands of NamedFunc::op_. Empty for leaves.
+  std::size_t id_;//!<Identity of leaf. Equal ids imply equal results.
+  std::string variable_;//!<Name of Baby variable read if NamedFunc::op_ is Op::variable
+  ScalarType constant_;//!<Value returned if NamedFunc::op_ is Op::constant
+  bool opaque_;//!<If true, the callable was wrapped and no longer just applies NamedFunc::op_ to NamedFunc::operands_
+  bool file_invariant_;//!<If true, result is the same for all entries of a file
+  bool pure_;//!<If true, the callable has no side effects and can be evaluated for any entry
+  std::string version_;//!<Version of the callable's body, changed by hand whenever the body changes
+  Type type_;//!<Narrowest type holding every result (every element for vector functions)
+  std::shared_ptr<const std::set<std::string> > branches_;//!<Baby branches read, if declared with NamedFunc::Branches()
 
   void CleanName();
+  void AddVersions(std::set<std::string> &versions) const;
+  static std::size_t NewId();
+  static std::size_t LeafId(const std::string &key);
 };
 
 NamedFunc operator + (NamedFunc f, NamedFunc g);
@@ -88,6 +155,8 @@ NamedFunc operator ! (NamedFunc f);
 std::ostream & operator<<(std::ostream &stream, const NamedFunc &function);
 
 bool HavePass(const NamedFunc::VectorType &v);
+bool HavePass(const NamedFunc::VectorView &v);
+bool HavePass(const TypedSpan &v);
 bool HavePass(const std::vector<NamedFunc::VectorType> &vv);
 
 #endif
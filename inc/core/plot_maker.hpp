@@ -3,8 +3,11 @@
 
 #include <vector>
 #include <set>
+#include <map>
 #include <memory>
 #include <utility>
+#include <string>
+#include <istream>
 
 #include "core/plot_opt.hpp"
 #include "core/figure.hpp"
@@ -42,12 +45,61 @@ public:
 
   bool multithreaded_;
   bool min_print_;
+  std::size_t num_threads_;//!<Number of threads if multithreaded_. 0 uses ThreadPool::DefaultSize()
+  std::size_t num_processes_;//!<Number of forked worker processes filling figures instead of threads. 0 or 1 disables forking
+  long entries_per_task_;//!<Approximate number of entries per task when splitting large babies
+  std::size_t column_block_size_;//!<Number of entries evaluated together by ColumnBatch. 0 disables batch evaluation
+  bool prune_branches_;//!<If true, disable and do not cache branches not read by any figure
+  long branch_warmup_entries_;//!<Entries read while learning branches of functions with undeclared branches
+  std::string skim_cache_dir_;//!<Directory storing entries passing the process cuts of each file. Empty disables the skim cache
+  std::string result_cache_dir_;//!<Directory storing what each component accumulated from each file. Empty disables the result cache
+  std::string trace_file_;//!<File to which a Chrome trace-event timeline of MakePlots() is written. Empty disables tracing
+  std::size_t profile_functions_;//!<Number of most expensive functions listed after MakePlots(). 0 disables profiling
+  long reorder_and_calls_;//!<Evaluations over which && chains measure their operands before reordering them. 0 disables reordering
+  bool use_bytecode_;//!<If true, expressions are evaluated by Bytecode programs instead of nested functors
+  std::string jit_command_;//!<Command compiling expressions to native code with JitCompiler, e.g. JitCompiler::DefaultCommand() or "cling". Empty disables compilation
+  std::size_t shard_index_;//!<Index of shard of entry ranges to fill if num_shards_>1
+  std::size_t num_shards_;//!<Number of shards into which the entry ranges are split among jobs
+  std::string shard_file_;//!<File to which a shard saves its filled figures, with .<k> appended for the k-th MakePlots() call if k>0. Empty uses shard_<i>_of_<N>_call_<k>.part
+  std::vector<std::string> merge_files_;//!<Shard files to merge and print instead of reading babies
+
+  static bool ReadPartialsHeader(std::istream &file, std::size_t &call, std::size_t &index,
+                                 std::size_t &num_parts, long &num_entries);
 
 private:
+  struct EntryRange{
+    EntryRange(Baby *baby, long first, long last);
+
+    Baby *baby_;//!<Baby from which to read entries
+    long first_;//!<First entry to process (inclusive)
+    long last_;//!<Last entry to process (exclusive)
+  };
+
+  //! Privately filled shadow to be merged into each original component
+  using ShadowMap = std::map<Figure::FigureComponent*, std::unique_ptr<Figure::FigureComponent> >;
+
   std::vector<std::unique_ptr<Figure> > figures_;//!<Figures to be produced
+  std::size_t call_index_;//!<Number of the current MakePlots() call among all PlotMakers of this process
 
   void GetYields();
-  long GetYield(Baby *baby_ptr);
+  long ForkYields(const std::set<Baby*> &babies, std::size_t &num_tasks);
+  long ShardYields(const std::set<Baby*> &babies, std::size_t &num_tasks);
+  long WritePartials(const std::vector<EntryRange> &ranges,
+                     const std::vector<std::size_t> &range_indices,
+                     std::size_t index, std::size_t num_parts,
+                     const std::string &file_name);
+  long ReadPartials(const std::string &file_name);
+  std::vector<EntryRange> GetAllRanges(const std::set<Baby*> &babies) const;
+  static std::vector<std::vector<std::size_t> > Partition(const std::vector<EntryRange> &ranges,
+                                                          std::size_t num_parts);
+  std::vector<std::pair<std::string, Figure::FigureComponent*> > GetComponentKeys() const;
+  std::vector<std::pair<NamedFunc*, NamedFunc> > ShareSubexpressions();
+  long GetYield(Baby *baby_ptr, long first_entry, long last_entry,
+                ShadowMap *shadows);
+  static void MergeShadows(ShadowMap &shadows);
+  bool GetBranches(const Baby &baby, std::set<std::string> &branches);
+
+  std::vector<std::pair<long, long> > GetEntryRanges(Baby *baby_ptr) const;
 
   std::set<Baby*> GetBabies() const;
   std::set<const Process *> GetProcesses() const;
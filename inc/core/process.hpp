@@ -5,6 +5,7 @@
 #include <string>
 #include <map>
 #include <set>
+#include <vector>
 #include <mutex>
 
 #include "core/baby.hpp"
@@ -29,9 +30,12 @@ public:
   Type type_;
   NamedFunc cut_;
   int color_;
+  std::vector<NamedFunc> grid_;//!<Scalar keys splitting the process into grid points. Empty if not a grid
 
   std::set<Baby*> Babies() const;
 
+  Process & Grid(const std::vector<NamedFunc> &keys);
+
   ~Process();
 
 private:
@@ -70,7 +74,8 @@ Process::Process(BabyType * /*dummy_baby*/,
   name_(name),
   type_(type),
   cut_(cut),
-  color_(color){
+  color_(color),
+  grid_(){
   std::lock_guard<std::mutex> lock(mutex_);
   for(const auto &file: files){
     const auto &full_files = Glob(file);
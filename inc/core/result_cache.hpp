@@ -0,0 +1,35 @@
+#ifndef H_RESULT_CACHE
+#define H_RESULT_CACHE
+
+#include <string>
+
+#include "core/figure.hpp"
+
+class ResultCache{
+public:
+  explicit ResultCache(const std::string &directory);
+  ResultCache(const ResultCache &) = default;
+  ResultCache & operator=(const ResultCache &) = default;
+  ResultCache(ResultCache &&) = default;
+  ResultCache & operator=(ResultCache &&) = default;
+  ~ResultCache() = default;
+
+  static bool Supports(const Figure::FigureComponent &component);
+
+  bool Load(Figure::FigureComponent &component, const std::string &file_name,
+            long first_entry, long last_entry) const;
+  void Save(const Figure::FigureComponent &component, const std::string &file_name,
+            long first_entry, long last_entry) const;
+
+private:
+  ResultCache() = delete;
+
+  std::string directory_;//!<Directory in which partial results are stored
+
+  static std::string Key(const Figure::FigureComponent &component,
+                         const std::string &file_name,
+                         long first_entry, long last_entry);
+  std::string Path(const std::string &key) const;
+};
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef H_SKIM_CACHE
+#define H_SKIM_CACHE
+
+#include <string>
+#include <vector>
+#include <utility>
+
+class SkimCache{
+public:
+  //! Half-open ranges [first, last) of consecutive entries passing the cut
+  using Runs = std::vector<std::pair<long, long> >;
+
+  SkimCache(const std::string &directory, const std::string &cut);
+  SkimCache(const SkimCache &) = default;
+  SkimCache & operator=(const SkimCache &) = default;
+  SkimCache(SkimCache &&) = default;
+  SkimCache & operator=(SkimCache &&) = default;
+  ~SkimCache() = default;
+
+  bool Load(const std::string &file_name, long first_entry, long last_entry,
+            Runs &runs) const;
+  void Save(const std::string &file_name, long first_entry, long last_entry,
+            const Runs &runs) const;
+
+  static Runs MakeRuns(const std::vector<long> &entries);
+  static std::string Hash(const std::string &text);
+  static std::string FileStamp(const std::string &file_name);
+
+private:
+  SkimCache() = delete;
+
+  std::string directory_;//!<Directory in which entry lists are stored
+  std::string cut_;//!<Canonical text of the cut selecting the entries
+
+  std::string Key(const std::string &file_name, long first_entry, long last_entry) const;
+  std::string Path(const std::string &key) const;
+};
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef H_SPAN
+#define H_SPAN
+
+#include <cstddef>
+#include <vector>
+#include <stdexcept>
+#include <string>
+
+/*!\brief Read-only view of a contiguous array owned elsewhere
+
+  Copying a Span copies only the pointer and length. The viewed array must
+  outlive all uses of the Span.
+
+  \tparam T Type of elements
+*/
+template<typename T>
+class Span{
+public:
+  using value_type = T;
+  using const_iterator = const T*;
+
+  Span(): data_(nullptr), size_(0){}
+  Span(const T *data, std::size_t size): data_(data), size_(size){}
+  explicit Span(const std::vector<T> &v): data_(v.data()), size_(v.size()){}
+  Span(const Span &) = default;
+  Span & operator=(const Span &) = default;
+  Span(Span &&) = default;
+  Span & operator=(Span &&) = default;
+  ~Span() = default;
+
+  const T * data() const{return data_;}
+  std::size_t size() const{return size_;}
+  bool empty() const{return size_ == 0;}
+
+  const_iterator begin() const{return data_;}
+  const_iterator end() const{return data_+size_;}
+  const_iterator cbegin() const{return data_;}
+  const_iterator cend() const{return data_+size_;}
+
+  const T & operator[](std::size_t i) const{return data_[i];}
+  const T & at(std::size_t i) const;
+
+private:
+  const T *data_;//!<First element
+  std::size_t size_;//!<Number of elements
+};
+
+/*!\brief Get element with bounds checking
+
+  \param[in] i Index of element
+
+  \return Reference to element i
+
+  \throws std::out_of_range if i is not less than size()
+*/
+template<typename T>
+const T & Span<T>::at(std::size_t i) const{
+  if(i >= size_) throw std::out_of_range("Span::at: index "+std::to_string(i)
+                                         +" >= size "+std::to_string(size_));
+  return data_[i];
+}
+
+#endif
@@ -11,6 +11,7 @@
 #include "core/process.hpp"
 #include "core/gamma_params.hpp"
 #include "core/plot_opt.hpp"
+#include "core/grid.hpp"
 
 class Table final: public Figure{
 public:
@@ -22,7 +23,24 @@ public:
 
     void RecordEvent(const Baby &baby) final;
 
+    std::unique_ptr<FigureComponent> Shadow() const final;
+    void Merge(const FigureComponent &shadow) final;
+
+    std::vector<NamedFunc*> GetFunctions() final;
+
+    bool AddColumns(ColumnBatch &batch) final;
+    void RecordColumns(const ColumnBatch &batch) final;
+
+    std::string Definition() const final;
+    void WritePartial(std::ostream &out) const final;
+    bool ReadPartial(std::istream &in) final;
+
+    struct GridSums{
+      std::vector<double> sumw_, sumw2_;
+    };
+
     std::vector<double> sumw_, sumw2_;
+    Grid::Map<GridSums> grid_sums_;//!<Per-row sums for each grid point if the process has a grid
 
   private:
     TableColumn() = delete;
@@ -32,7 +50,8 @@ public:
     TableColumn& operator=(TableColumn &&) = delete;
 
     std::vector<NamedFunc> proc_and_table_cut_;
-    NamedFunc::VectorType cut_vector_, wgt_vector_, val_vector_;
+    TypedSpan cut_vector_, wgt_vector_, val_vector_;
+    std::vector<std::size_t> cut_columns_, wgt_columns_;//!<Columns of each row's cut and weight in batch from AddColumns()
   };
 
   Table(const std::string &name,
@@ -50,12 +69,17 @@ public:
              const std::string &subdir) final;
   
   std::vector<GammaParams> Yield(const Process *process, double luminosity) const;
+  std::vector<GammaParams> Yield(const Process *process, double luminosity,
+                                 const Grid::Point &point) const;
+  std::vector<Grid::Point> GridPoints(const Process *process) const;
   std::vector<GammaParams> BackgroundYield(double luminosity) const;
   std::vector<GammaParams> DataYield() const;
   
   std::set<const Process*> GetProcesses() const final;
 
   FigureComponent * GetComponent(const Process *process) final;
+
+  std::vector<NamedFunc*> GetFunctions() final;
   
   std::string name_;
   std::vector<TableRow> rows_;
@@ -75,6 +99,7 @@ private:
   Table() = delete;
 
   const std::vector<std::unique_ptr<TableColumn> >& GetComponentList(const Process *process) const;
+  const TableColumn * GetColumn(const Process *process) const;
 
   void PrintHeader(std::ofstream &file, double luminosity) const;
   void PrintRow(std::ofstream &file, std::size_t irow, double luminosity) const;
@@ -0,0 +1,6 @@
+#ifndef H_TEST_EVALUATION
+#define H_TEST_EVALUATION
+
+void GetOptions(int argc, char *argv[]);
+
+#endif
@@ -6,7 +6,7 @@
 #include <future>
 #include <memory>
 #include <functional>
-#include <queue>
+#include <deque>
 #include <mutex>
 #include <vector>
 #include <atomic>
@@ -21,22 +21,22 @@ public:
   std::size_t Size() const;
   void Resize(size_t num_threads);
 
+  static std::size_t DefaultSize();
+  static std::size_t CurrentWorker();
+
   template<typename FuncType, typename...ArgTypes>
   auto Push(FuncType &&func, ArgTypes&&... args) -> std::future<decltype(func(args...))>;
 
 private:
+  using FuncPtr = std::unique_ptr<std::function<void()> >;
+
   ThreadPool(const ThreadPool &) = delete;
   ThreadPool& operator=(const ThreadPool &) = delete;
   ThreadPool(ThreadPool &&) = delete;
   ThreadPool& operator=(ThreadPool &&) = delete;
 
-  void DoTasksFromQueue(size_t ithread);
-  bool ReadyToAct(size_t ithread, std::unique_ptr<std::function<void()> > &task);
-
   class Queue{
   public:
-    using FuncPtr = std::unique_ptr<std::function<void()> >;
-
     Queue() = default;
     ~Queue() = default;
 
@@ -49,26 +49,48 @@ private:
     Queue(Queue &&) = delete;
     Queue& operator=(Queue &&) = delete;
 
-    std::queue<FuncPtr> queue_;
+    std::deque<FuncPtr> deque_;
     std::mutex mutex_;
   };
 
-  Queue tasks_;
-  std::vector<std::unique_ptr<std::thread> > threads_;
-  std::vector<std::shared_ptr<std::atomic<bool> > > stop_thread_now_;
+  class Worker{
+  public:
+    Worker();
+    ~Worker() = default;
+
+    Queue tasks_;//!<Tasks assigned to this worker, open to stealing by the others
+    std::thread thread_;
+    std::atomic<bool> stop_now_;
+
+  private:
+    Worker(const Worker &) = delete;
+    Worker& operator=(const Worker &) = delete;
+    Worker(Worker &&) = delete;
+    Worker& operator=(Worker &&) = delete;
+  };
+
+  void PushTask(FuncPtr &func);
+  void DoTasks(std::size_t iworker);
+  FuncPtr FindTask(std::size_t iworker);
+  std::vector<FuncPtr> StopWorkers();
+
+  std::vector<std::unique_ptr<Worker> > workers_;
+  std::atomic<std::size_t> next_worker_;//!<Round-robin counter for tasks pushed from outside the pool
+  std::size_t num_queued_;//!<Tasks pushed but not yet picked up by any worker. Guarded by mutex_, as are the queues.
   std::atomic<bool> stop_at_empty_;
 
   std::mutex mutex_;
   std::condition_variable cv_;
+
+  static thread_local const ThreadPool *current_pool_;//!<Pool owning the calling thread, if any
+  static thread_local std::size_t current_worker_;//!<Index of the calling thread in current_pool_
 };
 
 template<typename FuncType, typename...ArgTypes>
 auto ThreadPool::Push(FuncType &&func, ArgTypes&&... args) -> std::future<decltype(func(args...))>{
   auto task =  std::make_shared<std::packaged_task<decltype(func(args...))()> >(std::bind(std::forward<FuncType>(func), std::forward<ArgTypes>(args)...));
-  std::unique_ptr<std::function<void()> > pkg_func(new std::function<void()>([task](){(*task)();}));
-  tasks_.Push(pkg_func);
-  std::lock_guard<std::mutex> lock(mutex_);
-  cv_.notify_one();
+  FuncPtr pkg_func(new std::function<void()>([task](){(*task)();}));
+  PushTask(pkg_func);
   return task->get_future();
 }
 
@@ -0,0 +1,39 @@
+#ifndef H_TRACE
+#define H_TRACE
+
+#include <string>
+
+class Trace{
+public:
+  class Span{
+  public:
+    explicit Span(const char *name, const std::string &detail = std::string());
+    Span(const Span &) = delete;
+    Span & operator=(const Span &) = delete;
+    Span(Span &&) = delete;
+    Span & operator=(Span &&) = delete;
+    ~Span();
+
+    void End();
+    void Discard();
+
+  private:
+    const char *name_;//!<Name of span shown in timeline
+    std::string detail_;//!<Optional description shown in span arguments
+    long start_;//!<Start time in microseconds since Trace::Start()
+    bool active_;//!<Flag if span is still to be recorded
+  };
+
+  static void Start();
+  static bool Enabled();
+  static void Write(const std::string &file_name);
+
+private:
+  Trace() = delete;
+
+  static long Now();
+  static void Record(const char *name, const std::string &detail,
+                     long start, long duration);
+};
+
+#endif
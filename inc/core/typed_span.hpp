@@ -0,0 +1,381 @@
+#ifndef H_TYPED_SPAN
+#define H_TYPED_SPAN
+
+#include <cstddef>
+#include <vector>
+#include <functional>
+
+#include "core/span.hpp"
+#include "core/arena.hpp"
+
+/*!\brief Read-only view of a contiguous array of bool, int, float, or double
+
+  Lets vector branches be read in the type in which they are stored. Elements
+  are converted to double only when read, and element-wise operations dispatch
+  on the element type once per call rather than once per element. Results of
+  operations are stored in Arena, as bool masks for comparisons and logical
+  operations (see ElementResult) and as double otherwise.
+*/
+class TypedSpan{
+public:
+  //! Type of viewed elements
+  enum class Type{bool_type, int_type, float_type, double_type};
+
+  TypedSpan(): data_(nullptr), size_(0), type_(Type::double_type){}
+  TypedSpan(const Span<double> &s): data_(s.data()), size_(s.size()), type_(Type::double_type){}
+  TypedSpan(const Span<float> &s): data_(s.data()), size_(s.size()), type_(Type::float_type){}
+  TypedSpan(const Span<int> &s): data_(s.data()), size_(s.size()), type_(Type::int_type){}
+  TypedSpan(const Span<bool> &s): data_(s.data()), size_(s.size()), type_(Type::bool_type){}
+  TypedSpan(const TypedSpan &) = default;
+  TypedSpan & operator=(const TypedSpan &) = default;
+  TypedSpan(TypedSpan &&) = default;
+  TypedSpan & operator=(TypedSpan &&) = default;
+  ~TypedSpan() = default;
+
+  Type ElementType() const{return type_;}
+  std::size_t size() const{return size_;}
+  bool empty() const{return size_ == 0;}
+
+  double operator[](std::size_t i) const;
+  double at(std::size_t i) const;
+
+  template<typename T>
+  Span<T> As() const;
+
+  Span<double> Widen() const;
+
+  bool AnyNonzero() const;
+  bool AllNonzero() const;
+
+  template<typename R = double, typename Operator>
+  Span<R> Transform(const Operator &op) const;
+  template<typename R = double, typename Operator>
+  Span<R> TransformLeft(double a, const Operator &op) const;
+  template<typename R = double, typename Operator>
+  Span<R> TransformRight(const Operator &op, double b) const;
+  template<typename R = double, typename Operator>
+  static Span<R> Zip(const Operator &op, const TypedSpan &a, const TypedSpan &b);
+
+  template<typename T>
+  static TypedSpan Of(const std::vector<T> &v);
+  template<typename T>
+  static Type TypeOf();
+
+private:
+  const void *data_;//!<First element
+  std::size_t size_;//!<Number of elements
+  Type type_;//!<Type of elements
+
+  template<typename R, typename T, typename Operator>
+  static Span<R> Map(const Operator &op, const Span<T> &a);
+  template<typename R, typename T, typename Operator>
+  static Span<R> ZipLeft(const Operator &op, const Span<T> &a, const TypedSpan &b);
+  template<typename R, typename T, typename U, typename Operator>
+  static Span<R> Zip(const Operator &op, const Span<T> &a, const Span<U> &b);
+};
+
+/*!\brief Element type of the result of applying an operator element-wise
+
+  Comparisons and logical operations give bool, so their results are stored as
+  compact masks. All other operations give double.
+
+  \tparam Operator Type of function object applied to doubles
+*/
+template<typename Operator>
+struct ElementResult{
+  using type = double;//!<Element type of result
+};
+
+template<> struct ElementResult<std::equal_to<double> >{using type = bool;};
+template<> struct ElementResult<std::not_equal_to<double> >{using type = bool;};
+template<> struct ElementResult<std::greater<double> >{using type = bool;};
+template<> struct ElementResult<std::less<double> >{using type = bool;};
+template<> struct ElementResult<std::greater_equal<double> >{using type = bool;};
+template<> struct ElementResult<std::less_equal<double> >{using type = bool;};
+template<> struct ElementResult<std::logical_and<double> >{using type = bool;};
+template<> struct ElementResult<std::logical_or<double> >{using type = bool;};
+template<> struct ElementResult<std::logical_not<double> >{using type = bool;};
+
+/*!\brief Get element converted to double, without bounds checking
+
+  \param[in] i Index of element
+
+  \return Element i
+*/
+inline double TypedSpan::operator[](std::size_t i) const{
+  switch(type_){
+  case Type::bool_type: return static_cast<const bool*>(data_)[i];
+  case Type::int_type: return static_cast<const int*>(data_)[i];
+  case Type::float_type: return static_cast<const float*>(data_)[i];
+  case Type::double_type:
+  default: return static_cast<const double*>(data_)[i];
+  }
+}
+
+/*!\brief Get element converted to double, with bounds checking
+
+  \param[in] i Index of element
+
+  \return Element i
+
+  \throws std::out_of_range if i is not less than size()
+*/
+inline double TypedSpan::at(std::size_t i) const{
+  switch(type_){
+  case Type::bool_type: return As<bool>().at(i);
+  case Type::int_type: return As<int>().at(i);
+  case Type::float_type: return As<float>().at(i);
+  case Type::double_type:
+  default: return As<double>().at(i);
+  }
+}
+
+/*!\brief Get view in the stored element type
+
+  \tparam T Must be the type given by ElementType()
+
+  \return View of the elements
+*/
+template<typename T>
+Span<T> TypedSpan::As() const{
+  return Span<T>(static_cast<const T*>(data_), size_);
+}
+
+/*!\brief Get view of elements converted to double
+
+  \return View of *this if the elements are double, else of a copy in Arena
+*/
+inline Span<double> TypedSpan::Widen() const{
+  switch(type_){
+  case Type::bool_type: return Arena::Copy<double>(As<bool>().cbegin(), As<bool>().cend());
+  case Type::int_type: return Arena::Copy<double>(As<int>().cbegin(), As<int>().cend());
+  case Type::float_type: return Arena::Copy<double>(As<float>().cbegin(), As<float>().cend());
+  case Type::double_type:
+  default: return As<double>();
+  }
+}
+
+/*!\brief Check if any element is nonzero
+
+  \return True if any element is nonzero (or NaN)
+*/
+inline bool TypedSpan::AnyNonzero() const{
+  if(type_ == Type::bool_type){
+    const bool *mask = static_cast<const bool*>(data_);
+    for(std::size_t i = 0; i < size_; ++i){
+      if(mask[i]) return true;
+    }
+    return false;
+  }
+  for(std::size_t i = 0; i < size_; ++i){
+    if((*this)[i] != 0.) return true;
+  }
+  return false;
+}
+
+/*!\brief Check if all elements are nonzero
+
+  \return True if all elements are nonzero (or NaN)
+*/
+inline bool TypedSpan::AllNonzero() const{
+  if(type_ == Type::bool_type){
+    const bool *mask = static_cast<const bool*>(data_);
+    for(std::size_t i = 0; i < size_; ++i){
+      if(!mask[i]) return false;
+    }
+    return true;
+  }
+  for(std::size_t i = 0; i < size_; ++i){
+    if((*this)[i] == 0.) return false;
+  }
+  return true;
+}
+
+/*!\brief Apply unary operator to each element
+
+  \tparam R Element type of result, e.g. from ElementResult
+
+  \param[in] op Operator taking a double
+
+  \return View of results, stored in Arena
+*/
+template<typename R, typename Operator>
+Span<R> TypedSpan::Transform(const Operator &op) const{
+  switch(type_){
+  case Type::bool_type: return Map<R>(op, As<bool>());
+  case Type::int_type: return Map<R>(op, As<int>());
+  case Type::float_type: return Map<R>(op, As<float>());
+  case Type::double_type:
+  default: return Map<R>(op, As<double>());
+  }
+}
+
+/*!\brief Apply binary operator with a scalar left operand to each element
+
+  \tparam R Element type of result, e.g. from ElementResult
+
+  \param[in] a Left operand
+
+  \param[in] op Operator taking two doubles
+
+  \return View of op(a, x) for each element x, stored in Arena
+*/
+template<typename R, typename Operator>
+Span<R> TypedSpan::TransformLeft(double a, const Operator &op) const{
+  return Transform<R>([&op, a](double x){return op(a, x);});
+}
+
+/*!\brief Apply binary operator with a scalar right operand to each element
+
+  \tparam R Element type of result, e.g. from ElementResult
+
+  \param[in] op Operator taking two doubles
+
+  \param[in] b Right operand
+
+  \return View of op(x, b) for each element x, stored in Arena
+*/
+template<typename R, typename Operator>
+Span<R> TypedSpan::TransformRight(const Operator &op, double b) const{
+  return Transform<R>([&op, b](double x){return op(x, b);});
+}
+
+/*!\brief Apply binary operator to corresponding elements
+
+  \tparam R Element type of result, e.g. from ElementResult
+
+  \param[in] op Operator taking two doubles
+
+  \param[in] a Left operands
+
+  \param[in] b Right operands
+
+  \return View of op(a[i], b[i]) for i up to the length of the shorter
+  operand, stored in Arena
+*/
+template<typename R, typename Operator>
+Span<R> TypedSpan::Zip(const Operator &op, const TypedSpan &a, const TypedSpan &b){
+  switch(a.type_){
+  case Type::bool_type: return ZipLeft<R>(op, a.As<bool>(), b);
+  case Type::int_type: return ZipLeft<R>(op, a.As<int>(), b);
+  case Type::float_type: return ZipLeft<R>(op, a.As<float>(), b);
+  case Type::double_type:
+  default: return ZipLeft<R>(op, a.As<double>(), b);
+  }
+}
+
+/*!\brief Get view of a vector, copied into Arena unless its elements are
+  double, float, or int
+
+  \param[in] v Vector to view. Must outlive the result.
+
+  \return View of v or of its copy, as bool mask for vector<bool> and double
+  for other types
+*/
+template<typename T>
+TypedSpan TypedSpan::Of(const std::vector<T> &v){
+  return Arena::Copy<double>(v.cbegin(), v.cend());
+}
+
+template<>
+inline TypedSpan TypedSpan::Of(const std::vector<double> &v){
+  return Span<double>(v);
+}
+
+template<>
+inline TypedSpan TypedSpan::Of(const std::vector<float> &v){
+  return Span<float>(v);
+}
+
+template<>
+inline TypedSpan TypedSpan::Of(const std::vector<int> &v){
+  return Span<int>(v);
+}
+
+template<>
+inline TypedSpan TypedSpan::Of(const std::vector<bool> &v){
+  return Arena::Copy<bool>(v.cbegin(), v.cend());
+}
+
+/*!\brief Get the Type of a C++ type
+
+  \tparam T C++ type
+
+  \return Type whose values include all values of T exactly. Types other than
+  bool, int, and float give Type::double_type.
+*/
+template<typename T>
+TypedSpan::Type TypedSpan::TypeOf(){
+  return Type::double_type;
+}
+
+template<>
+inline TypedSpan::Type TypedSpan::TypeOf<bool>(){
+  return Type::bool_type;
+}
+
+template<>
+inline TypedSpan::Type TypedSpan::TypeOf<int>(){
+  return Type::int_type;
+}
+
+template<>
+inline TypedSpan::Type TypedSpan::TypeOf<float>(){
+  return Type::float_type;
+}
+
+/*!\brief Apply unary operator to each element of known type
+
+  \param[in] op Operator taking a double
+
+  \param[in] a Operands
+
+  \return View of results, stored in Arena
+*/
+template<typename R, typename T, typename Operator>
+Span<R> TypedSpan::Map(const Operator &op, const Span<T> &a){
+  R *out = Arena::Allocate<R>(a.size());
+  for(std::size_t i = 0; i < a.size(); ++i) out[i] = op(a[i]);
+  return Span<R>(out, a.size());
+}
+
+/*!\brief Dispatch on element type of right operand of Zip()
+
+  \param[in] op Operator taking two doubles
+
+  \param[in] a Left operands
+
+  \param[in] b Right operands
+
+  \return View of results, stored in Arena
+*/
+template<typename R, typename T, typename Operator>
+Span<R> TypedSpan::ZipLeft(const Operator &op, const Span<T> &a, const TypedSpan &b){
+  switch(b.type_){
+  case Type::bool_type: return Zip<R>(op, a, b.As<bool>());
+  case Type::int_type: return Zip<R>(op, a, b.As<int>());
+  case Type::float_type: return Zip<R>(op, a, b.As<float>());
+  case Type::double_type:
+  default: return Zip<R>(op, a, b.As<double>());
+  }
+}
+
+/*!\brief Apply binary operator to corresponding elements of known types
+
+  \param[in] op Operator taking two doubles
+
+  \param[in] a Left operands
+
+  \param[in] b Right operands
+
+  \return View of results, stored in Arena
+*/
+template<typename R, typename T, typename U, typename Operator>
+Span<R> TypedSpan::Zip(const Operator &op, const Span<T> &a, const Span<U> &b){
+  std::size_t size = a.size() > b.size() ? b.size() : a.size();
+  R *out = Arena::Allocate<R>(size);
+  for(std::size_t i = 0; i < size; ++i) out[i] = op(a[i], b[i]);
+  return Span<R>(out, size);
+}
+
+#endif
@@ -75,6 +75,9 @@ void Normalize(TH1D &h, double normalization, bool norm_per_avg_x);
 
 void MergeOverflow(TH1D &h, bool merge_underflow, bool merge_overflow);
 
+void WriteHistContents(std::ostream &out, const TH1 &hist);
+bool ReadHistContents(std::istream &in, TH1 &hist);
+
 std::string FixedDigits(double x, int n_digits);
 
 std::string FullTitle(const TH1 &h);
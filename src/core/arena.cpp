@@ -0,0 +1,81 @@
+/*! \class Arena
+
+  \brief Per-thread bump allocator for the vector results of \link NamedFunc
+  NamedFuncs\endlink
+
+  Evaluating a vector expression such as "ak4pfjets_pt>30" used to allocate a
+  new std::vector for every leaf and operator at every entry. Such results now
+  live in blocks of memory owned by the evaluating thread and are passed around
+  as NamedFunc::VectorView. Allocating moves a pointer through the current
+  block, and Baby::GetEntry() calls Reset(), which makes all blocks reusable at
+  once. After the first few entries the blocks are large enough, and vector
+  evaluation does no heap allocation at all.
+
+  Consequently, a view obtained from NamedFunc::GetView() is only valid until
+  the Baby moves to another entry, and must not be passed to another thread.
+*/
+#include "core/arena.hpp"
+
+using namespace std;
+
+const size_t Arena::kBlockSize;
+
+/*!\brief Make all memory of the calling thread reusable
+
+  Invalidates all storage previously returned to this thread.
+*/
+void Arena::Reset(){
+  Blocks &blocks = ThreadBlocks();
+  blocks.current_ = 0;
+  blocks.used_ = 0;
+}
+
+/*!\brief Get memory held by the calling thread
+
+  \return Total size of the thread's blocks in bytes
+*/
+size_t Arena::Capacity(){
+  const Blocks &blocks = ThreadBlocks();
+  size_t capacity = 0;
+  for(const auto &size: blocks.sizes_){
+    capacity += size;
+  }
+  return capacity;
+}
+
+/*!\brief Get storage from the calling thread's blocks
+
+  Skips to the next block (allocating one if needed) when the current one is
+  too small.
+
+  \param[in] bytes Size of storage
+
+  \return Pointer to storage aligned for any fundamental type
+*/
+void * Arena::AllocateBytes(size_t bytes){
+  const size_t align = alignof(max_align_t);
+  bytes = (bytes+align-1)/align*align;
+  Blocks &blocks = ThreadBlocks();
+  while(blocks.current_ < blocks.data_.size()
+        && blocks.used_+bytes > blocks.sizes_[blocks.current_]){
+    ++blocks.current_;
+    blocks.used_ = 0;
+  }
+  if(blocks.current_ == blocks.data_.size()){
+    size_t size = max(kBlockSize, bytes);
+    blocks.data_.emplace_back(new char[size]);
+    blocks.sizes_.push_back(size);
+  }
+  void *out = blocks.data_[blocks.current_].get()+blocks.used_;
+  blocks.used_ += bytes;
+  return out;
+}
+
+/*!\brief Get blocks of the calling thread
+
+  \return Blocks owned by the calling thread
+*/
+Arena::Blocks & Arena::ThreadBlocks(){
+  thread_local Blocks blocks{{}, {}, 0, 0};
+  return blocks;
+}
@@ -0,0 +1,142 @@
+/*! \class BulkColumnBase
+
+  \brief Tracks which basket of a branch is held by a BulkColumn
+
+  Reading a branch entry by entry goes through the full TBranch machinery once
+  per event. A BulkColumn instead reads every entry of the basket containing the
+  requested entry at once into a contiguous array, so that later entries of the
+  same basket are served by indexing into that array. Buffered baskets are
+  identified by tree number and entry range, since a TChain replaces its
+  branches whenever it moves to a new file.
+*/
+
+/*! \class BulkColumn
+
+  \brief Contiguous buffer of all values of a branch in one basket
+
+  Scalar branches are deserialized with ROOT's bulk interface, falling back to
+  reading by the caller if the branch does not support it. ROOT has no such
+  interface for vector branches, so their baskets are decoded directly from the
+  serialized form into offsets and one concatenated array of elements, again
+  falling back to reading by the caller if a basket has an unexpected layout.
+*/
+#include "core/bulk_column.hpp"
+
+#include <algorithm>
+#include <cstdint>
+
+using namespace std;
+
+/*!\brief Standard constructor. No basket is buffered.
+ */
+BulkColumnBase::BulkColumnBase():
+  tree_number_(-1),
+  basket_(-1),
+  first_entry_(0),
+  last_entry_(0){
+}
+
+/*!\brief Check if an entry is in the buffered basket
+
+  \param[in] tree_number Index in TChain of tree containing entry
+
+  \param[in] entry Entry number within tree
+
+  \return True if entry can be read from buffer
+*/
+bool BulkColumnBase::Contains(int tree_number, long entry) const{
+  return tree_number == tree_number_ && entry >= first_entry_ && entry < last_entry_;
+}
+
+/*!\brief Set the buffered entry range to the basket containing an entry
+
+  \param[in] branch Branch to be read
+
+  \param[in] tree_number Index in TChain of tree owning branch
+
+  \param[in] entry Entry number within tree
+
+  \return True if a basket containing entry was found
+*/
+bool BulkColumnBase::FindBasket(TBranch &branch, int tree_number, long entry){
+  tree_number_ = -1;
+  const Long64_t *starts = branch.GetBasketEntry();
+  long num_entries = branch.GetEntries();
+  if(starts == nullptr || entry < 0 || entry >= num_entries) return false;
+  int write_basket = branch.GetWriteBasket();
+  const Long64_t *next = upper_bound(starts, starts+write_basket+1, static_cast<Long64_t>(entry));
+  if(next == starts) return false;
+  basket_ = static_cast<int>(next-starts)-1;
+  first_entry_ = *(next-1);
+  last_entry_ = next == starts+write_basket+1 ? num_entries : *next;
+  if(last_entry_ > num_entries) last_entry_ = num_entries;
+  tree_number_ = tree_number;
+  return true;
+}
+
+/*!\brief Get position of an entry in the buffered arrays
+
+  \param[in] entry Entry number within tree. Must be in buffered basket.
+
+  \return Index of entry relative to start of basket
+*/
+size_t BulkColumnBase::Index(long entry) const{
+  return static_cast<size_t>(entry-first_entry_);
+}
+
+/*!\brief Find the elements of one serialized std::vector entry in a basket
+
+  A vector is stored as a byte count with ROOT's kByteCountMask set, a 2 byte
+  class version, the number of elements, and the elements themselves, all
+  big-endian.
+
+  \param[in] begin Start of serialized entry
+
+  \param[in] end End of serialized entry
+
+  \param[in] element_size Size in bytes of one element
+
+  \param[out] elements Start of first element
+
+  \param[out] num_elements Number of elements
+
+  \return True if the entry has exactly this layout
+*/
+bool BulkColumnBase::GetVectorElements(const char *begin, const char *end, size_t element_size,
+                                       const char *&elements, size_t &num_elements){
+  const uint32_t byte_count_mask = 0x40000000;
+  const long header_size = 10;
+  if(end-begin < header_size) return false;
+  uint32_t byte_count = 0, size = 0;
+  FromBigEndian(begin, sizeof(byte_count), &byte_count);
+  FromBigEndian(begin+6, sizeof(size), &size);
+  if(!(byte_count & byte_count_mask)) return false;
+  byte_count &= ~byte_count_mask;
+  if(byte_count != static_cast<uint32_t>(end-begin-4)) return false;
+  if(static_cast<size_t>(end-begin-header_size) != size*element_size) return false;
+  elements = begin+header_size;
+  num_elements = size;
+  return true;
+}
+
+/*!\brief Copy a big-endian value as stored by ROOT into native byte order
+
+  \param[in] data Serialized value
+
+  \param[in] size Size in bytes of value
+
+  \param[out] value Pointer to object of the given size
+*/
+void BulkColumnBase::FromBigEndian(const char *data, size_t size, void *value){
+  const uint16_t one = 1;
+  unsigned char first_byte = 0;
+  memcpy(&first_byte, &one, 1);
+  char *out = static_cast<char*>(value);
+  if(first_byte == 0){
+    memcpy(out, data, size);
+  }else{
+    for(size_t i = 0; i < size; ++i){
+      out[i] = data[size-1-i];
+    }
+  }
+}
@@ -0,0 +1,1146 @@
+/*! \class Bytecode
+
+  \brief Evaluates a NamedFunc as a flat program of register instructions
+  instead of a tree of nested functors
+
+  Each operator applied to \link NamedFunc NamedFuncs\endlink normally wraps
+  the functors of its operands in a new functor, so evaluating a cut costs an
+  indirect call for every operator, constant, and operand. Bytecode walks the
+  expression tree once (NamedFunc::Operation() and NamedFunc::Operands()) and
+  emits one instruction per operator into a flat list. A small interpreter loop
+  runs the list, keeping intermediate scalar and vector results in registers.
+  Constants are stored in the program, and only the leaves (Baby variables and
+  arbitrary functions) are still called through their functors.
+
+  Scalar registers come in three classes, chosen from NamedFunc::ResultType():
+  bool for comparisons and logical operations, integer for int variables,
+  constants, and subscripts of int vectors, and real for everything else.
+  Comparisons of integers run on integer registers, and the terms of "&&" and
+  "||" chains are tested as bools, so cuts on counts and flags never go
+  through floating point. Arithmetic stays in real registers, and leaves still
+  return ScalarType, as does the program itself.
+
+  Identical subexpressions within a program are computed once and read from
+  the same register afterwards. Chains of "&&" and "||" keep their
+  short-circuit evaluation through conditional jumps, and a subexpression first
+  computed after such a jump is not reused where the jump may have skipped it.
+
+  Since every dispatched instruction costs about as much as a functor call,
+  the call of a scalar leaf is merged into the instruction first using its
+  result, and a conditional jump into the instruction computing the tested
+  value. A cut like "njets>=2&&met>150" thus runs as two instructions.
+
+  Functions whose callable was replaced (see NamedFunc::Opaque()), e.g. by
+  NamedFunc::Memoize(), are called as a whole like leaves.
+
+  Vector registers are views of Baby branches in their stored element type or
+  of storage from Arena, so vector instructions neither copy branches nor
+  allocate once the arena is warmed up. Programs with few registers
+  keep them on the stack. Otherwise, registers live in a per-thread stack of
+  frames reused by later evaluations. Either way, a program may be run
+  concurrently by several threads and may call functions which themselves run
+  programs.
+*/
+#include "core/bytecode.hpp"
+
+#include <cmath>
+#include <memory>
+#include <algorithm>
+
+#include "core/utilities.hpp"
+#include "core/arena.hpp"
+
+using namespace std;
+
+using Op = NamedFunc::Op;
+using ScalarType = NamedFunc::ScalarType;
+using TypedFunc = NamedFunc::TypedFunc;
+
+namespace{
+  /*!\brief Registers of one running program
+
+    Frames are kept per thread and per nesting depth, so their storage is
+    reused by the next program run at the same depth.
+  */
+  class Registers{
+  public:
+    /*!\brief Acquire the frame for the current nesting depth
+
+      \param[in] num_scalars Number of real registers needed
+
+      \param[in] num_integers Number of integer registers needed
+
+      \param[in] num_booleans Number of bool registers needed
+
+      \param[in] num_vectors Number of vector registers needed
+    */
+    Registers(size_t num_scalars, size_t num_integers, size_t num_booleans, size_t num_vectors):
+      frame_(nullptr){
+      vector<unique_ptr<Frame> > &stack = Stack();
+      size_t &depth = Depth();
+      if(depth == stack.size()) stack.emplace_back(new Frame());
+      frame_ = stack[depth++].get();
+      if(frame_->scalars_.size() < num_scalars) frame_->scalars_.resize(num_scalars, 0.);
+      if(frame_->integers_.size() < num_integers) frame_->integers_.resize(num_integers, 0);
+      if(frame_->num_booleans_ < num_booleans){
+        frame_->booleans_.reset(new bool[num_booleans]());
+        frame_->num_booleans_ = num_booleans;
+      }
+      if(frame_->vectors_.size() < num_vectors) frame_->vectors_.resize(num_vectors);
+    }
+    Registers(const Registers &) = delete;
+    Registers & operator=(const Registers &) = delete;
+    Registers(Registers &&) = delete;
+    Registers & operator=(Registers &&) = delete;
+
+    /*!\brief Release the frame
+     */
+    ~Registers(){
+      --Depth();
+    }
+
+    /*!\brief Get real registers
+
+      \return Pointer to first real register
+    */
+    ScalarType * Scalars(){
+      return frame_->scalars_.data();
+    }
+
+    /*!\brief Get integer registers
+
+      \return Pointer to first integer register
+    */
+    long * Integers(){
+      return frame_->integers_.data();
+    }
+
+    /*!\brief Get bool registers
+
+      \return Pointer to first bool register
+    */
+    bool * Booleans(){
+      return frame_->booleans_.get();
+    }
+
+    /*!\brief Get vector registers
+
+      \return Pointer to first vector register
+    */
+    TypedSpan * Vectors(){
+      return frame_->vectors_.data();
+    }
+
+  private:
+    struct Frame{
+      Frame(): scalars_(), integers_(), booleans_(), num_booleans_(0), vectors_(){}
+
+      vector<ScalarType> scalars_;//!<Real registers
+      vector<long> integers_;//!<Integer registers
+      unique_ptr<bool[]> booleans_;//!<Bool registers
+      size_t num_booleans_;//!<Number of bool registers allocated
+      vector<TypedSpan> vectors_;//!<Vector registers
+    };
+
+    Frame *frame_;//!<Frame in use
+
+    /*!\brief Get frames of the calling thread
+
+      \return Frames indexed by nesting depth
+    */
+    static vector<unique_ptr<Frame> > & Stack(){
+      thread_local vector<unique_ptr<Frame> > stack;
+      return stack;
+    }
+
+    /*!\brief Get number of frames in use by the calling thread
+
+      \return Reference to nesting depth
+    */
+    static size_t & Depth(){
+      thread_local size_t depth = 0;
+      return depth;
+    }
+  };
+
+  /*!\brief Apply an element-wise binary operation to scalar and vector
+    operands
+
+    Vector results have the length of the shorter vector operand, and scalar
+    operands are applied to every element, as for the functors built by
+    NamedFunc::Apply(). The result is stored in Arena.
+
+    \param[in] op Binary operator
+
+    \param[in] vector_a Flag if left operand is va rather than sa
+
+    \param[in] vector_b Flag if right operand is vb rather than sb
+
+    \param[in] sa Left operand if scalar
+
+    \param[in] va Left operand if vector
+
+    \param[in] sb Right operand if scalar
+
+    \param[in] vb Right operand if vector
+
+    \return Result
+  */
+  template<typename Operator>
+    TypedSpan Combine(const Operator &op, bool vector_a, bool vector_b,
+                      ScalarType sa, const TypedSpan &va,
+                      ScalarType sb, const TypedSpan &vb){
+    using Result = typename ElementResult<Operator>::type;
+    if(vector_a && vector_b){
+      return TypedSpan::Zip<Result>(op, va, vb);
+    }else if(vector_a){
+      return va.TransformRight<Result>(op, sb);
+    }else{
+      return vb.TransformLeft<Result>(sa, op);
+    }
+  }
+
+  /*!\brief Apply a binary operation with at least one vector operand
+
+    \param[in] op Binary operation other than Op::subscript
+
+    \param[in] vector_a Flag if left operand is va rather than sa
+
+    \param[in] vector_b Flag if right operand is vb rather than sb
+
+    \param[in] sa Left operand if scalar
+
+    \param[in] va Left operand if vector
+
+    \param[in] sb Right operand if scalar
+
+    \param[in] vb Right operand if vector
+
+    \return Result, stored in Arena unless it is vb itself
+  */
+  TypedSpan BinaryVector(Op op, bool vector_a, bool vector_b,
+                         ScalarType sa, const TypedSpan &va,
+                         ScalarType sb, const TypedSpan &vb){
+    switch(op){
+    case Op::plus:
+      return Combine(plus<ScalarType>(), vector_a, vector_b, sa, va, sb, vb);
+    case Op::minus:
+      return Combine(minus<ScalarType>(), vector_a, vector_b, sa, va, sb, vb);
+    case Op::multiplies:
+      return Combine(multiplies<ScalarType>(), vector_a, vector_b, sa, va, sb, vb);
+    case Op::divides:
+      return Combine(divides<ScalarType>(), vector_a, vector_b, sa, va, sb, vb);
+    case Op::modulus:
+      return Combine(static_cast<ScalarType (*)(ScalarType ,ScalarType)>(fmod),
+                     vector_a, vector_b, sa, va, sb, vb);
+    case Op::equal_to:
+      return Combine(equal_to<ScalarType>(), vector_a, vector_b, sa, va, sb, vb);
+    case Op::not_equal_to:
+      return Combine(not_equal_to<ScalarType>(), vector_a, vector_b, sa, va, sb, vb);
+    case Op::greater:
+      return Combine(greater<ScalarType>(), vector_a, vector_b, sa, va, sb, vb);
+    case Op::less:
+      return Combine(less<ScalarType>(), vector_a, vector_b, sa, va, sb, vb);
+    case Op::greater_equal:
+      return Combine(greater_equal<ScalarType>(), vector_a, vector_b, sa, va, sb, vb);
+    case Op::less_equal:
+      return Combine(less_equal<ScalarType>(), vector_a, vector_b, sa, va, sb, vb);
+    case Op::logical_and:
+    case Op::logical_or:
+      if(!vector_a){
+        //Scalar decides alone, otherwise the vector is passed through unchanged
+        bool fill = op == Op::logical_or;
+        if(static_cast<bool>(sa) != fill) return vb;
+        bool *vo = Arena::Allocate<bool>(vb.size());
+        std::fill(vo, vo+vb.size(), fill);
+        return Span<bool>(vo, vb.size());
+      }else if(op == Op::logical_and){
+        return Combine(logical_and<ScalarType>(), vector_a, vector_b, sa, va, sb, vb);
+      }else{
+        return Combine(logical_or<ScalarType>(), vector_a, vector_b, sa, va, sb, vb);
+      }
+    case Op::function:
+    case Op::variable:
+    case Op::constant:
+    case Op::negate:
+    case Op::logical_not:
+    case Op::subscript:
+    default:
+      ERROR("Operation "+to_string(static_cast<int>(op))+" is not binary");
+    }
+  }
+
+  /*!\brief Collect the terms of a chain of the same scalar logical operation
+
+    \param[in] func Function whose terms are collected
+
+    \param[in] op Op::logical_and or Op::logical_or
+
+    \param[out] terms Terms in the order they are written
+  */
+  void GetChain(const NamedFunc &func, Op op, vector<const NamedFunc*> &terms){
+    if(func.Operation() == op && func.IsScalar() && !func.Opaque()){
+      for(const auto &operand: func.Operands()){
+        GetChain(*operand, op, terms);
+      }
+    }else{
+      terms.push_back(&func);
+    }
+  }
+}
+
+/*!\brief Compile a function into a program
+
+  \param[in] func Function to compile. Its leaves are copied into the program.
+*/
+Bytecode::Bytecode(const NamedFunc &func):
+  code_(),
+  constants_(),
+  int_constants_(),
+  bool_constants_(),
+  scalar_calls_(),
+  vector_calls_(),
+  num_scalars_(0),
+  num_integers_(0),
+  num_booleans_(0),
+  num_vectors_(0),
+  result_(0),
+  result_reg_(Natural(func)),
+  nodes_(),
+  registers_(),
+  fence_(0){
+  result_ = Emit(func, result_reg_);
+  nodes_.clear();
+  registers_.clear();
+}
+
+/*!\brief Check if program returns a scalar
+
+  \return True if program was compiled from a scalar function
+*/
+bool Bytecode::IsScalar() const{
+  return result_reg_ != Reg::vector;
+}
+
+/*!\brief Check if program returns a vector
+
+  \return True if program was compiled from a vector function
+*/
+bool Bytecode::IsVector() const{
+  return result_reg_ == Reg::vector;
+}
+
+/*!\brief Get length of program
+
+  \return Number of instructions
+*/
+size_t Bytecode::NumInstructions() const{
+  return code_.size();
+}
+
+/*!\brief Run scalar program with b as argument
+
+  \param[in] b Baby passed to the leaves
+
+  \return Result of the compiled function
+*/
+ScalarType Bytecode::GetScalar(const Baby &b) const{
+  if(result_reg_ == Reg::vector) ERROR("Cannot get scalar from vector program");
+  if(num_scalars_ <= kStackScalars && num_integers_ <= kStackIntegers
+     && num_booleans_ <= kStackBooleans){
+    ScalarType s[kStackScalars];
+    long n[kStackIntegers];
+    bool p[kStackBooleans];
+    if(num_vectors_ == 0){
+      Run(b, s, n, p, nullptr);
+      return Result(s, n, p);
+    }else if(num_vectors_ <= kStackVectors){
+      TypedSpan v[kStackVectors];
+      Run(b, s, n, p, v);
+      return Result(s, n, p);
+    }
+  }
+  Registers registers(num_scalars_, num_integers_, num_booleans_, num_vectors_);
+  Run(b, registers.Scalars(), registers.Integers(), registers.Booleans(), registers.Vectors());
+  return Result(registers.Scalars(), registers.Integers(), registers.Booleans());
+}
+
+/*!\brief Run vector program with b as argument
+
+  \param[in] b Baby passed to the leaves
+
+  \return Result of the compiled function, viewing a Baby branch or Arena
+*/
+TypedSpan Bytecode::GetTyped(const Baby &b) const{
+  if(result_reg_ != Reg::vector) ERROR("Cannot get vector from scalar program");
+  if(num_vectors_ <= kStackVectors && num_scalars_ <= kStackScalars
+     && num_integers_ <= kStackIntegers && num_booleans_ <= kStackBooleans){
+    ScalarType s[kStackScalars];
+    long n[kStackIntegers];
+    bool p[kStackBooleans];
+    TypedSpan v[kStackVectors];
+    Run(b, s, n, p, v);
+    return v[result_];
+  }
+  Registers registers(num_scalars_, num_integers_, num_booleans_, num_vectors_);
+  Run(b, registers.Scalars(), registers.Integers(), registers.Booleans(), registers.Vectors());
+  return registers.Vectors()[result_];
+}
+
+/*!\brief Emit instructions computing func into a register of the given class,
+  unless already computed
+
+  A value already held in another class is converted. Leaves are loaded
+  directly into a wider class than their own, since their callables return
+  ScalarType anyway.
+
+  \param[in] func Function to compute
+
+  \param[in] reg Class of register to fill. Ignored for vector functions.
+
+  \return Register of class reg holding the result of func
+*/
+size_t Bytecode::Emit(const NamedFunc &func, Reg reg){
+  if(func.IsVector()) reg = Reg::vector;
+  size_t node = Intern(func);
+  auto known = registers_.find(make_pair(node, reg));
+  if(known != registers_.end()) return known->second;
+
+  Reg natural = Natural(func);
+  size_t out = 0;
+  //Registers of the natural class or wider hold the exact value
+  auto held = registers_.end();
+  Reg held_reg = natural;
+  for(int c = static_cast<int>(natural); c <= static_cast<int>(Reg::real) && held == registers_.end(); ++c){
+    held_reg = static_cast<Reg>(c);
+    held = registers_.find(make_pair(node, held_reg));
+  }
+  bool leaf = func.Operation() != Op::constant && (func.Operands().empty() || func.Opaque());
+  if(func.Operation() == Op::constant || (held == registers_.end() && (reg == natural || (leaf && reg > natural)))){
+    out = EmitNode(func, reg);
+  }else if(held != registers_.end()){
+    out = Convert(held_reg, held->second, reg);
+  }else{
+    out = Convert(natural, Emit(func, natural), reg);
+  }
+  registers_[make_pair(node, reg)] = out;
+  return out;
+}
+
+/*!\brief Emit instructions computing func
+
+  \param[in] func Function to compute
+
+  \param[in] reg Class of register to fill. Must be Natural(func), except for
+  constants and for leaves, which may be loaded into a wider class.
+
+  \return Register of class reg holding the result of func
+*/
+size_t Bytecode::EmitNode(const NamedFunc &func, Reg reg){
+  Op op = func.Operation();
+  size_t out = NewRegister(reg);
+  const auto &operands = func.Operands();
+  if(op == Op::constant && reg != Reg::vector){
+    Preset(reg, out, func.Constant());
+  }else if(operands.empty() || func.Opaque()){
+    if(reg == Reg::vector){
+      Add(Code::call_vector, op, false, false, out, vector_calls_.size(), 0);
+      vector_calls_.push_back(func.TypedFunction());
+    }else{
+      Add(LoadCode(reg), op, false, false, out, out, 0);
+      scalar_calls_.push_back(func.ScalarFunction());
+      code_.back().call_a_ = scalar_calls_.size();
+    }
+  }else if(operands.size() == 1){
+    const NamedFunc &a = *operands.at(0);
+    if(reg == Reg::vector){
+      Add(Code::unary_vector, op, true, false, out, Emit(a, Reg::vector), 0);
+    }else{
+      Reg reg_a = op == Op::logical_not ? Reg::boolean : Reg::real;
+      size_t ra = Emit(a, reg_a);
+      size_t call_a = TakeCall(ra, reg_a);
+      Add(ScalarCode(op, reg_a), op, false, false, out, ra, 0);
+      code_.back().call_a_ = call_a;
+    }
+  }else if(op == Op::logical_and || op == Op::logical_or){
+    EmitLogical(func, out);
+  }else{
+    const NamedFunc &a = *operands.at(0);
+    const NamedFunc &b = *operands.at(1);
+    //Comparisons of integers and bools are exact in integer registers
+    Reg reg_a = Reg::real, reg_b = Reg::real;
+    if(op == Op::subscript){
+      if(Natural(b) <= Reg::integer) reg_b = Reg::integer;
+    }else if(reg == Reg::boolean && Natural(a) <= Reg::integer && Natural(b) <= Reg::integer){
+      reg_a = reg_b = Reg::integer;
+    }
+    size_t ra = Emit(a, reg_a);
+    size_t rb = Emit(b, reg_b);
+    if(reg == Reg::vector){
+      Add(Code::binary_vector, op, a.IsVector(), b.IsVector(), out, ra, rb);
+    }else{
+      //Same register for both operands must be filled before reading b
+      size_t call_b = a.IsScalar() && reg_a == reg_b && ra == rb ? 0 : TakeCall(rb, reg_b);
+      size_t call_a = a.IsScalar() ? TakeCall(ra, reg_a) : 0;
+      Add(op == Op::subscript ? ScalarCode(op, reg) : ScalarCode(op, reg_a), op,
+          a.IsVector(), false, out, ra, rb);
+      code_.back().call_a_ = call_a;
+      code_.back().call_b_ = call_b;
+      code_.back().real_b_ = reg_b == Reg::real;
+    }
+  }
+  return out;
+}
+
+/*!\brief Emit instructions computing "&&" or "||" with the same
+  short-circuiting as NamedFunc::Apply()
+
+  A scalar chain a&&b&&...&&z presets its bool result to false and jumps past
+  the remaining terms as soon as one is false. Every term is evaluated into a
+  bool register, and the last one, evaluated only if all others are true, is
+  the result. Chains of "||" work the same way with true.
+
+  \param[in] func Op::logical_and or Op::logical_or function
+
+  \param[in] out Register receiving the result
+*/
+void Bytecode::EmitLogical(const NamedFunc &func, size_t out){
+  Op op = func.Operation();
+  bool is_and = op == Op::logical_and;
+  if(func.IsScalar()){
+    vector<const NamedFunc*> terms;
+    GetChain(func, op, terms);
+    Jump jump = is_and ? Jump::if_false : Jump::if_true;
+    Preset(Reg::boolean, out, is_and ? 0. : 1.);
+    vector<size_t> jumps = {AddJump(Emit(*terms.front(), Reg::boolean), jump)};
+    auto outside = registers_;
+    for(size_t i = 1; i+1 < terms.size(); ++i){
+      jumps.push_back(AddJump(Emit(*terms.at(i), Reg::boolean), jump));
+    }
+    size_t last = Emit(*terms.back(), Reg::boolean);
+    size_t call = TakeCall(last, Reg::boolean);
+    Add(Code::load_bool, op, false, false, out, last, 0);
+    code_.back().call_a_ = call;
+    registers_.swap(outside);
+    SetTargets(jumps);
+    return;
+  }
+
+  const NamedFunc &a = *func.Operands().at(0);
+  const NamedFunc &b = *func.Operands().at(1);
+  size_t ra = Emit(a, Reg::real);
+  if(a.IsVector() && b.IsScalar()){
+    //Scalar is only needed if some element does not decide the result alone
+    size_t jump = Add(is_and ? Code::jump_if_none : Code::jump_if_all, op, true, false, 0, ra, 0);
+    auto outside = registers_;
+    size_t rb = Emit(b, Reg::real);
+    registers_.swap(outside);
+    SetTargets({jump});
+    //After the jump, rb must still hold a value, though no element depends on
+    //it. Placed first so that presets made by the code for b take precedence.
+    Preset(Reg::real, rb, is_and ? 0. : 1., true);
+    Add(Code::binary_vector, op, true, false, out, ra, rb);
+  }else{
+    size_t rb = Emit(b, Reg::real);
+    Add(Code::binary_vector, op, a.IsVector(), b.IsVector(), out, ra, rb);
+  }
+}
+
+/*!\brief Emit an instruction copying a scalar register into another class
+
+  \param[in] from Class of reg
+
+  \param[in] reg Scalar register holding the value
+
+  \param[in] to Class of register to fill
+
+  \return Register of class to holding the value
+*/
+size_t Bytecode::Convert(Reg from, size_t reg, Reg to){
+  if(from == to) return reg;
+  Code code = Code::load;
+  switch(to){
+  case Reg::real: code = from == Reg::integer ? Code::int_to_real : Code::bool_to_real; break;
+  case Reg::integer: code = from == Reg::real ? Code::real_to_int : Code::bool_to_int; break;
+  case Reg::boolean: code = from == Reg::real ? Code::truth : Code::int_truth; break;
+  case Reg::vector:
+  default:
+    ERROR("Cannot convert scalar register to vector");
+  }
+  size_t call = TakeCall(reg, from);
+  size_t out = NewRegister(to);
+  Add(code, Op::function, false, false, out, reg, 0);
+  code_.back().call_a_ = call;
+  return out;
+}
+
+/*!\brief Reserve a register
+
+  \param[in] reg Class of register
+
+  \return Index of new register among those of its class
+*/
+size_t Bytecode::NewRegister(Reg reg){
+  switch(reg){
+  case Reg::boolean: return num_booleans_++;
+  case Reg::integer: return num_integers_++;
+  case Reg::real: return num_scalars_++;
+  case Reg::vector:
+  default: return num_vectors_++;
+  }
+}
+
+/*!\brief Set a scalar register before running the program
+
+  \param[in] reg Class of register
+
+  \param[in] out Register to set
+
+  \param[in] value Value converted to the class of the register
+
+  \param[in] first If true, the value is set before all other presets of the
+  class, so that they take precedence
+*/
+void Bytecode::Preset(Reg reg, size_t out, ScalarType value, bool first){
+  switch(reg){
+  case Reg::boolean:
+    bool_constants_.emplace(first ? bool_constants_.begin() : bool_constants_.end(), out, value != 0.);
+    break;
+  case Reg::integer:
+    int_constants_.emplace(first ? int_constants_.begin() : int_constants_.end(), out, static_cast<long>(value));
+    break;
+  case Reg::real:
+    constants_.emplace(first ? constants_.begin() : constants_.end(), out, value);
+    break;
+  case Reg::vector:
+  default:
+    ERROR("Vector registers cannot be preset");
+  }
+}
+
+/*!\brief Get node index shared by all functions structurally identical to func
+
+  \param[in] func Function to look up
+
+  \return Index of node representing func
+*/
+size_t Bytecode::Intern(const NamedFunc &func){
+  vector<size_t> key = {static_cast<size_t>(func.Operation()), func.Id()};
+  for(const auto &operand: func.Operands()){
+    key.push_back(Intern(*operand));
+  }
+  auto node = nodes_.find(key);
+  if(node == nodes_.end()){
+    node = nodes_.emplace(key, nodes_.size()).first;
+  }
+  return node->second;
+}
+
+/*!\brief Append an instruction to the program
+
+  \param[in] code Kind of instruction
+
+  \param[in] op Operation applied by vector instructions
+
+  \param[in] vector_a Flag if a is a vector register
+
+  \param[in] vector_b Flag if b is a vector register
+
+  \param[in] out Register receiving the result
+
+  \param[in] a First operand register, or index of vector callable
+
+  \param[in] b Second operand register
+
+  \return Position of the new instruction
+*/
+size_t Bytecode::Add(Code code, Op op, bool vector_a, bool vector_b,
+                     size_t out, size_t a, size_t b){
+  Instruction instruction;
+  instruction.code_ = code;
+  instruction.op_ = op;
+  instruction.jump_ = Jump::never;
+  instruction.vector_a_ = vector_a;
+  instruction.vector_b_ = vector_b;
+  instruction.real_b_ = false;
+  instruction.out_ = out;
+  instruction.a_ = a;
+  instruction.b_ = b;
+  instruction.call_a_ = 0;
+  instruction.call_b_ = 0;
+  instruction.target_ = 0;
+  code_.push_back(instruction);
+  return code_.size()-1;
+}
+
+/*!\brief Make the program jump depending on a bool register
+
+  The jump is merged into the last instruction if it just computed the
+  register.
+
+  \param[in] reg Bool register to test
+
+  \param[in] jump Condition for jumping
+
+  \return Position of the jumping instruction, whose target is set later with
+  SetTargets()
+*/
+size_t Bytecode::AddJump(size_t reg, Jump jump){
+  if(code_.size() > fence_){
+    Instruction &last = code_.back();
+    if(Output(last.code_) == Reg::boolean && last.out_ == reg && last.jump_ == Jump::never){
+      last.jump_ = jump;
+      return code_.size()-1;
+    }
+  }
+  size_t pos = Add(Code::load_bool, Op::function, false, false, reg, reg, 0);
+  code_.back().jump_ = jump;
+  return pos;
+}
+
+/*!\brief Point jumps at the end of the program emitted so far
+
+  \param[in] jumps Positions of jumping instructions
+*/
+void Bytecode::SetTargets(const vector<size_t> &jumps){
+  for(const auto &jump: jumps){
+    code_.at(jump).target_ = code_.size();
+  }
+  fence_ = code_.size();
+}
+
+/*!\brief Remove the last instruction if it only calls a scalar leaf filling
+  reg, so that the next instruction can make the call itself
+
+  \param[in] reg Scalar register read by the next instruction
+
+  \param[in] reg_class Class of reg
+
+  \return One plus index of the scalar leaf to call, or 0 if no instruction was
+  removed
+*/
+size_t Bytecode::TakeCall(size_t reg, Reg reg_class){
+  if(code_.size() <= fence_ || reg_class == Reg::vector) return 0;
+  const Instruction &last = code_.back();
+  if(last.code_ != LoadCode(reg_class) || last.call_a_ == 0
+     || last.out_ != reg || last.a_ != reg || last.jump_ != Jump::never) return 0;
+  size_t call = last.call_a_;
+  code_.pop_back();
+  return call;
+}
+
+/*!\brief Get class of register holding the result of a function when computed
+  by its own operation
+
+  \param[in] func Function to classify
+
+  \return Reg::vector for vectors. For scalars, the class given by
+  NamedFunc::ResultType() for leaves, constants, and opaque functions,
+  Reg::boolean for comparisons and logical operations, the class of the
+  element type for subscripts, and Reg::real otherwise.
+*/
+Bytecode::Reg Bytecode::Natural(const NamedFunc &func){
+  if(func.IsVector()) return Reg::vector;
+  if(func.Operands().empty() || func.Opaque()) return OfType(func.ResultType());
+  switch(func.Operation()){
+  case Op::equal_to:
+  case Op::not_equal_to:
+  case Op::greater:
+  case Op::less:
+  case Op::greater_equal:
+  case Op::less_equal:
+  case Op::logical_and:
+  case Op::logical_or:
+  case Op::logical_not:
+    return Reg::boolean;
+  case Op::subscript:
+    return OfType(func.Operands().at(0)->ResultType());
+  case Op::function:
+  case Op::variable:
+  case Op::constant:
+  case Op::plus:
+  case Op::minus:
+  case Op::multiplies:
+  case Op::divides:
+  case Op::modulus:
+  case Op::negate:
+  default:
+    return Reg::real;
+  }
+}
+
+/*!\brief Get class of register holding a scalar type
+
+  \param[in] type Result type of a function
+
+  \return Register class holding every value of type exactly
+*/
+Bytecode::Reg Bytecode::OfType(NamedFunc::Type type){
+  switch(type){
+  case NamedFunc::Type::bool_type: return Reg::boolean;
+  case NamedFunc::Type::int_type: return Reg::integer;
+  case NamedFunc::Type::float_type:
+  case NamedFunc::Type::double_type:
+  default: return Reg::real;
+  }
+}
+
+/*!\brief Get class of register receiving the result of an instruction
+
+  \param[in] code Kind of instruction
+
+  \return Class of Instruction::out_
+*/
+Bytecode::Reg Bytecode::Output(Code code){
+  if(code < Code::load_int) return Reg::real;
+  if(code < Code::load_bool) return Reg::integer;
+  if(code < Code::call_vector) return Reg::boolean;
+  return Reg::vector;
+}
+
+/*!\brief Get instruction calling a scalar leaf into a register
+
+  \param[in] reg Class of scalar register
+
+  \return Code of load instruction for class reg
+*/
+Bytecode::Code Bytecode::LoadCode(Reg reg){
+  switch(reg){
+  case Reg::boolean: return Code::load_bool;
+  case Reg::integer: return Code::load_int;
+  case Reg::real: return Code::load;
+  case Reg::vector:
+  default:
+    ERROR("Vector registers are not loaded from scalar leaves");
+  }
+}
+
+/*!\brief Get instruction applying an operation to scalar registers
+
+  \param[in] op Unary or binary operation other than Op::logical_and and
+  Op::logical_or
+
+  \param[in] reg Class of the operand registers, or of the result for
+  Op::subscript
+
+  \return Code of instruction applying op
+*/
+Bytecode::Code Bytecode::ScalarCode(Op op, Reg reg){
+  bool integer = reg == Reg::integer;
+  switch(op){
+  case Op::negate: return Code::negate;
+  case Op::logical_not: return Code::logical_not;
+  case Op::plus: return Code::plus;
+  case Op::minus: return Code::minus;
+  case Op::multiplies: return Code::multiplies;
+  case Op::divides: return Code::divides;
+  case Op::modulus: return Code::modulus;
+  case Op::equal_to: return integer ? Code::equal_to_int : Code::equal_to;
+  case Op::not_equal_to: return integer ? Code::not_equal_to_int : Code::not_equal_to;
+  case Op::greater: return integer ? Code::greater_int : Code::greater;
+  case Op::less: return integer ? Code::less_int : Code::less;
+  case Op::greater_equal: return integer ? Code::greater_equal_int : Code::greater_equal;
+  case Op::less_equal: return integer ? Code::less_equal_int : Code::less_equal;
+  case Op::subscript:
+    return integer ? Code::subscript_int : reg == Reg::boolean ? Code::subscript_bool : Code::subscript;
+  case Op::function:
+  case Op::variable:
+  case Op::constant:
+  case Op::logical_and:
+  case Op::logical_or:
+  default:
+    ERROR("No scalar instruction for operation "+to_string(static_cast<int>(op)));
+  }
+}
+
+/*!\brief Read a real operand, calling its leaf first if merged into the
+  instruction
+
+  \param[in] reg Real register holding the operand
+
+  \param[in] call One plus index of the scalar leaf filling reg, or 0
+
+  \param[in] b Baby passed to the leaf
+
+  \param[in,out] s Real registers
+
+  \return Value of operand
+*/
+ScalarType Bytecode::Operand(size_t reg, size_t call, const Baby &b, ScalarType *s) const{
+  if(call != 0) s[reg] = scalar_calls_[call-1](b);
+  return s[reg];
+}
+
+/*!\brief Read an integer operand, calling its leaf first if merged into the
+  instruction
+
+  \param[in] reg Integer register holding the operand
+
+  \param[in] call One plus index of the scalar leaf filling reg, or 0
+
+  \param[in] b Baby passed to the leaf
+
+  \param[in,out] n Integer registers
+
+  \return Value of operand
+*/
+long Bytecode::IntOperand(size_t reg, size_t call, const Baby &b, long *n) const{
+  if(call != 0) n[reg] = static_cast<long>(scalar_calls_[call-1](b));
+  return n[reg];
+}
+
+/*!\brief Read a bool operand, calling its leaf first if merged into the
+  instruction
+
+  \param[in] reg Bool register holding the operand
+
+  \param[in] call One plus index of the scalar leaf filling reg, or 0
+
+  \param[in] b Baby passed to the leaf
+
+  \param[in,out] p Bool registers
+
+  \return Value of operand
+*/
+bool Bytecode::BoolOperand(size_t reg, size_t call, const Baby &b, bool *p) const{
+  if(call != 0) p[reg] = scalar_calls_[call-1](b) != 0.;
+  return p[reg];
+}
+
+/*!\brief Read the index operand of a subscript
+
+  \param[in] in Subscript instruction
+
+  \param[in] b Baby passed to the leaves
+
+  \param[in,out] s Real registers
+
+  \param[in,out] n Integer registers
+
+  \return Index converted as by NamedFunc::Apply()
+*/
+size_t Bytecode::Index(const Instruction &in, const Baby &b, ScalarType *s, long *n) const{
+  if(in.real_b_) return static_cast<size_t>(Operand(in.b_, in.call_b_, b, s));
+  return static_cast<size_t>(IntOperand(in.b_, in.call_b_, b, n));
+}
+
+/*!\brief Get the result of a finished scalar program
+
+  \param[in] s Real registers
+
+  \param[in] n Integer registers
+
+  \param[in] p Bool registers
+
+  \return Result register converted to ScalarType
+*/
+ScalarType Bytecode::Result(const ScalarType *s, const long *n, const bool *p) const{
+  switch(result_reg_){
+  case Reg::boolean: return p[result_];
+  case Reg::integer: return static_cast<ScalarType>(n[result_]);
+  case Reg::real:
+  case Reg::vector:
+  default: return s[result_];
+  }
+}
+
+/*!\brief Execute the program
+
+  \param[in] b Baby passed to the leaves
+
+  \param[in,out] s At least Bytecode::num_scalars_ real registers
+
+  \param[in,out] n At least Bytecode::num_integers_ integer registers
+
+  \param[in,out] p At least Bytecode::num_booleans_ bool registers
+
+  \param[in,out] v At least Bytecode::num_vectors_ vector registers
+*/
+void Bytecode::Run(const Baby &b, ScalarType *s, long *n, bool *p, TypedSpan *v) const{
+  for(const auto &constant: constants_){
+    s[constant.first] = constant.second;
+  }
+  for(const auto &constant: int_constants_){
+    n[constant.first] = constant.second;
+  }
+  for(const auto &constant: bool_constants_){
+    p[constant.first] = constant.second;
+  }
+  const Instruction *code = code_.data();
+  size_t pc = 0, end = code_.size();
+  while(pc < end){
+    const Instruction &in = code[pc++];
+    ScalarType x = 0., y = 0.;
+    long i = 0, j = 0;
+    bool t = false;
+    switch(in.code_){
+    case Code::load:
+      s[in.out_] = Operand(in.a_, in.call_a_, b, s);
+      continue;
+    case Code::negate:
+      s[in.out_] = -Operand(in.a_, in.call_a_, b, s);
+      continue;
+    case Code::int_to_real:
+      s[in.out_] = static_cast<ScalarType>(IntOperand(in.a_, in.call_a_, b, n));
+      continue;
+    case Code::bool_to_real:
+      s[in.out_] = BoolOperand(in.a_, in.call_a_, b, p);
+      continue;
+    case Code::plus:
+      x = Operand(in.a_, in.call_a_, b, s);
+      y = Operand(in.b_, in.call_b_, b, s);
+      s[in.out_] = x + y;
+      continue;
+    case Code::minus:
+      x = Operand(in.a_, in.call_a_, b, s);
+      y = Operand(in.b_, in.call_b_, b, s);
+      s[in.out_] = x - y;
+      continue;
+    case Code::multiplies:
+      x = Operand(in.a_, in.call_a_, b, s);
+      y = Operand(in.b_, in.call_b_, b, s);
+      s[in.out_] = x * y;
+      continue;
+    case Code::divides:
+      x = Operand(in.a_, in.call_a_, b, s);
+      y = Operand(in.b_, in.call_b_, b, s);
+      s[in.out_] = x / y;
+      continue;
+    case Code::modulus:
+      x = Operand(in.a_, in.call_a_, b, s);
+      y = Operand(in.b_, in.call_b_, b, s);
+      s[in.out_] = fmod(x, y);
+      continue;
+    case Code::subscript:
+      s[in.out_] = v[in.a_].at(Index(in, b, s, n));
+      continue;
+    case Code::load_int:
+      n[in.out_] = IntOperand(in.a_, in.call_a_, b, n);
+      continue;
+    case Code::real_to_int:
+      n[in.out_] = static_cast<long>(Operand(in.a_, in.call_a_, b, s));
+      continue;
+    case Code::bool_to_int:
+      n[in.out_] = BoolOperand(in.a_, in.call_a_, b, p);
+      continue;
+    case Code::subscript_int:
+      n[in.out_] = static_cast<long>(v[in.a_].at(Index(in, b, s, n)));
+      continue;
+    case Code::load_bool:
+      t = BoolOperand(in.a_, in.call_a_, b, p);
+      break;
+    case Code::truth:
+      t = Operand(in.a_, in.call_a_, b, s) != 0.;
+      break;
+    case Code::int_truth:
+      t = IntOperand(in.a_, in.call_a_, b, n) != 0;
+      break;
+    case Code::logical_not:
+      t = !BoolOperand(in.a_, in.call_a_, b, p);
+      break;
+    case Code::equal_to:
+      x = Operand(in.a_, in.call_a_, b, s);
+      y = Operand(in.b_, in.call_b_, b, s);
+      t = x == y;
+      break;
+    case Code::not_equal_to:
+      x = Operand(in.a_, in.call_a_, b, s);
+      y = Operand(in.b_, in.call_b_, b, s);
+      t = x != y;
+      break;
+    case Code::greater:
+      x = Operand(in.a_, in.call_a_, b, s);
+      y = Operand(in.b_, in.call_b_, b, s);
+      t = x > y;
+      break;
+    case Code::less:
+      x = Operand(in.a_, in.call_a_, b, s);
+      y = Operand(in.b_, in.call_b_, b, s);
+      t = x < y;
+      break;
+    case Code::greater_equal:
+      x = Operand(in.a_, in.call_a_, b, s);
+      y = Operand(in.b_, in.call_b_, b, s);
+      t = x >= y;
+      break;
+    case Code::less_equal:
+      x = Operand(in.a_, in.call_a_, b, s);
+      y = Operand(in.b_, in.call_b_, b, s);
+      t = x <= y;
+      break;
+    case Code::equal_to_int:
+      i = IntOperand(in.a_, in.call_a_, b, n);
+      j = IntOperand(in.b_, in.call_b_, b, n);
+      t = i == j;
+      break;
+    case Code::not_equal_to_int:
+      i = IntOperand(in.a_, in.call_a_, b, n);
+      j = IntOperand(in.b_, in.call_b_, b, n);
+      t = i != j;
+      break;
+    case Code::greater_int:
+      i = IntOperand(in.a_, in.call_a_, b, n);
+      j = IntOperand(in.b_, in.call_b_, b, n);
+      t = i > j;
+      break;
+    case Code::less_int:
+      i = IntOperand(in.a_, in.call_a_, b, n);
+      j = IntOperand(in.b_, in.call_b_, b, n);
+      t = i < j;
+      break;
+    case Code::greater_equal_int:
+      i = IntOperand(in.a_, in.call_a_, b, n);
+      j = IntOperand(in.b_, in.call_b_, b, n);
+      t = i >= j;
+      break;
+    case Code::less_equal_int:
+      i = IntOperand(in.a_, in.call_a_, b, n);
+      j = IntOperand(in.b_, in.call_b_, b, n);
+      t = i <= j;
+      break;
+    case Code::subscript_bool:
+      t = v[in.a_].at(Index(in, b, s, n)) != 0.;
+      break;
+    case Code::call_vector:
+      v[in.out_] = vector_calls_[in.a_](b);
+      continue;
+    case Code::unary_vector:
+    case Code::binary_vector:
+      RunVector(in, s, v);
+      continue;
+    case Code::jump_if_none:
+      if(!v[in.a_].AnyNonzero()) pc = in.target_;
+      continue;
+    case Code::jump_if_all:
+      if(v[in.a_].AllNonzero()) pc = in.target_;
+      continue;
+    default:
+      ERROR("Unknown instruction "+to_string(static_cast<int>(in.code_)));
+    }
+    p[in.out_] = t;
+    if(in.jump_ != Jump::never && t == (in.jump_ == Jump::if_true)) pc = in.target_;
+  }
+}
+
+/*!\brief Execute an instruction producing a vector
+
+  \param[in] in Code::unary_vector or Code::binary_vector instruction
+
+  \param[in] s Real registers
+
+  \param[in,out] v Vector registers
+*/
+void Bytecode::RunVector(const Instruction &in, ScalarType *s, TypedSpan *v) const{
+  static const TypedSpan none;
+  if(in.code_ == Code::unary_vector){
+    if(in.op_ == Op::negate){
+      v[in.out_] = v[in.a_].Transform(negate<ScalarType>());
+    }else{
+      v[in.out_] = v[in.a_].Transform<bool>(logical_not<ScalarType>());
+    }
+  }else{
+    v[in.out_] = BinaryVector(in.op_, in.vector_a_, in.vector_b_,
+                              in.vector_a_ ? 0. : s[in.a_], in.vector_a_ ? v[in.a_] : none,
+                              in.vector_b_ ? 0. : s[in.b_], in.vector_b_ ? v[in.b_] : none);
+  }
+}
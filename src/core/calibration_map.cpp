@@ -0,0 +1,181 @@
+/*! \class CalibrationMap
+
+  \brief Immutable lookup table made from a TH1, TH2, or TH3 of efficiencies or
+  scale factors
+
+  The bin edges, contents, and errors of the histogram are copied into flat
+  vectors on construction, so looking up a value needs neither ROOT nor any
+  locking, and a single CalibrationMap can be read concurrently by any number of
+  threads. Values outside the histogram range come from the under- and overflow
+  bins, exactly as with TH1::GetBinContent(TH1::FindBin(x,y,z)).
+
+  CalibrationMap::Get() loads each map from file the first time it is requested
+  and keeps it for the rest of the process, so functions evaluated for every
+  event can simply ask for their maps by file and histogram name.
+*/
+#include "core/calibration_map.hpp"
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+#include "TFile.h"
+#include "TH1.h"
+#include "TAxis.h"
+
+#include "core/utilities.hpp"
+
+using namespace std;
+
+/*!\brief Copies binning and contents of a histogram
+
+  \param[in] hist TH1, TH2, or TH3 to copy
+*/
+CalibrationMap::CalibrationMap(const TH1 &hist):
+  edges_(),
+  values_(),
+  errors_(){
+  int dimension = hist.GetDimension();
+  if(dimension < 1 || dimension > 3){
+    ERROR("Cannot make calibration map from "+to_string(dimension)+"-dimensional histogram "+hist.GetName());
+  }
+  edges_.push_back(GetEdges(*hist.GetXaxis()));
+  if(dimension > 1) edges_.push_back(GetEdges(*hist.GetYaxis()));
+  if(dimension > 2) edges_.push_back(GetEdges(*hist.GetZaxis()));
+
+  size_t num_bins = 1;
+  for(const auto &edges: edges_){
+    num_bins *= edges.size()+1;
+  }
+  values_.resize(num_bins);
+  errors_.resize(num_bins);
+  for(size_t bin = 0; bin < num_bins; ++bin){
+    values_.at(bin) = hist.GetBinContent(static_cast<int>(bin));
+    errors_.at(bin) = hist.GetBinError(static_cast<int>(bin));
+  }
+}
+
+/*!\brief Get map from histogram in a ROOT file, loading it on first use
+
+  Maps are loaded once per process and never deleted, so the returned reference
+  stays valid for the lifetime of the program. Lookups after the first one from
+  a given thread do not lock.
+
+  \param[in] file_name Path to ROOT file
+
+  \param[in] hist_name Name of TH1, TH2, or TH3 in file
+
+  \return Map made from the requested histogram
+*/
+const CalibrationMap & CalibrationMap::Get(const string &file_name,
+                                           const string &hist_name){
+  using Key = pair<string, string>;
+  thread_local map<Key, const CalibrationMap *> local_maps;
+  Key key(file_name, hist_name);
+  auto local = local_maps.find(key);
+  if(local != local_maps.end()) return *local->second;
+
+  static mutex maps_mutex;
+  static map<Key, unique_ptr<const CalibrationMap> > maps;
+  lock_guard<mutex> lock(maps_mutex);
+  auto loaded = maps.find(key);
+  if(loaded == maps.end()){
+    lock_guard<mutex> root_lock(Multithreading::root_mutex);
+    TFile file(file_name.c_str(), "read");
+    if(file.IsZombie()) ERROR("Could not open calibration file "+file_name);
+    TH1 *hist = nullptr;
+    file.GetObject(hist_name.c_str(), hist);
+    if(hist == nullptr) ERROR("Could not find histogram "+hist_name+" in "+file_name);
+    loaded = maps.emplace(key, unique_ptr<const CalibrationMap>(new CalibrationMap(*hist))).first;
+    file.Close();
+  }
+  local_maps[key] = loaded->second.get();
+  return *loaded->second;
+}
+
+/*!\brief Get number of axes
+
+  \return 1, 2, or 3 for maps made from a TH1, TH2, or TH3
+*/
+size_t CalibrationMap::Dimension() const{
+  return edges_.size();
+}
+
+/*!\brief Find global bin containing a point
+
+  Coordinates beyond Dimension() are ignored.
+
+  \param[in] x Coordinate along x-axis
+
+  \param[in] y Coordinate along y-axis
+
+  \param[in] z Coordinate along z-axis
+
+  \return Global bin number, as from TH1::FindBin()
+*/
+size_t CalibrationMap::FindBin(double x, double y, double z) const{
+  const double coords[3] = {x, y, z};
+  size_t bin = 0;
+  for(size_t axis = edges_.size(); axis-- > 0; ){
+    bin = bin*(edges_[axis].size()+1) + FindAxisBin(edges_[axis], coords[axis]);
+  }
+  return bin;
+}
+
+/*!\brief Get content of bin containing a point
+
+  \param[in] x Coordinate along x-axis
+
+  \param[in] y Coordinate along y-axis
+
+  \param[in] z Coordinate along z-axis
+
+  \return Content of histogram bin containing (x, y, z)
+*/
+double CalibrationMap::Value(double x, double y, double z) const{
+  return values_[FindBin(x, y, z)];
+}
+
+/*!\brief Get error of bin containing a point
+
+  \param[in] x Coordinate along x-axis
+
+  \param[in] y Coordinate along y-axis
+
+  \param[in] z Coordinate along z-axis
+
+  \return Error of histogram bin containing (x, y, z)
+*/
+double CalibrationMap::Error(double x, double y, double z) const{
+  return errors_[FindBin(x, y, z)];
+}
+
+/*!\brief Get all bin edges of an axis
+
+  \param[in] axis Axis of histogram
+
+  \return Low edges of bins 1 to N followed by the high edge of bin N
+*/
+vector<double> CalibrationMap::GetEdges(const TAxis &axis){
+  int num_bins = axis.GetNbins();
+  vector<double> edges(num_bins+1);
+  for(int bin = 1; bin <= num_bins+1; ++bin){
+    edges.at(bin-1) = axis.GetBinLowEdge(bin);
+  }
+  return edges;
+}
+
+/*!\brief Find bin along one axis with binary search
+
+  \param[in] edges Edges from GetEdges()
+
+  \param[in] x Coordinate along axis
+
+  \return 0 for underflow, edges.size() for overflow (including NaN), or bin
+  number with edges[bin-1] <= x < edges[bin]
+*/
+size_t CalibrationMap::FindAxisBin(const vector<double> &edges, double x){
+  return static_cast<size_t>(upper_bound(edges.cbegin(), edges.cend(), x) - edges.cbegin());
+}
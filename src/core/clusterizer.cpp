@@ -84,6 +84,42 @@ void Clusterizer::AddPoint(float x, float y, float w){
   }
 }
 
+void Clusterizer::Merge(const Clusterizer &other){
+  clustered_lumi_ = -1.;
+  hist_.Add(&other.hist_);
+  if(hist_mode_ || other.hist_mode_
+     || (max_points_ >= 0
+         && orig_points_.size()+other.orig_points_.size() > static_cast<size_t>(max_points_))){
+    hist_mode_ = true;
+    orig_points_.clear();
+  }else{
+    orig_points_.insert(orig_points_.end(), other.orig_points_.cbegin(), other.orig_points_.cend());
+  }
+}
+
+void Clusterizer::Write(ostream &out) const{
+  out << hist_mode_ << ' ' << orig_points_.size() << '\n';
+  for(const auto &p: orig_points_){
+    out << p.x_ << ' ' << p.y_ << ' ' << p.w_ << '\n';
+  }
+  WriteHistContents(out, hist_);
+}
+
+bool Clusterizer::Read(istream &in){
+  clustered_lumi_ = -1.;
+  bool hist_mode = false;
+  size_t num_points = 0;
+  if(!(in >> hist_mode >> num_points)) return false;
+  vector<Point> points(num_points);
+  for(auto &p: points){
+    if(!(in >> p.x_ >> p.y_ >> p.w_)) return false;
+  }
+  if(!ReadHistContents(in, hist_)) return false;
+  hist_mode_ = hist_mode;
+  orig_points_.swap(points);
+  return true;
+}
+
 void Clusterizer::SetPoints(const vector<Point> &points){
   clustered_lumi_ = -1.;
   EmptyHistogram();
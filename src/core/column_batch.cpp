@@ -0,0 +1,251 @@
+/*! \class ColumnBatch
+
+  \brief Evaluates scalar \link NamedFunc NamedFuncs\endlink over blocks of
+  entries into contiguous columns
+
+  Instead of walking the chain of nested functors of a NamedFunc once per event,
+  ColumnBatch reads the leaves of the expression tree (Baby variables, constants,
+  and file invariant functions) entry by entry into one column each, then
+  computes every arithmetic, comparison, and logical node with a plain loop over
+  the whole block. Identical subexpressions of all added functions share one
+  column.
+
+  Only functions for which IsColumnar() is true can be added. Subscripts, vector
+  results, and arbitrary functions are excluded since they may be expensive or
+  invalid for entries that a short-circuiting "&&" or "||" would skip, while
+  batch evaluation computes every operand for every entry.
+*/
+#include "core/column_batch.hpp"
+
+#include <cmath>
+
+#include "core/utilities.hpp"
+
+using namespace std;
+
+using Op = NamedFunc::Op;
+
+/*!\brief Standard constructor
+
+  \param[in] max_size Maximum number of entries per block
+*/
+ColumnBatch::ColumnBatch(size_t max_size):
+  nodes_(),
+  columns_(),
+  node_ids_(),
+  leaves_(),
+  max_size_(max_size),
+  size_(0){
+}
+
+/*!\brief Check if a function can be evaluated in batches
+
+  \param[in] func Function to check
+
+  \return True if func is scalar and built only from scalar Baby variables,
+  constants, file invariant functions, and arithmetic, comparison, and logical
+  operators
+*/
+bool ColumnBatch::IsColumnar(const NamedFunc &func){
+  if(!func.IsScalar()) return false;
+  switch(func.Operation()){
+  case Op::variable:
+  case Op::constant:
+    return true;
+  case Op::function:
+    return func.FileInvariant();
+  case Op::subscript:
+    return false;
+  case Op::plus:
+  case Op::minus:
+  case Op::multiplies:
+  case Op::divides:
+  case Op::modulus:
+  case Op::negate:
+  case Op::equal_to:
+  case Op::not_equal_to:
+  case Op::greater:
+  case Op::less:
+  case Op::greater_equal:
+  case Op::less_equal:
+  case Op::logical_and:
+  case Op::logical_or:
+  case Op::logical_not:
+    for(const auto &operand: func.Operands()){
+      if(!IsColumnar(*operand)) return false;
+    }
+    return true;
+  default:
+    return false;
+  }
+}
+
+/*!\brief Add a function to be evaluated by Fill()
+
+  \param[in] func Function for which IsColumnar() is true
+
+  \return Index of column holding results of func
+*/
+size_t ColumnBatch::Add(const NamedFunc &func){
+  if(!IsColumnar(func)) ERROR("Cannot evaluate "+func.Name()+" in batches");
+  vector<size_t> key = {static_cast<size_t>(func.Operation()), func.Id()};
+  for(const auto &operand: func.Operands()){
+    key.push_back(Add(*operand));
+  }
+  auto known = node_ids_.find(key);
+  if(known != node_ids_.end()) return known->second;
+
+  Node node;
+  node.op_ = func.Operation();
+  node.operands_.assign(key.cbegin()+2, key.cend());
+  if(node.operands_.empty()){
+    node.leaf_ = make_shared<const NamedFunc>(func);
+    leaves_.push_back(nodes_.size());
+  }
+  nodes_.push_back(node);
+  columns_.emplace_back(max_size_, 0.);
+  node_ids_[key] = nodes_.size()-1;
+  return nodes_.size()-1;
+}
+
+/*!\brief Evaluate all added functions for a block of entries
+
+  \param[in,out] baby Baby from which to read entries. Left at last_entry-1.
+
+  \param[in] first_entry First entry of block (inclusive)
+
+  \param[in] last_entry Last entry of block (exclusive). At most MaxSize()
+  entries after first_entry.
+*/
+void ColumnBatch::Fill(Baby &baby, long first_entry, long last_entry){
+  if(last_entry < first_entry) last_entry = first_entry;
+  size_ = static_cast<size_t>(last_entry-first_entry);
+  if(size_ > max_size_) ERROR("Block of "+to_string(size_)+" entries exceeds maximum of "+to_string(max_size_));
+  for(long entry = first_entry; entry < last_entry; ++entry){
+    baby.GetEntry(entry);
+    size_t i = static_cast<size_t>(entry-first_entry);
+    for(const auto &ileaf: leaves_){
+      columns_[ileaf][i] = nodes_[ileaf].leaf_->GetScalar(baby);
+    }
+  }
+  for(size_t inode = 0; inode < nodes_.size(); ++inode){
+    if(!nodes_[inode].operands_.empty()) Compute(inode);
+  }
+}
+
+/*!\brief Get number of entries in last block passed to Fill()
+
+  \return Number of valid entries in each column
+*/
+size_t ColumnBatch::Size() const{
+  return size_;
+}
+
+/*!\brief Get maximum number of entries per block
+
+  \return Maximum number of entries that can be passed to Fill() at once
+*/
+size_t ColumnBatch::MaxSize() const{
+  return max_size_;
+}
+
+/*!\brief Get results of an added function for the current block
+
+  \param[in] column Index returned by Add()
+
+  \return Column whose first Size() elements are the results for each entry
+*/
+const NamedFunc::VectorType & ColumnBatch::Column(size_t column) const{
+  return columns_.at(column);
+}
+
+/*!\brief Compute one operator node from its already computed operands
+
+  \param[in] inode Index of node to compute
+*/
+void ColumnBatch::Compute(size_t inode){
+  const Node &node = nodes_[inode];
+  double *out = columns_[inode].data();
+  const double *a = columns_[node.operands_.at(0)].data();
+  if(node.operands_.size() == 1){
+    switch(node.op_){
+    case Op::negate:
+      for(size_t i = 0; i < size_; ++i) out[i] = -a[i];
+      break;
+    case Op::logical_not:
+      for(size_t i = 0; i < size_; ++i) out[i] = a[i] == 0.;
+      break;
+    case Op::function:
+    case Op::variable:
+    case Op::constant:
+    case Op::plus:
+    case Op::minus:
+    case Op::multiplies:
+    case Op::divides:
+    case Op::modulus:
+    case Op::equal_to:
+    case Op::not_equal_to:
+    case Op::greater:
+    case Op::less:
+    case Op::greater_equal:
+    case Op::less_equal:
+    case Op::logical_and:
+    case Op::logical_or:
+    case Op::subscript:
+    default:
+      ERROR("Operation "+to_string(static_cast<int>(node.op_))+" is not unary");
+    }
+    return;
+  }
+
+  const double *b = columns_[node.operands_.at(1)].data();
+  switch(node.op_){
+  case Op::plus:
+    for(size_t i = 0; i < size_; ++i) out[i] = a[i] + b[i];
+    break;
+  case Op::minus:
+    for(size_t i = 0; i < size_; ++i) out[i] = a[i] - b[i];
+    break;
+  case Op::multiplies:
+    for(size_t i = 0; i < size_; ++i) out[i] = a[i] * b[i];
+    break;
+  case Op::divides:
+    for(size_t i = 0; i < size_; ++i) out[i] = a[i] / b[i];
+    break;
+  case Op::modulus:
+    for(size_t i = 0; i < size_; ++i) out[i] = fmod(a[i], b[i]);
+    break;
+  case Op::equal_to:
+    for(size_t i = 0; i < size_; ++i) out[i] = a[i] == b[i];
+    break;
+  case Op::not_equal_to:
+    for(size_t i = 0; i < size_; ++i) out[i] = a[i] != b[i];
+    break;
+  case Op::greater:
+    for(size_t i = 0; i < size_; ++i) out[i] = a[i] > b[i];
+    break;
+  case Op::less:
+    for(size_t i = 0; i < size_; ++i) out[i] = a[i] < b[i];
+    break;
+  case Op::greater_equal:
+    for(size_t i = 0; i < size_; ++i) out[i] = a[i] >= b[i];
+    break;
+  case Op::less_equal:
+    for(size_t i = 0; i < size_; ++i) out[i] = a[i] <= b[i];
+    break;
+  case Op::logical_and:
+    for(size_t i = 0; i < size_; ++i) out[i] = (a[i] != 0.) & (b[i] != 0.);
+    break;
+  case Op::logical_or:
+    for(size_t i = 0; i < size_; ++i) out[i] = (a[i] != 0.) | (b[i] != 0.);
+    break;
+  case Op::function:
+  case Op::variable:
+  case Op::constant:
+  case Op::negate:
+  case Op::logical_not:
+  case Op::subscript:
+  default:
+    ERROR("Operation "+to_string(static_cast<int>(node.op_))+" is not binary");
+  }
+}
@@ -2,6 +2,8 @@
 
 #include <iostream>
 #include <iomanip>
+#include <sstream>
+#include <limits>
 
 #include <sys/stat.h>
 
@@ -10,13 +12,19 @@
 using namespace std;
 
 EventScan::SingleScan::SingleScan(const EventScan &event_scan,
-                                  const shared_ptr<Process> &process):
+                                  const shared_ptr<Process> &process,
+                                  bool write_to_file):
   FigureComponent(event_scan, process),
-  out_((CodeToPlainText(event_scan.name_+"_SCAN_"+process->name_)+".txt").c_str()),
+  out_(),
   full_cut_(event_scan.cut_ && process->cut_),
   cut_vector_(),
   val_vectors_(event_scan.columns_.size()),
-  row_(0){
+  row_(0),
+  write_to_file_(write_to_file),
+  events_(){
+  if(write_to_file_){
+    out_.open((CodeToPlainText(event_scan.name_+"_SCAN_"+process->name_)+".txt").c_str());
+  }
   out_.precision(event_scan.Precision());
 }
 
@@ -27,7 +35,7 @@ void EventScan::SingleScan::RecordEvent(const Baby &baby){
   if(full_cut_.IsScalar()){
     if(!full_cut_.GetScalar(baby)) return;
   }else{
-    cut_vector_ = full_cut_.GetVector(baby);
+    cut_vector_ = full_cut_.GetTyped(baby);
   }
   
   size_t max_size = 0;
@@ -36,7 +44,7 @@ void EventScan::SingleScan::RecordEvent(const Baby &baby){
     if(col.IsScalar()){
       if(max_size < 1) max_size = 1;
     }else{
-      val_vectors_.at(icol) = col.GetVector(baby);
+      val_vectors_.at(icol) = col.GetTyped(baby);
       if(val_vectors_.at(icol).size() > max_size){
 	max_size = val_vectors_.at(icol).size();
       }
@@ -45,33 +53,125 @@ void EventScan::SingleScan::RecordEvent(const Baby &baby){
   if(full_cut_.IsVector() && max_size > cut_vector_.size()){
     max_size = cut_vector_.size();
   }
+  if(max_size == 0) return;
 
-  if(max_size > 0 && !(row_ & 0x7)){
-    out_ << "      Row Instance";
-    for(const auto &col: scan.columns_){
-      out_ << ' ' << setw(w) << col.Name().substr(0,scan.width_);
-    }
-    out_.put('\n');
-  }
-
+  vector<string> instances(max_size);
+  ostringstream oss;
+  oss.precision(out_.precision());
   for(size_t instance = 0; instance < max_size; ++instance){
-    out_ << setw(9) << row_ << ' ' << setw(8) << instance;
+    oss.str("");
     for(size_t icol = 0; icol < scan.columns_.size(); ++icol){
       const NamedFunc& col = scan.columns_.at(icol);
       if(col.IsScalar()){
-        out_ << ' ' << setw(w) << col.GetScalar(baby);
+        oss << ' ' << setw(w) << col.GetScalar(baby);
       }else{
         if(instance < val_vectors_.at(icol).size()){
-          out_ << ' ' << setw(w) << val_vectors_.at(icol).at(instance);
+          oss << ' ' << setw(w) << val_vectors_.at(icol).at(instance);
         }else{
-	  out_ << ' ' << setw(w) << ' ';
+	  oss << ' ' << setw(w) << ' ';
 	}
       }
     }
+    instances.at(instance) = oss.str();
+  }
+
+  if(write_to_file_){
+    WriteEvent(instances);
+  }else{
+    events_.push_back(move(instances));
+  }
+}
+
+/*!\brief Get a scan component that buffers events in memory instead of
+  writing them
+
+  \return Empty component for the same EventScan and Process
+*/
+unique_ptr<Figure::FigureComponent> EventScan::SingleScan::Shadow() const{
+  unique_ptr<SingleScan> shadow(new SingleScan(static_cast<const EventScan&>(figure_),
+                                               process_, false));
+  shadow->full_cut_ = full_cut_;
+  return unique_ptr<FigureComponent>(shadow.release());
+}
+
+/*!\brief Writes all events buffered in a shadow scan to file, numbering them
+  after the events already written, or buffers them if this scan is itself a
+  shadow
+
+  \param[in] shadow Component obtained from SingleScan::Shadow()
+*/
+void EventScan::SingleScan::Merge(const FigureComponent &shadow){
+  for(const auto &instances: static_cast<const SingleScan&>(shadow).events_){
+    if(write_to_file_){
+      WriteEvent(instances);
+    }else{
+      events_.push_back(instances);
+    }
+  }
+}
+
+/*!\brief Write buffered events as text, one formatted instance per line
+
+  \param[out] out Stream to which events are written
+*/
+void EventScan::SingleScan::WritePartial(ostream &out) const{
+  out << events_.size() << '\n';
+  for(const auto &instances: events_){
+    out << instances.size() << '\n';
+    for(const auto &instance: instances){
+      out << instance << '\n';
+    }
+  }
+}
+
+/*!\brief Buffer events written by WritePartial()
+
+  \param[in] in Stream from which events are read
+
+  \return True if events were read successfully
+*/
+bool EventScan::SingleScan::ReadPartial(istream &in){
+  size_t num_events = 0;
+  if(!(in >> num_events)) return false;
+  for(size_t ievent = 0; ievent < num_events; ++ievent){
+    size_t num_instances = 0;
+    if(!(in >> num_instances)) return false;
+    in.ignore(numeric_limits<streamsize>::max(), '\n');
+    vector<string> instances(num_instances);
+    for(auto &instance: instances){
+      if(!getline(in, instance)) return false;
+    }
+    events_.push_back(move(instances));
+  }
+  return true;
+}
+
+vector<NamedFunc*> EventScan::SingleScan::GetFunctions(){
+  return {&full_cut_};
+}
+
+/*!\brief Writes one event to file, with a header every 8 events
+
+  \param[in] instances Formatted columns for each instance of the event
+*/
+void EventScan::SingleScan::WriteEvent(const vector<string> &instances){
+  const EventScan &scan = static_cast<const EventScan&>(figure_);
+  int w = scan.width_;
+
+  if(!(row_ & 0x7)){
+    out_ << "      Row Instance";
+    for(const auto &col: scan.columns_){
+      out_ << ' ' << setw(w) << col.Name().substr(0,scan.width_);
+    }
     out_.put('\n');
   }
 
-  if(max_size > 0) ++row_;
+  for(size_t instance = 0; instance < instances.size(); ++instance){
+    out_ << setw(9) << row_ << ' ' << setw(8) << instance << instances.at(instance);
+    out_.put('\n');
+  }
+
+  ++row_;
 }
 
 void EventScan::SingleScan::Precision(unsigned precision){
@@ -116,6 +216,14 @@ Figure::FigureComponent * EventScan::GetComponent(const Process *process){
   return nullptr;
 }
 
+vector<NamedFunc*> EventScan::GetFunctions(){
+  vector<NamedFunc*> funcs;
+  for(auto &column: columns_){
+    funcs.push_back(&column);
+  }
+  return funcs;
+}
+
 unsigned EventScan::Precision() const{
   return precision_;
 }
@@ -4,9 +4,101 @@
 
 using namespace std;
 
+/*!\fn Figure::FigureComponent::Shadow
+  \brief Get an empty component of the same figure and process
+
+  Worker threads fill shadow components privately with RecordEvent(), and the
+  results are later added to the original component with Merge(). This keeps
+  the per-event filling free of locks.
+
+  \return Empty component accumulating into its own storage
+*/
+
+/*!\fn Figure::FigureComponent::Merge
+  \brief Adds the contents of a shadow component to this one
+
+  \param[in] shadow Component obtained from Shadow() on this component
+*/
+
+/*!\fn Figure::FigureComponent::GetFunctions
+  \brief Get the functions evaluated by RecordEvent() that belong to this
+  component
+
+  PlotMaker may replace these with equivalent functions sharing common
+  subexpressions before any events are recorded.
+
+  \return Pointers to the component's own functions
+*/
+
+/*!\fn Figure::GetFunctions
+  \brief Get the functions evaluated by the components' RecordEvent() that are
+  shared by all components of the figure
+
+  \return Pointers to the figure's functions
+*/
+
 Figure::FigureComponent::FigureComponent(const Figure &figure,
                                          const shared_ptr<Process> &process):
   figure_(figure),
   process_(process),
   mutex_(){
 }
+
+/*!\brief Request the columns needed to record a block of events at once
+
+  Components supporting batch filling add their functions to batch and
+  remember the column indices for RecordColumns(). The default implementation
+  supports no batch filling.
+
+  \param[in,out] batch Batch to which needed functions are added
+
+  \return True if RecordColumns() can be used instead of RecordEvent()
+*/
+bool Figure::FigureComponent::AddColumns(ColumnBatch &/*batch*/){
+  return false;
+}
+
+/*!\brief Record every entry of the current block of a batch
+
+  \param[in] batch Batch previously passed to AddColumns() and filled with
+  ColumnBatch::Fill()
+*/
+void Figure::FigureComponent::RecordColumns(const ColumnBatch &/*batch*/){
+  ERROR("Batch filling not supported for this figure component");
+}
+
+/*!\brief Get a description of everything determining what the component
+  accumulates from a given set of events
+
+  Partial results saved by ResultCache are reused only if the definition is
+  unchanged. The default implementation returns an empty string, meaning the
+  component does not support partial results and is always refilled.
+
+  \return Single line with binning and the NamedFunc::Definition() of cuts,
+  weights, and values, or empty string
+*/
+string Figure::FigureComponent::Definition() const{
+  return "";
+}
+
+/*!\brief Write the accumulated contents of the component
+
+  Only called if Definition() is not empty.
+
+  \param[out] out Stream to which contents are written as text
+*/
+void Figure::FigureComponent::WritePartial(ostream &/*out*/) const{
+  ERROR("Partial results not supported for this figure component");
+}
+
+/*!\brief Read contents written by WritePartial()
+
+  Only called on an empty component obtained from Shadow().
+
+  \param[in] in Stream from which contents are read
+
+  \return True if contents were read successfully
+*/
+bool Figure::FigureComponent::ReadPartial(istream &/*in*/){
+  return false;
+}
@@ -0,0 +1,213 @@
+/*! \class FuncProfiler
+
+  \brief Counts calls and time spent in individual NamedFunc nodes
+
+  Functions instrumented with NamedFunc::Profile() open a FuncProfiler::Scope
+  on each evaluation. Every call is counted, but only one out of every
+  sample_period top-level calls (and everything it calls in turn) is timed, so
+  that reading the clock does not dominate cheap functions. Times are scaled up
+  by the fraction of sampled calls when printed.
+
+  Exclusive time is the inclusive time minus that of profiled functions called
+  from within, e.g. by a lambda evaluating another NamedFunc.
+
+  Statistics are kept per thread without locking and summed by Print(), which
+  must therefore not run while profiled functions are being evaluated.
+*/
+
+/*! \class FuncProfiler::Scope
+
+  \brief Records one call of a profiled function for the duration of its scope
+*/
+#include "core/func_profiler.hpp"
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <set>
+#include <map>
+#include <algorithm>
+#include <iomanip>
+
+using namespace std;
+
+namespace{
+  using Clock = chrono::steady_clock;
+
+  //! Statistics of one function in one thread
+  struct FuncStats{
+    long calls_;//!<Number of calls
+    long sampled_calls_;//!<Number of calls that were timed
+    double inclusive_;//!<Total time of timed calls in nanoseconds
+    double exclusive_;//!<Total time of timed calls excluding profiled callees in nanoseconds
+  };
+
+  //! Timed call in progress
+  struct Frame{
+    Clock::time_point start_;//!<Time call started
+    double callees_;//!<Time spent in timed profiled callees in nanoseconds
+  };
+
+  //! Statistics and call stack of one thread
+  struct ThreadStats{
+    vector<FuncStats> stats_;//!<Statistics indexed by function
+    vector<Frame> stack_;//!<Timed calls in progress
+    size_t countdown_;//!<Number of top-level calls until next sampled call
+  };
+
+  mutex registry_mutex;//!<Protects names, users, and threads
+  vector<string> names;//!<Name of each registered function
+  map<string, size_t> indices;//!<Index of each registered name
+  vector<set<string> > users;//!<Figures and processes using each function
+  vector<unique_ptr<ThreadStats> > threads;//!<Statistics of all threads that evaluated profiled functions
+  size_t period = 16;//!<One in period top-level calls is timed
+  thread_local ThreadStats *this_thread = nullptr;//!<Statistics of the calling thread
+
+  /*!\brief Get statistics of the calling thread, creating them if needed
+
+    \return Statistics owned by the calling thread
+  */
+  ThreadStats & GetThreadStats(){
+    if(this_thread == nullptr){
+      lock_guard<mutex> lock(registry_mutex);
+      threads.emplace_back(new ThreadStats{vector<FuncStats>(), vector<Frame>(), 1});
+      this_thread = threads.back().get();
+    }
+    return *this_thread;
+  }
+}
+
+/*!\brief Start recording a call
+
+  \param[in] index Index of function from FuncProfiler::Register()
+*/
+FuncProfiler::Scope::Scope(size_t index):
+  index_(index),
+  timed_(false){
+  ThreadStats &thread = GetThreadStats();
+  if(thread.stats_.size() <= index_) thread.stats_.resize(index_+1, FuncStats{0, 0, 0., 0.});
+  ++thread.stats_[index_].calls_;
+  if(thread.stack_.empty()){
+    if(--thread.countdown_ > 0) return;
+    thread.countdown_ = period;
+  }
+  timed_ = true;
+  thread.stack_.push_back(Frame{Clock::now(), 0.});
+}
+
+FuncProfiler::Scope::~Scope(){
+  if(!timed_) return;
+  ThreadStats &thread = GetThreadStats();
+  Frame frame = thread.stack_.back();
+  thread.stack_.pop_back();
+  double elapsed = chrono::duration<double, nano>(Clock::now()-frame.start_).count();
+  FuncStats &stats = thread.stats_[index_];
+  ++stats.sampled_calls_;
+  stats.inclusive_ += elapsed;
+  stats.exclusive_ += elapsed-frame.callees_;
+  if(!thread.stack_.empty()) thread.stack_.back().callees_ += elapsed;
+}
+
+/*!\brief Get the index under which a function's statistics are kept
+
+  \param[in] name Name of function. Functions with the same name share
+  statistics.
+
+  \return Index to pass to FuncProfiler::Scope
+*/
+size_t FuncProfiler::Register(const string &name){
+  lock_guard<mutex> lock(registry_mutex);
+  auto found = indices.find(name);
+  if(found != indices.end()) return found->second;
+  indices.emplace(name, names.size());
+  names.push_back(name);
+  users.emplace_back();
+  return names.size()-1;
+}
+
+/*!\brief Note that a figure or process uses a function
+
+  \param[in] index Index of function from FuncProfiler::Register()
+
+  \param[in] user Description of figure or process, listed in the report
+*/
+void FuncProfiler::AddUse(size_t index, const string &user){
+  lock_guard<mutex> lock(registry_mutex);
+  users.at(index).insert(user);
+}
+
+/*!\brief Discard all statistics recorded so far
+
+  \param[in] sample_period Time one in this many top-level calls
+*/
+void FuncProfiler::Start(size_t sample_period){
+  lock_guard<mutex> lock(registry_mutex);
+  period = max(sample_period, static_cast<size_t>(1));
+  for(auto &thread: threads){
+    thread->stats_.clear();
+    thread->countdown_ = 1;
+  }
+}
+
+/*!\brief Print the most expensive functions, summed over all threads
+
+  \param[out] out Stream to print to
+
+  \param[in] max_rows Maximum number of functions to list
+*/
+void FuncProfiler::Print(ostream &out, size_t max_rows){
+  lock_guard<mutex> lock(registry_mutex);
+  vector<FuncStats> totals(names.size(), FuncStats{0, 0, 0., 0.});
+  for(const auto &thread: threads){
+    for(size_t i = 0; i < thread->stats_.size() && i < totals.size(); ++i){
+      const FuncStats &stats = thread->stats_[i];
+      totals[i].calls_ += stats.calls_;
+      totals[i].sampled_calls_ += stats.sampled_calls_;
+      totals[i].inclusive_ += stats.inclusive_;
+      totals[i].exclusive_ += stats.exclusive_;
+    }
+  }
+
+  //Estimated total times, scaling sampled calls up to all calls
+  vector<double> inclusive(totals.size(), 0.), exclusive(totals.size(), 0.);
+  double total_time = 0.;
+  vector<size_t> order;
+  for(size_t i = 0; i < totals.size(); ++i){
+    if(totals[i].sampled_calls_ == 0) continue;
+    double scale = static_cast<double>(totals[i].calls_)/totals[i].sampled_calls_;
+    inclusive[i] = scale*totals[i].inclusive_;
+    exclusive[i] = scale*totals[i].exclusive_;
+    total_time += exclusive[i];
+    order.push_back(i);
+  }
+  stable_sort(order.begin(), order.end(), [&exclusive](size_t a, size_t b){
+      return exclusive[a] > exclusive[b];
+    });
+  if(order.size() > max_rows) order.resize(max_rows);
+
+  out << "\nMost expensive functions (" << (1.e-9*total_time) << " s exclusive time in total):\n";
+  out << setw(14) << "Calls" << setw(12) << "Incl. ns" << setw(12) << "Excl. ns"
+      << setw(8) << "Share" << "  Function [used by]\n";
+  ios::fmtflags flags = out.flags();
+  streamsize precision = out.precision();
+  for(const auto &i: order){
+    out << setw(14) << totals[i].calls_
+        << setw(12) << fixed << setprecision(1) << inclusive[i]/totals[i].calls_
+        << setw(12) << exclusive[i]/totals[i].calls_
+        << setw(7) << (total_time > 0. ? 100.*exclusive[i]/total_time : 0.) << "%";
+    out.flags(flags);
+    out.precision(precision);
+    out << "  " << names[i];
+    if(!users[i].empty()){
+      out << " [";
+      for(auto user = users[i].cbegin(); user != users[i].cend(); ++user){
+        if(user != users[i].cbegin()) out << ", ";
+        out << *user;
+      }
+      out << ']';
+    }
+    out << '\n';
+  }
+  out << endl;
+}
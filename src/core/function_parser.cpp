@@ -6,11 +6,17 @@
   function, cut, etc. and converts it to a NamedFunc. It first decomposes the
   string into components representing single numbers, variables, operators,
   etc. The components are stored as \link Token Tokens\endlink. The Tokens
-  representing constants and variables in Baby are processed to obtain valid
-  \link NamedFunc NamedFuncs\endlink. Operators are successively applied
-  following standard order of operations to merge the \link Token Tokens\endlink
-  into a single Token instance containing a NamedFunc which can return the value
-  represented by the initial string.
+  representing constants, variables in Baby, and the C++ functions registered
+  with FunctionParser::Register() (e.g. those in Functions and WH_Functions)
+  are processed to obtain valid \link NamedFunc NamedFuncs\endlink, with
+  names looked up in hash tables. Operators are
+  successively applied following standard order of operations to merge the
+  \link Token Tokens\endlink into a single Token instance containing a
+  NamedFunc which can return the value represented by the initial string. The
+  operators and constants of the final NamedFunc are then compiled into a
+  Bytecode program, so that evaluating it calls only the functions of the Baby
+  variables and C++ functions it uses. The result is cached, so each distinct
+  string is parsed only once per process.
 
   Parentheses and brackets are parsed recursively and can be arbitrarily nested.
 
@@ -23,9 +29,15 @@
 #include <cstdlib>
 #include <cctype>
 
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+
 #include "core/utilities.hpp"
 #include "core/named_func.hpp"
 #include "core/functions.hpp"
+#include "core/wh_functions.hpp"
+#include "core/baby.hpp"
 
 using namespace std;
 
@@ -34,6 +46,48 @@ using VectorType = NamedFunc::VectorType;
 using ScalarFunc = NamedFunc::ScalarFunc;
 using VectorFunc = NamedFunc::VectorFunc;
 
+namespace{
+  //! Mutex guarding Registry()
+  mutex & RegistryMutex(){
+    static mutex registry_mutex;
+    return registry_mutex;
+  }
+
+  /*!\brief Get the C++ \link NamedFunc NamedFuncs\endlink that can be
+    referenced by name in function strings
+
+    Built on first use, so that functions can be registered during static
+    initialization of any translation unit. Guarded by RegistryMutex().
+
+    \return Map from name to registered function
+  */
+  unordered_map<string, NamedFunc> & Registry(){
+    static unordered_map<string, NamedFunc> registry;
+    return registry;
+  }
+
+  /*!\brief Find a function registered with FunctionParser::Register()
+
+    \param[in] name Name used in function strings
+
+    \param[out] func Set to the registered function if found
+
+    \return True if a function is registered under name
+  */
+  bool FindRegistered(const string &name, NamedFunc &func){
+    lock_guard<mutex> lock(RegistryMutex());
+    auto found = Registry().find(name);
+    if(found == Registry().cend()) return false;
+    func = found->second;
+    return true;
+  }
+}
+
+//! Referenced so that linking the parser from a static library also links,
+//! and thereby registers, the functions of Functions and WH_Functions
+extern const NamedFunc * const kLinkedFunctions[];
+const NamedFunc * const kLinkedFunctions[] = {&Functions::n_isr_match, &WH_Functions::WHLeptons};
+
 /*!\brief Standard constructor from string representing a function
 
   \param[in] function_string String representing a number, variable, function,
@@ -47,6 +101,35 @@ FunctionParser::FunctionParser(const string &function_string):
   ReplaceAll(input_string_, " ", "");
 }
 
+/*!\brief Makes a C++ NamedFunc available by name in function strings
+
+  Meant to initialize each function where it is defined, e.g.
+
+  const NamedFunc nlep = FunctionParser::Register(NamedFunc("nlep", ...));
+
+  so that the parser never reads the globals of other translation units, which
+  may not be constructed yet during static initialization. Baby variables take
+  precedence over registered functions with the same name, and registering a
+  name again replaces the earlier function.
+
+  \param[in] func Function to register
+
+  \param[in] name Name used in function strings. Empty uses func.Name().
+
+  \return Copy of func
+*/
+NamedFunc FunctionParser::Register(const NamedFunc &func, const string &name){
+  const string &key = name == "" ? func.Name() : name;
+  lock_guard<mutex> lock(RegistryMutex());
+  auto found = Registry().find(key);
+  if(found == Registry().end()){
+    Registry().emplace(key, func);
+  }else{
+    found->second = func;
+  }
+  return func;
+}
+
 /*!\brief Get string being parsed
 
   \return String being parsed
@@ -81,14 +164,37 @@ Token FunctionParser::ResolveAsToken() const{
 }
 
 /*!\brief Parses provided string into a single NamedFunc
+
+  The returned function evaluates the whole expression with a single Bytecode
+  program (see NamedFunc::Compile()). Each distinct string (after removing
+  spaces) is parsed only once per process. Later calls, from any thread, return
+  a copy of the first result, sharing its program and operands.
  */
 NamedFunc FunctionParser::ResolveAsNamedFunc() const{
+  static mutex parsed_mutex;
+  static unordered_map<string, shared_ptr<const NamedFunc> > parsed;
+  {
+    lock_guard<mutex> lock(parsed_mutex);
+    auto found = parsed.find(input_string_);
+    if(found != parsed.cend()) return *found->second;
+  }
+
+  // Parse without holding the lock, since parsing may construct other
+  // NamedFuncs from strings
   Solve();
-  return tokens_.size() ? tokens_.at(0).function_
-    : NamedFunc(input_string_,
-                [](const Baby &){
-                  return 0.;
-                });
+  shared_ptr<NamedFunc> out;
+  if(tokens_.size() == 0){
+    out = make_shared<NamedFunc>(input_string_,
+                                 [](const Baby &){
+                                   return 0.;
+                                 });
+  }else{
+    out = make_shared<NamedFunc>(tokens_.at(0).function_);
+    out->Compile();
+  }
+
+  lock_guard<mutex> lock(parsed_mutex);
+  return *parsed.emplace(input_string_, out).first->second;
 }
 
 /*!\brief Constructs FunctionParser from list of \link Token Tokens\endlink
@@ -173,55 +279,21 @@ void FunctionParser::CheckForUnknowns() const{
   }
 }
 
-/*!\brief Generates NamedFunc for each Token representing a constant or Baby
-  variable
+/*!\brief Generates NamedFunc for each Token representing a constant, Baby
+  variable, or NamedFunc registered with FunctionParser::Register()
 */
 void FunctionParser::ResolveVariables() const{
   for(auto &token: tokens_){
     if(token.type_ == Token::Type::variable_name){
-      // if(Functions::func_map.find(token.string_rep_) != Functions::func_map.end()){
-      // 	token = Functions::func_map.at(token.string_rep_);
-      if(token.string_rep_ == "nbm_moriond"){
-	token = Functions::nbm_moriond;
-      }
-      else if(token.string_rep_ == "ntop_loose_decor"){
-	token = Functions::ntop_loose_decor;
-      }
-      else if(token.string_rep_ == "ntop_med_decor"){
-	token = Functions::ntop_med_decor;
-      }
-      else if(token.string_rep_ == "ntop_tight_decor"){
-	token = Functions::ntop_tight_decor;
-      }
-      else if(token.string_rep_ == "ntop_loose_nom"){
-	token = Functions::ntop_loose_nom;
-      }
-      else if(token.string_rep_ == "ntop_med_nom"){
-	token = Functions::ntop_med_nom;
-      }
-      else if(token.string_rep_ == "ntop_tight_nom"){
-	token = Functions::ntop_tight_nom;
-      }
-      else if(token.string_rep_ == "n_mus_bad"){
-	token = Functions::n_mus_bad;
-      }
-      else if(token.string_rep_ == "n_mus_bad_trkmu"){
-	token = Functions::n_mus_bad_trkmu;
-      }
-      else if(token.string_rep_ == "n_mus_bad_dupl"){
-	token = Functions::n_mus_bad_dupl;
-      }
-      else {
-	token.function_ = Baby::GetFunction(token.string_rep_);
-	token.type_ = token.function_.IsScalar() ? Token::Type::resolved_scalar : Token::Type::resolved_vector;
+      if(Baby::HasFunction(token.string_rep_)
+         || !FindRegistered(token.string_rep_, token.function_)){
+        token.function_ = Baby::GetFunction(token.string_rep_);
       }
+      token.type_ = token.function_.IsScalar() ? Token::Type::resolved_scalar : Token::Type::resolved_vector;
     }else if(token.type_ == Token::Type::number){
       char *cp = nullptr;
       NamedFunc::ScalarType val = strtod(&token.string_rep_[0], &cp);
-      token.function_ = NamedFunc(token.string_rep_,
-                                  [val](const Baby &){
-                                    return val;
-                                  });
+      token.function_ = NamedFunc(val).Name(token.string_rep_);
       token.type_ = Token::Type::resolved_scalar;
     }
   }
@@ -288,13 +360,8 @@ void FunctionParser::ApplySubscripts() const{
       continue;
     }
 
-    function<VectorFunc> vec_func = vec.function_.VectorFunction();
-    function<ScalarFunc> sub_func = sub.function_.ScalarFunction();
-    function<ScalarFunc> function = [vec_func,sub_func](const Baby &b){
-      return vec_func(b).at(sub_func(b));
-    };
     string name = ConcatenateTokenStrings(i, i+4);
-    Token merged(NamedFunc(name, function));
+    Token merged(NamedFunc(vec.function_[sub.function_]).Name(name));
 
     CondenseTokens(i, i+4, merged);
   }
@@ -4,47 +4,48 @@
 
 #include "core/utilities.hpp"
 #include "core/config_parser.hpp"
+#include "core/function_parser.hpp"
 
 using namespace std;
 
 namespace Functions{
 
-  const NamedFunc n_mus_bad("n_mus_bad", [](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc n_mus_bad = FunctionParser::Register(NamedFunc("n_mus_bad", [](const Baby &b) -> NamedFunc::ScalarType{
       int n=0;
       for(unsigned int i=0; i< b.mus_pt()->size(); i++){
 	if(b.mus_bad()->at(i)) n++;
       }
       return n;
-    });
+    }));
 
-  const NamedFunc n_mus_bad_dupl("n_mus_bad_dupl", [](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc n_mus_bad_dupl = FunctionParser::Register(NamedFunc("n_mus_bad_dupl", [](const Baby &b) -> NamedFunc::ScalarType{
       int n=0;
       for(unsigned int i=0; i< b.mus_pt()->size(); i++){
 	if(b.mus_bad_dupl()->at(i)) n++;
       }
       return n;
-    });
+    }));
 
-  const NamedFunc n_mus_bad_trkmu("n_mus_bad_trkmu", [](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc n_mus_bad_trkmu = FunctionParser::Register(NamedFunc("n_mus_bad_trkmu", [](const Baby &b) -> NamedFunc::ScalarType{
       int n=0;
       for(unsigned int i=0; i< b.mus_pt()->size(); i++){
 	if(b.mus_bad_trkmu()->at(i)) n++;
       }
       return n;
-    });
+    }));
 
 
 
 
-  const NamedFunc n_isr_match("n_isr_match", NISRMatch);
+  const NamedFunc n_isr_match = FunctionParser::Register(NamedFunc("n_isr_match", NISRMatch));
 
-  const NamedFunc njets_weights_ttisr("njets_weights_ttisr", [](const Baby &b){
+  const NamedFunc njets_weights_ttisr = FunctionParser::Register(NamedFunc("njets_weights_ttisr", [](const Baby &b){
       return NJetsWeights_ttISR(b, false);
-    });
+    }));
 
-  const NamedFunc njets_weights_visr("njets_weights_visr", NJetsWeights_vISR);
+  const NamedFunc njets_weights_visr = FunctionParser::Register(NamedFunc("njets_weights_visr", NJetsWeights_vISR));
 
-  const NamedFunc min_dphi_lep_met("min_dphi_lep_met", [](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc min_dphi_lep_met = FunctionParser::Register(NamedFunc("min_dphi_lep_met", [](const Baby &b) -> NamedFunc::ScalarType{
       double phi1, eta1, phi2, eta2;
       DileptonAngles(b, eta1, phi1, eta2, phi2);
       double dphi1 = fabs(TVector2::Phi_mpi_pi(phi1-b.met_phi()));
@@ -57,9 +58,9 @@ namespace Functions{
         return dphi2;
       }
       return -1;
-    });
+    }));
 
-  const NamedFunc max_dphi_lep_met("max_dphi_lep_met", [](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc max_dphi_lep_met = FunctionParser::Register(NamedFunc("max_dphi_lep_met", [](const Baby &b) -> NamedFunc::ScalarType{
       double phi1, eta1, phi2, eta2;
       DileptonAngles(b, eta1, phi1, eta2, phi2);
       double dphi1 = fabs(TVector2::Phi_mpi_pi(phi1-b.met_phi()));
@@ -72,9 +73,9 @@ namespace Functions{
         return dphi2;
       }
       return -1;
-    });
+    }));
 
-  const NamedFunc min_dphi_lep_jet("min_dphi_lep_jet", [](const Baby &b) ->NamedFunc::ScalarType{
+  const NamedFunc min_dphi_lep_jet = FunctionParser::Register(NamedFunc("min_dphi_lep_jet", [](const Baby &b) ->NamedFunc::ScalarType{
       double phi1, eta1, phi2, eta2;
       DileptonAngles(b, eta1, phi1, eta2, phi2);
       double minphi = -1.;
@@ -95,9 +96,9 @@ namespace Functions{
         }
        }
       return minphi;
-    });
+    }));
 
-  const NamedFunc nbm_moriond("nbm_moriond", [](const Baby &b) ->NamedFunc::ScalarType{
+  const NamedFunc nbm_moriond = FunctionParser::Register(NamedFunc("nbm_moriond", [](const Baby &b) ->NamedFunc::ScalarType{
       int nbm = 0;
       for(size_t ijet = 0; ijet < b.jets_pt()->size(); ++ijet){
         if(!IsGoodJet(b,ijet)) continue;
@@ -105,63 +106,63 @@ namespace Functions{
 	//if(b.jets_csv()->at(ijet) > 0.800) nbm++;
       } // Loop over jets
       return nbm;
-    });
+    }));
 
-  const NamedFunc ntop_loose_nom("ntop_loose_nom", [](const Baby &b) ->NamedFunc::ScalarType{
+  const NamedFunc ntop_loose_nom = FunctionParser::Register(NamedFunc("ntop_loose_nom", [](const Baby &b) ->NamedFunc::ScalarType{
       int ntop = 0;
       for(size_t ijet = 0; ijet < b.ak8jets_pt()->size(); ++ijet){
       	if(!IsGoodak8Jet(b,ijet)) continue;
 	if(b.ak8jets_decor_bin_top()->at(ijet) > 0.1883) ntop++;
       } // Loop over all ak8 jets
       return ntop;
-    });
+    }));
 
-  const NamedFunc ntop_med_nom("ntop_med_nom", [](const Baby &b) ->NamedFunc::ScalarType{
+  const NamedFunc ntop_med_nom = FunctionParser::Register(NamedFunc("ntop_med_nom", [](const Baby &b) ->NamedFunc::ScalarType{
       int ntop = 0;
       for(size_t ijet = 0; ijet < b.ak8jets_pt()->size(); ++ijet){
 	if(!IsGoodak8Jet(b,ijet)) continue;
 	if(b.ak8jets_decor_bin_top()->at(ijet) > 0.8511) ntop++;
       } // Loop over all ak8 jets
       return ntop;
-    });
+    }));
 
-  const NamedFunc ntop_tight_nom("ntop_tight_nom", [](const Baby &b) ->NamedFunc::ScalarType{
+  const NamedFunc ntop_tight_nom = FunctionParser::Register(NamedFunc("ntop_tight_nom", [](const Baby &b) ->NamedFunc::ScalarType{
       int ntop = 0;
       for(size_t ijet = 0; ijet < b.ak8jets_pt()->size(); ++ijet){
 	if(!IsGoodak8Jet(b,ijet)) continue;
 	if(b.ak8jets_decor_bin_top()->at(ijet) > 0.9377) ntop++;
       } // Loop over all ak8 jets
       return ntop;
-    });
+    }));
 
-  const NamedFunc ntop_loose_decor("ntop_loose_decor", [](const Baby &b) ->NamedFunc::ScalarType{
+  const NamedFunc ntop_loose_decor = FunctionParser::Register(NamedFunc("ntop_loose_decor", [](const Baby &b) ->NamedFunc::ScalarType{
       int ntop = 0;
       for(size_t ijet = 0; ijet < b.ak8jets_pt()->size(); ++ijet){
       	if(!IsGoodak8Jet(b,ijet)) continue;
 	if(b.ak8jets_decor_bin_top()->at(ijet) > 0.04738 && b.ak8jets_m()->at(ijet)>105 && b.ak8jets_m()->at(ijet)<210) ntop++;
       } // Loop over all ak8 jets
       return ntop;
-    });
+    }));
 
-  const NamedFunc ntop_med_decor("ntop_med_decor", [](const Baby &b) ->NamedFunc::ScalarType{
+  const NamedFunc ntop_med_decor = FunctionParser::Register(NamedFunc("ntop_med_decor", [](const Baby &b) ->NamedFunc::ScalarType{
       int ntop = 0;
       for(size_t ijet = 0; ijet < b.ak8jets_pt()->size(); ++ijet){
 	if(!IsGoodak8Jet(b,ijet)) continue;
 	if(b.ak8jets_decor_bin_top()->at(ijet) > 0.4585 && b.ak8jets_m()->at(ijet)>105 && b.ak8jets_m()->at(ijet)<210) ntop++;
       } // Loop over all ak8 jets
       return ntop;
-    });
+    }));
 
-  const NamedFunc ntop_tight_decor("ntop_tight_decor", [](const Baby &b) ->NamedFunc::ScalarType{
+  const NamedFunc ntop_tight_decor = FunctionParser::Register(NamedFunc("ntop_tight_decor", [](const Baby &b) ->NamedFunc::ScalarType{
       int ntop = 0;
       for(size_t ijet = 0; ijet < b.ak8jets_pt()->size(); ++ijet){
 	if(!IsGoodak8Jet(b,ijet)) continue;
 	if(b.ak8jets_decor_bin_top()->at(ijet) > 0.6556 && b.ak8jets_m()->at(ijet)>105 && b.ak8jets_m()->at(ijet)<210) ntop++;
       } // Loop over all ak8 jets
       return ntop;
-    });
+    }));
 
-  const NamedFunc max_dphi_lep_jet("max_dphi_lep_jet", [](const Baby &b) ->NamedFunc::ScalarType{
+  const NamedFunc max_dphi_lep_jet = FunctionParser::Register(NamedFunc("max_dphi_lep_jet", [](const Baby &b) ->NamedFunc::ScalarType{
       double phi1, eta1, phi2, eta2;
       DileptonAngles(b, eta1, phi1, eta2, phi2);
       double maxphi = -1.;
@@ -182,9 +183,9 @@ namespace Functions{
         }
       }
       return maxphi;
-    });
+    }));
 
-  const NamedFunc min_dphi_met_jet("min_dphi_met_jet", [](const Baby &b) ->NamedFunc::ScalarType{
+  const NamedFunc min_dphi_met_jet = FunctionParser::Register(NamedFunc("min_dphi_met_jet", [](const Baby &b) ->NamedFunc::ScalarType{
       double minphi = -1.;
       for(size_t ijet = 0; ijet < b.jets_pt()->size(); ++ijet){
         if(!IsGoodJet(b,ijet)) continue;
@@ -194,9 +195,9 @@ namespace Functions{
         }
       }
       return minphi;
-    });
+    }));
 
-  const NamedFunc max_dphi_met_jet("max_dphi_met_jet", [](const Baby &b) ->NamedFunc::ScalarType{
+  const NamedFunc max_dphi_met_jet = FunctionParser::Register(NamedFunc("max_dphi_met_jet", [](const Baby &b) ->NamedFunc::ScalarType{
       double maxphi = -1.;
       for(size_t ijet = 0; ijet < b.jets_pt()->size(); ++ijet){
         if(!IsGoodJet(b,ijet)) continue;
@@ -206,9 +207,9 @@ namespace Functions{
         }
       }
       return maxphi;
-    });
+    }));
 
-  const NamedFunc min_dr_lep_jet("min_dr_lep_jet", [](const Baby &b) ->NamedFunc::ScalarType{
+  const NamedFunc min_dr_lep_jet = FunctionParser::Register(NamedFunc("min_dr_lep_jet", [](const Baby &b) ->NamedFunc::ScalarType{
       double phi1, eta1, phi2, eta2;
       DileptonAngles(b, eta1, phi1, eta2, phi2);
       double minr = -1.;
@@ -229,9 +230,9 @@ namespace Functions{
         }
       }
       return minr;
-    });
+    }));
 
-  const NamedFunc max_dr_lep_jet("max_dr_lep_jet", [](const Baby &b) ->NamedFunc::ScalarType{
+  const NamedFunc max_dr_lep_jet = FunctionParser::Register(NamedFunc("max_dr_lep_jet", [](const Baby &b) ->NamedFunc::ScalarType{
       double phi1, eta1, phi2, eta2;
       DileptonAngles(b, eta1, phi1, eta2, phi2);
       double maxr = -1.;
@@ -252,9 +253,9 @@ namespace Functions{
         }
       }
       return maxr;
-    });
+    }));
 
-  const NamedFunc offshellw("offshellw",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc offshellw = FunctionParser::Register(NamedFunc("offshellw",[](const Baby &b) -> NamedFunc::ScalarType{
       for (unsigned i(0); i<b.mc_pt()->size(); i++){
 	if (abs(b.mc_id()->at(i))!=24) continue;
 	if (b.mc_mass()->at(i) > 140.) {
@@ -262,7 +263,7 @@ namespace Functions{
 	}
       }
       return 0;
-    });
+    }));
 
   bool IsGoodJet(const Baby &b, size_t ijet){
     return ijet<b.jets_pt()->size()
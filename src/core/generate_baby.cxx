@@ -401,6 +401,40 @@ string ToLower(string x){
   return x;
 }
 
+/*!\brief Checks if a branch type can be read through a BulkColumn
+
+  \param[in] type Type of variable, as given by Variable::Type()
+
+  \return True if type is a scalar or a std::vector of scalars
+*/
+bool IsBulkReadable(const string &type){
+  const string vector_prefix = "std::vector<";
+  if(type.compare(0, vector_prefix.size(), vector_prefix) == 0 && type.back() == '>'){
+    string element = type.substr(vector_prefix.size(), type.size()-vector_prefix.size()-1);
+    return element.find_first_of(":<") == string::npos;
+  }
+  return type.find("std::") == string::npos;
+}
+
+/*!\brief Assigns each variable cached by a Baby class a slot in its
+  cache_entries_ array
+
+  \param[in] vars All variables for all Baby classes, with type information
+
+  \param[in] type Name of derived Baby class, or empty for the base class
+
+  \return Slot of each variable implemented in the class, by name
+*/
+map<string, size_t> CacheIndices(const set<Variable> &vars, const string &type){
+  map<string, size_t> indices;
+  for(const auto &var: vars){
+    if(type == "" ? var.ImplementInBase() : (var.ImplementIn(type) || var.EverythingIn(type))){
+      indices.emplace(var.Name(), indices.size());
+    }
+  }
+  return indices;
+}
+
 /*!\brief Writes inc/baby.hpp
 
   \param[in] vars All variables for all Baby classes, with type information
@@ -413,14 +447,19 @@ void WriteBaseHeader(const set<Variable> &vars,
   file << "#ifndef H_BABY\n";
   file << "#define H_BABY\n\n";
 
+  file << "#include <array>\n";
   file << "#include <vector>\n";
   file << "#include <set>\n";
   file << "#include <memory>\n";
-  file << "#include <string>\n\n";
+  file << "#include <string>\n";
+  file << "#include <functional>\n\n";
 
   file << "#include \"TChain.h\"\n\n";
   file << "#include \"TString.h\"\n\n";
 
+  file << "#include \"core/bulk_column.hpp\"\n";
+  file << "#include \"core/span.hpp\"\n\n";
+
   file << "class Process;\n";
   file << "class NamedFunc;\n\n";
 
@@ -471,15 +510,30 @@ void WriteBaseHeader(const set<Variable> &vars,
 
   file << "  const std::unique_ptr<TChain> & GetTree() const;\n\n";
 
-  file << "  static NamedFunc GetFunction(const std::string &var_name);\n\n";
+  file << "  static NamedFunc GetFunction(const std::string &var_name);\n";
+  file << "  static bool HasFunction(const std::string &var_name);\n\n";
+
+  file << "  double GetMemoScalar(std::size_t slot,\n";
+  file << "                       const std::function<double(const Baby &)> &func,\n";
+  file << "                       bool per_file = false) const;\n";
+  file << "  Span<double> GetMemoVector(std::size_t slot,\n";
+  file << "                             const std::function<Span<double>(const Baby &)> &func,\n";
+  file << "                             bool per_file = false) const;\n\n";
+
+  file << "  void RecordBranches(std::set<std::string> *branches);\n";
+  file << "  void SelectBranches(const std::set<std::string> &branches,\n";
+  file << "                      long first_entry, long last_entry);\n\n";
 
-  file << "  std::unique_ptr<Activator> Activate();\n\n";
+  file << "  std::unique_ptr<Activator> Activate();\n";
+  file << "  virtual std::unique_ptr<Baby> Clone() const = 0;\n\n";
 
   file << "protected:\n";
   file << "  virtual void Initialize();\n\n";
 
   file << "  std::unique_ptr<TChain> chain_;//!<Chain to load variables from\n";
-  file << "  long entry_;//!<Current entry\n\n";
+  file << "  long entry_;//!<Current entry\n";
+  file << "  std::set<std::string> *branch_record_;//!<If not null, names of branches read are added here\n";
+  file << "  long memo_entry_;//!<Number of GetEntry calls. Memoized values and cached variables from other calls are stale.\n\n";
 
   file << "private:\n";
   file << "  friend class Activator;\n\n";
@@ -491,21 +545,31 @@ void WriteBaseHeader(const set<Variable> &vars,
   file << "  std::set<std::string> file_names_;//!<Files loaded into TChain\n";
   file << "  int sample_type_;//!< Integer indicating what kind of sample the first file has\n";
   file << "  mutable long total_entries_;//!<Cached number of events in TChain\n";
-  file << "  mutable bool cached_total_entries_;//!<Flag if cached event count up to date\n\n";
+  file << "  mutable bool cached_total_entries_;//!<Flag if cached event count up to date\n";
+  file << "  long memo_file_;//!<Number of file changes in GetEntry. Per-file memoized values from other files are stale.\n";
+  file << "  int tree_number_;//!<Index in TChain of file containing current entry\n";
+  file << "  mutable std::vector<long> scalar_memo_entries_;//!<Value of memo_entry_ when each scalar memo slot was filled\n";
+  file << "  mutable std::vector<double> scalar_memo_values_;//!<Memoized scalar results by slot\n";
+  file << "  mutable std::vector<long> vector_memo_entries_;//!<Value of memo_entry_ when each vector memo slot was filled\n";
+  file << "  mutable std::vector<std::vector<double> > vector_memo_values_;//!<Memoized vector results by slot\n\n";
 
   file << "  void ActivateChain();\n";
   file << "  void DeactivateChain();\n\n";
 
   for(const auto &var: vars){
     if(!var.ImplementInBase()) continue;
-    file << "  "
+    file << "  mutable "
          << var.DecoratedType() << " "
          << var.Name() << "_;//!<Cached value of " << var.Name() << '\n';
     file << "  TBranch *b_" << var.Name() << "_;//!<Branch from which "
          << var.Name() << " is read\n";
-    file << "  mutable bool c_" << var.Name() << "_;//!<Flag if cached "
-         << var.Name() << " up to date\n";
+    if(IsBulkReadable(var.Type())){
+      file << "  mutable BulkColumn<" << var.Type() << (var.Type().back() == '>' ? " > " : "> ") << "bulk_" << var.Name()
+           << "_;//!<Basket of " << var.Name() << " currently being read\n";
+    }
   }
+  file << "  mutable std::array<long, " << CacheIndices(vars, "").size() << "> cache_entries_;"
+       << "//!<Value of memo_entry_ when each cached variable was read\n";
   file << "};\n\n";
 
   for(const auto &type: types){
@@ -527,7 +591,12 @@ void WriteBaseSource(const set<Variable> &vars){
 
   file << "  \\brief Abstract base class for access to ntuple variables\n\n";
 
-  file << "  Loads variables on demand and caches for fast repeated use within an event.\n\n";
+  file << "  Loads variables on demand and caches for fast repeated use within an event.\n";
+  file << "  The first time a variable is read from a basket, the whole basket is read\n";
+  file << "  into a BulkColumn, from which the following entries are then served. Each\n";
+  file << "  class records in one array the value of memo_entry_ at which each variable was\n";
+  file << "  last read, so GetEntry() invalidates all cached variables by incrementing\n";
+  file << "  memo_entry_ rather than clearing a flag per variable.\n\n";
 
   file << "  A derived class is used for each known ntuple format. Variables and functions\n";
   file << "  are kept in this base class whenever possible, and placed in the derived classes\n";
@@ -544,20 +613,22 @@ void WriteBaseSource(const set<Variable> &vars){
   file << "#include \"core/baby.hpp\"\n\n";
 
   file << "#include <mutex>\n";
+  file << "#include <unordered_map>\n";
   file << "#include <type_traits>\n";
   file << "#include <utility>\n";
   file << "#include <stdexcept>\n\n";
 
   file << "#include \"core/named_func.hpp\"\n";
+  file << "#include \"core/arena.hpp\"\n";
+  file << "#include \"core/trace.hpp\"\n";
   file << "#include \"core/utilities.hpp\"\n\n";
 
   file << "using namespace std;\n\n";
 
   file << "namespace{\n";
   file << "  using ScalarType = NamedFunc::ScalarType;\n";
-  file << "  using VectorType = NamedFunc::VectorType;\n";
   file << "  using ScalarFunc = NamedFunc::ScalarFunc;\n";
-  file << "  using VectorFunc = NamedFunc::VectorFunc;\n\n";
+  file << "  using TypedFunc = NamedFunc::TypedFunc;\n\n";
 
   file << "  /*!\\brief Get dummy NamedFunc in case of substitution failure\n\n";
 
@@ -586,7 +657,7 @@ void WriteBaseSource(const set<Variable> &vars){
   file << "    return NamedFunc(name,\n";
   file << "                     [baby_func](const Baby &b){\n";
   file << "                       return ScalarType((b.*baby_func)());\n";
-  file << "                     });\n";
+  file << "                     }).ResultType(TypedSpan::TypeOf<T>());\n";
   file << "  }\n\n";
 
   file << "  /*!\\brief Get NamedFunc for a function returning a vector\n\n";
@@ -595,32 +666,31 @@ void WriteBaseSource(const set<Variable> &vars){
 
   file << "    \\param[in] name Name of function/variable\n\n";
 
-  file << "    \\return NamedFunc that returns appropriate vectorr\n";
+  file << "    \\return NamedFunc viewing the vector without copying if its elements\n";
+  file << "    are double, float, or int, else a copy in Arena\n";
   file << "  */\n";
   file << "  template<typename T>\n";
   file << "    NamedFunc GetFunction(vector<T>* const &(Baby::*baby_func)() const,\n";
   file << "                          const string &name){\n";
   file << "    return NamedFunc(name,\n";
-  file << "                     [baby_func](const Baby &b){\n";
-  file << "                       const auto &raw = (b.*baby_func)();\n";
-  file << "                       return VectorType(raw->cbegin(), raw->cend());\n";
-  file << "                     });\n";
+  file << "                     function<TypedFunc>([baby_func](const Baby &b){\n";
+  file << "                         return TypedSpan::Of(*((b.*baby_func)()));\n";
+  file << "                       })).ResultType(TypedSpan::TypeOf<T>());\n";
   file << "  }\n\n";
 
-  bool have_vector_double = false;
-  for(auto var = vars.cbegin(); var != vars.cend() && !have_vector_double; ++var){
-    if(var->Type().find("vector<double>") != string::npos){
-      have_vector_double = true;
-    }
-  }
+  file << "  /*!\\brief Get NamedFunc for each variable, built on first use\n\n";
 
-  if(have_vector_double){
-    file << "    template<>\n";
-    file << "      NamedFunc GetFunction<vector<double>* const &(Baby::*)() const>(vector<double>* const &(Baby::*baby_func)() const,\n";
-    file << "                                                                      const string &name){\n";
-    file << "      return NamedFunc(name, [baby_func](const Baby &b){return *((b.*baby_func)());}, true);\n";
-    file << "  }\n";
+  file << "    \\return Map from variable name to NamedFunc reading it\n";
+  file << "  */\n";
+  file << "  const unordered_map<string, NamedFunc> & VariableFunctions(){\n";
+  file << "    static const unordered_map<string, NamedFunc> functions{\n";
+  for(const auto &var: vars){
+    file << "      {\"" << var.Name() << "\", GetFunction(&Baby::" << var.Name() << ", \"" << var.Name()
+         << "\").Variable(\"" << var.Name() << "\")},\n";
   }
+  file << "    };\n";
+  file << "    return functions;\n";
+  file << "  }\n";
   file << "}\n\n";
 
   file << "Baby::Activator::Activator(Baby &baby):\n";
@@ -640,30 +710,25 @@ void WriteBaseSource(const set<Variable> &vars){
   file << "           const set<const Process*> &processes):\n";
   file << "  processes_(processes),\n";
   file << "  chain_(nullptr),\n";
+  file << "  branch_record_(nullptr),\n";
+  file << "  memo_entry_(0),\n";
   file << "  file_names_(file_names),\n";
   file << "  total_entries_(0),\n";
-  auto last_base = vars.cbegin();
-  bool found_in_base = false;
-  for(auto iter = vars.cbegin(); iter != vars.cend(); ++iter){
-    if(iter->ImplementInBase()){
-      last_base = iter;
-      found_in_base = true;
-    }
-  }
-  if(vars.size() == 0 || !found_in_base){
-    file << "  cached_total_entries_(false){\n";
-  }else{
-    file << "  cached_total_entries_(false),\n";
-    for(auto var = vars.cbegin(); var != last_base; ++var){
-      if(!var->ImplementInBase()) continue;
-      file << "  " << var->Name() << "_{},\n";
-      file << "  b_" << var->Name() << "_(nullptr),\n";
-      file << "  c_" << var->Name() << "_(false),\n";
-    }
-    file << "  " << last_base->Name() << "_{},\n";
-    file << "  b_" << last_base->Name() << "_(nullptr),\n";
-    file << "  c_" << last_base->Name() << "_(false){\n";
+  file << "  cached_total_entries_(false),\n";
+  file << "  memo_file_(0),\n";
+  file << "  tree_number_(-1),\n";
+  file << "  scalar_memo_entries_(),\n";
+  file << "  scalar_memo_values_(),\n";
+  file << "  vector_memo_entries_(),\n";
+  file << "  vector_memo_values_(),\n";
+  for(const auto &var: vars){
+    if(!var.ImplementInBase()) continue;
+    file << "  " << var.Name() << "_{},\n";
+    file << "  b_" << var.Name() << "_(nullptr),\n";
+    if(IsBulkReadable(var.Type())) file << "  bulk_" << var.Name() << "_(),\n";
   }
+  file << "  cache_entries_(){\n";
+  file << "  cache_entries_.fill(-1);\n";
   file << "  TString filename=\"\";\n";
   file << "  if(file_names_.size()) filename = *file_names_.cbegin();\n";
   file << "  sample_type_ = SetSampleType(filename);\n";
@@ -687,12 +752,74 @@ void WriteBaseSource(const set<Variable> &vars){
   file << "  \\param[in] entry Entry number to load\n";
   file << "*/\n";
   file << "void Baby::GetEntry(long entry){\n";
-  for(const auto &var: vars){
-    if(!var.ImplementInBase()) continue;
-    file << "  c_" << var.Name() << "_ = false;\n";
-  }
+  file << "  ++memo_entry_;\n";
+  file << "  Arena::Reset();\n";
   file << "  lock_guard<mutex> lock(Multithreading::root_mutex);\n";
+  file << "  Trace::Span open_span(\"OpenFile\");\n";
   file << "  entry_ = chain_->LoadTree(entry);\n";
+  file << "  if(chain_->GetTreeNumber() != tree_number_){\n";
+  file << "    tree_number_ = chain_->GetTreeNumber();\n";
+  file << "    ++memo_file_;\n";
+  file << "  }else{\n";
+  file << "    open_span.Discard();\n";
+  file << "  }\n";
+  file << "}\n\n";
+
+  file << "/*!\\brief Evaluate scalar function at most once per entry or file\n\n";
+
+  file << "  \\param[in] slot Memo slot reserved for func (see NamedFunc::Memoize())\n\n";
+
+  file << "  \\param[in] func Function to evaluate if slot not yet filled for current entry\n\n";
+
+  file << "  \\param[in] per_file If true, func is evaluated once per file instead\n";
+  file << "  of once per entry. Must be the same for all uses of slot.\n\n";
+
+  file << "  \\return Result of func for current entry\n";
+  file << "*/\n";
+  file << "double Baby::GetMemoScalar(size_t slot,\n";
+  file << "                           const function<double(const Baby &)> &func,\n";
+  file << "                           bool per_file) const{\n";
+  file << "  long stamp = per_file ? memo_file_ : memo_entry_;\n";
+  file << "  if(slot < scalar_memo_entries_.size() && scalar_memo_entries_[slot] == stamp){\n";
+  file << "    return scalar_memo_values_[slot];\n";
+  file << "  }\n";
+  file << "  double value = func(*this);\n";
+  file << "  if(slot >= scalar_memo_entries_.size()){\n";
+  file << "    scalar_memo_entries_.resize(slot+1, -1);\n";
+  file << "    scalar_memo_values_.resize(slot+1, 0.);\n";
+  file << "  }\n";
+  file << "  scalar_memo_entries_[slot] = stamp;\n";
+  file << "  scalar_memo_values_[slot] = value;\n";
+  file << "  return value;\n";
+  file << "}\n\n";
+
+  file << "/*!\\brief Evaluate vector function at most once per entry or file\n\n";
+
+  file << "  \\param[in] slot Memo slot reserved for func (see NamedFunc::Memoize())\n\n";
+
+  file << "  \\param[in] func Function to evaluate if slot not yet filled for current entry\n\n";
+
+  file << "  \\param[in] per_file If true, func is evaluated once per file instead\n";
+  file << "  of once per entry. Must be the same for all uses of slot.\n\n";
+
+  file << "  \\return View of result of func for current entry, valid until func is\n";
+  file << "  evaluated again for slot\n";
+  file << "*/\n";
+  file << "Span<double> Baby::GetMemoVector(size_t slot,\n";
+  file << "                                 const function<Span<double>(const Baby &)> &func,\n";
+  file << "                                 bool per_file) const{\n";
+  file << "  long stamp = per_file ? memo_file_ : memo_entry_;\n";
+  file << "  if(slot < vector_memo_entries_.size() && vector_memo_entries_[slot] == stamp){\n";
+  file << "    return Span<double>(vector_memo_values_[slot]);\n";
+  file << "  }\n";
+  file << "  Span<double> value = func(*this);\n";
+  file << "  if(slot >= vector_memo_entries_.size()){\n";
+  file << "    vector_memo_entries_.resize(slot+1, -1);\n";
+  file << "    vector_memo_values_.resize(slot+1);\n";
+  file << "  }\n";
+  file << "  vector_memo_entries_[slot] = stamp;\n";
+  file << "  vector_memo_values_[slot].assign(value.cbegin(), value.cend());\n";
+  file << "  return Span<double>(vector_memo_values_[slot]);\n";
   file << "}\n\n";
 
   file << "const std::set<std::string> & Baby::FileNames() const{\n";
@@ -729,30 +856,70 @@ void WriteBaseSource(const set<Variable> &vars){
 
   file << "/*! \\brief Get a NamedFunc accessing specified variable\n\n";
 
+  file << "  Looked up in a hash table built on the first call.\n\n";
+
+  file << "  \\param[in] var_name Name of variable\n\n";
+
   file << "  \\return NamedFunc which returns specified variable from a Baby\n";
   file << "*/\n";
   file << "NamedFunc Baby::GetFunction(const std::string &var_name){\n";
-  if(vars.size() != 0){
-    file << "  if(var_name == \"" << vars.cbegin()->Name() << "\"){\n";
-    file << "    return ::GetFunction(&Baby::" << vars.cbegin()->Name() << ", \"" << vars.cbegin()->Name() << "\");\n";
-    for(auto var = ++vars.cbegin(); var != vars.cend(); ++var){
-      file << "  }else if(var_name == \"" << var->Name() << "\"){\n";
-      file << "    return ::GetFunction(&Baby::" << var->Name() << ", \"" << var->Name() << "\");\n";
-    }
-    file << "  }else{\n";
-    file << "    DBG(\"Function lookup failed for \\\"\" << var_name << \"\\\"\");\n";
-    file << "    return NamedFunc(var_name,\n";
-    file << "                     [](const Baby &){\n";
-    file << "                       return 0.;\n";
-    file << "                     });\n";
-    file << "  }\n";
-  }else{
-    file << "  DBG(\"No variables defined in Baby.\");\n";
-    file << "  return NamedFunc(var_name,\n";
-    file << "                   [](const Baby &){\n";
-    file << "                     return 0.;\n";
-    file << "                   });\n";
-  }
+  file << "  const auto &functions = VariableFunctions();\n";
+  file << "  auto found = functions.find(var_name);\n";
+  file << "  if(found != functions.cend()) return found->second;\n";
+  file << "  DBG(\"Function lookup failed for \\\"\" << var_name << \"\\\"\");\n";
+  file << "  return NamedFunc(var_name,\n";
+  file << "                   [](const Baby &){\n";
+  file << "                     return 0.;\n";
+  file << "                   });\n";
+  file << "}\n\n";
+
+  file << "/*! \\brief Check if a variable is known to Baby\n\n";
+
+  file << "  \\param[in] var_name Name of variable\n\n";
+
+  file << "  \\return True if GetFunction() can read var_name\n";
+  file << "*/\n";
+  file << "bool Baby::HasFunction(const std::string &var_name){\n";
+  file << "  return VariableFunctions().count(var_name) != 0;\n";
+  file << "}\n\n";
+
+  file << "/*! \\brief Start or stop recording which branches are read\n\n";
+
+  file << "  \\param[in] branches Set to which the name of each branch read is added, or\n";
+  file << "  nullptr to stop recording\n";
+  file << "*/\n";
+  file << "void Baby::RecordBranches(set<string> *branches){\n";
+  file << "  branch_record_ = branches;\n";
+  file << "}\n\n";
+
+  file << "/*! \\brief Disable all branches except the given ones and cache only those\n\n";
+
+  file << "  Disabled branches can still be read through the accessors, but are not\n";
+  file << "  prefetched by the TTreeCache.\n\n";
+
+  file << "  \\param[in] branches Names of branches to keep enabled. Names not in the\n";
+  file << "  TChain are ignored.\n\n";
+
+  file << "  \\param[in] first_entry First entry to be read (inclusive)\n\n";
+
+  file << "  \\param[in] last_entry Last entry to be read (exclusive)\n";
+  file << "*/\n";
+  file << "void Baby::SelectBranches(const set<string> &branches,\n";
+  file << "                          long first_entry, long last_entry){\n";
+  file << "  Trace::Span span(\"SelectBranches\");\n";
+  file << "  lock_guard<mutex> lock(Multithreading::root_mutex);\n";
+  file << "  chain_->SetBranchStatus(\"*\", false);\n";
+  file << "  for(const auto &branch: branches){\n";
+  file << "    if(chain_->GetBranch(branch.c_str()) == nullptr) continue;\n";
+  file << "    chain_->SetBranchStatus(branch.c_str(), true);\n";
+  file << "  }\n";
+  file << "  chain_->SetCacheSize();\n";
+  file << "  chain_->SetCacheEntryRange(first_entry, last_entry);\n";
+  file << "  for(const auto &branch: branches){\n";
+  file << "    if(chain_->GetBranch(branch.c_str()) == nullptr) continue;\n";
+  file << "    chain_->AddBranchToCache(branch.c_str(), true);\n";
+  file << "  }\n";
+  file << "  chain_->StopCacheLearningPhase();\n";
   file << "}\n\n";
 
   file << "unique_ptr<Baby::Activator> Baby::Activate(){\n";
@@ -771,7 +938,10 @@ void WriteBaseSource(const set<Variable> &vars){
 
   file << "void Baby::ActivateChain(){\n";
   file << "  if(chain_) ERROR(\"Chain has already been initialized\");\n";
+  file << "  Trace::Span span(\"ActivateChain\");\n";
+  file << "  Trace::Span wait_span(\"WaitRootLock\");\n";
   file << "  lock_guard<mutex> lock(Multithreading::root_mutex);\n";
+  file << "  wait_span.End();\n";
   file << "  chain_ = unique_ptr<TChain>(new TChain(\"t\"));\n";
   file << "  for(const auto &file: file_names_){\n";
   file << "    chain_->Add(file.c_str());\n";
@@ -780,20 +950,33 @@ void WriteBaseSource(const set<Variable> &vars){
   file << "}\n\n";
 
   file << "void Baby::DeactivateChain(){\n";
+  file << "  Trace::Span span(\"DeactivateChain\");\n";
+  file << "  Trace::Span wait_span(\"WaitRootLock\");\n";
   file << "  lock_guard<mutex> lock(Multithreading::root_mutex);\n";
+  file << "  wait_span.End();\n";
   file << "  chain_.reset();\n";
   file << "}\n\n";
 
+  map<string, size_t> cache_indices = CacheIndices(vars, "");
   for(const auto &var: vars){
     if(!var.ImplementInBase()) continue;
+    string cache_entry = "cache_entries_["+to_string(cache_indices.at(var.Name()))+"]";
     file << "/*! \\brief Get " << var.Name() << " for current event and cache it\n\n";
 
     file << "  \\return " << var.Name() << " for current event\n";
     file << "*/\n";
     file << var.DecoratedType() << " const & Baby::" << var.Name() << "() const{\n";
-    file << "  if(!c_" << var.Name() << "_ && b_" << var.Name() << "_){\n";
-    file << "    b_" << var.Name() << "_->GetEntry(entry_);\n";
-    file << "    c_" << var.Name() << "_ = true;\n";
+    file << "  if(" << cache_entry << " != memo_entry_ && b_" << var.Name() << "_){\n";
+    file << "    if(branch_record_) branch_record_->insert(\"" << var.Name() << "\");\n";
+    if(IsBulkReadable(var.Type())){
+      file << "    if(!bulk_" << var.Name() << "_.Read(*b_" << var.Name() << "_, chain_->GetTreeNumber(), entry_, "
+           << var.Name() << "_)){\n";
+      file << "      b_" << var.Name() << "_->GetEntry(entry_, 1);\n";
+      file << "    }\n";
+    }else{
+      file << "    b_" << var.Name() << "_->GetEntry(entry_, 1);\n";
+    }
+    file << "    " << cache_entry << " = memo_entry_;\n";
     file << "  }\n";
     file << "  return " << var.Name() << "_;\n";
     file << "}\n\n";
@@ -820,7 +1003,7 @@ void WriteSpecializedHeader(const set<Variable> &vars, const string &type){
   file << "  explicit Baby_" << type << "(const std::set<std::string> &file_names, const std::set<const Process*> &processes = std::set<const Process*>{});\n";
   file << "  virtual ~Baby_" << type << "() = default;\n\n";
 
-  file << "  virtual void GetEntry(long entry);\n\n";
+  file << "  virtual std::unique_ptr<Baby> Clone() const;\n\n";
 
   for(const auto &var: vars){
     if(var.VirtualInBase()){
@@ -847,14 +1030,18 @@ void WriteSpecializedHeader(const set<Variable> &vars, const string &type){
 
   for(const auto &var: vars){
     if(var.ImplementIn(type) || var.EverythingIn(type)){
-      file << "  " << var.DecoratedType(type) << " "
+      file << "  mutable " << var.DecoratedType(type) << " "
            << var.Name() << "_;//!<Cached value of " << var.Name() << '\n';
       file << "  TBranch *b_" << var.Name() << "_;\n//!<Branch from which "
            << var.Name() << " is read\n";
-      file << "  mutable bool c_" << var.Name() << "_;//!<Flag if cached "
-           << var.Name() << " up to date\n";
+      if(IsBulkReadable(var.Type(type))){
+        file << "  mutable BulkColumn<" << var.Type(type) << (var.Type(type).back() == '>' ? " > " : "> ") << "bulk_" << var.Name()
+             << "_;//!<Basket of " << var.Name() << " currently being read\n";
+      }
     }
   }
+  file << "  mutable std::array<long, " << CacheIndices(vars, type).size() << "> " << type << "_cache_entries_;"
+       << "//!<Value of memo_entry_ when each cached variable was read\n";
   file << "};\n\n";
 
   file << "#endif" << endl;
@@ -891,45 +1078,25 @@ void WriteSpecializedSource(const set<Variable> &vars, const string &type){
   file << "  \\param[in] file_names ntuple files to read from\n";
   file << "*/\n";
   file << "Baby_" << type << "::Baby_" << type << "(const set<string> &file_names, const set<const Process*> &processes):\n";
-  int implemented_here = 0;
-  for(const auto & var: vars){
-    if(var.ImplementIn(type) || var.EverythingIn(type)) ++implemented_here;
-  }
-  if(implemented_here == 0){
-    file << "  Baby(file_names, processes){\n";
-  }else{
-    file << "  Baby(file_names, processes),\n";
-    set<Variable>::const_iterator last = vars.cend();
-    for(auto var = vars.cbegin(); var != vars.cend(); ++var){
-      if(var->ImplementIn(type) || var->EverythingIn(type)){
-        last = var;
-      }
-    }
-    for(auto var = vars.cbegin(); var != vars.cend(); ++var){
-      if(var->ImplementIn(type) || var->EverythingIn(type)){
-        file << "  " << var->Name() << "_{},\n";
-        file << "  b_" << var->Name() << "_(nullptr),\n";
-        if(var != last){
-          file << "  c_" << var->Name() << "_(false),\n";
-        }else{
-          file << "  c_" << var->Name() << "_(false){\n";
-        }
-      }
+  file << "  Baby(file_names, processes),\n";
+  for(const auto &var: vars){
+    if(var.ImplementIn(type) || var.EverythingIn(type)){
+      file << "  " << var.Name() << "_{},\n";
+      file << "  b_" << var.Name() << "_(nullptr),\n";
+      if(IsBulkReadable(var.Type(type))) file << "  bulk_" << var.Name() << "_(),\n";
     }
   }
+  file << "  " << type << "_cache_entries_(){\n";
+  file << "  " << type << "_cache_entries_.fill(-1);\n";
   file << "}\n\n";
 
-  file << "/*!\\brief Change current entry\n\n";
+  file << "/*!\\brief Get a new, inactive Baby_" << type << " reading the same files for the\n";
+  file << "  same processes\n\n";
 
-  file << "  \\param[in] entry Entry number to load\n";
+  file << "  \\return Pointer to the new Baby\n";
   file << "*/\n";
-  file << "void Baby_" << type << "::GetEntry(long entry){\n";
-  for(const auto &var: vars){
-    if(var.ImplementIn(type) || var.EverythingIn(type)){
-      file << "  c_" << var.Name() << "_ = false;\n";
-    }
-  }
-  file << "  Baby::GetEntry(entry);\n";
+  file << "unique_ptr<Baby> Baby_" << type << "::Clone() const{\n";
+  file << "  return unique_ptr<Baby>(new Baby_" << type << "(FileNames(), processes_));\n";
   file << "}\n\n";
 
   file << "/*! \\brief Setup all branches\n";
@@ -944,16 +1111,26 @@ void WriteSpecializedSource(const set<Variable> &vars, const string &type){
   }
   file << "}\n";
 
+  map<string, size_t> cache_indices = CacheIndices(vars, type);
   for(const auto &var: vars){
     if(var.ImplementIn(type) || var.EverythingIn(type)){
+      string cache_entry = type+"_cache_entries_["+to_string(cache_indices.at(var.Name()))+"]";
       file << "/*!\\brief Get " << var.Name() << " for current event and cache it\n\n";
 
       file << "  \\return " << var.Name() << " for current event\n";
       file << "*/\n";
       file << var.DecoratedType(type) << " const & Baby_" << type << "::" << var.Name() << "() const{\n";
-      file << "  if(!c_" << var.Name() << "_ && b_" << var.Name() << "_){\n";
-      file << "    b_" << var.Name() << "_->GetEntry(entry_);\n";
-      file << "    c_" << var.Name() << "_ = true;\n";
+      file << "  if(" << cache_entry << " != memo_entry_ && b_" << var.Name() << "_){\n";
+      file << "    if(branch_record_) branch_record_->insert(\"" << var.Name() << "\");\n";
+      if(IsBulkReadable(var.Type(type))){
+        file << "    if(!bulk_" << var.Name() << "_.Read(*b_" << var.Name() << "_, chain_->GetTreeNumber(), entry_, "
+             << var.Name() << "_)){\n";
+        file << "      b_" << var.Name() << "_->GetEntry(entry_, 1);\n";
+        file << "    }\n";
+      }else{
+        file << "    b_" << var.Name() << "_->GetEntry(entry_, 1);\n";
+      }
+      file << "    " << cache_entry << " = memo_entry_;\n";
       file << "  }\n";
       file << "  return " << var.Name() << "_;\n";
       file << "}\n\n";
@@ -0,0 +1,65 @@
+/*! \namespace Grid
+  \brief Tools for splitting a Process into points of a signal grid
+
+  A Process given grid keys with Process::Grid() is split by the values those
+  keys take in each event, e.g. (mass_stop, mass_lsp) for a signal scan. Each
+  figure component then keeps one accumulator per grid point in a hash map,
+  so the yields for every point come out of a single pass over the sample
+  instead of one "mass_stop==X&&mass_lsp==Y" cut per point.
+*/
+#include "core/grid.hpp"
+
+#include <functional>
+#include <sstream>
+
+#include "core/baby.hpp"
+
+using namespace std;
+
+namespace Grid{
+  /*!\brief Combines the hashes of all key values
+
+    \param[in] point Grid point to hash
+
+    \return Hash of the grid point
+  */
+  size_t PointHash::operator()(const Point &point) const{
+    size_t seed = point.size();
+    hash<NamedFunc::ScalarType> hasher;
+    for(const auto &value: point){
+      seed ^= hasher(value) + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2);
+    }
+    return seed;
+  }
+
+  /*!\brief Evaluates the grid keys for the current event
+
+    \param[in] keys Scalar NamedFuncs defining the grid
+
+    \param[in] baby Baby with the current event loaded
+
+    \return Grid point to which the event belongs
+  */
+  Point Evaluate(const vector<NamedFunc> &keys, const Baby &baby){
+    Point point(keys.size());
+    for(size_t ikey = 0; ikey < keys.size(); ++ikey){
+      point[ikey] = keys[ikey].GetScalar(baby);
+    }
+    return point;
+  }
+
+  /*!\brief Prints grid point as comma separated list of key values
+
+    \param[in] point Grid point to print
+
+    \return String such as "750,1"
+  */
+  string ToString(const Point &point){
+    ostringstream oss;
+    for(size_t ikey = 0; ikey < point.size(); ++ikey){
+      if(ikey > 0) oss << ',';
+      oss << point[ikey];
+    }
+    return oss.str();
+  }
+}
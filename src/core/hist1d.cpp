@@ -34,6 +34,7 @@
 
 #include <algorithm>
 #include <sstream>
+#include <iomanip>
 
 #include <sys/stat.h>
 
@@ -140,11 +141,15 @@ Hist1D::SingleHist1D::SingleHist1D(const Hist1D &figure,
                                    const TH1D &hist):
   FigureComponent(figure, process),
   raw_hist_(hist),
+  grid_hists_(),
   scaled_hist_(),
   proc_and_hist_cut_(figure.cut_ && process->cut_),
   cut_vector_(),
   wgt_vector_(),
-  val_vector_(){
+  val_vector_(),
+  cut_column_(0),
+  wgt_column_(0),
+  val_column_(0){
   raw_hist_.Sumw2();
   scaled_hist_.Sumw2();
   raw_hist_.SetBinErrorOption(TH1::kPoisson);
@@ -160,7 +165,7 @@ void Hist1D::SingleHist1D::RecordEvent(const Baby &baby){
   if(cut.IsScalar()){
     if(!cut.GetScalar(baby)) return;
   }else{
-    cut_vector_ = cut.GetVector(baby);
+    cut_vector_ = cut.GetTyped(baby);
     if(!HavePass(cut_vector_)) return;
     have_vec = true;
     min_vec_size = cut_vector_.size();
@@ -170,7 +175,7 @@ void Hist1D::SingleHist1D::RecordEvent(const Baby &baby){
   if(wgt.IsScalar()){
     wgt_scalar = wgt.GetScalar(baby);
   }else{
-    wgt_vector_ = wgt.GetVector(baby);
+    wgt_vector_ = wgt.GetTyped(baby);
     if(!have_vec || wgt_vector_.size() < min_vec_size){
       have_vec = true;
       min_vec_size = wgt_vector_.size();
@@ -182,22 +187,172 @@ void Hist1D::SingleHist1D::RecordEvent(const Baby &baby){
   if(val.IsScalar()){
     val_scalar = val.GetScalar(baby);
   }else{
-    val_vector_ = val.GetVector(baby);
+    val_vector_ = val.GetTyped(baby);
     if(!have_vec || val_vector_.size() < min_vec_size){
       have_vec = true;
       min_vec_size = val_vector_.size();
     }
   }
 
+  TH1D *grid_hist = nullptr;
+  if(!process_->grid_.empty()){
+    Grid::Point point = Grid::Evaluate(process_->grid_, baby);
+    auto hist = grid_hists_.find(point);
+    if(hist == grid_hists_.end()){
+      lock_guard<mutex> lock(Multithreading::root_mutex);
+      hist = grid_hists_.emplace(point, raw_hist_).first;
+      hist->second.Reset();
+    }
+    grid_hist = &hist->second;
+  }
+
   if(!have_vec){
     raw_hist_.Fill(val_scalar, wgt_scalar);
+    if(grid_hist != nullptr) grid_hist->Fill(val_scalar, wgt_scalar);
   }else{
     for(size_t i = 0; i < min_vec_size; ++i){
       if(cut.IsVector() && !cut_vector_.at(i)) continue;
-      raw_hist_.Fill(val.IsScalar() ? val_scalar : val_vector_.at(i),
-                     wgt.IsScalar() ? wgt_scalar : wgt_vector_.at(i));
+      NamedFunc::ScalarType this_val = val.IsScalar() ? val_scalar : val_vector_.at(i);
+      NamedFunc::ScalarType this_wgt = wgt.IsScalar() ? wgt_scalar : wgt_vector_.at(i);
+      raw_hist_.Fill(this_val, this_wgt);
+      if(grid_hist != nullptr) grid_hist->Fill(this_val, this_wgt);
+    }
+  }
+}
+
+/*!\brief Get an empty histogram with the same binning and style for private
+  filling
+
+  \return Empty component for the same Hist1D and Process
+*/
+unique_ptr<Figure::FigureComponent> Hist1D::SingleHist1D::Shadow() const{
+  TH1D hist(raw_hist_);
+  hist.Reset();
+  unique_ptr<SingleHist1D> shadow(new SingleHist1D(static_cast<const Hist1D&>(figure_),
+                                                   process_, hist));
+  shadow->proc_and_hist_cut_ = proc_and_hist_cut_;
+  return unique_ptr<FigureComponent>(shadow.release());
+}
+
+/*!\brief Adds the contents of a shadow histogram to this one
+
+  \param[in] shadow Component obtained from SingleHist1D::Shadow()
+*/
+void Hist1D::SingleHist1D::Merge(const FigureComponent &shadow){
+  const SingleHist1D &other = static_cast<const SingleHist1D&>(shadow);
+  raw_hist_.Add(&other.raw_hist_);
+  for(const auto &point: other.grid_hists_){
+    auto hist = grid_hists_.find(point.first);
+    if(hist == grid_hists_.end()){
+      lock_guard<mutex> lock(Multithreading::root_mutex);
+      grid_hists_.emplace(point.first, point.second);
+    }else{
+      hist->second.Add(&point.second);
+    }
+  }
+}
+
+vector<NamedFunc*> Hist1D::SingleHist1D::GetFunctions(){
+  return {&proc_and_hist_cut_};
+}
+
+/*!\brief Request cut, weight, and value columns if all can be batch evaluated
+
+  \param[in,out] batch Batch to which functions are added
+
+  \return True if the histogram can be filled with RecordColumns()
+*/
+bool Hist1D::SingleHist1D::AddColumns(ColumnBatch &batch){
+  const Hist1D& stack = static_cast<const Hist1D&>(figure_);
+  if(!process_->grid_.empty()
+     || !ColumnBatch::IsColumnar(proc_and_hist_cut_)
+     || !ColumnBatch::IsColumnar(stack.weight_)
+     || !ColumnBatch::IsColumnar(stack.xaxis_.var_)) return false;
+  cut_column_ = batch.Add(proc_and_hist_cut_);
+  wgt_column_ = batch.Add(stack.weight_);
+  val_column_ = batch.Add(stack.xaxis_.var_);
+  return true;
+}
+
+/*!\brief Fill histogram with all entries of current block passing the cut
+
+  \param[in] batch Batch filled with the columns from AddColumns()
+*/
+void Hist1D::SingleHist1D::RecordColumns(const ColumnBatch &batch){
+  const NamedFunc::VectorType &cut = batch.Column(cut_column_);
+  const NamedFunc::VectorType &wgt = batch.Column(wgt_column_);
+  const NamedFunc::VectorType &val = batch.Column(val_column_);
+  for(size_t i = 0; i < batch.Size(); ++i){
+    if(!cut[i]) continue;
+    raw_hist_.Fill(val[i], wgt[i]);
+  }
+}
+
+/*!\brief Get binning, cut, weight, and variable determining the histogram
+
+  \return Single line describing what is filled for a given set of events
+*/
+string Hist1D::SingleHist1D::Definition() const{
+  const Hist1D& stack = static_cast<const Hist1D&>(figure_);
+  ostringstream oss;
+  oss << setprecision(17) << "Hist1D\t" << proc_and_hist_cut_.Definition()
+      << '\t' << stack.weight_.Definition() << '\t' << stack.xaxis_.var_.Definition() << '\t';
+  const TAxis *axis = raw_hist_.GetXaxis();
+  for(int bin = 1; bin <= raw_hist_.GetNbinsX()+1; ++bin){
+    oss << ' ' << axis->GetBinLowEdge(bin);
+  }
+  for(const auto &key: process_->grid_){
+    oss << '\t' << key.Definition();
+  }
+  string definition = oss.str();
+  ReplaceAll(definition, "\n", " ");
+  return definition;
+}
+
+/*!\brief Write histogram and grid point histograms
+
+  \param[out] out Stream to which contents are written as text
+*/
+void Hist1D::SingleHist1D::WritePartial(ostream &out) const{
+  WriteHistContents(out, raw_hist_);
+  out << grid_hists_.size() << '\n';
+  for(const auto &point: Grid::SortedPoints(grid_hists_)){
+    out << point.size();
+    for(const auto &value: point){
+      out << ' ' << value;
+    }
+    out << '\n';
+    WriteHistContents(out, grid_hists_.at(point));
+  }
+}
+
+/*!\brief Read contents written by WritePartial()
+
+  \param[in] in Stream from which contents are read
+
+  \return True if contents were read successfully
+*/
+bool Hist1D::SingleHist1D::ReadPartial(istream &in){
+  if(!ReadHistContents(in, raw_hist_)) return false;
+  size_t num_points = 0;
+  if(!(in >> num_points)) return false;
+  for(size_t ipoint = 0; ipoint < num_points; ++ipoint){
+    size_t point_size = 0;
+    if(!(in >> point_size)) return false;
+    Grid::Point point(point_size);
+    for(auto &value: point){
+      if(!(in >> value)) return false;
+    }
+    auto hist = grid_hists_.find(point);
+    if(hist == grid_hists_.end()){
+      lock_guard<mutex> lock(Multithreading::root_mutex);
+      TH1D blank(raw_hist_);
+      blank.Reset();
+      hist = grid_hists_.emplace(point, blank).first;
     }
+    if(!ReadHistContents(in, hist->second)) return false;
   }
+  return true;
 }
 
 /*! Get the maximum of the histogram
@@ -510,6 +665,49 @@ Figure::FigureComponent * Hist1D::GetComponent(const Process *process){
   return nullptr;
 }
 
+vector<NamedFunc*> Hist1D::GetFunctions(){
+  return {&weight_, &xaxis_.var_};
+}
+
+/*!\brief Get all grid points found for a process split with Process::Grid()
+
+  \param[in] process Process split into grid points
+
+  \return Sorted list of grid points with at least one event
+*/
+vector<Grid::Point> Hist1D::GridPoints(const Process *process) const{
+  for(const auto &component: GetComponentList(process)){
+    if(component->process_.get() == process){
+      return Grid::SortedPoints(component->grid_hists_);
+    }
+  }
+  return vector<Grid::Point>();
+}
+
+/*!\brief Get the histogram for one point of a process split with
+  Process::Grid()
+
+  \param[in] process Process split into grid points
+
+  \param[in] point Values of the grid keys, in the order given to
+  Process::Grid()
+
+  \return Histogram at 1 fb^{-1}, before stacking. Empty if no event was
+  found at this point.
+*/
+TH1D Hist1D::GridHist(const Process *process, const Grid::Point &point) const{
+  for(const auto &component: GetComponentList(process)){
+    if(component->process_.get() != process) continue;
+    auto hist = component->grid_hists_.find(point);
+    if(hist != component->grid_hists_.cend()) return hist->second;
+    TH1D empty(component->raw_hist_);
+    empty.Reset();
+    return empty;
+  }
+  DBG("Could not find histogram for process "+process->name_+".");
+  return blank_;
+}
+
 string Hist1D::Name() const{
   string cut = "";
   if(cut_.Name() != "1") cut = "__"+cut_.Name();
@@ -1514,7 +1712,7 @@ void Hist1D::GetTitleSize(double &width, double &height, bool in_pixels) const{
   }
 }
 
-const vector<unique_ptr<Hist1D::SingleHist1D> >& Hist1D::GetComponentList(const Process *process){
+const vector<unique_ptr<Hist1D::SingleHist1D> >& Hist1D::GetComponentList(const Process *process) const{
   switch(process->type_){
   case Process::Type::data:
     return datas_;
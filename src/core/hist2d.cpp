@@ -3,6 +3,7 @@
 #include <string>
 #include <vector>
 #include <sstream>
+#include <iomanip>
 
 #include <sys/stat.h>
 
@@ -16,6 +17,7 @@
 #include "TColor.h"
 #include "TArrow.h"
 #include "core/named_func.hpp"
+#include "core/utilities.hpp"
 
 using namespace std;
 using namespace PlotOptTypes;
@@ -41,7 +43,7 @@ void Hist2D::SingleHist2D::RecordEvent(const Baby &baby){
   if(cut.IsScalar()){
     if(!cut.GetScalar(baby)) return;
   }else{
-    cut_vector_ = cut.GetVector(baby);
+    cut_vector_ = cut.GetTyped(baby);
     if(!HavePass(cut_vector_)) return;
     have_vec = true;
     min_vec_size = cut_vector_.size();
@@ -52,7 +54,7 @@ void Hist2D::SingleHist2D::RecordEvent(const Baby &baby){
   if(wgt.IsScalar()){
     wgt_scalar = wgt.GetScalar(baby);
   }else{
-    wgt_vector_ = wgt.GetVector(baby);
+    wgt_vector_ = wgt.GetTyped(baby);
     if(!have_vec || wgt_vector_.size() < min_vec_size){
       have_vec = true;
       min_vec_size = wgt_vector_.size();
@@ -64,7 +66,7 @@ void Hist2D::SingleHist2D::RecordEvent(const Baby &baby){
   if(xval.IsScalar()){
     xval_scalar = xval.GetScalar(baby);
   }else{
-    xval_vector_ = xval.GetVector(baby);
+    xval_vector_ = xval.GetTyped(baby);
     if(!have_vec || xval_vector_.size() < min_vec_size){
       have_vec = true;
       min_vec_size = xval_vector_.size();
@@ -76,7 +78,7 @@ void Hist2D::SingleHist2D::RecordEvent(const Baby &baby){
   if(yval.IsScalar()){
     yval_scalar = yval.GetScalar(baby);
   }else{
-    yval_vector_ = yval.GetVector(baby);
+    yval_vector_ = yval.GetTyped(baby);
     if(!have_vec || yval_vector_.size() < min_vec_size){
       have_vec = true;
       min_vec_size = yval_vector_.size();
@@ -95,6 +97,63 @@ void Hist2D::SingleHist2D::RecordEvent(const Baby &baby){
   }
 }
 
+unique_ptr<Figure::FigureComponent> Hist2D::SingleHist2D::Shadow() const{
+  TH2D hist_template = clusterizer_.GetHistogram(1.);
+  hist_template.Reset();
+  unique_ptr<SingleHist2D> shadow(new SingleHist2D(static_cast<const Hist2D&>(figure_),
+                                                   process_, hist_template));
+  shadow->proc_and_hist_cut_ = proc_and_hist_cut_;
+  return unique_ptr<FigureComponent>(shadow.release());
+}
+
+void Hist2D::SingleHist2D::Merge(const FigureComponent &shadow){
+  clusterizer_.Merge(static_cast<const SingleHist2D&>(shadow).clusterizer_);
+}
+
+/*!\brief Get binning, cut, weight, and variables determining the histogram
+
+  \return Single line describing what is filled for a given set of events
+*/
+string Hist2D::SingleHist2D::Definition() const{
+  const Hist2D& hist = static_cast<const Hist2D&>(figure_);
+  ostringstream oss;
+  oss << setprecision(17) << "Hist2D\t" << proc_and_hist_cut_.Definition()
+      << '\t' << hist.weight_.Definition() << '\t' << hist.xaxis_.var_.Definition()
+      << '\t' << hist.yaxis_.var_.Definition() << '\t';
+  for(const auto &edge: hist.xaxis_.Bins()){
+    oss << ' ' << edge;
+  }
+  oss << '\t';
+  for(const auto &edge: hist.yaxis_.Bins()){
+    oss << ' ' << edge;
+  }
+  string definition = oss.str();
+  ReplaceAll(definition, "\n", " ");
+  return definition;
+}
+
+/*!\brief Write accumulated points and histogram as text
+
+  \param[out] out Stream to which contents are written
+*/
+void Hist2D::SingleHist2D::WritePartial(ostream &out) const{
+  clusterizer_.Write(out);
+}
+
+/*!\brief Read contents written by WritePartial()
+
+  \param[in] in Stream from which contents are read
+
+  \return True if contents were read successfully
+*/
+bool Hist2D::SingleHist2D::ReadPartial(istream &in){
+  return clusterizer_.Read(in);
+}
+
+vector<NamedFunc*> Hist2D::SingleHist2D::GetFunctions(){
+  return {&proc_and_hist_cut_};
+}
+
 Hist2D::Hist2D(const Axis &xaxis, const Axis &yaxis, const NamedFunc &cut,
                const std::vector<std::shared_ptr<Process> > &processes,
                const std::vector<PlotOpt> &plot_options):
@@ -486,6 +545,10 @@ Figure::FigureComponent * Hist2D::GetComponent(const Process *process){
   return nullptr;
 }
 
+vector<NamedFunc*> Hist2D::GetFunctions(){
+  return {&weight_, &xaxis_.var_, &yaxis_.var_};
+}
+
 const vector<unique_ptr<Hist2D::SingleHist2D> >& Hist2D::GetComponentList(const Process *process){
   switch(process->type_){
   case Process::Type::data:
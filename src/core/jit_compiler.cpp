@@ -0,0 +1,403 @@
+/*! \class JitCompiler
+
+  \brief Compiles scalar \link NamedFunc NamedFuncs\endlink to native code at
+  run time
+
+  Expressions parsed from strings are otherwise evaluated by nested functors or
+  a Bytecode program, which pay for a dispatch at every operator. JitCompiler
+  translates the operator tree of each added NamedFunc into a C++ function
+  calling the Baby accessors directly, so that "njets>=2&&met>150" becomes
+  essentially "b.njets()>=2.&&b.met()>150.". All of them are compiled at once
+  with the system compiler (or in-process with ROOT's interpreter) into a
+  library from which the functions are loaded.
+  Leaves built from arbitrary C++ callables and subexpressions whose callable
+  was wrapped (see NamedFunc::Opaque()) are called through their own callable,
+  so memoization and profiling are kept.
+
+  NamedFunc::Substitute() makes each added function call through a slot
+  holding its current callable, so the functions may be copied or wrapped
+  before JitCompiler::Build() swaps in the native code. If compilation fails,
+  the slots keep the original callables and the results are unchanged.
+  Libraries are never unloaded, since the functions can be copied anywhere.
+
+  Accessors defined outside the generated Baby class must be visible to the
+  library, so executables are linked with -rdynamic.
+*/
+#include "core/jit_compiler.hpp"
+
+#include <cstdlib>
+#include <cstdio>
+#include <cstdint>
+#include <cmath>
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <limits>
+
+#include <dlfcn.h>
+#include <unistd.h>
+
+#include "TInterpreter.h"
+
+#include "core/utilities.hpp"
+
+using namespace std;
+
+using ScalarType = NamedFunc::ScalarType;
+using ScalarFunc = NamedFunc::ScalarFunc;
+using TypedFunc = NamedFunc::TypedFunc;
+using Type = NamedFunc::Type;
+using Op = NamedFunc::Op;
+
+namespace{
+  /*!\brief Get C++ literal of a constant
+
+    \param[in] x Finite value
+
+    \return Parenthesized floating point literal exactly equal to x
+  */
+  string Literal(ScalarType x){
+    ostringstream oss;
+    oss << scientific << setprecision(numeric_limits<ScalarType>::max_digits10) << '(' << x << ')';
+    return oss.str();
+  }
+
+  /*!\brief Convert result of C++ expression to NamedFunc::ScalarType
+
+    \param[in] expression C++ expression
+
+    \return Expression casting the result of expression
+  */
+  string Cast(const string &expression){
+    return "static_cast<NamedFunc::ScalarType>("+expression+")";
+  }
+
+  /*!\brief Convert result of C++ expression to NamedFunc::ScalarType if needed
+
+    \param[in] expression C++ expression
+
+    \param[in] type Type of expression
+
+    \return expression if of type double, else expression cast to ScalarType
+  */
+  string Cast(const string &expression, Type type){
+    return type == Type::double_type ? expression : Cast(expression);
+  }
+
+  /*!\brief Check if a comparison of two types gives the same result without
+    converting to double
+
+    \param[in] a Type of left operand
+
+    \param[in] b Type of right operand
+
+    \return True if both are the same type, or both bool or int, or either is
+    bool, so that the usual arithmetic conversions are exact
+  */
+  bool ExactComparison(Type a, Type b){
+    bool integral_a = a == Type::bool_type || a == Type::int_type;
+    bool integral_b = b == Type::bool_type || b == Type::int_type;
+    return a == b || (integral_a && integral_b)
+      || a == Type::bool_type || b == Type::bool_type;
+  }
+
+  /*!\brief Get directory for temporary files
+
+    \return Value of TMPDIR if set, else /tmp
+  */
+  string TempDir(){
+    const char *dir = getenv("TMPDIR");
+    return dir == nullptr || *dir == '\0' ? "/tmp" : dir;
+  }
+}
+
+/*!\brief Standard constructor
+
+  \param[in] command Shell command compiling C++ into a shared library, to
+  which the include path, output, and source file are appended. "cling" uses
+  ROOT's interpreter instead.
+
+  \param[in] include_dir Directory containing core/named_func.hpp and
+  core/baby.hpp
+*/
+JitCompiler::JitCompiler(const string &command, const string &include_dir):
+  command_(command),
+  include_dir_(include_dir),
+  slots_(){
+}
+
+/*!\brief Register a function to be compiled by the next Build()
+
+  The callable of func is replaced by one calling through a slot, which holds
+  the original callable until Build() succeeds. Leaves, vector functions, and
+  functions whose callable was wrapped are not compiled.
+
+  \param[in,out] func Function to compile
+
+  \return True if func will be compiled
+*/
+bool JitCompiler::Add(NamedFunc &func){
+  if(func.Operands().empty() || func.Opaque() || !func.IsScalar()) return false;
+  auto slot = make_shared<Slot>();
+  slot->function_ = func.ScalarFunction();
+  Type type = Type::double_type;
+  slot->body_ = Cast(Translate(func, *slot, type), type);
+  slots_.push_back(slot);
+  func.Substitute([slot](const Baby &b){
+      return slot->function_(b);
+    });
+  return true;
+}
+
+/*!\brief Compile all added functions and swap in the native code
+
+  \return Number of functions now evaluated natively. 0 if compilation failed,
+  in which case the functions keep their original callables.
+*/
+size_t JitCompiler::Build(){
+  if(slots_.empty()) return 0;
+  string source = Source();
+  vector<Native> natives;
+  bool built = command_ == "cling"
+    ? BuildWithCling(source, natives)
+    : BuildWithCommand(source, natives);
+  if(!built || natives.size() != slots_.size()) return 0;
+  for(size_t i = 0; i < slots_.size(); ++i){
+    const Slot *slot = slots_.at(i).get();
+    Native native = natives.at(i);
+    slots_.at(i)->function_ = [slot, native](const Baby &b){
+      return native(b, slot->scalar_calls_.data(), slot->vector_calls_.data());
+    };
+  }
+  size_t num_built = slots_.size();
+  slots_.clear();
+  return num_built;
+}
+
+/*!\brief Get default command compiling a shared library against ROOT
+
+  \return Command using the compiler and flags reported by root-config
+*/
+string JitCompiler::DefaultCommand(){
+  return "$(root-config --cxx) $(root-config --cflags) -O2 -fPIC -shared";
+}
+
+/*!\brief Get C++ expression computing the result of a scalar function
+
+  Baby variables and comparisons keep their C++ type (see
+  NamedFunc::ResultType()), and are only converted to ScalarType where the
+  result could otherwise differ, e.g. for arithmetic or comparisons mixing int
+  and float.
+
+  \param[in] func Scalar function to translate
+
+  \param[in,out] slot Slot receiving the callables called by the expression
+
+  \param[out] type Type of the returned expression
+
+  \return C++ expression using the Baby b and the callables s and v of the
+  generated function
+*/
+string JitCompiler::Translate(const NamedFunc &func, Slot &slot, Type &type){
+  const auto &operands = func.Operands();
+  type = Type::double_type;
+  if(func.Opaque() || operands.empty()){
+    if(!func.Opaque() && func.Operation() == Op::constant && isfinite(func.Constant())){
+      if(func.ResultType() != Type::int_type) return Literal(func.Constant());
+      type = Type::int_type;
+      return "("+to_string(static_cast<long>(func.Constant()))+")";
+    }else if(!func.Opaque() && func.Operation() == Op::variable){
+      // Accessors of other types than bool, int, and float are converted
+      type = func.ResultType();
+      string value = "b."+func.Variable()+"()";
+      return type == Type::double_type ? Cast(value) : value;
+    }
+    slot.scalar_calls_.push_back(func.ScalarFunction());
+    return "s["+to_string(slot.scalar_calls_.size()-1)+"](b)";
+  }
+  const NamedFunc &a = *operands.at(0);
+  if(func.Operation() == Op::subscript){
+    Type index_type;
+    string index = "static_cast<std::size_t>("+Translate(*operands.at(1), slot, index_type)+")";
+    if(!a.Opaque() && a.Operation() == Op::variable){
+      type = a.ResultType();
+      string element = "b."+a.Variable()+"()->at("+index+")";
+      // Elements of vector<bool> are proxies
+      if(type == Type::bool_type) return "static_cast<bool>("+element+")";
+      return type == Type::double_type ? Cast(element) : element;
+    }
+    slot.vector_calls_.push_back(a.TypedFunction());
+    return "v["+to_string(slot.vector_calls_.size()-1)+"](b).at("+index+")";
+  }
+  Type type_x = Type::double_type, type_y = Type::double_type;
+  string x = Translate(a, slot, type_x);
+  string y = operands.size() > 1 ? Translate(*operands.at(1), slot, type_y) : "";
+  string dx = Cast(x, type_x), dy = Cast(y, type_y);
+  bool exact = ExactComparison(type_x, type_y);
+  switch(func.Operation()){
+  case Op::negate:
+    if(type_x != Type::float_type) return "(-"+dx+")";
+    type = type_x;
+    return "(-"+x+")";
+  // Same as x+y and x-y, but GCC folds 0.+(-y) and 0.-y to -y (giving -0.)
+  // when y is converted from an integer type, while it leaves calls alone
+  case Op::plus:          return "std::plus<double>()("+dx+","+dy+")";
+  case Op::minus:         return "std::minus<double>()("+dx+","+dy+")";
+  case Op::multiplies:    return "("+dx+"*"+dy+")";
+  case Op::divides:       return "("+dx+"/"+dy+")";
+  case Op::modulus:       return "std::fmod("+dx+","+dy+")";
+  case Op::logical_not:
+  case Op::equal_to:
+  case Op::not_equal_to:
+  case Op::greater:
+  case Op::less:
+  case Op::greater_equal:
+  case Op::less_equal:
+  case Op::logical_and:
+  case Op::logical_or:
+    type = Type::bool_type;
+    break;
+  case Op::function:
+  case Op::variable:
+  case Op::constant:
+  case Op::subscript:
+  default:
+    ERROR("Operation "+to_string(static_cast<int>(func.Operation()))+" has no operands to translate");
+  }
+  if(!exact){
+    x = dx;
+    y = dy;
+  }
+  switch(func.Operation()){
+  case Op::logical_not:   return "(!"+x+")";
+  case Op::equal_to:      return "("+x+"=="+y+")";
+  case Op::not_equal_to:  return "("+x+"!="+y+")";
+  case Op::greater:       return "("+x+">"+y+")";
+  case Op::less:          return "("+x+"<"+y+")";
+  case Op::greater_equal: return "("+x+">="+y+")";
+  case Op::less_equal:    return "("+x+"<="+y+")";
+  case Op::logical_and:   return "("+x+"&&"+y+")";
+  case Op::logical_or:    return "("+x+"||"+y+")";
+  case Op::function:
+  case Op::variable:
+  case Op::constant:
+  case Op::subscript:
+  case Op::negate:
+  case Op::plus:
+  case Op::minus:
+  case Op::multiplies:
+  case Op::divides:
+  case Op::modulus:
+  default:
+    ERROR("Operation "+to_string(static_cast<int>(func.Operation()))+" is not a comparison or logical operation");
+  }
+}
+
+/*!\brief Get name of generated function
+
+  \param[in] index Index of added function
+
+  \return Unmangled name of the generated function
+*/
+string JitCompiler::Symbol(size_t index){
+  return "wh_jit_"+to_string(index);
+}
+
+/*!\brief Get C++ source defining one function for each added function
+
+  \return Full source file
+*/
+string JitCompiler::Source() const{
+  ostringstream oss;
+  oss << "#include <cmath>\n"
+      << "#include <cstddef>\n"
+      << "#include <vector>\n"
+      << "#include <functional>\n\n"
+      << "#include \"core/named_func.hpp\"\n";
+  for(size_t i = 0; i < slots_.size(); ++i){
+    oss << "\nextern \"C\" NamedFunc::ScalarType " << Symbol(i) << "(const Baby &b,\n"
+        << "    const std::function<NamedFunc::ScalarFunc> *s,\n"
+        << "    const std::function<NamedFunc::TypedFunc> *v){\n"
+        << "  (void)s; (void)v;\n"
+        << "  return " << slots_.at(i)->body_ << ";\n"
+        << "}\n";
+  }
+  return oss.str();
+}
+
+/*!\brief Compile source in-process with ROOT's interpreter
+
+  \param[in] source Source from Source()
+
+  \param[out] natives Address of each generated function
+
+  \return True if all functions were compiled and found
+*/
+bool JitCompiler::BuildWithCling(const string &source, vector<Native> &natives) const{
+  if(gInterpreter == nullptr) return false;
+  gInterpreter->AddIncludePath(include_dir_.c_str());
+  if(!gInterpreter->Declare(source.c_str())){
+    DBG("Could not declare generated functions to ROOT's interpreter");
+    return false;
+  }
+  natives.clear();
+  for(size_t i = 0; i < slots_.size(); ++i){
+    TInterpreter::EErrorCode error = TInterpreter::kNoError;
+    Long_t address = gInterpreter->Calc(("reinterpret_cast<long>(&"+Symbol(i)+")").c_str(), &error);
+    if(error != TInterpreter::kNoError || address == 0){
+      DBG("Could not find " << Symbol(i) << " in ROOT's interpreter");
+      return false;
+    }
+    natives.push_back(reinterpret_cast<Native>(static_cast<intptr_t>(address)));
+  }
+  return true;
+}
+
+/*!\brief Compile source into a shared library with JitCompiler::command_ and
+  load it
+
+  \param[in] source Source from Source()
+
+  \param[out] natives Address of each generated function
+
+  \return True if all functions were compiled and found
+*/
+bool JitCompiler::BuildWithCommand(const string &source, vector<Native> &natives) const{
+  string dir_template = TempDir()+"/wh_jit_XXXXXX";
+  vector<char> dir_name(dir_template.cbegin(), dir_template.cend());
+  dir_name.push_back('\0');
+  if(mkdtemp(dir_name.data()) == nullptr){
+    DBG("Could not create directory " << dir_template);
+    return false;
+  }
+  string dir = dir_name.data();
+  string source_file = dir+"/jit.cpp";
+  string library_file = dir+"/jit.so";
+  {
+    ofstream file(source_file);
+    file << source;
+  }
+  string command = command_+" -I "+include_dir_+" -o "+library_file+" "+source_file;
+  int status = system(command.c_str());
+  void *library = status == 0 ? dlopen(library_file.c_str(), RTLD_NOW | RTLD_LOCAL) : nullptr;
+  if(status != 0){
+    DBG("Command failed: " << command);
+  }else if(library == nullptr){
+    DBG("Could not load " << library_file << ": " << dlerror());
+  }
+  remove(source_file.c_str());
+  remove(library_file.c_str());
+  rmdir(dir.c_str());
+  if(library == nullptr) return false;
+  natives.clear();
+  for(size_t i = 0; i < slots_.size(); ++i){
+    void *address = dlsym(library, Symbol(i).c_str());
+    if(address == nullptr){
+      DBG("Could not find " << Symbol(i) << " in " << library_file);
+      return false;
+    }
+    natives.push_back(reinterpret_cast<Native>(address));
+  }
+  return true;
+}
@@ -0,0 +1,147 @@
+/*! \file merge_shards.cxx
+
+  \brief Combines the partial results of a sharded plotting job and prints the
+  figures
+
+  Usage: merge_shards.exe [-c] shard_file... -- plot_program.exe [options]
+
+  Each shard is produced by running the plotting program with WH_DRAW_SHARD set
+  to "i/N" (see PlotMaker), with one file per shard and MakePlots call. This
+  checks that the given files hold each of the N shards exactly once for every
+  call and then runs the plotting program with
+  WH_DRAW_MERGE_FILES pointing to them, so that it merges the shards instead of
+  reading babies and prints its figures as usual.
+*/
+#include "core/merge_shards.hpp"
+
+#include <cstdlib>
+#include <cstdio>
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <map>
+
+#include <unistd.h>
+#include <getopt.h>
+
+#include "core/plot_maker.hpp"
+#include "core/utilities.hpp"
+
+using namespace std;
+
+namespace{
+  bool check_only = false;
+  vector<string> shard_files;
+  vector<char*> program_args;
+}
+
+int main(int argc, char *argv[]){
+  GetOptions(argc, argv);
+  if(shard_files.empty() || (program_args.empty() && !check_only)){
+    cerr << "Usage: " << argv[0] << " [-c] shard_file... -- plot_program.exe [options]" << endl;
+    return 1;
+  }
+
+  size_t num_shards = 0;
+  long num_entries = 0;
+  map<size_t, vector<bool> > found;//Shards found for each MakePlots call
+  for(const auto &file_name: shard_files){
+    ifstream file(file_name);
+    size_t call = 0, index = 0, num_parts = 0;
+    long shard_entries = 0;
+    if(!PlotMaker::ReadPartialsHeader(file, call, index, num_parts, shard_entries)){
+      cerr << file_name << " is not a partial results file." << endl;
+      return 1;
+    }
+    if(num_shards == 0){
+      num_shards = num_parts;
+    }else if(num_parts != num_shards){
+      cerr << file_name << " is shard " << index << " of " << num_parts
+           << ", but other files are from " << num_shards << " shards." << endl;
+      return 1;
+    }
+    vector<bool> &call_found = found[call];
+    call_found.resize(num_shards, false);
+    if(call_found.at(index)){
+      cerr << "Shard " << index << " of MakePlots call " << call
+           << " given more than once, again in " << file_name << "." << endl;
+      return 1;
+    }
+    call_found.at(index) = true;
+    num_entries += shard_entries;
+  }
+  if(found.rbegin()->first+1 != found.size()){
+    cerr << "Shards of some MakePlots calls before call " << found.rbegin()->first
+         << " are missing." << endl;
+    return 1;
+  }
+  for(const auto &call_found: found){
+    for(size_t index = 0; index < call_found.second.size(); ++index){
+      if(!call_found.second.at(index)){
+        cerr << "Shard " << index << " of " << num_shards << " of MakePlots call "
+             << call_found.first << " is missing." << endl;
+        return 1;
+      }
+    }
+  }
+  cout << "Found all " << num_shards << " shards of " << found.size()
+       << " MakePlots calls with " << AddCommas(num_entries) << " entries." << endl;
+  if(check_only) return 0;
+
+  string merge_files;
+  for(const auto &file_name: shard_files){
+    if(merge_files != "") merge_files += ":";
+    merge_files += file_name;
+  }
+  setenv("WH_DRAW_MERGE_FILES", merge_files.c_str(), 1);
+  unsetenv("WH_DRAW_SHARD");
+  program_args.push_back(nullptr);
+  cout.flush();
+  execvp(program_args.front(), program_args.data());
+  perror(("Could not run "+string(program_args.front())).c_str());
+  return 1;
+}
+
+void GetOptions(int argc, char *argv[]){
+  while(true){
+    static struct option long_options[] = {
+      {"check_only", no_argument, 0, 'c'},
+      {0, 0, 0, 0}
+    };
+
+    char opt = -1;
+    int option_index;
+    opt = getopt_long(argc, argv, "+c", long_options, &option_index);
+
+    if( opt == -1) break;
+
+    string optname;
+    switch(opt){
+    case 'c':
+      check_only = true;
+      break;
+    case 0:
+      optname = long_options[option_index].name;
+      if(false){
+      }else{
+        printf("Bad option! Found option name %s\n", optname.c_str());
+      }
+      break;
+    default:
+      printf("Bad option! getopt_long returned character code 0%o\n", opt);
+      break;
+    }
+  }
+
+  bool after_separator = false;
+  for(int iarg = optind; iarg < argc; ++iarg){
+    if(after_separator){
+      program_args.push_back(argv[iarg]);
+    }else if(string(argv[iarg]) == "--"){
+      after_separator = true;
+    }else{
+      shard_files.push_back(argv[iarg]);
+    }
+  }
+}
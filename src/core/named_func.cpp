@@ -38,6 +38,26 @@
   extra vectors being constructed (and often copied if care is not taken with
   results) even when evaluating a simple scalar value.
 
+  Internally, vector functions return a TypedSpan viewing either the Baby's own
+  vector branch or storage from the per-thread Arena, which is reused after
+  every Baby::GetEntry(), so that evaluating vector expressions allocates no
+  memory once warmed up. Branches of float or int are not copied: operators
+  read them in their stored type and write double results to Arena.
+  NamedFunc::GetTyped() returns the view as is, NamedFunc::GetView() converts
+  it to ScalarType if needed, both valid until the next entry, while
+  NamedFunc::GetVector() returns a copy.
+
+  Each NamedFunc also remembers the operation and operands from which it was
+  built (NamedFunc::Operation() and NamedFunc::Operands()). Leaves built from an
+  arbitrary callable get a unique NamedFunc::Id() which is kept by copies, while
+  Baby variables and constants are identified by name and value. Two
+  \link NamedFunc NamedFuncs\endlink with equal operations on equal operands
+  therefore compute the same result, which PlotMaker uses to evaluate shared
+  subexpressions only once per event (see NamedFunc::Memoize()). The same
+  structure lets NamedFunc::Compile() replace the nested functors of an
+  expression by a single Bytecode program, as done for all expressions parsed
+  from strings.
+
   \see FunctionParser for allowed expression syntax for constructing a
   NamedFunc.
 */
@@ -45,18 +65,47 @@
 
 #include <iostream>
 #include <utility>
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <cstring>
+#include <cstdint>
+#include <chrono>
+#include <limits>
+#include <cmath>
 
 #include "core/utilities.hpp"
 #include "core/function_parser.hpp"
+#include "core/func_profiler.hpp"
+#include "core/bytecode.hpp"
+#include "core/arena.hpp"
 
 using namespace std;
 
 using ScalarType = NamedFunc::ScalarType;
 using VectorType = NamedFunc::VectorType;
+using VectorView = NamedFunc::VectorView;
 using ScalarFunc = NamedFunc::ScalarFunc;
 using VectorFunc = NamedFunc::VectorFunc;
+using ViewFunc = NamedFunc::ViewFunc;
+using TypedFunc = NamedFunc::TypedFunc;
 
 namespace{
+  /*!\brief Get a functor copying the result of f into Arena
+
+    \param[in] f Function which takes a Baby and returns a vector
+
+    \return Functor returning a view of a copy of the result of f, or invalid
+    functor if f is invalid
+  */
+  function<TypedFunc> CopyToArena(const function<VectorFunc> &f){
+    if(!static_cast<bool>(f)) return function<TypedFunc>();
+    return [f](const Baby &b){
+      VectorType v = f(b);
+      return TypedSpan(Arena::Copy<ScalarType>(v.cbegin(), v.cend()));
+    };
+  }
+
   /*!\brief Get a functor applying unary operator op to f
 
     \param[in] f Function which takes a Baby and returns a single value
@@ -76,6 +125,69 @@ namespace{
     };
   }
 
+  /*!\brief Check if a constant can be used as an int without changing
+    results
+
+    \param[in] x Constant
+
+    \return True if x is an integer exactly representable as float (and thus as
+    int), other than -0
+  */
+  bool IsSmallInteger(ScalarType x){
+    return x == trunc(x) && fabs(x) <= 16777216. && !(x == 0. && signbit(x));
+  }
+
+  /*!\brief Get the result type of a binary operation
+
+    \param[in] op Binary operation
+
+    \param[in] a Result type of left operand
+
+    \return bool for comparisons and logical operations, the element type of a
+    for subscripts, and double for arithmetic
+  */
+  NamedFunc::Type BinaryType(NamedFunc::Op op, NamedFunc::Type a){
+    switch(op){
+    case NamedFunc::Op::equal_to:
+    case NamedFunc::Op::not_equal_to:
+    case NamedFunc::Op::greater:
+    case NamedFunc::Op::less:
+    case NamedFunc::Op::greater_equal:
+    case NamedFunc::Op::less_equal:
+    case NamedFunc::Op::logical_and:
+    case NamedFunc::Op::logical_or:
+      return NamedFunc::Type::bool_type;
+    case NamedFunc::Op::subscript:
+      return a;
+    case NamedFunc::Op::plus:
+    case NamedFunc::Op::minus:
+    case NamedFunc::Op::multiplies:
+    case NamedFunc::Op::divides:
+    case NamedFunc::Op::modulus:
+    case NamedFunc::Op::function:
+    case NamedFunc::Op::variable:
+    case NamedFunc::Op::constant:
+    case NamedFunc::Op::negate:
+    case NamedFunc::Op::logical_not:
+    default:
+      return NamedFunc::Type::double_type;
+    }
+  }
+
+  /*!\brief Get a mask of n copies of x stored in Arena
+
+    \param[in] n Number of elements
+
+    \param[in] x Value of each element
+
+    \return View of the new elements
+  */
+  Span<bool> Filled(size_t n, bool x){
+    bool *out = Arena::Allocate<bool>(n);
+    fill(out, out+n, x);
+    return Span<bool>(out, n);
+  }
+
   /*!\brief Get a functor applying unary operator op to f
 
     \param[in] f Function which takes a Baby and returns a vector of values
@@ -83,19 +195,16 @@ namespace{
     \param[in] op Unary operator to apply to f
 
     \return Functor which takes a Baby and returns the result of applying op to
-    each element of the result of f
+    each element of the result of f, stored in Arena
   */
   template<typename Operator>
-    function<VectorFunc> ApplyOp(const function<VectorFunc> &f,
-                                 const Operator &op){
+    function<TypedFunc> ApplyOp(const function<TypedFunc> &f,
+                                const Operator &op){
+    using Result = typename ElementResult<Operator>::type;
     if(!static_cast<bool>(f)) return f;
     function<ScalarType(ScalarType)> op_c(op);
     return [f,op_c](const Baby &b){
-      VectorType v = f(b);
-      for(auto &x: v){
-        x = op_c(x);
-      }
-      return v;
+      return TypedSpan(f(b).Transform<Result>(op_c));
     };
   }
 
@@ -106,7 +215,9 @@ namespace{
     associated to the same NamedFunc. Exactly one from each pair should be a
     valid function. Determines the valid function from each pair and applies
     binary operator op between the "a" function result on the left and the "b"
-    function result on the right.
+    function result on the right. Vector operands are read in their native
+    element type, and vector results are stored in Arena, as masks for
+    comparisons.
 
     \param[in] sfa Scalar function from the same NamedFunc as vfa
 
@@ -122,14 +233,15 @@ namespace{
     (sfa or vfa) and (sfb or vfb)
   */
   template<typename Operator>
-    pair<function<ScalarFunc>, function<VectorFunc> > ApplyOp(const function<ScalarFunc> &sfa,
-                                                              const function<VectorFunc> &vfa,
-                                                              const function<ScalarFunc> &sfb,
-                                                              const function<VectorFunc> &vfb,
-                                                              const Operator &op){
+    pair<function<ScalarFunc>, function<TypedFunc> > ApplyOp(const function<ScalarFunc> &sfa,
+                                                             const function<TypedFunc> &vfa,
+                                                             const function<ScalarFunc> &sfb,
+                                                             const function<TypedFunc> &vfb,
+                                                             const Operator &op){
+    using Result = typename ElementResult<Operator>::type;
     function<ScalarType(ScalarType,ScalarType)> op_c(op);
     function<ScalarFunc> sfo;
-    function<VectorFunc> vfo;
+    function<TypedFunc> vfo;
     if(static_cast<bool>(sfa) && static_cast<bool>(sfb)){
       sfo = [sfa,sfb,op_c](const Baby &b){
         return op_c(sfa(b), sfb(b));
@@ -137,32 +249,17 @@ namespace{
     }else if(static_cast<bool>(sfa) && static_cast<bool>(vfb)){
       vfo = [sfa,vfb,op_c](const Baby &b){
         ScalarType sa = sfa(b);
-        VectorType vb = vfb(b);
-        VectorType vo(vb.size());
-        for(size_t i = 0; i < vo.size(); ++i){
-          vo.at(i) = op_c(sa, vb.at(i));
-        }
-        return vo;
+        return TypedSpan(vfb(b).TransformLeft<Result>(sa, op_c));
       };
     }else if(static_cast<bool>(vfa) && static_cast<bool>(sfb)){
       vfo = [vfa,sfb,op_c](const Baby &b){
-        VectorType va = vfa(b);
-        ScalarType sb = sfb(b);
-        VectorType vo(va.size());
-        for(size_t i = 0; i < vo.size(); ++i){
-          vo.at(i) = op_c(va.at(i), sb);
-        }
-        return vo;
+        TypedSpan va = vfa(b);
+        return TypedSpan(va.TransformRight<Result>(op_c, sfb(b)));
       };
     }else if(static_cast<bool>(vfa) && static_cast<bool>(vfb)){
       vfo = [vfa,vfb,op_c](const Baby &b){
-        VectorType va = vfa(b);
-        VectorType vb = vfb(b);
-        VectorType vo(va.size() > vb.size() ? vb.size() : va.size());
-        for(size_t i = 0; i < vo.size(); ++i){
-          vo.at(i) = op_c(va.at(i), vb.at(i));
-        }
-        return vo;
+        TypedSpan va = vfa(b);
+        return TypedSpan(TypedSpan::Zip<Result>(op_c, va, vfb(b)));
       };
     }
     return make_pair(sfo, vfo);
@@ -185,50 +282,45 @@ namespace{
     (sfa or vfa) and (sfb or vfb)
   */
   template<>
-    pair<function<ScalarFunc>, function<VectorFunc> > ApplyOp(const function<ScalarFunc> &sfa,
-                                                              const function<VectorFunc> &vfa,
-                                                              const function<ScalarFunc> &sfb,
-                                                              const function<VectorFunc> &vfb,
-                                                              const logical_and<ScalarType> &/*op*/){
+    pair<function<ScalarFunc>, function<TypedFunc> > ApplyOp(const function<ScalarFunc> &sfa,
+                                                             const function<TypedFunc> &vfa,
+                                                             const function<ScalarFunc> &sfb,
+                                                             const function<TypedFunc> &vfb,
+                                                             const logical_and<ScalarType> &/*op*/){
     function<ScalarFunc> sfo;
-    function<VectorFunc> vfo;
+    function<TypedFunc> vfo;
     if(static_cast<bool>(sfa) && static_cast<bool>(sfb)){
       sfo = [sfa,sfb](const Baby &b){
         return sfa(b)&&sfb(b);
       };
     }else if(static_cast<bool>(sfa) && static_cast<bool>(vfb)){
-      vfo = [sfa,vfb](const Baby &b){
+      vfo = [sfa,vfb](const Baby &b) -> TypedSpan{
         ScalarType sa = sfa(b);
         if(!sa){
-          return VectorType(vfb(b).size(), false);
+          return Filled(vfb(b).size(), false);
         }else{
           return vfb(b);
         }
       };
     }else if(static_cast<bool>(vfa) && static_cast<bool>(sfb)){
       vfo = [vfa,sfb](const Baby &b){
-        VectorType va = vfa(b);
-        VectorType vo(va.size());
+        TypedSpan va = vfa(b);
+        bool *vo = Arena::Allocate<bool>(va.size());
         bool evaluated = false;
         ScalarType sb = 0.;
-        for(size_t i = 0; i < vo.size(); ++i){
-          if(!evaluated && va.at(i)){
+        for(size_t i = 0; i < va.size(); ++i){
+          if(!evaluated && va[i]){
             evaluated = true;
             sb = sfb(b);
           }
-          vo.at(i) = va.at(i)&&sb;
+          vo[i] = va[i]&&sb;
         }
-        return vo;
+        return TypedSpan(Span<bool>(vo, va.size()));
       };
     }else if(static_cast<bool>(vfa) && static_cast<bool>(vfb)){
       vfo = [vfa,vfb](const Baby &b){
-        VectorType va = vfa(b);
-        VectorType vb = vfb(b);
-        VectorType vo(va.size() > vb.size() ? vb.size() : va.size());
-        for(size_t i = 0; i < vo.size(); ++i){
-          vo.at(i) = va.at(i)&&vb.at(i);
-        }
-        return vo;
+        TypedSpan va = vfa(b);
+        return TypedSpan(TypedSpan::Zip<bool>(logical_and<ScalarType>(), va, vfb(b)));
       };
     }
     return make_pair(sfo, vfo);
@@ -251,54 +343,212 @@ namespace{
     (sfa or vfa) and (sfb or vfb)
   */
   template<>
-    pair<function<ScalarFunc>, function<VectorFunc> > ApplyOp(const function<ScalarFunc> &sfa,
-                                                              const function<VectorFunc> &vfa,
-                                                              const function<ScalarFunc> &sfb,
-                                                              const function<VectorFunc> &vfb,
-                                                              const logical_or<ScalarType> &/*op*/){
+    pair<function<ScalarFunc>, function<TypedFunc> > ApplyOp(const function<ScalarFunc> &sfa,
+                                                             const function<TypedFunc> &vfa,
+                                                             const function<ScalarFunc> &sfb,
+                                                             const function<TypedFunc> &vfb,
+                                                             const logical_or<ScalarType> &/*op*/){
     function<ScalarFunc> sfo;
-    function<VectorFunc> vfo;
+    function<TypedFunc> vfo;
     if(static_cast<bool>(sfa) && static_cast<bool>(sfb)){
       sfo = [sfa,sfb](const Baby &b){
         return sfa(b)||sfb(b);
       };
     }else if(static_cast<bool>(sfa) && static_cast<bool>(vfb)){
-      vfo = [sfa,vfb](const Baby &b){
+      vfo = [sfa,vfb](const Baby &b) -> TypedSpan{
         ScalarType sa = sfa(b);
         if(sa){
-          return VectorType(vfb(b).size(), true);
+          return Filled(vfb(b).size(), true);
         }else{
           return vfb(b);
         }
       };
     }else if(static_cast<bool>(vfa) && static_cast<bool>(sfb)){
       vfo = [vfa,sfb](const Baby &b){
-        VectorType va = vfa(b);
-        VectorType vo(va.size());
+        TypedSpan va = vfa(b);
+        bool *vo = Arena::Allocate<bool>(va.size());
         bool evaluated = false;
         ScalarType sb = 0.;
-        for(size_t i = 0; i < vo.size(); ++i){
-          if(!(evaluated || va.at(i))){
+        for(size_t i = 0; i < va.size(); ++i){
+          if(!(evaluated || va[i])){
             evaluated = true;
             sb = sfb(b);
           }
-          vo.at(i) = va.at(i)||sb;
+          vo[i] = va[i]||sb;
         }
-        return vo;
+        return TypedSpan(Span<bool>(vo, va.size()));
       };
     }else if(static_cast<bool>(vfa) && static_cast<bool>(vfb)){
       vfo = [vfa,vfb](const Baby &b){
-        VectorType va = vfa(b);
-        VectorType vb = vfb(b);
-        VectorType vo(va.size() > vb.size() ? vb.size() : va.size());
-        for(size_t i = 0; i < vo.size(); ++i){
-          vo.at(i) = va.at(i)||vb.at(i);
-        }
-        return vo;
+        TypedSpan va = vfa(b);
+        return TypedSpan(TypedSpan::Zip<bool>(logical_or<ScalarType>(), va, vfb(b)));
       };
     }
     return make_pair(sfo, vfo);
   }
+
+  /*!\brief Check if a scalar function can be evaluated in any order relative
+    to the other operands of an && chain
+
+    \param[in] func Function to check
+
+    \return True if func is marked with NamedFunc::Pure() or only combines
+    such functions, Baby variables, and constants with operators other than
+    subscripts, so that evaluating it cannot throw or depend on a guard
+  */
+  bool CanReorder(const NamedFunc &func){
+    if(!func.IsScalar()) return false;
+    if(func.Pure()) return true;
+    if(func.Operation() == NamedFunc::Op::function
+       || func.Operation() == NamedFunc::Op::subscript) return false;
+    for(const auto &operand: func.Operands()){
+      if(!CanReorder(*operand)) return false;
+    }
+    return true;
+  }
+
+  /*!\brief Collect the operands of a chain of scalar && operations
+
+    Opaque && operations (e.g. memoized or already reordered) are kept whole,
+    so that their wrapped callable is still used.
+
+    \param[in] func Function whose && operands are collected
+
+    \param[out] operands Operands in the order they are written
+  */
+  void GetAndOperands(const NamedFunc &func, vector<const NamedFunc*> &operands){
+    if(func.Operation() == NamedFunc::Op::logical_and && func.IsScalar() && !func.Opaque()){
+      for(const auto &operand: func.Operands()){
+        GetAndOperands(*operand, operands);
+      }
+    }else{
+      operands.push_back(&func);
+    }
+  }
+
+  /*!\brief Scalar && chain which evaluates its operands in written order while
+    measuring their cost and pass rate, then switches to the order with the
+    lowest expected cost
+
+    Operands that may depend on a guard or throw (see CanReorder()) are never
+    moved past, in either direction, so they are evaluated exactly when they
+    would be in written order. Only runs of other operands between them are
+    reordered, and the result and any exceptions are the same as for the
+    written order.
+  */
+  class AdaptiveAnd{
+  public:
+    /*!\brief Standard constructor
+
+      \param[in] operands Operands of the chain, in written order
+
+      \param[in] learn_calls Number of calls measured before reordering
+    */
+    AdaptiveAnd(const vector<const NamedFunc*> &operands, long learn_calls):
+      funcs_(),
+      movable_(),
+      calls_(operands.size(), 0),
+      passes_(operands.size(), 0),
+      time_(operands.size(), 0.),
+      learned_(0),
+      learn_calls_(learn_calls),
+      order_(),
+      ready_(false),
+      mutex_(){
+      for(const auto &operand: operands){
+        funcs_.push_back(operand->ScalarFunction());
+        movable_.push_back(CanReorder(*operand));
+      }
+    }
+
+    /*!\brief Evaluate the chain
+
+      \param[in] b Baby to pass to the operands
+
+      \return 1 if all operands pass, 0 otherwise
+    */
+    ScalarType Evaluate(const Baby &b){
+      if(!ready_.load(memory_order_acquire)) return Learn(b);
+      for(const auto &i: order_){
+        if(!funcs_[i](b)) return false;
+      }
+      return true;
+    }
+
+  private:
+    using Clock = chrono::steady_clock;
+
+    vector<function<ScalarFunc> > funcs_;//!<Operands in written order
+    vector<bool> movable_;//!<Flag if each operand may swap places with neighboring movable operands
+    vector<long> calls_;//!<Number of measured evaluations of each operand
+    vector<long> passes_;//!<Number of measured evaluations of each operand that passed
+    vector<double> time_;//!<Total time of measured evaluations of each operand in seconds
+    long learned_;//!<Number of measured calls of the chain
+    long learn_calls_;//!<Number of calls to measure before reordering
+    vector<size_t> order_;//!<Order of evaluation once ready_
+    atomic<bool> ready_;//!<Flag if order_ is final
+    mutex mutex_;//!<Protects measurements
+
+    /*!\brief Evaluate the chain in written order and record measurements
+
+      \param[in] b Baby to pass to the operands
+
+      \return 1 if all operands pass, 0 otherwise
+    */
+    ScalarType Learn(const Baby &b){
+      vector<pair<double, bool> > results;
+      for(const auto &func: funcs_){
+        auto start = Clock::now();
+        bool pass = func(b);
+        results.emplace_back(chrono::duration<double>(Clock::now()-start).count(), pass);
+        if(!pass) break;
+      }
+      lock_guard<mutex> lock(mutex_);
+      for(size_t i = 0; i < results.size(); ++i){
+        ++calls_[i];
+        time_[i] += results[i].first;
+        if(results[i].second) ++passes_[i];
+      }
+      if(++learned_ >= learn_calls_ && !ready_.load(memory_order_relaxed)){
+        order_ = BestOrder();
+        ready_.store(true, memory_order_release);
+      }
+      return results.back().second;
+    }
+
+    /*!\brief Get the evaluation order with the lowest expected cost
+
+      Repeatedly picks, among operands allowed to go next, the one with the
+      lowest cost per rejected event. Only movable operands written before the
+      next operand that is not movable are allowed.
+
+      \return Indices of operands in order of evaluation
+    */
+    vector<size_t> BestOrder() const{
+      vector<double> rank(funcs_.size(), numeric_limits<double>::infinity());
+      for(size_t i = 0; i < funcs_.size(); ++i){
+        if(calls_[i] == 0) continue;
+        double cost = time_[i]/calls_[i];
+        double fail_rate = 1.-static_cast<double>(passes_[i])/calls_[i];
+        if(fail_rate > 0.) rank[i] = cost/fail_rate;
+      }
+      vector<size_t> order;
+      vector<bool> placed(funcs_.size(), false);
+      size_t first_unplaced = 0;
+      while(order.size() < funcs_.size()){
+        size_t best = first_unplaced;
+        for(size_t i = first_unplaced+1; movable_[first_unplaced] && i < funcs_.size(); ++i){
+          if(placed[i]) continue;
+          if(!movable_[i]) break;
+          if(rank[i] < rank[best]) best = i;
+        }
+        order.push_back(best);
+        placed[best] = true;
+        while(first_unplaced < funcs_.size() && placed[first_unplaced]) ++first_unplaced;
+      }
+      return order;
+    }
+  };
 }
 
 /*!\brief Constructor of a scalar NamedFunc
@@ -311,23 +561,60 @@ NamedFunc::NamedFunc(const std::string &name,
                      const std::function<ScalarFunc> &function):
   name_(name),
   scalar_func_(function),
-  vector_func_(){
+  typed_func_(),
+  op_(Op::function),
+  operands_(),
+  id_(NewId()),
+  variable_(),
+  constant_(0.),
+  opaque_(false),
+  file_invariant_(false),
+  pure_(false),
+  version_(),
+  type_(Type::double_type),
+  branches_(){
   CleanName();
 }
 
 /*!\brief Constructor of a vector NamedFunc
 
+  The result of function is copied into Arena on each call. Use a functor
+  returning a TypedSpan to avoid the copy.
+
   \param[in] name Text representation of function
 
   \param[in] function Functor taking a Baby and returning a vector
 */
 NamedFunc::NamedFunc(const std::string &name,
                      const std::function<VectorFunc> &function):
+  NamedFunc(name, CopyToArena(function)){
+}
+
+/*!\brief Constructor of a vector NamedFunc returning a view
+
+  \param[in] name Text representation of function
+
+  \param[in] function Functor taking a Baby and returning a view of storage
+  valid until the next entry, e.g. a Baby branch or Arena
+*/
+NamedFunc::NamedFunc(const std::string &name,
+                     const std::function<TypedFunc> &function):
   name_(name),
   scalar_func_(),
-  vector_func_(function){
+  typed_func_(function),
+  op_(Op::function),
+  operands_(),
+  id_(NewId()),
+  variable_(),
+  constant_(0.),
+  opaque_(false),
+  file_invariant_(false),
+  pure_(false),
+  version_(),
+  type_(Type::double_type),
+  branches_(){
   CleanName();
-  }
+}
 
 /*!\brief Constructor using FunctionParser to produce a real function from a
   string
@@ -366,7 +653,21 @@ NamedFunc::NamedFunc(const TString &function):
 NamedFunc::NamedFunc(ScalarType x):
   name_(ToString(x)),
   scalar_func_([x](const Baby&){return x;}),
-  vector_func_(){
+  typed_func_(),
+  op_(Op::constant),
+  operands_(),
+  id_(0),
+  variable_(),
+  constant_(x),
+  opaque_(false),
+  file_invariant_(true),
+  pure_(false),
+  version_(),
+  type_(IsSmallInteger(x) ? Type::int_type : Type::double_type),
+  branches_(){
+  uint64_t bits;
+  memcpy(&bits, &x, sizeof(bits));
+  id_ = LeafId("constant "+to_string(bits));
 }
 
 /*!\brief Get the string representation of this function
@@ -390,7 +691,7 @@ NamedFunc & NamedFunc::Name(const string &name){
 /*!\brief Set function to given scalar function
 
   This function overwrites the scalar function and invalidates the vector
-  function if set.
+  function if set. *this becomes a leaf with a new identity.
 
   \param[in] f Valid function taking a Baby and returning a scalar
 
@@ -399,23 +700,58 @@ NamedFunc & NamedFunc::Name(const string &name){
 NamedFunc & NamedFunc::Function(const std::function<ScalarFunc> &f){
   if(!static_cast<bool>(f)) return *this;
   scalar_func_ = f;
-  vector_func_ = function<VectorFunc>();
+  typed_func_ = function<TypedFunc>();
+  op_ = Op::function;
+  operands_.clear();
+  id_ = NewId();
+  variable_.clear();
+  opaque_ = false;
+  file_invariant_ = false;
+  pure_ = false;
+  version_.clear();
+  type_ = Type::double_type;
+  branches_.reset();
   return *this;
 }
 
 /*!\brief Set function to given vector function
 
   This function overwrites the vector function and invalidates the scalar
-  function if set.
+  function if set. *this becomes a leaf with a new identity.
 
-  \param[in] f Valid function taking a Baby and returning a vector
+  \param[in] f Valid function taking a Baby and returning a vector. Its
+  result is copied into Arena on each call.
 
   \return Reference to *this
 */
 NamedFunc & NamedFunc::Function(const std::function<VectorFunc> &f){
+  return Function(CopyToArena(f));
+}
+
+/*!\brief Set function to given vector function returning a view
+
+  This function overwrites the vector function and invalidates the scalar
+  function if set. *this becomes a leaf with a new identity.
+
+  \param[in] f Valid function taking a Baby and returning a view of storage
+  valid until the next entry, e.g. a Baby branch or Arena
+
+  \return Reference to *this
+*/
+NamedFunc & NamedFunc::Function(const std::function<TypedFunc> &f){
   if(!static_cast<bool>(f)) return *this;
   scalar_func_ = function<ScalarFunc>();
-  vector_func_ = f;
+  typed_func_ = f;
+  op_ = Op::function;
+  operands_.clear();
+  id_ = NewId();
+  variable_.clear();
+  opaque_ = false;
+  file_invariant_ = false;
+  pure_ = false;
+  version_.clear();
+  type_ = Type::double_type;
+  branches_.reset();
   return *this;
 }
 
@@ -429,10 +765,400 @@ const function<ScalarFunc> & NamedFunc::ScalarFunction() const{
 
 /*!\brief Return the (possibly invalid) vector function
 
-  \return The (possibly invalid) vector function associated to *this
+  \return The (possibly invalid) vector function associated to *this,
+  returning a view of storage valid until the next entry
+*/
+const function<TypedFunc> & NamedFunc::TypedFunction() const{
+  return typed_func_;
+}
+
+/*!\brief Get name of Baby variable read by this function
+
+  \return Name of Baby variable if *this is a Baby variable leaf; empty string
+  otherwise
+*/
+const string & NamedFunc::Variable() const{
+  return variable_;
+}
+
+/*!\brief Mark *this as a leaf which reads exactly Baby variable var_name
+
+  Leaves reading the same Baby variable are considered identical regardless of
+  which callable they hold.
+
+  \param[in] var_name Name of Baby variable returned by the function
+
+  \return Reference to *this
+*/
+NamedFunc & NamedFunc::Variable(const string &var_name){
+  op_ = Op::variable;
+  operands_.clear();
+  id_ = LeafId("variable "+var_name);
+  variable_ = var_name;
+  opaque_ = false;
+  file_invariant_ = false;
+  pure_ = false;
+  branches_.reset();
+  return *this;
+}
+
+/*!\brief Get operation from which this function was built
+
+  \return Operation applied to NamedFunc::Operands(), or Op::function,
+  Op::variable, or Op::constant for leaves
+*/
+NamedFunc::Op NamedFunc::Operation() const{
+  return op_;
+}
+
+/*!\brief Get operands to which NamedFunc::Operation() is applied
+
+  \return Operands in order (left hand operand first). Empty for leaves.
+*/
+const vector<shared_ptr<const NamedFunc> > & NamedFunc::Operands() const{
+  return operands_;
+}
+
+/*!\brief Get identity of a leaf
+
+  \return Identifier shared by copies of the same callable, by Baby variables
+  with the same name, and by constants with the same value
+*/
+size_t NamedFunc::Id() const{
+  return id_;
+}
+
+/*!\brief Get value of a constant
+
+  \return Value returned by the function if Operation() is Op::constant; 0
+  otherwise
+*/
+ScalarType NamedFunc::Constant() const{
+  return op_ == Op::constant ? constant_ : 0.;
+}
+
+/*!\brief Check if the callable was wrapped by Memoize(), Profile(),
+  ReorderAnd(), or Substitute()
+
+  Such functions still give the same result as NamedFunc::Operation() applied
+  to NamedFunc::Operands(), but must be called through their own callable to
+  keep the added behavior, e.g. by Bytecode.
+
+  \return True if the callable was wrapped
+*/
+bool NamedFunc::Opaque() const{
+  return opaque_;
+}
+
+/*!\brief Check if function is known to give the same result for all entries of
+  a file
+
+  \return True if marked with FileInvariant(true), a constant, or built only
+  from such functions
+*/
+bool NamedFunc::FileInvariant() const{
+  return file_invariant_;
+}
+
+/*!\brief Mark whether the function gives the same result for all entries of a
+  file
+
+  Typically used for weights depending only on the sample or year. Memoized file
+  invariant functions are evaluated once per file instead of once per entry.
+
+  \param[in] file_invariant If true, result depends only on the file being read
+
+  \return Reference to *this
+*/
+NamedFunc & NamedFunc::FileInvariant(bool file_invariant){
+  file_invariant_ = file_invariant;
+  return *this;
+}
+
+/*!\brief Check if the callable is declared free of side effects and safe to
+  evaluate for any entry
+
+  \return True if marked with Pure(true). Always false for operators, whose
+  safety follows from their operands.
+*/
+bool NamedFunc::Pure() const{
+  return pure_;
+}
+
+/*!\brief Declare whether the callable has no side effects and never throws,
+  whatever the entry
+
+  A pure function may be evaluated before the cuts written ahead of it in an
+  && chain (see ReorderAnd()), e.g. it must not index a vector that only those
+  cuts guarantee to be long enough. Reset by Function() and Variable().
+
+  \param[in] pure If true, the callable may be evaluated at any time
+
+  \return Reference to *this
+*/
+NamedFunc & NamedFunc::Pure(bool pure){
+  pure_ = pure;
+  return *this;
+}
+
+/*!\brief Get the version of the callable's body
+
+  \return Version set with Version(const std::string&), or empty string
+*/
+const string & NamedFunc::Version() const{
+  return version_;
+}
+
+/*!\brief Set the version of the callable's body
+
+  Caches on disk (SkimCache, ResultCache) identify a function built from a C++
+  callable only by Definition(), so the version must be changed whenever the
+  body of the callable changes. Reset by Function().
+
+  \param[in] version Arbitrary text, e.g. "2"
+
+  \return Reference to *this
+*/
+NamedFunc & NamedFunc::Version(const string &version){
+  version_ = version;
+  ReplaceAll(version_, "\n", " ");
+  return *this;
+}
+
+/*!\brief Get text identifying the function's results
+
+  \return Name(), followed by the name and version of every versioned
+  callable from which the function is built
+*/
+string NamedFunc::Definition() const{
+  set<string> versions;
+  AddVersions(versions);
+  string definition = name_;
+  for(const auto &version: versions){
+    definition += " ["+version+"]";
+  }
+  return definition;
+}
+
+/*!\brief Get the narrowest type holding every result
+
+  Baby variables have the type in which they are stored, integral constants
+  small enough to be exact as float are int, comparisons and logical
+  operations are bool, except a scalar "&&" or "||" a vector, which may return
+  the vector unchanged and has its type, and subscripts have the element type
+  of the vector. Arithmetic and arbitrary functions are double unless declared
+  otherwise with ResultType(Type). Results are still returned as ScalarType,
+  but JitCompiler and Bytecode use the type to avoid conversions, and vector
+  comparisons are stored as bool masks.
+
+  \return Type holding every result (every element for vector functions)
+*/
+NamedFunc::Type NamedFunc::ResultType() const{
+  return type_;
+}
+
+/*!\brief Declare the narrowest type holding every result
+
+  \param[in] type Type holding every result, e.g. Type::bool_type for a
+  function only returning 0 or 1
+
+  \return Reference to *this
+*/
+NamedFunc & NamedFunc::ResultType(Type type){
+  type_ = type;
+  return *this;
+}
+
+/*!\brief Add the Baby branches read by this function to a set
+
+  Baby variables read their own branch and constants read none. Arbitrary
+  functions read an unknown set of branches unless declared with
+  NamedFunc::Branches(). Operators read the branches of their operands.
+
+  \param[in,out] branches Set to which branch names are added
+
+  \return True if all branches read by the function are known
+*/
+bool NamedFunc::AddBranches(set<string> &branches) const{
+  if(branches_){
+    branches.insert(branches_->cbegin(), branches_->cend());
+    return true;
+  }
+  switch(op_){
+  case Op::variable:
+    branches.insert(variable_);
+    return true;
+  case Op::constant:
+    return true;
+  case Op::function:
+    return false;
+  case Op::plus:
+  case Op::minus:
+  case Op::multiplies:
+  case Op::divides:
+  case Op::modulus:
+  case Op::negate:
+  case Op::equal_to:
+  case Op::not_equal_to:
+  case Op::greater:
+  case Op::less:
+  case Op::greater_equal:
+  case Op::less_equal:
+  case Op::logical_and:
+  case Op::logical_or:
+  case Op::logical_not:
+  case Op::subscript:
+  default:
+    break;
+  }
+  bool known = true;
+  for(const auto &operand: operands_){
+    known = operand->AddBranches(branches) && known;
+  }
+  return known;
+}
+
+/*!\brief Declare the Baby branches read by this function
+
+  Needed only for functions built from arbitrary callables, whose branches are
+  otherwise learned by PlotMaker from a few entries. Reset by Function().
+
+  \param[in] branches Names of all branches the function may read
+
+  \return Reference to *this
+*/
+NamedFunc & NamedFunc::Branches(const set<string> &branches){
+  branches_ = make_shared<const set<string> >(branches);
+  return *this;
+}
+
+/*!\brief Cache the result of this function so that it is computed at most once
+  per Baby entry, or once per file if FileInvariant()
+
+  Does not change the name, operation, or operands of *this.
+
+  \param[in] slot Index of Baby memo slot reserved for this function. Must not be
+  used by any function with a different result.
+
+  \return Reference to *this
+*/
+NamedFunc & NamedFunc::Memoize(size_t slot){
+  bool per_file = file_invariant_;
+  if(IsScalar()){
+    function<ScalarFunc> f = scalar_func_;
+    scalar_func_ = [f, slot, per_file](const Baby &b){
+      return b.GetMemoScalar(slot, f, per_file);
+    };
+  }else if(IsVector()){
+    function<TypedFunc> f = typed_func_;
+    function<ViewFunc> widened = [f](const Baby &b){
+      return f(b).Widen();
+    };
+    typed_func_ = [widened, slot, per_file](const Baby &b){
+      return TypedSpan(b.GetMemoVector(slot, widened, per_file));
+    };
+  }
+  opaque_ = true;
+  return *this;
+}
+
+/*!\brief Count calls and time spent in this function with FuncProfiler
+
+  Does not change the name, operation, or operands of *this.
+
+  \param[in] index Index of function from FuncProfiler::Register()
+
+  \return Reference to *this
 */
-const function<VectorFunc> & NamedFunc::VectorFunction() const{
-  return vector_func_;
+NamedFunc & NamedFunc::Profile(size_t index){
+  if(IsScalar()){
+    function<ScalarFunc> f = scalar_func_;
+    scalar_func_ = [f, index](const Baby &b){
+      FuncProfiler::Scope scope(index);
+      return f(b);
+    };
+  }else if(IsVector()){
+    function<TypedFunc> f = typed_func_;
+    typed_func_ = [f, index](const Baby &b){
+      FuncProfiler::Scope scope(index);
+      return f(b);
+    };
+  }
+  opaque_ = true;
+  return *this;
+}
+
+/*!\brief Let a scalar chain of && operations reorder its operands to reject
+  events with the least work
+
+  The first learn_calls evaluations use the written order and measure the
+  cost and pass rate of each operand. Later evaluations use the order with the
+  lowest expected cost. Operands calling arbitrary functions not marked with
+  Pure(), or subscripts, may rely on earlier operands as guards or throw, so no
+  operand is moved past them in either direction. The result and any exceptions are therefore
+  unchanged. Opaque operands, such as memoized subexpressions, are kept whole.
+
+  Does nothing unless *this is a scalar && operation. Does not change the name,
+  operation, or operands of *this.
+
+  \param[in] learn_calls Number of evaluations measured before reordering
+
+  \return Reference to *this
+*/
+NamedFunc & NamedFunc::ReorderAnd(long learn_calls){
+  if(op_ != Op::logical_and || !IsScalar() || learn_calls <= 0) return *this;
+  vector<const NamedFunc*> operands;
+  for(const auto &operand: operands_){
+    GetAndOperands(*operand, operands);
+  }
+  if(operands.size() < 2) return *this;
+  auto chain = make_shared<AdaptiveAnd>(operands, learn_calls);
+  scalar_func_ = [chain](const Baby &b){
+    return chain->Evaluate(b);
+  };
+  opaque_ = true;
+  return *this;
+}
+
+/*!\brief Evaluate this function with a Bytecode program instead of nested
+  functors
+
+  The whole expression tree below *this is compiled into one program, except
+  for subexpressions whose callable was wrapped (see Opaque()), which are
+  called as a whole. Does nothing for leaves. Does not change the name,
+  operation, operands, or result of *this.
+
+  \return Reference to *this
+*/
+NamedFunc & NamedFunc::Compile(){
+  if(operands_.empty() || opaque_) return *this;
+  auto program = make_shared<const Bytecode>(*this);
+  if(program->IsScalar()){
+    scalar_func_ = [program](const Baby &b){
+      return program->GetScalar(b);
+    };
+  }else{
+    typed_func_ = [program](const Baby &b){
+      return program->GetTyped(b);
+    };
+  }
+  return *this;
+}
+
+/*!\brief Replace the scalar function by an equivalent one, e.g. compiled to
+  native code by JitCompiler
+
+  Does not change the name, operation, or operands of *this.
+
+  \param[in] f Callable giving the same result as the current scalar function
+
+  \return Reference to *this
+*/
+NamedFunc & NamedFunc::Substitute(const function<ScalarFunc> &f){
+  if(!IsScalar() || !static_cast<bool>(f)) return *this;
+  scalar_func_ = f;
+  opaque_ = true;
+  return *this;
 }
 
 /*!\brief Check if scalar function is valid
@@ -448,7 +1174,7 @@ bool NamedFunc::IsScalar() const{
   \return True if vector function is valid; false otherwise.
 */
 bool NamedFunc::IsVector() const{
-  return static_cast<bool>(vector_func_);
+  return static_cast<bool>(typed_func_);
 }
 
 /*!\brief Evaluate scalar function with b as argument
@@ -465,10 +1191,39 @@ ScalarType NamedFunc::GetScalar(const Baby &b) const{
 
   \param[in] b Baby to pass to vector function
 
-  \return Result of applying vector function to b
+  \return Copy of the result of applying vector function to b
 */
 VectorType NamedFunc::GetVector(const Baby &b) const{
-  return vector_func_(b);
+  TypedSpan v = typed_func_(b);
+  VectorType out(v.size());
+  for(size_t i = 0; i < v.size(); ++i){
+    out[i] = v[i];
+  }
+  return out;
+}
+
+/*!\brief Evaluate vector function with b as argument without copying the
+  result
+
+  \param[in] b Baby to pass to vector function
+
+  \return Result of applying vector function to b, converted to ScalarType in
+  Arena if needed. Valid until b moves to another entry (see Arena).
+*/
+VectorView NamedFunc::GetView(const Baby &b) const{
+  return typed_func_(b).Widen();
+}
+
+/*!\brief Evaluate vector function with b as argument without copying or
+  converting the result
+
+  \param[in] b Baby to pass to vector function
+
+  \return Result of applying vector function to b, in the element type in which
+  it is stored. Valid until b moves to another entry (see Arena).
+*/
+TypedSpan NamedFunc::GetTyped(const Baby &b) const{
+  return typed_func_(b);
 }
 
 /*!\brief Add func to *this
@@ -478,13 +1233,7 @@ VectorType NamedFunc::GetVector(const Baby &b) const{
   \return Reference to *this
 */
 NamedFunc & NamedFunc::operator += (const NamedFunc &func){
-  name_ = "("+name_ + ")+(" + func.name_ + ")";
-  auto fp = ApplyOp(scalar_func_, vector_func_,
-                    func.scalar_func_, func.vector_func_,
-                    plus<ScalarType>());
-  scalar_func_ = fp.first;
-  vector_func_ = fp.second;
-  return *this;
+  return *this = Apply(Op::plus, *this, func);
 }
 
 /*!\brief Subtract func from *this
@@ -494,13 +1243,7 @@ NamedFunc & NamedFunc::operator += (const NamedFunc &func){
   \return Reference to *this
 */
 NamedFunc & NamedFunc::operator -= (const NamedFunc &func){
-  name_ = "("+name_ + ")-(" + func.name_ + ")";
-  auto fp = ApplyOp(scalar_func_, vector_func_,
-                    func.scalar_func_, func.vector_func_,
-                    minus<ScalarType>());
-  scalar_func_ = fp.first;
-  vector_func_ = fp.second;
-  return *this;
+  return *this = Apply(Op::minus, *this, func);
 }
 
 /*!\brief Multiply *this by func
@@ -510,13 +1253,7 @@ NamedFunc & NamedFunc::operator -= (const NamedFunc &func){
   \return Reference to *this
 */
 NamedFunc & NamedFunc::operator *= (const NamedFunc &func){
-  name_ = "("+name_ + ")*(" + func.name_ + ")";
-  auto fp = ApplyOp(scalar_func_, vector_func_,
-                    func.scalar_func_, func.vector_func_,
-                    multiplies<ScalarType>());
-  scalar_func_ = fp.first;
-  vector_func_ = fp.second;
-  return *this;
+  return *this = Apply(Op::multiplies, *this, func);
 }
 
 /*!\brief Divide *this by func
@@ -526,13 +1263,7 @@ NamedFunc & NamedFunc::operator *= (const NamedFunc &func){
   \return Reference to *this
 */
 NamedFunc & NamedFunc::operator /= (const NamedFunc &func){
-  name_ = "("+name_ + ")/(" + func.name_ + ")";
-  auto fp = ApplyOp(scalar_func_, vector_func_,
-                    func.scalar_func_, func.vector_func_,
-                    divides<ScalarType>());
-  scalar_func_ = fp.first;
-  vector_func_ = fp.second;
-  return *this;
+  return *this = Apply(Op::divides, *this, func);
 }
 
 /*!\brief Set *this to remainder of *this divided by func
@@ -542,25 +1273,13 @@ NamedFunc & NamedFunc::operator /= (const NamedFunc &func){
   \return Reference to *this
 */
 NamedFunc & NamedFunc::operator %= (const NamedFunc &func){
-  name_ = "("+name_ + ")%(" + func.name_ + ")";
-  auto fp = ApplyOp(scalar_func_, vector_func_,
-                    func.scalar_func_, func.vector_func_,
-                    static_cast<ScalarType (*)(ScalarType ,ScalarType)>(fmod));
-  scalar_func_ = fp.first;
-  vector_func_ = fp.second;
-  return *this;
+  return *this = Apply(Op::modulus, *this, func);
 }
 
 /*!\brief Apply indexing operator and return result as a NamedFunc
  */
 NamedFunc NamedFunc::operator [] (const NamedFunc &func) const{
-  if(IsScalar()) ERROR("Cannot apply indexing operator to scalar NamedFunc "+Name());
-  if(func.IsVector()) ERROR("Cannot use vector "+func.Name()+" as index");
-  const auto &vec = VectorFunction();
-  const auto &index = func.ScalarFunction();
-  return NamedFunc("("+Name()+")["+func.Name()+"]", [vec, index](const Baby &b){
-      return vec(b).at(index(b));
-    });
+  return Apply(Op::subscript, *this, func);
 }
 
 /*!\brief Strip spaces from name
@@ -569,6 +1288,209 @@ void NamedFunc::CleanName(){
   ReplaceAll(name_, " ", "");
 }
 
+/*!\brief Get NamedFunc applying unary operation op to a
+
+  \param[in] op Op::negate or Op::logical_not
+
+  \param[in] a Operand
+
+  \return NamedFunc returning the result of op applied to the result of a
+*/
+NamedFunc NamedFunc::Apply(Op op, const NamedFunc &a){
+  NamedFunc out(a);
+  switch(op){
+  case Op::negate:
+    out.Name("-(" + a.Name() + ")");
+    out.Function(ApplyOp(a.ScalarFunction(), negate<ScalarType>()));
+    out.Function(ApplyOp(a.TypedFunction(), negate<ScalarType>()));
+    break;
+  case Op::logical_not:
+    out.Name("!(" + a.Name() + ")");
+    out.Function(ApplyOp(a.ScalarFunction(), logical_not<ScalarType>()));
+    out.Function(ApplyOp(a.TypedFunction(), logical_not<ScalarType>()));
+    break;
+  case Op::function:
+  case Op::variable:
+  case Op::constant:
+  case Op::plus:
+  case Op::minus:
+  case Op::multiplies:
+  case Op::divides:
+  case Op::modulus:
+  case Op::equal_to:
+  case Op::not_equal_to:
+  case Op::greater:
+  case Op::less:
+  case Op::greater_equal:
+  case Op::less_equal:
+  case Op::logical_and:
+  case Op::logical_or:
+  case Op::subscript:
+  default:
+    ERROR("Operation "+to_string(static_cast<int>(op))+" is not unary");
+  }
+  out.op_ = op;
+  out.operands_ = {make_shared<const NamedFunc>(a)};
+  out.id_ = 0;
+  out.opaque_ = false;
+  out.file_invariant_ = a.file_invariant_;
+  out.pure_ = false;
+  if(op == Op::logical_not){
+    out.type_ = Type::bool_type;
+  }else if(a.type_ != Type::float_type){
+    //Negating int or bool could overflow or give -1
+    out.type_ = Type::double_type;
+  }
+  return out;
+}
+
+/*!\brief Get NamedFunc applying binary operation op to a and b
+
+  \param[in] op Binary operation (arithmetic, comparison, logical, or subscript)
+
+  \param[in] a Left hand operand
+
+  \param[in] b Right hand operand
+
+  \return NamedFunc returning the result of op applied to the results of a and b
+*/
+NamedFunc NamedFunc::Apply(Op op, const NamedFunc &a, const NamedFunc &b){
+  string symbol;
+  pair<function<ScalarFunc>, function<TypedFunc> > fp;
+  const function<ScalarFunc> &sfa = a.ScalarFunction();
+  const function<TypedFunc> &vfa = a.TypedFunction();
+  const function<ScalarFunc> &sfb = b.ScalarFunction();
+  const function<TypedFunc> &vfb = b.TypedFunction();
+  switch(op){
+  case Op::plus:
+    symbol = "+";
+    fp = ApplyOp(sfa, vfa, sfb, vfb, plus<ScalarType>());
+    break;
+  case Op::minus:
+    symbol = "-";
+    fp = ApplyOp(sfa, vfa, sfb, vfb, minus<ScalarType>());
+    break;
+  case Op::multiplies:
+    symbol = "*";
+    fp = ApplyOp(sfa, vfa, sfb, vfb, multiplies<ScalarType>());
+    break;
+  case Op::divides:
+    symbol = "/";
+    fp = ApplyOp(sfa, vfa, sfb, vfb, divides<ScalarType>());
+    break;
+  case Op::modulus:
+    symbol = "%";
+    fp = ApplyOp(sfa, vfa, sfb, vfb,
+                 static_cast<ScalarType (*)(ScalarType ,ScalarType)>(fmod));
+    break;
+  case Op::equal_to:
+    symbol = "==";
+    fp = ApplyOp(sfa, vfa, sfb, vfb, equal_to<ScalarType>());
+    break;
+  case Op::not_equal_to:
+    symbol = "!=";
+    fp = ApplyOp(sfa, vfa, sfb, vfb, not_equal_to<ScalarType>());
+    break;
+  case Op::greater:
+    symbol = ">";
+    fp = ApplyOp(sfa, vfa, sfb, vfb, greater<ScalarType>());
+    break;
+  case Op::less:
+    symbol = "<";
+    fp = ApplyOp(sfa, vfa, sfb, vfb, less<ScalarType>());
+    break;
+  case Op::greater_equal:
+    symbol = ">=";
+    fp = ApplyOp(sfa, vfa, sfb, vfb, greater_equal<ScalarType>());
+    break;
+  case Op::less_equal:
+    symbol = "<=";
+    fp = ApplyOp(sfa, vfa, sfb, vfb, less_equal<ScalarType>());
+    break;
+  case Op::logical_and:
+    symbol = "&&";
+    fp = ApplyOp(sfa, vfa, sfb, vfb, logical_and<ScalarType>());
+    break;
+  case Op::logical_or:
+    symbol = "||";
+    fp = ApplyOp(sfa, vfa, sfb, vfb, logical_or<ScalarType>());
+    break;
+  case Op::subscript:
+    if(a.IsScalar()) ERROR("Cannot apply indexing operator to scalar NamedFunc "+a.Name());
+    if(b.IsVector()) ERROR("Cannot use vector "+b.Name()+" as index");
+    fp.first = [vfa, sfb](const Baby &baby){
+      return vfa(baby).at(sfb(baby));
+    };
+    break;
+  case Op::function:
+  case Op::variable:
+  case Op::constant:
+  case Op::negate:
+  case Op::logical_not:
+  default:
+    ERROR("Operation "+to_string(static_cast<int>(op))+" is not binary");
+  }
+  NamedFunc out(a);
+  if(op == Op::subscript){
+    out.Name("(" + a.Name() + ")[" + b.Name() + "]");
+  }else{
+    out.Name("(" + a.Name() + ")" + symbol + "(" + b.Name() + ")");
+  }
+  out.Function(fp.first);
+  out.Function(fp.second);
+  out.op_ = op;
+  out.operands_ = {make_shared<const NamedFunc>(a), make_shared<const NamedFunc>(b)};
+  out.id_ = 0;
+  out.opaque_ = false;
+  out.file_invariant_ = a.file_invariant_ && b.file_invariant_;
+  out.pure_ = false;
+  if((op == Op::logical_and || op == Op::logical_or) && a.IsScalar() && b.IsVector()){
+    //The vector is passed through unchanged unless the scalar decides
+    out.type_ = b.type_;
+  }else{
+    out.type_ = BinaryType(op, a.type_);
+  }
+  return out;
+}
+
+/*!\brief Collect name and version of versioned callables used by the function
+
+  \param[in,out] versions Set to which "name@version" is added for *this and
+  all operands
+*/
+void NamedFunc::AddVersions(set<string> &versions) const{
+  if(version_ != "") versions.insert(name_+"@"+version_);
+  for(const auto &operand: operands_){
+    operand->AddVersions(versions);
+  }
+}
+
+/*!\brief Get a new identifier for a leaf built from an arbitrary callable
+
+  \return Identifier not returned by any previous call to NewId() or LeafId()
+*/
+size_t NamedFunc::NewId(){
+  static atomic<size_t> next_id(1);
+  return next_id++;
+}
+
+/*!\brief Get identifier for a leaf determined entirely by key
+
+  \param[in] key Text uniquely determining the result of the leaf
+
+  \return Identifier shared by all leaves with the same key
+*/
+size_t NamedFunc::LeafId(const string &key){
+  static mutex ids_mutex;
+  static map<string, size_t> ids;
+  lock_guard<mutex> lock(ids_mutex);
+  auto id = ids.find(key);
+  if(id != ids.end()) return id->second;
+  size_t new_id = NewId();
+  ids[key] = new_id;
+  return new_id;
+}
+
 /*!\brief Add two \link NamedFunc NamedFuncs\endlink
 
   \param[in] f Augend
@@ -648,10 +1570,7 @@ NamedFunc operator + (NamedFunc f){
   \return NamedFunc returing the negative of the result of f
 */
 NamedFunc operator - (NamedFunc f){
-  f.Name("-(" + f.Name() + ")");
-  f.Function(ApplyOp(f.ScalarFunction(), negate<ScalarType>()));
-  f.Function(ApplyOp(f.VectorFunction(), negate<ScalarType>()));
-  return f;
+  return NamedFunc::Apply(NamedFunc::Op::negate, f);
 }
 
 /*!\brief Gets NamedFunc which tests for equality of results of f and g
@@ -663,13 +1582,7 @@ NamedFunc operator - (NamedFunc f){
   \return NamedFunc returning whether the results of f and g are equal
 */
 NamedFunc operator == (NamedFunc f, NamedFunc g){
-  f.Name("(" + f.Name() + ")==(" + g.Name() + ")");
-  auto fp = ApplyOp(f.ScalarFunction(), f.VectorFunction(),
-                    g.ScalarFunction(), g.VectorFunction(),
-                    equal_to<ScalarType>());
-  f.Function(fp.first);
-  f.Function(fp.second);
-  return f;
+  return NamedFunc::Apply(NamedFunc::Op::equal_to, f, g);
 }
 
 /*!\brief Gets NamedFunc which tests for inequality of results of f and g
@@ -681,13 +1594,7 @@ NamedFunc operator == (NamedFunc f, NamedFunc g){
   \return NamedFunc returning whether the results of f and g are not equal
 */
 NamedFunc operator != (NamedFunc f, NamedFunc g){
-  f.Name("(" + f.Name() + ")!=(" + g.Name() + ")");
-  auto fp = ApplyOp(f.ScalarFunction(), f.VectorFunction(),
-                    g.ScalarFunction(), g.VectorFunction(),
-                    not_equal_to<ScalarType>());
-  f.Function(fp.first);
-  f.Function(fp.second);
-  return f;
+  return NamedFunc::Apply(NamedFunc::Op::not_equal_to, f, g);
 }
 
 /*!\brief Gets NamedFunc which tests if result of f is greater than result of g
@@ -700,13 +1607,7 @@ NamedFunc operator != (NamedFunc f, NamedFunc g){
   g
 */
 NamedFunc operator > (NamedFunc f, NamedFunc g){
-  f.Name("(" + f.Name() + ")>(" + g.Name() + ")");
-  auto fp = ApplyOp(f.ScalarFunction(), f.VectorFunction(),
-                    g.ScalarFunction(), g.VectorFunction(),
-                    greater<ScalarType>());
-  f.Function(fp.first);
-  f.Function(fp.second);
-  return f;
+  return NamedFunc::Apply(NamedFunc::Op::greater, f, g);
 }
 
 /*!\brief Gets NamedFunc which tests if result of f is less than result of g
@@ -718,13 +1619,7 @@ NamedFunc operator > (NamedFunc f, NamedFunc g){
   \return NamedFunc returning whether the results of f is less than result of g
 */
 NamedFunc operator < (NamedFunc f, NamedFunc g){
-  f.Name("(" + f.Name() + ")<(" + g.Name() + ")");
-  auto fp = ApplyOp(f.ScalarFunction(), f.VectorFunction(),
-                    g.ScalarFunction(), g.VectorFunction(),
-                    less<ScalarType>());
-  f.Function(fp.first);
-  f.Function(fp.second);
-  return f;
+  return NamedFunc::Apply(NamedFunc::Op::less, f, g);
 }
 
 /*!\brief Gets NamedFunc which tests if result of f is greater than or equal to
@@ -738,13 +1633,7 @@ NamedFunc operator < (NamedFunc f, NamedFunc g){
   to result of g
 */
 NamedFunc operator >= (NamedFunc f, NamedFunc g){
-  f.Name("(" + f.Name() + ")>=(" + g.Name() + ")");
-  auto fp = ApplyOp(f.ScalarFunction(), f.VectorFunction(),
-                    g.ScalarFunction(), g.VectorFunction(),
-                    greater_equal<ScalarType>());
-  f.Function(fp.first);
-  f.Function(fp.second);
-  return f;
+  return NamedFunc::Apply(NamedFunc::Op::greater_equal, f, g);
 }
 
 /*!\brief Gets NamedFunc which tests if result of f is less than or equal to
@@ -758,13 +1647,7 @@ NamedFunc operator >= (NamedFunc f, NamedFunc g){
   result of g
 */
 NamedFunc operator <= (NamedFunc f, NamedFunc g){
-  f.Name("(" + f.Name() + ")<=(" + g.Name() + ")");
-  auto fp = ApplyOp(f.ScalarFunction(), f.VectorFunction(),
-                    g.ScalarFunction(), g.VectorFunction(),
-                    less_equal<ScalarType>());
-  f.Function(fp.first);
-  f.Function(fp.second);
-  return f;
+  return NamedFunc::Apply(NamedFunc::Op::less_equal, f, g);
 }
 
 /*!\brief Gets NamedFunc which tests if results of both f and g are true
@@ -776,13 +1659,7 @@ NamedFunc operator <= (NamedFunc f, NamedFunc g){
   \return NamedFunc returning whether the results of both f and g are true
 */
 NamedFunc operator && (NamedFunc f, NamedFunc g){
-  f.Name("(" + f.Name() + ")&&(" + g.Name() + ")");
-  auto fp = ApplyOp(f.ScalarFunction(), f.VectorFunction(),
-                    g.ScalarFunction(), g.VectorFunction(),
-                    logical_and<ScalarType>());
-  f.Function(fp.first);
-  f.Function(fp.second);
-  return f;
+  return NamedFunc::Apply(NamedFunc::Op::logical_and, f, g);
 }
 
 /*!\brief Gets NamedFunc which tests if result of f or g is true
@@ -794,13 +1671,7 @@ NamedFunc operator && (NamedFunc f, NamedFunc g){
   \return NamedFunc returning whether the results of f or g is true
 */
 NamedFunc operator || (NamedFunc f, NamedFunc g){
-  f.Name("(" + f.Name() + ")||(" + g.Name() + ")");
-  auto fp = ApplyOp(f.ScalarFunction(), f.VectorFunction(),
-                    g.ScalarFunction(), g.VectorFunction(),
-                    logical_or<ScalarType>());
-  f.Function(fp.first);
-  f.Function(fp.second);
-  return f;
+  return NamedFunc::Apply(NamedFunc::Op::logical_or, f, g);
 }
 
 /*!\brief Gets NamedFunct returning logical inverse of result of f
@@ -810,10 +1681,7 @@ NamedFunc operator || (NamedFunc f, NamedFunc g){
   \return NamedFunc returning logical inverse of result of f
 */
 NamedFunc operator ! (NamedFunc f){
-  f.Name("!(" + f.Name() + ")");
-  f.Function(ApplyOp(f.ScalarFunction(), logical_not<ScalarType>()));
-  f.Function(ApplyOp(f.VectorFunction(), logical_not<ScalarType>()));
-  return f;
+  return NamedFunc::Apply(NamedFunc::Op::logical_not, f);
 }
 
 /*!\brief Print NamedFunc to output stream
@@ -834,6 +1702,17 @@ bool HavePass(const NamedFunc::VectorType &v){
   return false;
 }
 
+bool HavePass(const NamedFunc::VectorView &v){
+  for(const auto &x: v){
+    if(x) return true;
+  }
+  return false;
+}
+
+bool HavePass(const TypedSpan &v){
+  return v.AnyNonzero();
+}
+
 bool HavePass(const std::vector<NamedFunc::VectorType> &vv){
   if(vv.size()==0) return false;
   bool this_pass;
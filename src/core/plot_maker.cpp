@@ -6,6 +6,75 @@
   PlotMaker::MakePlots() determines the full set of \link Process
   Processes\endlink used by all plots, loops once over each Process to fill all
   histograms using that Process, and then prints the plots.
+
+  When every component filled from a Baby only uses functions accepted by
+  ColumnBatch::IsColumnar(), the Baby is read in blocks of
+  PlotMaker::column_block_size_ entries and all cuts, weights, and values are
+  computed column-wise for the whole block before the components are filled.
+  Otherwise, each event is evaluated and recorded one at a time.
+
+  If PlotMaker::skim_cache_dir_ is set, the entries of each TTree cluster
+  passing any process cut are saved there with SkimCache, and later runs with
+  the same process cuts (see NamedFunc::Definition()) read only those entries.
+
+  If PlotMaker::result_cache_dir_ is set, what each figure component
+  accumulates from each TTree cluster is saved there with ResultCache. Later
+  runs add the saved contents of unchanged components and read a cluster only
+  if some component filled from it is new, changed, or does not support saving.
+
+  If PlotMaker::num_processes_ is larger than 1, the entry ranges are split
+  among that many forked worker processes instead of threads, so that they do
+  not contend for ROOT's global locks. Each worker writes its filled components
+  to a temporary file, and the parent merges them before printing. Every
+  component used this way must implement
+  Figure::FigureComponent::WritePartial() and ReadPartial().
+
+  A job can also be split across independent batch jobs sharing a filesystem.
+  Setting PlotMaker::shard_index_ and PlotMaker::num_shards_ (or the
+  WH_DRAW_SHARD environment variable to "i/N") makes MakePlots() fill the
+  figures from the i-th of N deterministic shards of the entry ranges and save
+  them to PlotMaker::shard_file_ without printing. A job with the same figures
+  and PlotMaker::merge_files_ (or WH_DRAW_MERGE_FILES, colon-separated) set
+  reads no babies, merges the given files, and prints the figures. The
+  merge_shards.exe executable checks that a set of shard files is complete and
+  runs such a merging job. Programs calling MakePlots() several times, from one
+  or several PlotMakers, save one set of shard files per call. Each file is
+  tagged with the number of the call that wrote it, and each call merges only
+  the files with its own number.
+
+  If PlotMaker::trace_file_ is set, MakePlots() records a timeline of chain
+  activation, file opening, basket reads, event loops, batches of recorded
+  events, and printing for each thread with Trace, and writes it there as a
+  Chrome trace-event JSON file.
+
+  If PlotMaker::profile_functions_ is positive, each Baby variable, callable
+  leaf, and top-level function of the figures and processes is instrumented
+  with FuncProfiler, and that many of the most expensive ones are listed at the
+  end of MakePlots() along with the figures using them.
+
+  Each scalar chain of && operations measures the cost and pass rate of its
+  operands over its first PlotMaker::reorder_and_calls_ evaluations, and then
+  evaluates them in the order rejecting events with the least work (see
+  NamedFunc::ReorderAnd()). This does not change any result.
+
+  If PlotMaker::use_bytecode_ is set, each rewritten expression is evaluated
+  by a Bytecode program running all of its operators in one interpreter loop,
+  down to its Baby variables, callable leaves, and shared subexpressions (see
+  NamedFunc::Compile()).
+
+  If PlotMaker::jit_command_ is set, each rewritten scalar expression is
+  instead translated to C++, compiled into a shared library with that command
+  (or with ROOT's interpreter if it is "cling"), and evaluated natively (see
+  JitCompiler). && chains then keep their written order. If compilation fails,
+  the expressions are evaluated as without it.
+
+  If PlotMaker::prune_branches_ is set, only the Baby branches read by the
+  figures and processes are enabled and prefetched with a TTreeCache. Branches
+  read by parsed expressions are known from their Baby variables. Those read by
+  arbitrary C++ functions are learned by recording the branches read in the
+  first PlotMaker::branch_warmup_entries_ entries, unless declared with
+  NamedFunc::Branches(). A branch missed this way is still read correctly, only
+  without prefetching.
 */
 #include "core/plot_maker.hpp"
 
@@ -14,14 +83,33 @@
 #include <chrono>
 #include <map>
 #include <iomanip>  // setw
+#include <limits>
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <cstdio>
+#include <cstdlib>
+
+#include <unistd.h>
+#include <sys/wait.h>
 
 #include "TLegend.h"
+#include "TChain.h"
 
 #include "core/utilities.hpp"
 #include "core/timer.hpp"
 #include "core/thread_pool.hpp"
 #include "core/named_func.hpp"
 #include "core/process.hpp"
+#include "core/skim_cache.hpp"
+#include "core/result_cache.hpp"
+#include "core/trace.hpp"
+#include "core/func_profiler.hpp"
+#include "core/jit_compiler.hpp"
+#include "core/hist1d.hpp"
+#include "core/hist2d.hpp"
+#include "core/table.hpp"
+#include "core/event_scan.hpp"
 
 using namespace std;
 using namespace PlotOptTypes;
@@ -35,6 +123,475 @@ using Clock = chrono::steady_clock;
 
 namespace{
   mutex print_mutex;
+
+  const string kPartialsHeader = "wh_draw partial results v2";//!<First line of every partial results file
+
+  size_t num_make_plots_calls = 0;//!<Number of PlotMaker::MakePlots() calls so far in this process
+
+  /*!\brief Get value of an environment variable
+
+    \param[in] name Name of variable
+
+    \return Value of variable, or empty string if not set
+  */
+  string GetEnvString(const char *name){
+    const char *env = getenv(name);
+    return env == nullptr ? "" : env;
+  }
+
+  /*!\brief Get shard to process from the WH_DRAW_SHARD environment variable
+
+    \param[out] index Set to i if WH_DRAW_SHARD is "i/N" with i<N, else 0
+
+    \param[out] num_shards Set to N if WH_DRAW_SHARD is "i/N" with i<N, else 1
+  */
+  void GetEnvShard(size_t &index, size_t &num_shards){
+    index = 0;
+    num_shards = 1;
+    string env = GetEnvString("WH_DRAW_SHARD");
+    if(env == "") return;
+    unsigned long env_index = 0, env_num_shards = 0;
+    char extra = '\0';
+    if(sscanf(env.c_str(), "%lu/%lu%c", &env_index, &env_num_shards, &extra) == 2
+       && env_index < env_num_shards){
+      index = env_index;
+      num_shards = env_num_shards;
+    }else{
+      DBG("Ignoring invalid WH_DRAW_SHARD=\"" << env << "\"");
+    }
+  }
+
+  //! Entries of one input file within a range of TChain entries
+  struct FilePiece{
+    string file_;//!<Path to input file
+    long offset_;//!<TChain entry number of first entry in file
+    long first_;//!<First TChain entry in range (inclusive)
+    long last_;//!<Last TChain entry in range (exclusive)
+  };
+
+  /*!\brief Split a range of TChain entries at file boundaries
+
+    \param[in] baby Active Baby whose TChain is split
+
+    \param[in] first_entry First entry of range (inclusive)
+
+    \param[in] last_entry Last entry of range (exclusive)
+
+    \return Non-empty parts of the range in each file, in order
+  */
+  vector<FilePiece> GetFilePieces(const Baby &baby, long first_entry, long last_entry){
+    vector<FilePiece> pieces;
+    lock_guard<mutex> lock(Multithreading::root_mutex);
+    TChain &chain = *baby.GetTree();
+    const Long64_t *offsets = chain.GetTreeOffset();
+    TObjArray *files = chain.GetListOfFiles();
+    for(int itree = 0; itree < chain.GetNtrees(); ++itree){
+      long first = max(first_entry, static_cast<long>(offsets[itree]));
+      long last = min(last_entry, static_cast<long>(offsets[itree+1]));
+      if(first >= last) continue;
+      pieces.push_back(FilePiece{files->At(itree)->GetTitle(), static_cast<long>(offsets[itree]), first, last});
+    }
+    return pieces;
+  }
+
+  /*!\brief Split a range of TChain entries at file and TTree cluster
+    boundaries
+
+    Caches keyed by these pieces are reused however the entries are later split
+    into tasks, since GetEntryRanges() only splits at cluster boundaries.
+
+    \param[in] baby Active Baby whose TChain is split
+
+    \param[in] first_entry First entry of range (inclusive)
+
+    \param[in] last_entry Last entry of range (exclusive)
+
+    \return Non-empty parts of the range in each cluster, in order
+  */
+  vector<FilePiece> GetClusterPieces(const Baby &baby, long first_entry, long last_entry){
+    vector<FilePiece> pieces;
+    for(const auto &file_piece: GetFilePieces(baby, first_entry, last_entry)){
+      vector<long> boundaries;
+      {
+        lock_guard<mutex> lock(Multithreading::root_mutex);
+        TChain &chain = *baby.GetTree();
+        TTree *tree = chain.LoadTree(file_piece.offset_) < 0 ? nullptr : chain.GetTree();
+        if(tree != nullptr){
+          long tree_entries = tree->GetEntries();
+          TTree::TClusterIterator clusters = tree->GetClusterIterator(0);
+          for(long start = clusters(); start < tree_entries; start = clusters()){
+            long boundary = file_piece.offset_ + start;
+            if(boundary > file_piece.first_ && boundary < file_piece.last_) boundaries.push_back(boundary);
+          }
+        }
+      }
+      FilePiece piece = file_piece;
+      for(const auto &boundary: boundaries){
+        piece.last_ = boundary;
+        pieces.push_back(piece);
+        piece.first_ = boundary;
+      }
+      piece.last_ = file_piece.last_;
+      pieces.push_back(piece);
+    }
+    return pieces;
+  }
+
+  /*!\brief Remove the first entries from a list of runs
+
+    \param[in,out] runs Runs of entries from which the first num_entries are
+    removed
+
+    \param[in] num_entries Maximum number of entries to remove
+
+    \return Runs of removed entries
+  */
+  SkimCache::Runs SplitRuns(SkimCache::Runs &runs, long num_entries){
+    SkimCache::Runs head;
+    auto run = runs.begin();
+    for(; run != runs.end() && num_entries > 0; ++run){
+      long length = run->second-run->first;
+      if(length > num_entries){
+        head.emplace_back(run->first, run->first+num_entries);
+        run->first += num_entries;
+        break;
+      }
+      head.push_back(*run);
+      num_entries -= length;
+    }
+    runs.erase(runs.begin(), run);
+    return head;
+  }
+
+  //! Components to fill for each process of a Baby
+  using ProcFigs = vector<pair<const Process*, vector<Figure::FigureComponent*> > >;
+
+  /*!\brief Records ranges of entries into figure components, evaluating all
+    functions column-wise when every component supports it
+  */
+  class EntryFiller{
+  public:
+    /*!\brief Standard constructor
+
+      \param[in,out] baby Active Baby from which entries are read
+
+      \param[in] proc_figs Components to fill for each process of baby
+
+      \param[in] block_size Number of entries per ColumnBatch block. 0 disables
+      batch evaluation.
+
+      \param[in] record_passed If true, remember entries passing any process cut
+
+      \param[in,out] timer Timer to iterate for each entry, or nullptr
+    */
+    EntryFiller(Baby &baby, const ProcFigs &proc_figs, size_t block_size,
+                bool record_passed, Timer *timer):
+      baby_(baby),
+      proc_figs_(proc_figs),
+      batch_(block_size),
+      use_columns_(block_size > 0),
+      record_passed_(record_passed),
+      proc_columns_(),
+      passed_(),
+      timer_(timer){
+      for(const auto &proc_fig: proc_figs_){
+        for(const auto &component: proc_fig.second){
+          if(use_columns_) use_columns_ = component->AddColumns(batch_);
+        }
+      }
+      for(const auto &proc_fig: proc_figs_){
+        if(!use_columns_ || !record_passed_) break;
+        if(ColumnBatch::IsColumnar(proc_fig.first->cut_)){
+          proc_columns_.push_back(batch_.Add(proc_fig.first->cut_));
+        }else{
+          use_columns_ = false;
+        }
+      }
+    }
+
+    /*!\brief Record a range of entries into all components
+
+      \param[in] first_entry First entry to record (inclusive)
+
+      \param[in] last_entry Last entry to record (exclusive)
+    */
+    void Fill(long first_entry, long last_entry){
+      if(use_columns_){
+        long block_size = static_cast<long>(batch_.MaxSize());
+        for(long block_first = first_entry; block_first < last_entry; block_first += block_size){
+          long block_last = min(block_first+block_size, last_entry);
+          Trace::Span span("RecordColumns");
+          if(timer_ != nullptr){
+            for(long entry = block_first; entry < block_last; ++entry) timer_->Iterate();
+          }
+          batch_.Fill(baby_, block_first, block_last);
+          //Process cuts are already part of each component's cut column
+          for(const auto &proc_fig: proc_figs_){
+            for(const auto &component: proc_fig.second){
+              component->RecordColumns(batch_);
+            }
+          }
+          if(!record_passed_) continue;
+          for(size_t i = 0; i < batch_.Size(); ++i){
+            for(const auto &column: proc_columns_){
+              if(!batch_.Column(column)[i]) continue;
+              passed_.push_back(block_first+static_cast<long>(i));
+              break;
+            }
+          }
+        }
+      }else{
+        Trace::Span span("RecordEvents");
+        for(long entry = first_entry; entry < last_entry; ++entry){
+          if(timer_ != nullptr) timer_->Iterate();
+          baby_.GetEntry(entry);
+
+          bool any_pass = false;
+          for(const auto &proc_fig: proc_figs_){
+            if(proc_fig.first->cut_.IsScalar()){
+              if(!proc_fig.first->cut_.GetScalar(baby_)) continue;
+            }else{
+              if(!HavePass(proc_fig.first->cut_.GetView(baby_))) continue;
+            }
+            any_pass = true;
+            for(const auto &component: proc_fig.second){
+              component->RecordEvent(baby_);
+            }
+          }
+          if(record_passed_ && any_pass) passed_.push_back(entry);
+        }
+      }
+    }
+
+    /*!\brief Get entries passing any process cut
+
+      \return Entries recorded so far passing any process cut, in order. Empty
+      unless record_passed was set on construction.
+    */
+    const vector<long> & Passed() const{
+      return passed_;
+    }
+
+  private:
+    Baby &baby_;//!<Baby from which entries are read
+    const ProcFigs &proc_figs_;//!<Components to fill for each process
+    ColumnBatch batch_;//!<Columns of all functions for the current block
+    bool use_columns_;//!<If true, fill with ColumnBatch instead of entry by entry
+    bool record_passed_;//!<If true, remember entries passing any process cut
+    vector<size_t> proc_columns_;//!<Columns of process cuts in batch_
+    vector<long> passed_;//!<Entries passing any process cut
+    Timer *timer_;//!<Timer iterated for each entry, or nullptr
+  };
+
+  /*!\brief Get a Baby memo slot not used by any other function
+
+    Slots are never reused, so that a Baby read again by a later
+    PlotMaker::MakePlots() call never returns a value memoized for another
+    function.
+
+    \return Index of new memo slot
+  */
+  size_t NewMemoSlot(){
+    static atomic<size_t> next_slot(0);
+    return next_slot++;
+  }
+
+  /*!\brief Check if a function is a callable or Baby variable, as opposed to
+    a constant or an operation on other functions
+
+    \param[in] func Function to check
+
+    \return True if func is a callable or Baby variable
+  */
+  bool IsLeaf(const NamedFunc &func){
+    return func.Operation() == NamedFunc::Op::function
+      || func.Operation() == NamedFunc::Op::variable;
+  }
+
+  /*!\brief Note with FuncProfiler that a figure or process uses the leaves of
+    a function
+
+    \param[in] func Function whose leaves are recorded
+
+    \param[in] user Description of figure or process
+  */
+  void AddProfileUses(const NamedFunc &func, const string &user){
+    if(IsLeaf(func)){
+      FuncProfiler::AddUse(FuncProfiler::Register(func.Name()), user);
+    }
+    for(const auto &operand: func.Operands()){
+      AddProfileUses(*operand, user);
+    }
+  }
+
+  /*!\brief Get short description of a figure for reports
+
+    \param[in] figure Figure to describe
+
+    \param[in] index Position of figure in PlotMaker
+
+    \return Type and name of figure
+  */
+  string FigureLabel(const Figure &figure, size_t index){
+    if(const Hist1D *hist1d = dynamic_cast<const Hist1D*>(&figure)){
+      return "Hist1D "+hist1d->Name();
+    }else if(const Hist2D *hist2d = dynamic_cast<const Hist2D*>(&figure)){
+      return "Hist2D "+hist2d->Name();
+    }else if(const Table *table = dynamic_cast<const Table*>(&figure)){
+      return "Table "+table->name_;
+    }else if(const EventScan *scan = dynamic_cast<const EventScan*>(&figure)){
+      return "EventScan "+scan->name_;
+    }
+    return "figure "+to_string(index);
+  }
+
+  /*!\brief Hash-conses expression trees of \link NamedFunc NamedFuncs\endlink to
+    find and share common subexpressions
+  */
+  class SubexpressionTable{
+  public:
+    /*!\brief Standard constructor
+
+      \param[in] profile If true, rewritten leaves are instrumented with
+      NamedFunc::Profile()
+
+      \param[in] reorder_calls If positive, rewritten && chains reorder their
+      operands after this many evaluations (see NamedFunc::ReorderAnd())
+
+      \param[in] compile If true, rewritten operators are evaluated with
+      Bytecode (see NamedFunc::Compile())
+
+      \param[in] jit If not null, shared subexpressions are added to it to be
+      compiled to native code
+    */
+    SubexpressionTable(bool profile, long reorder_calls, bool compile,
+                       JitCompiler *jit):
+      nodes_(),
+      uses_(),
+      rewritten_(),
+      profile_(profile),
+      reorder_calls_(reorder_calls),
+      compile_(compile),
+      jit_(jit){
+    }
+
+    /*!\brief Record one use of func. Subexpressions of func are recorded only
+      the first time func is seen.
+
+      \param[in] func Function evaluated by a figure or process
+    */
+    void Count(const NamedFunc &func){
+      size_t node = Intern(func);
+      if(uses_.at(node)++ > 0) return;
+      for(const auto &operand: func.Operands()){
+        Count(*operand);
+      }
+    }
+
+    /*!\brief Get function equivalent to func with every subexpression used more
+      than once evaluated at most once per entry, and every file invariant
+      subexpression evaluated once per file
+
+      \param[in] func Function previously passed to Count()
+
+      \return Rewritten function with the same name as func
+    */
+    NamedFunc Rewrite(const NamedFunc &func){
+      size_t node = Intern(func);
+      auto done = rewritten_.find(node);
+      if(done == rewritten_.end()){
+        NamedFunc out = func;
+        const auto &operands = func.Operands();
+        if(operands.size() == 1){
+          out = NamedFunc::Apply(func.Operation(), Rewrite(*operands.at(0)));
+        }else if(operands.size() == 2){
+          out = NamedFunc::Apply(func.Operation(),
+                                 Rewrite(*operands.at(0)), Rewrite(*operands.at(1)));
+        }
+        if(compile_) out.Compile();
+        if(profile_ && IsLeaf(func)){
+          out.Profile(FuncProfiler::Register(func.Name()));
+        }
+        if(reorder_calls_ > 0) out.ReorderAnd(reorder_calls_);
+        if((uses_.at(node) > 1 || func.FileInvariant())
+           && func.Operation() != NamedFunc::Op::variable
+           && func.Operation() != NamedFunc::Op::constant){
+          if(jit_ != nullptr) jit_->Add(out);
+          out.Memoize(NewMemoSlot());
+        }
+        done = rewritten_.emplace(node, out).first;
+      }
+      NamedFunc out = done->second;
+      return out.Name(func.Name());
+    }
+
+  private:
+    map<vector<size_t>, size_t> nodes_;//!<Node index of each (operation, leaf id, operand nodes)
+    vector<size_t> uses_;//!<Number of uses of each node
+    map<size_t, NamedFunc> rewritten_;//!<Rewritten function for each node
+    bool profile_;//!<If true, instrument leaves with NamedFunc::Profile()
+    long reorder_calls_;//!<Evaluations before && chains are reordered. 0 disables reordering
+    bool compile_;//!<If true, compile rewritten operators with NamedFunc::Compile()
+    JitCompiler *jit_;//!<Compiler to which shared subexpressions are added. May be null
+
+    /*!\brief Get node index shared by all functions structurally identical to
+      func
+
+      Nodes are found from the structure alone, never from the address of
+      func, which may be reused by another function once func is destroyed.
+
+      \param[in] func Function to look up
+
+      \return Index of node representing func
+    */
+    size_t Intern(const NamedFunc &func){
+      vector<size_t> key = {static_cast<size_t>(func.Operation()), func.Id()};
+      for(const auto &operand: func.Operands()){
+        key.push_back(Intern(*operand));
+      }
+      auto node = nodes_.find(key);
+      if(node == nodes_.end()){
+        node = nodes_.emplace(key, uses_.size()).first;
+        uses_.push_back(0);
+      }
+      return node->second;
+    }
+  };
+
+  //! Functions of the figures and processes paired with their rewritten forms
+  using RewrittenList = vector<pair<NamedFunc*, NamedFunc> >;
+
+  /*!\brief Puts rewritten functions in place of the originals for the
+    lifetime of the object, and then puts the originals back
+  */
+  class RewriteScope{
+  public:
+    /*!\brief Swaps in the rewritten functions
+
+      \param[in,out] funcs Functions and their rewritten forms. Holds the
+      originals while the object lives.
+    */
+    explicit RewriteScope(RewrittenList &funcs):
+      funcs_(funcs){
+      Swap();
+    }
+
+    ~RewriteScope(){
+      Swap();
+    }
+
+  private:
+    RewriteScope(const RewriteScope &) = delete;
+    RewriteScope& operator=(const RewriteScope &) = delete;
+
+    RewrittenList &funcs_;//!<Functions and their replacements
+
+    void Swap(){
+      for(auto &func: funcs_){
+        swap(*func.first, func.second);
+      }
+    }
+  };
 }
 
 /*!\brief Standard constructor
@@ -42,19 +599,66 @@ namespace{
 PlotMaker::PlotMaker():
   multithreaded_(true),
   min_print_(false),
-  figures_(){
+  num_threads_(0),
+  num_processes_(0),
+  entries_per_task_(1000000),
+  column_block_size_(256),
+  prune_branches_(true),
+  branch_warmup_entries_(100),
+  skim_cache_dir_(""),
+  result_cache_dir_(""),
+  trace_file_(""),
+  profile_functions_(0),
+  reorder_and_calls_(1000),
+  use_bytecode_(true),
+  jit_command_(""),
+  shard_index_(0),
+  num_shards_(1),
+  shard_file_(GetEnvString("WH_DRAW_SHARD_FILE")),
+  merge_files_(Tokenize(GetEnvString("WH_DRAW_MERGE_FILES"), ":")),
+  figures_(),
+  call_index_(0){
+  GetEnvShard(shard_index_, num_shards_);
 }
 
 /*!\brief Prints all added plots with given luminosity
+
+  When running one of several shards, the filled figures are only saved to
+  PlotMaker::shard_file_ and printed later by the job merging the shards.
+
   \param[in] luminosity Integrated luminosity with which to draw plots
 */
 void PlotMaker::MakePlots(double luminosity,
                           const string &subdir){
+  call_index_ = num_make_plots_calls++;
+  if(trace_file_ != "") Trace::Start();
+  if(profile_functions_ > 0) FuncProfiler::Start();
   GetYields();
 
+  if(num_shards_ > 1 && merge_files_.empty()){
+    if(trace_file_ != "") Trace::Write(trace_file_);
+    return;
+  }
   for(auto &figure: figures_){
+    Trace::Span span("Print");
     figure->Print(luminosity, subdir);
   }
+  if(trace_file_ != "") Trace::Write(trace_file_);
+  if(profile_functions_ > 0) FuncProfiler::Print(cout, profile_functions_);
+}
+
+/*!\brief Standard constructor
+
+  \param[in] baby Baby from which to read entries
+
+  \param[in] first First entry to process (inclusive)
+
+  \param[in] last Last entry to process (exclusive)
+*/
+PlotMaker::EntryRange::EntryRange(Baby *baby, long first, long last):
+  baby_(baby),
+  first_(first),
+  last_(last){
 }
 
 const vector<unique_ptr<Figure> > & PlotMaker::Figures() const{
@@ -70,44 +674,119 @@ void PlotMaker::Clear(){
 void PlotMaker::GetYields(){
   auto start_time = Clock::now();
 
+  //Originals are restored when done, so that the figures and the processes,
+  //which may be shared with other PlotMakers, are rewritten afresh each time
+  RewrittenList rewritten = ShareSubexpressions();
+  RewriteScope rewrite_scope(rewritten);
+
   auto babies = GetBabies();
-  size_t num_threads = multithreaded_ ? min(babies.size(), static_cast<size_t>(thread::hardware_concurrency())) : 1;
-  if(num_threads >=9) num_threads=8;
-  cout << "Processing " << babies.size() << " babies with " << num_threads << " threads." << endl;
+  size_t num_threads = 1;
+  if(multithreaded_){
+    num_threads = num_threads_ > 0 ? num_threads_ : ThreadPool::DefaultSize();
+  }
 
   long num_entries = 0;
+  size_t num_tasks = babies.size();
 
-  if(multithreaded_ && num_threads>1){
-    vector<future<long> > num_entries_future(babies.size());
-
+  if(!merge_files_.empty()){
+    num_threads = 1;
+    vector<string> call_files;
+    for(const auto &file_name: merge_files_){
+      ifstream file(file_name);
+      size_t call = 0, index = 0, num_parts = 0;
+      long part_entries = 0;
+      if(ReadPartialsHeader(file, call, index, num_parts, part_entries)
+         && call == call_index_){
+        call_files.push_back(file_name);
+      }
+    }
+    if(call_files.empty()){
+      ERROR("None of the merged files holds results of MakePlots call "+to_string(call_index_));
+    }
+    num_tasks = call_files.size();
+    cout << "Merging " << num_tasks << " partial result files." << endl;
+    for(const auto &file_name: call_files){
+      num_entries += ReadPartials(file_name);
+    }
+  }else if(num_shards_>1){
+    num_threads = 1;
+    num_entries = ShardYields(babies, num_tasks);
+  }else if(num_processes_>1){
+    num_threads = 1;
+    num_entries = ForkYields(babies, num_tasks);
+  }else if(num_threads>1){
+    vector<unique_ptr<Baby> > clones;
     ThreadPool tp(num_threads);
-    size_t Nbabies = 0;
-    for(const auto &baby: babies){
-      num_entries_future.at(Nbabies) = tp.Push(bind(&PlotMaker::GetYield, this, ref(baby)));
-      ++Nbabies;
+
+    //Opening the files to find the cluster boundaries is slow, so do it in parallel
+    vector<Baby*> baby_list(babies.cbegin(), babies.cend());
+    vector<future<vector<pair<long, long> > > > ranges_future(baby_list.size());
+    for(size_t ibaby = 0; ibaby < baby_list.size(); ++ibaby){
+      ranges_future.at(ibaby) = tp.Push(bind(&PlotMaker::GetEntryRanges, this, baby_list.at(ibaby)));
     }
-    size_t Nfiles=0;
-    long printStep=Nbabies/20+1; // Print up to 20 lines of info
+
+    //Every range after the first needs its own Baby so that it can have its own TChain
+    vector<EntryRange> ranges;
+    for(size_t ibaby = 0; ibaby < baby_list.size(); ++ibaby){
+      Baby *baby = baby_list.at(ibaby);
+      const auto &baby_ranges = ranges_future.at(ibaby).get();
+      for(size_t irange = 0; irange < baby_ranges.size(); ++irange){
+        Baby *range_baby = baby;
+        if(irange > 0){
+          clones.push_back(baby->Clone());
+          range_baby = clones.back().get();
+        }
+        ranges.emplace_back(range_baby, baby_ranges.at(irange).first, baby_ranges.at(irange).second);
+      }
+    }
+
+    //Start the longest ranges first so that the small ones fill in the gaps at the end
+    stable_sort(ranges.begin(), ranges.end(), [](const EntryRange &a, const EntryRange &b){
+        return a.last_-a.first_ > b.last_-b.first_;
+      });
+    num_tasks = ranges.size();
+    cout << "Processing " << babies.size() << " babies in " << num_tasks
+         << " entry ranges with " << num_threads << " threads." << endl;
+
+    //Each worker fills one set of shadow components without locking, shared
+    //by all of its tasks. They are merged at the end in worker order.
+    vector<ShadowMap> shadows(tp.Size());
+    vector<future<long> > num_entries_future(num_tasks);
+    for(size_t irange = 0; irange < num_tasks; ++irange){
+      const EntryRange &range = ranges.at(irange);
+      num_entries_future.at(irange) = tp.Push([this, &range, &shadows](){
+          return GetYield(range.baby_, range.first_, range.last_,
+                          &shadows.at(ThreadPool::CurrentWorker()));
+        });
+    }
+    size_t Ndone=0;
+    long printStep=num_tasks/20+1; // Print up to 20 lines of info
     auto start_entries_time = Clock::now();
-    for(auto& entries: num_entries_future){
-      num_entries += entries.get();
-      Nfiles++;
-      if(min_print_ && ((Nfiles-1)%printStep==0 || Nfiles==Nbabies)){
+    for(size_t itask = 0; itask < num_tasks; ++itask){
+      num_entries += num_entries_future.at(itask).get();
+      Ndone++;
+      if(min_print_ && ((Ndone-1)%printStep==0 || Ndone==num_tasks)){
 	double seconds = chrono::duration<double>(Clock::now()-start_entries_time).count();
-	cout<<"Done "<<setw(log10(Nbabies)+1)<<Nfiles<<"/"<<Nbabies<<" files: "<<setw(10)<<AddCommas(num_entries)
+	cout<<"Done "<<setw(log10(num_tasks)+1)<<Ndone<<"/"<<num_tasks<<" ranges: "<<setw(10)<<AddCommas(num_entries)
 	    <<" entries in "<<HoursMinSec(seconds)<<"  ->  "<<setw(5)<<RoundNumber(num_entries/1000.,1,seconds)
 	    <<" kHz "<<endl;
       }
     }
+    for(auto &worker_shadows: shadows){
+      MergeShadows(worker_shadows);
+    }
   }else{
+    cout << "Processing " << babies.size() << " babies with " << num_threads << " threads." << endl;
     for(const auto &baby: babies){
-      num_entries += GetYield(ref(baby));
+      num_entries += GetYield(baby, 0, numeric_limits<long>::max(), nullptr);
     }
   }
   auto end_time = Clock::now();
   double num_seconds = chrono::duration<double>(end_time-start_time).count();
-  if(!min_print_) cout << endl << num_threads << " threads processed "
-		       << babies.size() << " babies with "
+  if(!min_print_) cout << endl << (num_processes_>1 ? num_processes_ : num_threads)
+                       << (num_processes_>1 ? " processes" : " threads") << " processed "
+		       << babies.size() << " babies in "
+		       << num_tasks << " entry ranges with "
 		       << AddCommas(num_entries) << " events in "
 		       << num_seconds << " seconds = "
 		       << 0.001*num_entries/num_seconds << " kHz."
@@ -115,9 +794,403 @@ void PlotMaker::GetYields(){
   cout << endl;
 }
 
-long PlotMaker::GetYield(Baby *baby_ptr){
+/*!\brief Fills all figures using forked worker processes instead of threads
+
+  Each worker reads its share of the entry ranges into private shadows of all
+  components, without contending for ROOT's global locks, and writes them to a
+  temporary file with PlotMaker::WritePartials(). Once all workers have exited,
+  the partial results are read back and merged in worker order, so the output
+  does not depend on timing.
+
+  \param[in] babies Babies to read
+
+  \param[out] num_tasks Set to number of entry ranges
+
+  \return Number of entries read by all workers
+*/
+long PlotMaker::ForkYields(const set<Baby*> &babies, size_t &num_tasks){
+  vector<EntryRange> ranges = GetAllRanges(babies);
+  num_tasks = ranges.size();
+  size_t num_workers = min(num_processes_, max(num_tasks, static_cast<size_t>(1)));
+  vector<vector<size_t> > worker_ranges = Partition(ranges, num_workers);
+
+  cout << "Processing " << babies.size() << " babies in " << num_tasks
+       << " entry ranges with " << num_workers << " processes." << endl;
+
+  vector<string> file_names;
+  vector<pid_t> pids;
+  for(size_t worker = 0; worker < num_workers; ++worker){
+    string file_name = MakeTemp("/tmp/wh_draw_partial_");
+    cout.flush();
+    cerr.flush();
+    pid_t pid = fork();
+    if(pid < 0){
+      remove(file_name.c_str());
+      break;
+    }else if(pid == 0){
+      int status = 0;
+      try{
+        WritePartials(ranges, worker_ranges.at(worker), worker, num_workers, file_name);
+      }catch(const exception &e){
+        cerr << e.what() << endl;
+        status = 1;
+      }
+      cout.flush();
+      cerr.flush();
+      _exit(status);
+    }
+    file_names.push_back(file_name);
+    pids.push_back(pid);
+  }
+
+  bool failed = pids.size() < num_workers;
+  for(const auto &pid: pids){
+    int status = 0;
+    if(waitpid(pid, &status, 0) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0){
+      failed = true;
+    }
+  }
+
+  long num_entries = 0;
+  for(const auto &file_name: file_names){
+    if(!failed) num_entries += ReadPartials(file_name);
+    remove(file_name.c_str());
+  }
+  if(failed) ERROR("Worker processes failed to fill figures");
+  return num_entries;
+}
+
+/*!\brief Fills all figures from one shard of the entry ranges and saves them
+  to PlotMaker::shard_file_
+
+  The entry ranges of all babies are split into PlotMaker::num_shards_ shards
+  of similar size. The split depends only on the input files, so independent
+  jobs given the same figures and shard count cover every range exactly once.
+
+  \param[in] babies Babies to read
+
+  \param[out] num_tasks Set to number of entry ranges in this shard
+
+  \return Number of entries read
+*/
+long PlotMaker::ShardYields(const set<Baby*> &babies, size_t &num_tasks){
+  if(shard_index_ >= num_shards_){
+    ERROR("Shard "+to_string(shard_index_)+" requested out of "+to_string(num_shards_));
+  }
+  vector<EntryRange> ranges = GetAllRanges(babies);
+  vector<size_t> shard_ranges = Partition(ranges, num_shards_).at(shard_index_);
+  num_tasks = shard_ranges.size();
+  cout << "Processing shard " << shard_index_ << " of " << num_shards_ << ": "
+       << num_tasks << " of " << ranges.size() << " entry ranges." << endl;
+  string file_name = shard_file_;
+  if(file_name == ""){
+    file_name = "shard_"+to_string(shard_index_)+"_of_"+to_string(num_shards_)
+      +"_call_"+to_string(call_index_)+".part";
+  }else if(call_index_ > 0){
+    file_name += "."+to_string(call_index_);
+  }
+  long num_entries = WritePartials(ranges, shard_ranges, shard_index_, num_shards_, file_name);
+  cout << "Saved shard " << shard_index_ << " of " << num_shards_ << " to " << file_name << endl;
+  return num_entries;
+}
+
+/*!\brief Fills private copies of all components from a set of entry ranges and
+  writes them to a file
+
+  The file starts with a header identifying the MakePlots() call, the part,
+  and the number of entries read, followed by each component's figure index, process name, definition,
+  and contents from Figure::FigureComponent::WritePartial().
+
+  \param[in] ranges All entry ranges
+
+  \param[in] range_indices Indices in ranges of the ranges to read
+
+  \param[in] index Index of this part
+
+  \param[in] num_parts Number of parts into which ranges were split
+
+  \param[in] file_name File to which the results are written
+
+  \return Number of entries read
+*/
+long PlotMaker::WritePartials(const vector<EntryRange> &ranges,
+                              const vector<size_t> &range_indices,
+                              size_t index, size_t num_parts,
+                              const string &file_name){
+  auto components = GetComponentKeys();
+  ShadowMap partials;
+  for(const auto &component: components){
+    partials[component.second] = component.second->Shadow();
+  }
+  long num_entries = 0;
+  for(const auto &irange: range_indices){
+    const EntryRange &range = ranges.at(irange);
+    num_entries += GetYield(range.baby_, range.first_, range.last_, &partials);
+  }
+
+  string tmp_name = file_name+".tmp."+to_string(getpid());
+  ofstream file(tmp_name);
+  file << setprecision(numeric_limits<double>::max_digits10);
+  file << kPartialsHeader << '\n'
+       << call_index_ << ' ' << index << ' ' << num_parts << ' ' << num_entries << '\n'
+       << components.size() << '\n';
+  for(const auto &component: components){
+    file << component.first << '\n'
+         << component.second->Definition() << '\n';
+    partials.at(component.second)->WritePartial(file);
+  }
+  file.close();
+  if(!file || rename(tmp_name.c_str(), file_name.c_str()) != 0){
+    remove(tmp_name.c_str());
+    ERROR("Could not write partial results to "+file_name);
+  }
+  return num_entries;
+}
+
+/*!\brief Adds partial results written by PlotMaker::WritePartials() to the
+  components
+
+  \param[in] file_name File to read
+
+  \return Number of entries read to produce the partial results
+*/
+long PlotMaker::ReadPartials(const string &file_name){
+  Trace::Span span("ReadPartials", file_name);
+  ifstream file(file_name);
+  size_t call = 0, index = 0, num_parts = 0;
+  long num_entries = 0;
+  if(!ReadPartialsHeader(file, call, index, num_parts, num_entries)){
+    ERROR("Could not read partial results from "+file_name);
+  }
+  if(call != call_index_){
+    ERROR(file_name+" holds results of MakePlots call "+to_string(call)
+          +", not of call "+to_string(call_index_));
+  }
+  size_t num_components = 0;
+  file >> num_components;
+  auto components = GetComponentKeys();
+  if(!file || num_components != components.size()){
+    ERROR(file_name+" does not hold partial results for the current figures");
+  }
+  for(const auto &component: components){
+    string key, definition;
+    file >> ws;
+    getline(file, key);
+    getline(file, definition);
+    if(!file || key != component.first || definition != component.second->Definition()){
+      ERROR(file_name+" does not hold partial results for "+component.first);
+    }
+    unique_ptr<Figure::FigureComponent> shadow = component.second->Shadow();
+    if(!shadow->ReadPartial(file)){
+      ERROR("Could not read partial results for "+component.first+" from "+file_name);
+    }
+    component.second->Merge(*shadow);
+  }
+  return num_entries;
+}
+
+/*!\brief Reads the header of a partial results file
+
+  \param[in,out] file Stream positioned at start of file. Left after the
+  header.
+
+  \param[out] call Number of the PlotMaker::MakePlots() call in the writing
+  process that produced the file, counting from 0
+
+  \param[out] index Index of the part held in the file
+
+  \param[out] num_parts Number of parts into which the job was split
+
+  \param[out] num_entries Number of entries read to produce the part
+
+  \return True if the header was read successfully
+*/
+bool PlotMaker::ReadPartialsHeader(istream &file, size_t &call, size_t &index,
+                                   size_t &num_parts, long &num_entries){
+  string header;
+  if(!getline(file, header) || header != kPartialsHeader) return false;
+  if(!(file >> call >> index >> num_parts >> num_entries)) return false;
+  file.ignore(numeric_limits<streamsize>::max(), '\n');
+  return index < num_parts;
+}
+
+/*!\brief Gets all entry ranges of a set of babies in an order depending only
+  on the input files
+
+  \param[in] babies Babies to split into ranges
+
+  \return Entry ranges, longest first
+*/
+vector<PlotMaker::EntryRange> PlotMaker::GetAllRanges(const set<Baby*> &babies) const{
+  //Pointer order differs between jobs, so order babies by their files and processes
+  vector<pair<string, Baby*> > sorted_babies;
+  for(const auto &baby: babies){
+    string key;
+    for(const auto &file_name: baby->FileNames()){
+      key += file_name+'\n';
+    }
+    set<string> proc_names;
+    for(const auto &proc: baby->processes_){
+      proc_names.insert(proc->name_);
+    }
+    for(const auto &proc_name: proc_names){
+      key += '\t'+proc_name;
+    }
+    sorted_babies.emplace_back(key, baby);
+  }
+  stable_sort(sorted_babies.begin(), sorted_babies.end(),
+              [](const pair<string, Baby*> &a, const pair<string, Baby*> &b){
+                return a.first < b.first;
+              });
+
+  vector<EntryRange> ranges;
+  for(const auto &baby: sorted_babies){
+    for(const auto &range: GetEntryRanges(baby.second)){
+      ranges.emplace_back(baby.second, range.first, range.second);
+    }
+  }
+  stable_sort(ranges.begin(), ranges.end(), [](const EntryRange &a, const EntryRange &b){
+      return a.last_-a.first_ > b.last_-b.first_;
+    });
+  return ranges;
+}
+
+/*!\brief Splits entry ranges into parts with similar numbers of entries
+
+  \param[in] ranges Entry ranges, longest first
+
+  \param[in] num_parts Number of parts
+
+  \return Indices in ranges of the ranges in each part
+*/
+vector<vector<size_t> > PlotMaker::Partition(const vector<EntryRange> &ranges,
+                                             size_t num_parts){
+  //Give each range to the part with the fewest entries so far
+  vector<vector<size_t> > parts(num_parts);
+  vector<long> part_entries(num_parts, 0);
+  for(size_t irange = 0; irange < ranges.size() && num_parts > 0; ++irange){
+    size_t part = min_element(part_entries.cbegin(), part_entries.cend()) - part_entries.cbegin();
+    parts.at(part).push_back(irange);
+    part_entries.at(part) += ranges.at(irange).last_-ranges.at(irange).first_;
+  }
+  return parts;
+}
+
+/*!\brief Gets all components with a key identifying them across jobs
+
+  \return Pairs of key and component, with keys made of the figure index and
+  process name, in the order of the keys
+*/
+vector<pair<string, Figure::FigureComponent*> > PlotMaker::GetComponentKeys() const{
+  map<string, Figure::FigureComponent*> components;
+  for(size_t ifig = 0; ifig < figures_.size(); ++ifig){
+    for(const auto &process: figures_.at(ifig)->GetProcesses()){
+      string key = "Figure "+to_string(ifig)+" process "+CopyReplaceAll(process->name_, "\n", " ");
+      if(!components.emplace(key, figures_.at(ifig)->GetComponent(process)).second){
+        ERROR("Processes in a figure need distinct names to combine partial results: "+key);
+      }
+    }
+  }
+  return vector<pair<string, Figure::FigureComponent*> >(components.cbegin(), components.cend());
+}
+
+/*!\brief Gets replacements for the functions of all figures, components, and
+  processes which evaluate common subexpressions only once per entry
+
+  Structurally identical subexpressions (same operations applied to the same
+  Baby variables, constants, and custom functions) are found across all
+  functions, and each one used more than once is memoized in a Baby memo slot.
+  In particular, a process cut is computed once per entry no matter how many
+  figure cuts it is part of. Subexpressions marked with
+  NamedFunc::FileInvariant() are computed only when the Baby moves to a new
+  file, and act as constants for the rest of that file.
+
+  If PlotMaker::jit_command_ is set, the shared subexpressions and the
+  remaining top-level expressions are then compiled with JitCompiler.
+
+  Nothing is modified here. The functions are only replaced while filling,
+  with RewriteScope, so calling this again gives the same result.
+
+  \return Each function of the figures, components, and processes, once,
+  paired with its replacement
+*/
+RewrittenList PlotMaker::ShareSubexpressions(){
+  vector<pair<NamedFunc*, string> > funcs;
+  set<NamedFunc*> seen;
+  auto add_func = [&funcs, &seen](NamedFunc *func, const string &label){
+    if(seen.insert(func).second) funcs.emplace_back(func, label);
+  };
+  set<Process*> processes;
+  for(size_t ifig = 0; ifig < figures_.size(); ++ifig){
+    const auto &figure = figures_.at(ifig);
+    string label = FigureLabel(*figure, ifig);
+    for(const auto &func: figure->GetFunctions()){
+      add_func(func, label);
+    }
+    for(const auto &process: figure->GetProcesses()){
+      Figure::FigureComponent *component = figure->GetComponent(process);
+      if(component == nullptr) continue;
+      for(const auto &func: component->GetFunctions()){
+        add_func(func, label);
+      }
+      processes.insert(component->process_.get());
+    }
+  }
+  for(const auto &process: processes){
+    add_func(&process->cut_, "process "+process->name_);
+    for(auto &key: process->grid_){
+      add_func(&key, "process "+process->name_);
+    }
+  }
+
+  bool profile = profile_functions_ > 0;
+  unique_ptr<JitCompiler> jit;
+  if(jit_command_ != "") jit.reset(new JitCompiler(jit_command_));
+  SubexpressionTable table(profile, jit ? 0 : reorder_and_calls_, use_bytecode_, jit.get());
+  for(const auto &func: funcs){
+    table.Count(*func.first);
+    if(profile) AddProfileUses(*func.first, func.second);
+  }
+  RewrittenList rewritten;
+  for(const auto &func: funcs){
+    NamedFunc out = table.Rewrite(*func.first);
+    if(jit) jit->Add(out);
+    if(profile && !IsLeaf(out)){
+      size_t index = FuncProfiler::Register(out.Name());
+      FuncProfiler::AddUse(index, func.second);
+      out.Profile(index);
+    }
+    rewritten.emplace_back(func.first, out);
+  }
+  if(jit){
+    size_t num_native = jit->Build();
+    cout << "Compiled " << num_native << " expressions to native code." << endl;
+  }
+  return rewritten;
+}
+
+/*!\brief Fills all figure components using the given range of entries from a Baby
+
+  \param[in] baby_ptr Baby from which to read entries. Activated for the
+  duration of the call, so no other task may be using it.
+
+  \param[in] first_entry First entry to process (inclusive)
+
+  \param[in] last_entry Last entry to process (exclusive). Clamped to the
+  number of entries in the Baby.
+
+  \param[in,out] shadows If not null, events are recorded into the shadow
+  components stored here instead of the figures' own components, to be merged
+  later with MergeShadows(). Missing shadows are added. If null, the figures
+  are filled directly, which is only safe if no other task is running.
+
+  \return Number of entries processed
+*/
+long PlotMaker::GetYield(Baby *baby_ptr, long first_entry, long last_entry,
+                         ShadowMap *shadows){
   auto start_time = Clock::now();
   Baby &baby = *baby_ptr;
+  Trace::Span span("GetYield");
   auto activator = baby.Activate();
   string tag = "";
   if(baby.FileNames().size() == 1){
@@ -134,30 +1207,164 @@ long PlotMaker::GetYield(Baby *baby_ptr){
   oss << "]" << flush;
   tag += oss.str();
 
-  long num_entries = baby.GetEntries();
+  long total_entries = baby.GetEntries();
+  if(last_entry > total_entries) last_entry = total_entries;
+  if(first_entry > 0 || last_entry < total_entries){
+    tag += " entries "+to_string(first_entry)+"-"+to_string(last_entry);
+  }
+
+  //Entries to read, skipping those known to fail every process cut
+  SkimCache::Runs runs;
+  unique_ptr<SkimCache> skim_cache;
+  vector<FilePiece> new_skims;
+  if(skim_cache_dir_ != "" && first_entry < last_entry){
+    set<string> cuts;
+    for(const auto &proc: baby.processes_){
+      cuts.insert(proc->cut_.Definition());
+    }
+    string cut;
+    for(const auto &proc_cut: cuts){
+      if(cut != "") cut += " || ";
+      cut += "("+proc_cut+")";
+    }
+    skim_cache.reset(new SkimCache(skim_cache_dir_, cut));
+    for(const auto &piece: GetClusterPieces(baby, first_entry, last_entry)){
+      SkimCache::Runs file_runs;
+      if(skim_cache->Load(piece.file_, piece.first_-piece.offset_, piece.last_-piece.offset_, file_runs)){
+        for(const auto &run: file_runs){
+          runs.emplace_back(run.first+piece.offset_, run.second+piece.offset_);
+        }
+      }else{
+        runs.emplace_back(piece.first_, piece.last_);
+        new_skims.push_back(piece);
+      }
+    }
+    if(!new_skims.empty() || !runs.empty()) tag += " (skim cache)";
+  }else if(first_entry < last_entry){
+    runs.emplace_back(first_entry, last_entry);
+  }
+  long num_entries = 0;
+  for(const auto &run: runs){
+    num_entries += run.second-run.first;
+  }
 
-  vector<pair<const Process*, set<Figure::FigureComponent*> > > proc_figs(baby.processes_.size());
+  ProcFigs proc_figs(baby.processes_.size());
   size_t iproc = 0;
   for(const auto &proc: baby.processes_){
     proc_figs.at(iproc).first = proc;
-    proc_figs.at(iproc).second = GetComponents(proc);
+    for(const auto &component: GetComponents(proc)){
+      if(shadows == nullptr){
+        proc_figs.at(iproc).second.push_back(component);
+      }else{
+        unique_ptr<Figure::FigureComponent> &shadow = (*shadows)[component];
+        if(shadow == nullptr){
+          //Shadows may copy ROOT histograms, which is not thread safe
+          lock_guard<mutex> lock(Multithreading::root_mutex);
+          shadow = component->Shadow();
+        }
+        proc_figs.at(iproc).second.push_back(shadow.get());
+      }
+    }
     ++iproc;
   }
 
+  Trace::Span loop_span("EventLoop", tag);
   Timer timer(tag, num_entries, 10.);
-  for(long entry = 0; entry < num_entries; ++entry){
-    if(!min_print_) timer.Iterate();
-    baby.GetEntry(entry);
+  Timer *timer_ptr = min_print_ ? nullptr : &timer;
 
-    for(const auto &proc_fig: proc_figs){
-      if(proc_fig.first->cut_.IsScalar()){
-        if(!proc_fig.first->cut_.GetScalar(baby)) continue;
-      }else{
-        if(!HavePass(proc_fig.first->cut_.GetVector(baby))) continue;
+  set<string> branches;
+  bool branches_selected = !prune_branches_;
+  long warmup_left = 0;
+  if(prune_branches_ && !GetBranches(baby, branches)){
+    warmup_left = max(branch_warmup_entries_, 0L);
+  }
+  //Fills runs of entries, first learning the branches read from the first few
+  auto fill_runs = [&](EntryFiller &filler, SkimCache::Runs todo){
+    if(warmup_left > 0){
+      SkimCache::Runs warmup_runs = SplitRuns(todo, warmup_left);
+      baby.RecordBranches(&branches);
+      for(const auto &run: warmup_runs){
+        filler.Fill(run.first, run.second);
+        warmup_left -= run.second-run.first;
       }
-      for(const auto &component: proc_fig.second){
-	lock_guard<mutex> lock(component->mutex_);
-        component->RecordEvent(baby);
+      baby.RecordBranches(nullptr);
+    }
+    if(!branches_selected && warmup_left <= 0){
+      baby.SelectBranches(branches, first_entry, last_entry);
+      branches_selected = true;
+    }
+    for(const auto &run: todo){
+      filler.Fill(run.first, run.second);
+    }
+  };
+  //Saves skim cache lists for pieces entirely within [first, last)
+  auto save_skims = [&](const vector<long> &passed, long first, long last){
+    for(const auto &piece: new_skims){
+      if(piece.first_ < first || piece.last_ > last) continue;
+      vector<long> file_passed;
+      for(const auto &entry: passed){
+        if(entry >= piece.first_ && entry < piece.last_) file_passed.push_back(entry-piece.offset_);
+      }
+      skim_cache->Save(piece.file_, piece.first_-piece.offset_, piece.last_-piece.offset_,
+                       SkimCache::MakeRuns(file_passed));
+    }
+  };
+
+  if(result_cache_dir_ == ""){
+    EntryFiller filler(baby, proc_figs, column_block_size_, !new_skims.empty(), timer_ptr);
+    fill_runs(filler, runs);
+    save_skims(filler.Passed(), first_entry, last_entry);
+  }else{
+    ResultCache result_cache(result_cache_dir_);
+    for(const auto &piece: GetClusterPieces(baby, first_entry, last_entry)){
+      long file_first = piece.first_-piece.offset_;
+      long file_last = piece.last_-piece.offset_;
+      //Components with stored results for this cluster get them added. The others
+      //are filled, the supported ones into new shadows to be saved and merged.
+      ProcFigs piece_figs(proc_figs.size());
+      vector<pair<Figure::FigureComponent*, unique_ptr<Figure::FigureComponent> > > parts;
+      bool need_entries = false;
+      for(size_t ipf = 0; ipf < proc_figs.size(); ++ipf){
+        piece_figs.at(ipf).first = proc_figs.at(ipf).first;
+        for(const auto &component: proc_figs.at(ipf).second){
+          if(!ResultCache::Supports(*component)){
+            piece_figs.at(ipf).second.push_back(component);
+            need_entries = true;
+            continue;
+          }
+          unique_ptr<Figure::FigureComponent> part;
+          {
+            lock_guard<mutex> lock(Multithreading::root_mutex);
+            part = component->Shadow();
+          }
+          if(result_cache.Load(*part, piece.file_, file_first, file_last)){
+            component->Merge(*part);
+            continue;
+          }
+          {
+            //Start over in case the failed load left partial contents
+            lock_guard<mutex> lock(Multithreading::root_mutex);
+            part = component->Shadow();
+          }
+          piece_figs.at(ipf).second.push_back(part.get());
+          parts.emplace_back(component, move(part));
+          need_entries = true;
+        }
+      }
+      if(!need_entries) continue;
+
+      SkimCache::Runs piece_runs;
+      for(const auto &run: runs){
+        long first = max(run.first, piece.first_);
+        long last = min(run.second, piece.last_);
+        if(first < last) piece_runs.emplace_back(first, last);
+      }
+      EntryFiller filler(baby, piece_figs, column_block_size_, !new_skims.empty(), timer_ptr);
+      fill_runs(filler, piece_runs);
+      save_skims(filler.Passed(), piece.first_, piece.last_);
+      for(const auto &part: parts){
+        result_cache.Save(*part.second, piece.file_, file_first, file_last);
+        part.first->Merge(*part.second);
       }
     }
   }
@@ -173,6 +1380,101 @@ long PlotMaker::GetYield(Baby *baby_ptr){
   return num_entries;
 }
 
+/*!\brief Get the branches read by the process cuts and figures filled from a
+  Baby
+
+  \param[in] baby Baby whose processes are considered
+
+  \param[out] branches Set to which branch names are added
+
+  \return True if all functions read only known branches (see
+  NamedFunc::AddBranches())
+*/
+bool PlotMaker::GetBranches(const Baby &baby, set<string> &branches){
+  bool known = true;
+  for(const auto &proc: baby.processes_){
+    known = proc->cut_.AddBranches(branches) && known;
+    for(const auto &key: proc->grid_){
+      known = key.AddBranches(branches) && known;
+    }
+    for(auto &figure: figures_){
+      Figure::FigureComponent *component = figure->GetComponent(proc);
+      if(component == nullptr) continue;
+      for(const auto &func: figure->GetFunctions()){
+        known = func->AddBranches(branches) && known;
+      }
+      for(const auto &func: component->GetFunctions()){
+        known = func->AddBranches(branches) && known;
+      }
+    }
+  }
+  return known;
+}
+
+/*!\brief Adds shadow components to the components they were made from, then
+  deletes them
+
+  \param[in,out] shadows Shadow components filled by GetYield(). Empty on
+  return.
+*/
+void PlotMaker::MergeShadows(ShadowMap &shadows){
+  Trace::Span span("MergeShadows");
+  for(const auto &shadow: shadows){
+    lock_guard<mutex> lock(shadow.first->mutex_);
+    shadow.first->Merge(*shadow.second);
+  }
+  lock_guard<mutex> lock(Multithreading::root_mutex);
+  shadows.clear();
+}
+
+/*!\brief Splits a Baby into ranges of entries aligned to TTree cluster
+  boundaries
+
+  Each range holds at least PlotMaker::entries_per_task_ entries, except
+  possibly the last one. Since no cluster is shared between ranges, every
+  basket is decompressed by exactly one task.
+
+  \param[in] baby_ptr Baby to split. Activated for the duration of the call.
+
+  \return List of [first, last) entry ranges covering the whole Baby
+*/
+vector<pair<long, long> > PlotMaker::GetEntryRanges(Baby *baby_ptr) const{
+  Baby &baby = *baby_ptr;
+  Trace::Span span("GetEntryRanges");
+  auto activator = baby.Activate();
+  long num_entries = baby.GetEntries();
+
+  vector<pair<long, long> > ranges;
+  if(num_entries <= 0) return ranges;
+  if(entries_per_task_ <= 0 || num_entries <= entries_per_task_){
+    ranges.emplace_back(0, num_entries);
+    return ranges;
+  }
+
+  long first = 0;
+  {
+    lock_guard<mutex> lock(Multithreading::root_mutex);
+    TChain &chain = *baby.GetTree();
+    const Long64_t *offsets = chain.GetTreeOffset();
+    for(int itree = 0; itree < chain.GetNtrees(); ++itree){
+      if(chain.LoadTree(offsets[itree]) < 0) continue;
+      TTree *tree = chain.GetTree();
+      if(tree == nullptr) continue;
+      long tree_entries = tree->GetEntries();
+      TTree::TClusterIterator clusters = tree->GetClusterIterator(0);
+      for(long start = clusters(); start < tree_entries; start = clusters()){
+        long boundary = offsets[itree] + start;
+        if(boundary - first >= entries_per_task_){
+          ranges.emplace_back(first, boundary);
+          first = boundary;
+        }
+      }
+    }
+  }
+  if(first < num_entries) ranges.emplace_back(first, num_entries);
+  return ranges;
+}
+
 set<Baby*> PlotMaker::GetBabies() const{
   set<Baby*> babies;
   for(auto &proc: GetProcesses()){
@@ -19,6 +19,24 @@ set<Baby*> Process::Babies() const{
   return babies;
 }
 
+/*!\brief Splits the process into points of a signal grid
+
+  Figures using this process keep separate yields for every combination of
+  values taken by the keys, in addition to the total. For example,
+  proc->Grid({"mass_stop", "mass_lsp"}) replaces one process per mass point.
+
+  \param[in] keys Scalar NamedFuncs identifying the grid point of an event
+
+  \return Reference to *this
+*/
+Process & Process::Grid(const vector<NamedFunc> &keys){
+  for(const auto &key: keys){
+    if(!key.IsScalar()) ERROR("Grid key "+key.Name()+" must be scalar.");
+  }
+  grid_ = keys;
+  return *this;
+}
+
 Process::~Process(){
   lock_guard<mutex> lock(mutex_);
   auto baby_ptr_iter = baby_pool_.begin();
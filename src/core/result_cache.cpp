@@ -0,0 +1,151 @@
+/*! \class ResultCache
+
+  \brief Stores on disk what each figure component accumulated from each input
+  file
+
+  Adding one figure to a large job would otherwise mean refilling every figure
+  from every file. ResultCache saves the contents of a figure component filled
+  from one entry range of one input file, keyed by the component's
+  Figure::FigureComponent::Definition() and the path, size, and modification
+  time of the file. The definition holds the NamedFunc::Definition() of cuts,
+  weights, and variables, i.e. only the name and NamedFunc::Version() of a C++
+  function, so the version must be changed along with the function's body.
+  PlotMaker saves one result per TTree cluster, so results are reused however
+  the entries are split into tasks, then adds the stored contents instead of
+  reading the file again, and reads only clusters with new or changed figures.
+
+  As in SkimCache, the full key is stored in each file and compared on loading.
+*/
+#include "core/result_cache.hpp"
+
+#include <cerrno>
+#include <cstdio>
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <limits>
+
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "core/skim_cache.hpp"
+#include "core/utilities.hpp"
+
+using namespace std;
+
+namespace{
+  const string kHeader = "wh_draw partial result v2";//!<First line of every partial result file
+}
+
+/*!\brief Standard constructor
+
+  \param[in] directory Directory in which to store partial results. Created if
+  needed.
+*/
+ResultCache::ResultCache(const string &directory):
+  directory_(directory){
+  if(mkdir(directory_.c_str(), 0755) != 0 && errno != EEXIST){
+    ERROR("Could not create result cache directory "+directory_);
+  }
+}
+
+/*!\brief Check if a component can be saved and loaded
+
+  \param[in] component Figure component to check
+
+  \return True if the component has a non-empty definition
+*/
+bool ResultCache::Supports(const Figure::FigureComponent &component){
+  return component.Definition() != "";
+}
+
+/*!\brief Read stored contents for a component, file, and entry range
+
+  \param[in,out] component Empty component (e.g. from
+  Figure::FigureComponent::Shadow()) into which contents are read
+
+  \param[in] file_name Path to input file
+
+  \param[in] first_entry First entry of range in file (inclusive)
+
+  \param[in] last_entry Last entry of range in file (exclusive)
+
+  \return True if stored contents were found and read
+*/
+bool ResultCache::Load(Figure::FigureComponent &component, const string &file_name,
+                       long first_entry, long last_entry) const{
+  string key = Key(component, file_name, first_entry, last_entry);
+  if(key == "") return false;
+  ifstream file(Path(key));
+  if(!file) return false;
+  string header, stored_key;
+  if(!getline(file, header) || header != kHeader) return false;
+  if(!getline(file, stored_key) || stored_key != key) return false;
+  return component.ReadPartial(file);
+}
+
+/*!\brief Store contents of a component filled from a file and entry range
+
+  \param[in] component Component filled only from the given entries
+
+  \param[in] file_name Path to input file
+
+  \param[in] first_entry First entry of range in file (inclusive)
+
+  \param[in] last_entry Last entry of range in file (exclusive)
+*/
+void ResultCache::Save(const Figure::FigureComponent &component, const string &file_name,
+                       long first_entry, long last_entry) const{
+  string key = Key(component, file_name, first_entry, last_entry);
+  if(key == "") return;
+  string path = Path(key);
+  ostringstream tmp_path;
+  tmp_path << path << ".tmp." << getpid() << '.' << SkimCache::Hash(to_string(first_entry)+" "+to_string(last_entry));
+  {
+    ofstream file(tmp_path.str());
+    if(!file){
+      DBG("Could not write result cache file " << tmp_path.str());
+      return;
+    }
+    file << setprecision(numeric_limits<double>::max_digits10);
+    file << kHeader << '\n' << key << '\n';
+    component.WritePartial(file);
+  }
+  if(rename(tmp_path.str().c_str(), path.c_str()) != 0){
+    DBG("Could not move result cache file to " << path);
+    remove(tmp_path.str().c_str());
+  }
+}
+
+/*!\brief Get the full key identifying a partial result
+
+  \param[in] component Figure component
+
+  \param[in] file_name Path to input file
+
+  \param[in] first_entry First entry of range in file (inclusive)
+
+  \param[in] last_entry Last entry of range in file (exclusive)
+
+  \return Single line with component definition, file stamp, and entry range,
+  or empty string if the component is not supported or the file cannot be
+  found
+*/
+string ResultCache::Key(const Figure::FigureComponent &component, const string &file_name,
+                        long first_entry, long last_entry){
+  string definition = component.Definition();
+  string stamp = SkimCache::FileStamp(file_name);
+  if(definition == "" || stamp == "") return "";
+  return definition+'\t'+stamp+'\t'+to_string(first_entry)+'\t'+to_string(last_entry);
+}
+
+/*!\brief Get path of the file storing a partial result
+
+  \param[in] key Key from ResultCache::Key()
+
+  \return Path in cache directory named after the hash of key
+*/
+string ResultCache::Path(const string &key) const{
+  return directory_+"/"+SkimCache::Hash(key)+".part";
+}
@@ -0,0 +1,202 @@
+/*! \class SkimCache
+
+  \brief Stores on disk which entries of a file pass a cut
+
+  Heavy baseline selections typically reject nearly all events, yet every job
+  reads and evaluates all of them again. SkimCache saves the entries passing a
+  cut as a compact list of runs of consecutive entries, one small text file per
+  input file and entry range, so that later jobs can read only the surviving
+  entries. PlotMaker uses one range per TTree cluster, so lists are reused
+  however the entries are split into tasks.
+
+  Each list is keyed by the definition of the cut (see NamedFunc::Definition()),
+  the path, size, and modification time of the input file, and the entry
+  range. The definition of a cut built from a C++ function holds only the
+  function's name and NamedFunc::Version(), so the version must be changed
+  along with the function's body. A changed cut or rewritten input file
+  therefore never matches an old list. The full key is stored in the list
+  itself and compared on loading, so hash collisions are harmless.
+*/
+#include "core/skim_cache.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <cerrno>
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "core/utilities.hpp"
+
+using namespace std;
+
+namespace{
+  const string kHeader = "wh_draw skim cache v2";//!<First line of every entry list file
+}
+
+/*!\brief Standard constructor
+
+  \param[in] directory Directory in which to store entry lists. Created if
+  needed.
+
+  \param[in] cut Canonical text of the cut, e.g. the sorted definitions of all
+  process cuts applied to a Baby
+*/
+SkimCache::SkimCache(const string &directory, const string &cut):
+  directory_(directory),
+  cut_(cut){
+  ReplaceAll(cut_, "\n", " ");
+  if(mkdir(directory_.c_str(), 0755) != 0 && errno != EEXIST){
+    ERROR("Could not create skim cache directory "+directory_);
+  }
+}
+
+/*!\brief Get stored entries passing the cut
+
+  \param[in] file_name Path to input file
+
+  \param[in] first_entry First entry of range in file (inclusive)
+
+  \param[in] last_entry Last entry of range in file (exclusive)
+
+  \param[out] runs Runs of passing entries, numbered within file
+
+  \return True if a list for this cut, file, and range was found
+*/
+bool SkimCache::Load(const string &file_name, long first_entry, long last_entry,
+                     Runs &runs) const{
+  string key = Key(file_name, first_entry, last_entry);
+  if(key == "") return false;
+  ifstream file(Path(key));
+  if(!file) return false;
+  string header, stored_key;
+  if(!getline(file, header) || header != kHeader) return false;
+  if(!getline(file, stored_key) || stored_key != key) return false;
+  size_t num_runs = 0;
+  if(!(file >> num_runs)) return false;
+  Runs loaded(num_runs);
+  for(auto &run: loaded){
+    if(!(file >> run.first >> run.second)) return false;
+    if(run.first < first_entry || run.second > last_entry || run.first > run.second) return false;
+  }
+  runs.swap(loaded);
+  return true;
+}
+
+/*!\brief Store entries passing the cut
+
+  The list is written to a temporary file and then renamed, so concurrent jobs
+  never see a partial list.
+
+  \param[in] file_name Path to input file
+
+  \param[in] first_entry First entry of range in file (inclusive)
+
+  \param[in] last_entry Last entry of range in file (exclusive)
+
+  \param[in] runs Runs of passing entries, numbered within file
+*/
+void SkimCache::Save(const string &file_name, long first_entry, long last_entry,
+                     const Runs &runs) const{
+  string key = Key(file_name, first_entry, last_entry);
+  if(key == "") return;
+  string path = Path(key);
+  ostringstream tmp_path;
+  tmp_path << path << ".tmp." << getpid() << '.' << Hash(to_string(first_entry)+" "+to_string(last_entry));
+  {
+    ofstream file(tmp_path.str());
+    if(!file){
+      DBG("Could not write skim cache file " << tmp_path.str());
+      return;
+    }
+    file << kHeader << '\n' << key << '\n' << runs.size() << '\n';
+    for(const auto &run: runs){
+      file << run.first << ' ' << run.second << '\n';
+    }
+  }
+  if(rename(tmp_path.str().c_str(), path.c_str()) != 0){
+    DBG("Could not move skim cache file to " << path);
+    remove(tmp_path.str().c_str());
+  }
+}
+
+/*!\brief Compress a sorted list of entries into runs of consecutive entries
+
+  \param[in] entries Entry numbers in increasing order
+
+  \return Half-open ranges covering exactly the given entries
+*/
+SkimCache::Runs SkimCache::MakeRuns(const vector<long> &entries){
+  Runs runs;
+  for(const auto &entry: entries){
+    if(!runs.empty() && runs.back().second == entry){
+      ++runs.back().second;
+    }else{
+      runs.emplace_back(entry, entry+1);
+    }
+  }
+  return runs;
+}
+
+/*!\brief Get 64-bit FNV-1a hash of a string
+
+  \param[in] text String to hash
+
+  \return Hash as 16 hexadecimal digits
+*/
+string SkimCache::Hash(const string &text){
+  uint64_t hash = 14695981039346656037ULL;
+  for(const auto &c: text){
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 1099511628211ULL;
+  }
+  ostringstream oss;
+  oss << hex << setw(16) << setfill('0') << hash;
+  return oss.str();
+}
+
+/*!\brief Identify the current version of a file
+
+  \param[in] file_name Path to file
+
+  \return Path, size, and modification time of file separated by tabs, or
+  empty string if the file cannot be found
+*/
+string SkimCache::FileStamp(const string &file_name){
+  struct stat info;
+  if(stat(file_name.c_str(), &info) != 0) return "";
+  ostringstream oss;
+  oss << file_name << '\t' << info.st_size << '\t' << info.st_mtime;
+  return oss.str();
+}
+
+/*!\brief Get the full key identifying an entry list
+
+  \param[in] file_name Path to input file
+
+  \param[in] first_entry First entry of range in file (inclusive)
+
+  \param[in] last_entry Last entry of range in file (exclusive)
+
+  \return Single line with cut, file, file size and modification time, and
+  entry range, or empty string if the file cannot be found
+*/
+string SkimCache::Key(const string &file_name, long first_entry, long last_entry) const{
+  string stamp = FileStamp(file_name);
+  if(stamp == "") return "";
+  return cut_+'\t'+stamp+'\t'+to_string(first_entry)+'\t'+to_string(last_entry);
+}
+
+/*!\brief Get path of the file storing an entry list
+
+  \param[in] key Key from SkimCache::Key()
+
+  \return Path in cache directory named after the hash of key
+*/
+string SkimCache::Path(const string &key) const{
+  return directory_+"/"+Hash(key)+".skim";
+}
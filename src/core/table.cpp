@@ -45,7 +45,9 @@ Table::TableColumn::TableColumn(const Table &table,
   proc_and_table_cut_(table.rows_.size(), process->cut_),
   cut_vector_(),
   wgt_vector_(),
-  val_vector_(){
+  val_vector_(),
+  cut_columns_(table.rows_.size(), 0),
+  wgt_columns_(table.rows_.size(), 0){
   for(size_t irow = 0; irow < table.rows_.size(); ++irow){
     proc_and_table_cut_.at(irow) = table.rows_.at(irow).cut_ && process->cut_;
   }
@@ -54,6 +56,9 @@ Table::TableColumn::TableColumn(const Table &table,
 void Table::TableColumn::RecordEvent(const Baby &baby){
   const Table& table = static_cast<const Table&>(figure_);
 
+  //Grid point is only looked up once a row passes, so points with no
+  //selected events never show up
+  GridSums *grid_sums = nullptr;
   bool have_vector;
   size_t min_vec_size;
   for(size_t irow = 0; irow < table.rows_.size(); ++irow){
@@ -69,7 +74,7 @@ void Table::TableColumn::RecordEvent(const Baby &baby){
       if(!cut.GetScalar(baby)) continue;
       
     }else{
-      cut_vector_ = cut.GetVector(baby);
+      cut_vector_ = cut.GetTyped(baby);
       if(!have_vector || cut_vector_.size() < min_vec_size){
        have_vector = true;
        min_vec_size = cut_vector_.size();
@@ -80,26 +85,198 @@ void Table::TableColumn::RecordEvent(const Baby &baby){
     if(wgt.IsScalar()){
       wgt_scalar = wgt.GetScalar(baby);
     }else{
-      wgt_vector_ = wgt.GetVector(baby);
+      wgt_vector_ = wgt.GetTyped(baby);
       if(!have_vector || wgt_vector_.size() < min_vec_size){
        have_vector = true;
        min_vec_size = wgt_vector_.size();
       }
     }
 
+    double sumw = 0., sumw2 = 0.;
+    bool passed = !have_vector;
     if(!have_vector){
-      sumw_.at(irow) += wgt_scalar;
-      sumw2_.at(irow) += wgt_scalar*wgt_scalar;
+      sumw = wgt_scalar;
+      sumw2 = wgt_scalar*wgt_scalar;
     }else{
       for(size_t iobject = 0; iobject < min_vec_size; ++iobject){
        NamedFunc::ScalarType this_cut = cut.IsScalar() ? true : cut_vector_.at(iobject);
        if(!this_cut) continue;
+       passed = true;
        NamedFunc::ScalarType this_wgt = wgt.IsScalar() ? wgt_scalar : wgt_vector_.at(iobject);
-       sumw_.at(irow) += this_wgt;
-       sumw2_.at(irow) += this_wgt*this_wgt;
+       sumw += this_wgt;
+       sumw2 += this_wgt*this_wgt;
       }
     }
+    if(!passed) continue;
+    sumw_.at(irow) += sumw;
+    sumw2_.at(irow) += sumw2;
+    if(grid_sums == nullptr && !process_->grid_.empty()){
+      grid_sums = &grid_sums_[Grid::Evaluate(process_->grid_, baby)];
+      if(grid_sums->sumw_.empty()){
+        grid_sums->sumw_.resize(sumw_.size(), 0.);
+        grid_sums->sumw2_.resize(sumw2_.size(), 0.);
+      }
+    }
+    if(grid_sums != nullptr){
+      grid_sums->sumw_.at(irow) += sumw;
+      grid_sums->sumw2_.at(irow) += sumw2;
+    }
+  }
+}
+
+unique_ptr<Figure::FigureComponent> Table::TableColumn::Shadow() const{
+  unique_ptr<TableColumn> shadow(new TableColumn(static_cast<const Table&>(figure_), process_));
+  shadow->proc_and_table_cut_ = proc_and_table_cut_;
+  return unique_ptr<FigureComponent>(shadow.release());
+}
+
+void Table::TableColumn::Merge(const FigureComponent &shadow){
+  const TableColumn &other = static_cast<const TableColumn&>(shadow);
+  for(size_t irow = 0; irow < sumw_.size(); ++irow){
+    sumw_.at(irow) += other.sumw_.at(irow);
+    sumw2_.at(irow) += other.sumw2_.at(irow);
+  }
+  for(const auto &point: other.grid_sums_){
+    GridSums &sums = grid_sums_[point.first];
+    if(sums.sumw_.empty()){
+      sums = point.second;
+      continue;
+    }
+    for(size_t irow = 0; irow < sums.sumw_.size(); ++irow){
+      sums.sumw_.at(irow) += point.second.sumw_.at(irow);
+      sums.sumw2_.at(irow) += point.second.sumw2_.at(irow);
+    }
+  }
+}
+
+vector<NamedFunc*> Table::TableColumn::GetFunctions(){
+  vector<NamedFunc*> funcs;
+  for(auto &cut: proc_and_table_cut_){
+    funcs.push_back(&cut);
+  }
+  return funcs;
+}
+
+/*!\brief Request cut and weight columns of every row if all can be batch
+  evaluated
+
+  \param[in,out] batch Batch to which functions are added
+
+  \return True if the column can be filled with RecordColumns()
+*/
+bool Table::TableColumn::AddColumns(ColumnBatch &batch){
+  const Table& table = static_cast<const Table&>(figure_);
+  if(!process_->grid_.empty()) return false;
+  for(size_t irow = 0; irow < table.rows_.size(); ++irow){
+    const TableRow& row = table.rows_.at(irow);
+    if(!row.is_data_row_) continue;
+    if(!ColumnBatch::IsColumnar(proc_and_table_cut_.at(irow))
+       || !ColumnBatch::IsColumnar(row.weight_)) return false;
+  }
+  for(size_t irow = 0; irow < table.rows_.size(); ++irow){
+    const TableRow& row = table.rows_.at(irow);
+    if(!row.is_data_row_) continue;
+    cut_columns_.at(irow) = batch.Add(proc_and_table_cut_.at(irow));
+    wgt_columns_.at(irow) = batch.Add(row.weight_);
+  }
+  return true;
+}
+
+/*!\brief Add weights of all entries of current block passing each row's cut
+
+  \param[in] batch Batch filled with the columns from AddColumns()
+*/
+void Table::TableColumn::RecordColumns(const ColumnBatch &batch){
+  const Table& table = static_cast<const Table&>(figure_);
+  for(size_t irow = 0; irow < table.rows_.size(); ++irow){
+    if(!table.rows_.at(irow).is_data_row_) continue;
+    const NamedFunc::VectorType &cut = batch.Column(cut_columns_.at(irow));
+    const NamedFunc::VectorType &wgt = batch.Column(wgt_columns_.at(irow));
+    double sumw = 0., sumw2 = 0.;
+    for(size_t i = 0; i < batch.Size(); ++i){
+      if(!cut[i]) continue;
+      sumw += wgt[i];
+      sumw2 += wgt[i]*wgt[i];
+    }
+    sumw_.at(irow) += sumw;
+    sumw2_.at(irow) += sumw2;
+  }
+}
+
+/*!\brief Get cuts and weights of all rows determining the yields
+
+  \return Single line describing what is summed for a given set of events
+*/
+string Table::TableColumn::Definition() const{
+  const Table& table = static_cast<const Table&>(figure_);
+  string definition = "Table";
+  for(size_t irow = 0; irow < table.rows_.size(); ++irow){
+    const TableRow& row = table.rows_.at(irow);
+    if(row.is_data_row_){
+      definition += "\t"+proc_and_table_cut_.at(irow).Definition()+"\t"+row.weight_.Definition();
+    }else{
+      definition += "\t-\t-";
+    }
+  }
+  for(const auto &key: process_->grid_){
+    definition += "\t"+key.Definition();
   }
+  ReplaceAll(definition, "\n", " ");
+  return definition;
+}
+
+/*!\brief Write sums of weights and squared weights of all rows and grid points
+
+  \param[out] out Stream to which contents are written as text
+*/
+void Table::TableColumn::WritePartial(ostream &out) const{
+  out << sumw_.size() << '\n';
+  for(size_t irow = 0; irow < sumw_.size(); ++irow){
+    out << sumw_.at(irow) << ' ' << sumw2_.at(irow) << '\n';
+  }
+  out << grid_sums_.size() << '\n';
+  for(const auto &point: Grid::SortedPoints(grid_sums_)){
+    const GridSums &sums = grid_sums_.at(point);
+    out << point.size();
+    for(const auto &value: point){
+      out << ' ' << value;
+    }
+    out << '\n';
+    for(size_t irow = 0; irow < sums.sumw_.size(); ++irow){
+      out << sums.sumw_.at(irow) << ' ' << sums.sumw2_.at(irow) << '\n';
+    }
+  }
+}
+
+/*!\brief Read contents written by WritePartial()
+
+  \param[in] in Stream from which contents are read
+
+  \return True if contents were read successfully
+*/
+bool Table::TableColumn::ReadPartial(istream &in){
+  size_t num_rows = 0;
+  if(!(in >> num_rows) || num_rows != sumw_.size()) return false;
+  for(size_t irow = 0; irow < num_rows; ++irow){
+    if(!(in >> sumw_.at(irow) >> sumw2_.at(irow))) return false;
+  }
+  size_t num_points = 0;
+  if(!(in >> num_points)) return false;
+  for(size_t ipoint = 0; ipoint < num_points; ++ipoint){
+    size_t point_size = 0;
+    if(!(in >> point_size)) return false;
+    Grid::Point point(point_size);
+    for(auto &value: point){
+      if(!(in >> value)) return false;
+    }
+    GridSums &sums = grid_sums_[point];
+    sums.sumw_.assign(num_rows, 0.);
+    sums.sumw2_.assign(num_rows, 0.);
+    for(size_t irow = 0; irow < num_rows; ++irow){
+      if(!(in >> sums.sumw_.at(irow) >> sums.sumw2_.at(irow))) return false;
+    }
+  }
+  return true;
 }
 
 Table::Table(const string &name,
@@ -161,13 +338,7 @@ void Table::Print(double luminosity,
 }
 
 vector<GammaParams> Table::Yield(const Process *process, double luminosity) const{
-  const auto &component_list = GetComponentList(process);
-  const TableColumn *col = nullptr;
-  for(const auto &component: component_list){
-    if(component->process_.get() == process){
-      col = static_cast<const TableColumn *>(component.get());
-    }
-  }
+  const TableColumn *col = GetColumn(process);
   if(col == nullptr) return vector<GammaParams>();
   vector<GammaParams> yields(rows_.size());
   for(size_t i = 0; i < yields.size(); ++i){
@@ -176,6 +347,44 @@ vector<GammaParams> Table::Yield(const Process *process, double luminosity) cons
   return yields;
 }
 
+/*!\brief Get the yields in each row for one point of a process split with
+  Process::Grid()
+
+  \param[in] process Process split into grid points
+
+  \param[in] luminosity Luminosity by which to scale the yields
+
+  \param[in] point Values of the grid keys, in the order given to
+  Process::Grid()
+
+  \return Yield in each row. Zero if no event was found at this point.
+*/
+vector<GammaParams> Table::Yield(const Process *process, double luminosity,
+                                 const Grid::Point &point) const{
+  const TableColumn *col = GetColumn(process);
+  if(col == nullptr) return vector<GammaParams>();
+  vector<GammaParams> yields(rows_.size());
+  auto sums = col->grid_sums_.find(point);
+  if(sums == col->grid_sums_.cend()) return yields;
+  for(size_t i = 0; i < yields.size(); ++i){
+    yields.at(i).SetYieldAndUncertainty(luminosity*sums->second.sumw_.at(i),
+                                        luminosity*sqrt(sums->second.sumw2_.at(i)));
+  }
+  return yields;
+}
+
+/*!\brief Get all grid points found for a process split with Process::Grid()
+
+  \param[in] process Process split into grid points
+
+  \return Sorted list of grid points with at least one event
+*/
+vector<Grid::Point> Table::GridPoints(const Process *process) const{
+  const TableColumn *col = GetColumn(process);
+  if(col == nullptr) return vector<Grid::Point>();
+  return Grid::SortedPoints(col->grid_sums_);
+}
+
 vector<GammaParams> Table::BackgroundYield(double luminosity) const{
   vector<GammaParams> yields(rows_.size());  
   auto procs = GetProcesses();
@@ -227,6 +436,15 @@ Figure::FigureComponent * Table::GetComponent(const Process *process){
   return nullptr;
 }
 
+vector<NamedFunc*> Table::GetFunctions(){
+  vector<NamedFunc*> funcs;
+  for(auto &row: rows_){
+    if(!row.is_data_row_) continue;
+    funcs.push_back(&row.weight_);
+  }
+  return funcs;
+}
+
 const vector<unique_ptr<Table::TableColumn> >& Table::GetComponentList(const Process *process) const{
   switch(process->type_){
   case Process::Type::data:
@@ -240,6 +458,18 @@ const vector<unique_ptr<Table::TableColumn> >& Table::GetComponentList(const Pro
     return backgrounds_;
   }
 }
+
+const Table::TableColumn * Table::GetColumn(const Process *process) const{
+  const auto &component_list = GetComponentList(process);
+  const TableColumn *col = nullptr;
+  for(const auto &component: component_list){
+    if(component->process_.get() == process){
+      col = static_cast<const TableColumn *>(component.get());
+    }
+  }
+  return col;
+}
+
 void Table::PrintHeader(ofstream &file, double luminosity) const{
   file << "\\documentclass[10pt,oneside]{report}\n";
   file << "\\usepackage{graphicx,xspace,amssymb,amsmath,colordvi,colortbl,verbatim,multicol}\n";
@@ -0,0 +1,396 @@
+/*! \file test_evaluation.cxx
+
+  \brief Checks compiled expressions and partial results against the nested
+  functors they replace
+
+  Usage: test_evaluation.exe [-n entries] [-j jit_command | --no_jit]
+
+  Run from the top directory, since JitCompiler includes the headers from
+  inc. Writes a small Baby_full ntuple with random contents, then
+
+  1. evaluates cut strings (scalar and vector, with && and || chains and
+  subscripts) with the Bytecode program built by the parser, with
+  JitCompiler, and with the nested functors of the parsed expression, which
+  must agree exactly on every entry;
+
+  2. fills Hist1D, Hist2D, and Table components from the even and odd
+  entries, writes each half with WritePartial(), reads it back into a new
+  shadow with ReadPartial(), and checks that merging the read halves gives
+  the same contents, to full precision, as merging the filled ones.
+
+  Prints each mismatch and returns a nonzero status if any is found.
+*/
+#include "core/test_evaluation.hpp"
+
+#include <cstdlib>
+#include <cstdio>
+#include <cmath>
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <limits>
+#include <algorithm>
+#include <functional>
+#include <string>
+#include <vector>
+#include <memory>
+
+#include <unistd.h>
+#include <getopt.h>
+
+#include "TError.h"
+#include "TColor.h"
+#include "TFile.h"
+#include "TTree.h"
+#include "TRandom3.h"
+
+#include "core/baby.hpp"
+#include "core/baby_full.hpp"
+#include "core/process.hpp"
+#include "core/named_func.hpp"
+#include "core/function_parser.hpp"
+#include "core/jit_compiler.hpp"
+#include "core/figure.hpp"
+#include "core/axis.hpp"
+#include "core/hist1d.hpp"
+#include "core/hist2d.hpp"
+#include "core/table.hpp"
+#include "core/table_row.hpp"
+#include "core/utilities.hpp"
+
+using namespace std;
+
+namespace{
+  long num_entries = 5000;
+  bool use_jit = true;
+  string jit_command = "";
+
+  //! Expressions evaluated every way. Subscripts are guarded by the
+  //! multiplicities, which match the vector sizes in the generated ntuple
+  const vector<string> kExpressions = {
+    "ngoodleps==1&&pfmet>150&&ngoodjets>=2",
+    "pass&&(mt_met_lep>150||mbb<90)",
+    "!stitch||weight*2>1.5",
+    "ngoodbtags+2*ngoodjets-1.5",
+    "pfmet/ngoodjets",
+    "-ngoodleps*mass_stop<-250",
+    "ngoodjets%3==1||ngoodbtags==ngoodjets-1",
+    "ngoodjets>=2&&ak4pfjets_pt[1]>30",
+    "ngoodjets>ngoodbtags&&ak4pfjets_deepCSV[ngoodbtags]>0.5",
+    "ngoodleps>=1&&(leps_pdgid[0]==11||leps_pdgid[0]==-13)",
+    "ak4pfjets_pt>30&&ak4pfjets_deepCSV>0.5",
+    "ak4pfjets_pt*2-pfmet/10",
+    "leps_pdgid==11||leps_pdgid==-13",
+    "ngoodleps==1&&leps_pt>30",
+    "pass||ak4pfjets_deepCSV>0.8",
+    "ngoodjets>=1&&ak4pfjets_pt[0]>100&&ak4pfjets_pt>50"
+  };
+
+  //! Maximum number of mismatches printed for each expression
+  const long kMaxPrinted = 5;
+
+  /*!\brief Writes an ntuple with random values for the branches used by the
+    checks
+
+    Branches use small baskets, so that each spans several baskets.
+
+    \param[in] file_name Path of ROOT file to create
+
+    \param[in] entries Number of entries to write
+  */
+  void WriteBaby(const string &file_name, long entries){
+    TFile file(file_name.c_str(), "recreate");
+    TTree tree("t", "t");
+    const int buffer_size = 4000;
+    int ngoodleps = 0, ngoodjets = 0, ngoodbtags = 0;
+    float pfmet = 0.f, mt_met_lep = 0.f, mbb = 0.f, weight = 0.f, mass_stop = 0.f;
+    bool pass = false, stitch = false;
+    vector<float> ak4pfjets_pt, ak4pfjets_deepCSV, leps_pt;
+    vector<int> leps_pdgid;
+    tree.Branch("ngoodleps", &ngoodleps, buffer_size);
+    tree.Branch("ngoodjets", &ngoodjets, buffer_size);
+    tree.Branch("ngoodbtags", &ngoodbtags, buffer_size);
+    tree.Branch("pfmet", &pfmet, buffer_size);
+    tree.Branch("mt_met_lep", &mt_met_lep, buffer_size);
+    tree.Branch("mbb", &mbb, buffer_size);
+    tree.Branch("weight", &weight, buffer_size);
+    tree.Branch("mass_stop", &mass_stop, buffer_size);
+    tree.Branch("pass", &pass, buffer_size);
+    tree.Branch("stitch", &stitch, buffer_size);
+    tree.Branch("ak4pfjets_pt", &ak4pfjets_pt, buffer_size);
+    tree.Branch("ak4pfjets_deepCSV", &ak4pfjets_deepCSV, buffer_size);
+    tree.Branch("leps_pt", &leps_pt, buffer_size);
+    tree.Branch("leps_pdgid", &leps_pdgid, buffer_size);
+
+    TRandom3 rng(1234);
+    for(long entry = 0; entry < entries; ++entry){
+      ngoodleps = rng.Integer(3);
+      ngoodjets = rng.Integer(7);
+      ngoodbtags = ngoodjets > 0 ? rng.Integer(ngoodjets) : 0;
+      pfmet = rng.Exp(150.);
+      mt_met_lep = rng.Exp(100.);
+      mbb = rng.Uniform(0., 250.);
+      weight = rng.Uniform(0.5, 1.5);
+      mass_stop = rng.Integer(2) ? 300.f : 200.f;
+      pass = rng.Rndm() < 0.8;
+      stitch = rng.Rndm() < 0.9;
+      ak4pfjets_pt.clear();
+      ak4pfjets_deepCSV.clear();
+      for(int ijet = 0; ijet < ngoodjets; ++ijet){
+        ak4pfjets_pt.push_back(20.+rng.Exp(60.));
+        ak4pfjets_deepCSV.push_back(rng.Rndm());
+      }
+      sort(ak4pfjets_pt.begin(), ak4pfjets_pt.end(), greater<float>());
+      leps_pt.clear();
+      leps_pdgid.clear();
+      for(int ilep = 0; ilep < ngoodleps; ++ilep){
+        leps_pt.push_back(10.+rng.Exp(40.));
+        leps_pdgid.push_back((rng.Integer(2) ? 11 : 13)*(rng.Integer(2) ? 1 : -1));
+      }
+      tree.Fill();
+    }
+    tree.Write();
+    file.Close();
+  }
+
+  /*!\brief Check if two evaluations agree exactly, counting NaN as equal to
+    NaN
+
+    \param[in] a First result
+
+    \param[in] b Second result
+
+    \return True if a and b agree
+  */
+  bool Same(NamedFunc::ScalarType a, NamedFunc::ScalarType b){
+    return a == b || (std::isnan(a) && std::isnan(b));
+  }
+
+  /*!\brief Evaluates each expression with Bytecode, JitCompiler, and nested
+    functors on every entry and compares the results
+
+    \param[in] file_name ntuple to read
+
+    \return Number of evaluations differing from the nested functors
+  */
+  long CheckEvaluations(const string &file_name){
+    vector<NamedFunc> functors, programs, natives;
+    for(const auto &expression: kExpressions){
+      functors.push_back(FunctionParser(expression).ResolveAsToken().function_);
+      programs.push_back(NamedFunc(expression));
+      natives.push_back(functors.back());
+    }
+    if(use_jit){
+      JitCompiler jit(jit_command == "" ? JitCompiler::DefaultCommand() : jit_command);
+      size_t num_added = 0;
+      for(auto &native: natives){
+        if(jit.Add(native)) ++num_added;
+      }
+      size_t num_built = jit.Build();
+      cout << "Compiled " << num_built << " of " << num_added
+           << " scalar expressions to native code." << endl;
+      if(num_built != num_added) cout << "JitCompiler failed. Native code is not checked." << endl;
+    }
+
+    Baby_full baby(set<string>{file_name});
+    auto activator = baby.Activate();
+    long total_entries = baby.GetEntries();
+    if(total_entries != num_entries){
+      cout << "Read " << total_entries << " entries instead of " << num_entries << endl;
+      return 1;
+    }
+    long num_bad = 0;
+    for(size_t ifunc = 0; ifunc < kExpressions.size(); ++ifunc){
+      const NamedFunc &functor = functors.at(ifunc);
+      const NamedFunc &program = programs.at(ifunc);
+      const NamedFunc &native = natives.at(ifunc);
+      if(program.IsScalar() != functor.IsScalar()){
+        cout << kExpressions.at(ifunc) << ": Bytecode and functors disagree on being scalar" << endl;
+        ++num_bad;
+        continue;
+      }
+      long num_printed = 0;
+      for(long entry = 0; entry < total_entries; ++entry){
+        baby.GetEntry(entry);
+        ostringstream oss;
+        oss << setprecision(numeric_limits<double>::max_digits10);
+        bool bad = false;
+        if(functor.IsScalar()){
+          NamedFunc::ScalarType expected = functor.GetScalar(baby);
+          NamedFunc::ScalarType from_program = program.GetScalar(baby);
+          NamedFunc::ScalarType from_native = native.GetScalar(baby);
+          bad = !Same(from_program, expected) || !Same(from_native, expected);
+          oss << "functors " << expected << ", Bytecode " << from_program
+              << ", native " << from_native;
+        }else{
+          NamedFunc::VectorType expected = functor.GetVector(baby);
+          NamedFunc::VectorType from_program = program.GetVector(baby);
+          bad = expected.size() != from_program.size();
+          for(size_t i = 0; !bad && i < expected.size(); ++i){
+            bad = !Same(from_program.at(i), expected.at(i));
+          }
+          oss << "functors {";
+          for(const auto &x: expected) oss << ' ' << x;
+          oss << " }, Bytecode {";
+          for(const auto &x: from_program) oss << ' ' << x;
+          oss << " }";
+        }
+        if(!bad) continue;
+        ++num_bad;
+        if(num_printed++ < kMaxPrinted){
+          cout << kExpressions.at(ifunc) << " at entry " << entry << ": " << oss.str() << endl;
+        }
+      }
+    }
+    return num_bad;
+  }
+
+  /*!\brief Get everything WritePartial() saves for a component, to full
+    precision
+
+    \param[in] component Component to serialize
+
+    \return Serialized contents
+  */
+  string Contents(const Figure::FigureComponent &component){
+    ostringstream oss;
+    oss << setprecision(numeric_limits<double>::max_digits10);
+    component.WritePartial(oss);
+    return oss.str();
+  }
+
+  /*!\brief Checks that partial results of each component of a figure survive
+    a WritePartial()/ReadPartial() round trip
+
+    \param[in,out] figure Figure whose components are filled
+
+    \param[in] processes Processes of the figure
+
+    \param[in] name Label used when printing mismatches
+
+    \return Number of components whose contents changed or were never filled
+  */
+  long CheckPartials(Figure &figure,
+                     const vector<shared_ptr<Process> > &processes,
+                     const string &name){
+    long num_bad = 0;
+    for(const auto &process: processes){
+      Figure::FigureComponent *component = figure.GetComponent(process.get());
+      vector<unique_ptr<Figure::FigureComponent> > halves;
+      halves.push_back(component->Shadow());
+      halves.push_back(component->Shadow());
+      for(const auto &baby: process->Babies()){
+        auto activator = baby->Activate();
+        long total_entries = baby->GetEntries();
+        for(long entry = 0; entry < total_entries; ++entry){
+          baby->GetEntry(entry);
+          halves.at(entry%2)->RecordEvent(*baby);
+        }
+      }
+
+      auto filled = component->Shadow();
+      auto reread = component->Shadow();
+      string empty = Contents(*filled);
+      for(const auto &half: halves){
+        filled->Merge(*half);
+        istringstream iss(Contents(*half));
+        auto copy = component->Shadow();
+        if(!copy->ReadPartial(iss)){
+          cout << name << " (" << process->name_ << "): ReadPartial failed" << endl;
+          ++num_bad;
+        }
+        reread->Merge(*copy);
+      }
+      string expected = Contents(*filled);
+      if(expected == empty){
+        cout << name << " (" << process->name_ << "): no events recorded" << endl;
+        ++num_bad;
+      }else if(Contents(*reread) != expected){
+        cout << name << " (" << process->name_ << "): contents differ after round trip" << endl;
+        ++num_bad;
+      }
+    }
+    return num_bad;
+  }
+}
+
+int main(int argc, char *argv[]){
+  gErrorIgnoreLevel = 6000;
+  GetOptions(argc, argv);
+
+  string file_name = "/tmp/test_evaluation_"+to_string(getpid())+".root";
+  WriteBaby(file_name, num_entries);
+
+  long num_bad_evaluations = CheckEvaluations(file_name);
+  cout << num_bad_evaluations << " mismatched evaluations of " << kExpressions.size()
+       << " expressions on " << num_entries << " entries." << endl;
+
+  auto background = Process::MakeShared<Baby_full>("Background", Process::Type::background, kBlue,
+    {file_name}, "stitch");
+  auto signal = Process::MakeShared<Baby_full>("Signal", Process::Type::signal, kRed,
+    {file_name}, "ngoodbtags>=1");
+  signal->Grid({"mass_stop"});
+  auto data = Process::MakeShared<Baby_full>("Data", Process::Type::data, kBlack,
+    {file_name}, "pass");
+  vector<shared_ptr<Process> > processes = {background, signal, data};
+
+  Hist1D met(Axis(20, 0., 500., "pfmet", "MET [GeV]"), "ngoodleps==1", processes);
+  Hist1D jet_pt(Axis(20, 0., 300., "ak4pfjets_pt", "Jet p_{T} [GeV]"),
+                "ngoodjets>=2&&ak4pfjets_deepCSV>0.3", processes);
+  Hist2D met_mt(Axis(10, 0., 500., "pfmet", "MET [GeV]"),
+                Axis(10, 0., 400., "mt_met_lep", "m_{T} [GeV]"),
+                "ngoodjets>=2", processes);
+  Table cutflow("cutflow", vector<TableRow>{
+      TableRow("No Selection", "1"),
+        TableRow("$1\\ell$", "ngoodleps==1"),
+        TableRow("Second jet", "ngoodjets>=2&&ak4pfjets_pt[1]>30"),
+        TableRow("Tagged jets", "ak4pfjets_deepCSV>0.5")
+        }, processes, false, false, false, false);
+
+  long num_bad_partials = CheckPartials(met, processes, "Hist1D "+met.Name())
+    + CheckPartials(jet_pt, processes, "Hist1D "+jet_pt.Name())
+    + CheckPartials(met_mt, processes, "Hist2D "+met_mt.Name())
+    + CheckPartials(cutflow, processes, "Table cutflow");
+  cout << num_bad_partials << " components changed by a WritePartial/ReadPartial round trip." << endl;
+
+  remove(file_name.c_str());
+  return num_bad_evaluations == 0 && num_bad_partials == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+void GetOptions(int argc, char *argv[]){
+  while(true){
+    static struct option long_options[] = {
+      {"entries", required_argument, 0, 'n'},
+      {"jit", required_argument, 0, 'j'},
+      {"no_jit", no_argument, 0, 0},
+      {0, 0, 0, 0}
+    };
+
+    char opt = -1;
+    int option_index;
+    opt = getopt_long(argc, argv, "n:j:", long_options, &option_index);
+
+    if( opt == -1) break;
+
+    string optname;
+    switch(opt){
+    case 'n':
+      num_entries = atol(optarg);
+      break;
+    case 'j':
+      jit_command = optarg;
+      break;
+    case 0:
+      optname = long_options[option_index].name;
+      if(optname == "no_jit"){
+        use_jit = false;
+      }else{
+        printf("Bad option! Found option name %s\n", optname.c_str());
+      }
+      break;
+    default:
+      printf("Bad option! getopt_long returned character code 0%o\n", opt);
+      break;
+    }
+  }
+}
@@ -1,31 +1,37 @@
+/*! \class ThreadPool
+  \brief Runs tasks on a fixed set of worker threads
+
+  Each worker owns a queue of tasks. Tasks pushed from outside the pool are
+  dealt to the workers in turn, while tasks pushed by a running task go to the
+  queue of the worker running it. A worker whose queue is empty steals from
+  the others before going to sleep. Both owners and thieves take the oldest
+  task, so tasks start roughly in the order they were pushed.
+
+  The default number of threads can be set with the WH_DRAW_NUM_THREADS
+  environment variable.
+*/
 #include "core/thread_pool.hpp"
 
+#include <cstdlib>
+
 #include "TThread.h"
 
+#include "core/utilities.hpp"
+
 using namespace std;
 
+thread_local const ThreadPool * ThreadPool::current_pool_ = nullptr;
+thread_local size_t ThreadPool::current_worker_ = 0;
+
 ThreadPool::ThreadPool():
-  tasks_(),
-  threads_(),
-  stop_thread_now_(),
-  stop_at_empty_(),
-  mutex_(),
-  cv_(){
-  TThread::Initialize();
-  size_t num_threads = thread::hardware_concurrency();
-  if(num_threads > 2){
-    --num_threads;
-  }else{
-    num_threads = 1;
-  }
-  Resize(num_threads);
+  ThreadPool(DefaultSize()){
 }
 
 ThreadPool::ThreadPool(std::size_t num_threads):
-  tasks_(),
-  threads_(),
-  stop_thread_now_(),
-  stop_at_empty_(),
+  workers_(),
+  next_worker_(0),
+  num_queued_(0),
+  stop_at_empty_(false),
   mutex_(),
   cv_(){
   TThread::Initialize();
@@ -33,85 +39,174 @@ ThreadPool::ThreadPool(std::size_t num_threads):
 }
 
 ThreadPool::~ThreadPool(){
-  stop_at_empty_ = true;
   {
     lock_guard<mutex> lock(mutex_);
-    cv_.notify_all();
+    stop_at_empty_ = true;
   }
+  cv_.notify_all();
 
-  for(size_t ithread = 0; ithread < Size(); ++ithread){
-    if(threads_.at(ithread)->joinable()){
-      threads_.at(ithread)->join();
+  for(const auto &worker: workers_){
+    if(worker->thread_.joinable()){
+      worker->thread_.join();
     }
   }
 }
 
 size_t ThreadPool::Size() const{
-  return threads_.size();
+  return workers_.size();
 }
 
+/*!\brief Changes the number of worker threads
+
+  Running tasks are allowed to finish, and tasks still waiting in a queue are
+  handed to the new set of workers. Must not be called from inside a task.
+
+  \param[in] num_threads New number of worker threads. At least one thread is
+  always kept.
+*/
 void ThreadPool::Resize(size_t num_threads){
-  size_t old_num_threads = Size();
-  if(num_threads > old_num_threads){
-    threads_.resize(num_threads);
-    stop_thread_now_.resize(num_threads);
+  if(num_threads < 1) num_threads = 1;
+  if(num_threads == Size()) return;
 
-    for(size_t ithread = old_num_threads; ithread < num_threads; ++ithread){
-      threads_.at(ithread).reset(new thread(&ThreadPool::DoTasksFromQueue, this, ithread));
-    }
-  }else if(num_threads < old_num_threads){
-    for(size_t ithread = num_threads; ithread < old_num_threads; ++ithread){
-      *stop_thread_now_.at(ithread) = true;
-      threads_.at(ithread)->detach();
-    }
+  vector<FuncPtr> pending = StopWorkers();
+  for(size_t iworker = 0; iworker < num_threads; ++iworker){
+    workers_.emplace_back(new Worker());
+  }
+  for(auto &task: pending){
+    workers_.at(next_worker_++ % num_threads)->tasks_.Push(task);
+  }
+  for(size_t iworker = 0; iworker < num_threads; ++iworker){
+    workers_.at(iworker)->thread_ = thread(&ThreadPool::DoTasks, this, iworker);
+  }
+}
 
-    {
-      lock_guard<mutex> lock(mutex_);
-      cv_.notify_all();
+/*!\brief Number of threads used by the default constructor
+
+  Taken from the WH_DRAW_NUM_THREADS environment variable if set to a positive
+  integer. Otherwise, one less than the number of hardware threads so that the
+  calling thread keeps a core.
+
+  \return Default number of worker threads
+*/
+size_t ThreadPool::DefaultSize(){
+  const char *env = getenv("WH_DRAW_NUM_THREADS");
+  if(env != nullptr){
+    char *end = nullptr;
+    long num_threads = strtol(env, &end, 10);
+    if(end != env && *end == '\0' && num_threads > 0){
+      return num_threads;
     }
+    DBG("Ignoring invalid WH_DRAW_NUM_THREADS=\"" << env << "\"");
+  }
+  size_t num_threads = thread::hardware_concurrency();
+  return num_threads > 2 ? num_threads-1 : 1;
+}
+
+/*!\brief Index of the worker running the calling task
+
+  Lets tasks keep per-worker state, e.g. in a vector of Size() elements, that
+  is never used by two tasks at once.
 
-    threads_.resize(num_threads);
-    stop_thread_now_.resize(num_threads);
+  \return Index of the worker thread running the caller, or 0 if the caller is
+  not a worker of any pool
+*/
+size_t ThreadPool::CurrentWorker(){
+  return current_worker_;
+}
+
+void ThreadPool::PushTask(FuncPtr &func){
+  {
+    lock_guard<mutex> lock(mutex_);
+    size_t iworker = current_pool_ == this
+      ? current_worker_
+      : next_worker_++ % Size();
+    workers_.at(iworker)->tasks_.Push(func);
+    ++num_queued_;
   }
+  cv_.notify_one();
 }
 
-void ThreadPool::DoTasksFromQueue(size_t ithread){
-  unique_ptr<function<void()> > task = tasks_.Pop();
+void ThreadPool::DoTasks(size_t iworker){
+  current_pool_ = this;
+  current_worker_ = iworker;
+  Worker &worker = *workers_.at(iworker);
   while(true){
-    while(task != nullptr){
-      (*task)();
-      if(stop_thread_now_.at(ithread)) return;
-      task = tasks_.Pop();
-    }
-
     unique_lock<mutex> lock(mutex_);
-    cv_.wait(lock, bind(&ThreadPool::ReadyToAct, this, ithread, ref(task)));
-    if(task == nullptr) return;
+    cv_.wait(lock, [this, &worker](){
+        return worker.stop_now_ || stop_at_empty_ || num_queued_ > 0;
+      });
+    if(worker.stop_now_ || num_queued_ == 0) return;
+
+    FuncPtr task = FindTask(iworker);
+    --num_queued_;
+    lock.unlock();
+    (*task)();
   }
 }
 
-bool ThreadPool::ReadyToAct(size_t ithread, unique_ptr<function<void()> > &task){
-  if(stop_thread_now_.at(ithread)){
-    return true;
-  }else{
-    task = tasks_.Pop();
-    return stop_at_empty_ || task != nullptr;
+/*!\brief Takes the oldest task from the worker's own queue, or else steals one
+
+  Must be called with mutex_ held and num_queued_ positive, so that a task is
+  always found.
+
+  \param[in] iworker Index of the worker looking for a task
+
+  \return Task to run
+*/
+ThreadPool::FuncPtr ThreadPool::FindTask(size_t iworker){
+  for(size_t offset = 0; offset < Size(); ++offset){
+    FuncPtr task = workers_.at((iworker+offset) % Size())->tasks_.Pop();
+    if(task != nullptr) return task;
   }
+  return FuncPtr();
+}
+
+/*!\brief Stops and joins all workers once their current task is done
+
+  \return Tasks that were still waiting in a queue
+*/
+vector<ThreadPool::FuncPtr> ThreadPool::StopWorkers(){
+  {
+    lock_guard<mutex> lock(mutex_);
+    for(const auto &worker: workers_){
+      worker->stop_now_ = true;
+    }
+  }
+  cv_.notify_all();
+
+  vector<FuncPtr> pending;
+  for(const auto &worker: workers_){
+    if(worker->thread_.joinable()){
+      worker->thread_.join();
+    }
+  }
+  for(const auto &worker: workers_){
+    for(FuncPtr task = worker->tasks_.Pop(); task != nullptr; task = worker->tasks_.Pop()){
+      pending.push_back(move(task));
+    }
+  }
+  workers_.clear();
+  return pending;
+}
+
+ThreadPool::Worker::Worker():
+  tasks_(),
+  thread_(),
+  stop_now_(false){
 }
 
 void ThreadPool::Queue::Push(FuncPtr &func){
   lock_guard<mutex> lock(mutex_);
-  queue_.push(unique_ptr<function<void()> >());
-  queue_.back() = move(func);
+  deque_.push_back(move(func));
 }
 
-ThreadPool::Queue::FuncPtr ThreadPool::Queue::Pop(){
+ThreadPool::FuncPtr ThreadPool::Queue::Pop(){
   lock_guard<mutex> lock(mutex_);
-  if(queue_.empty()){
+  if(deque_.empty()){
     return FuncPtr();
   }else{
-    Queue::FuncPtr func = move(queue_.front());
-    queue_.pop();
+    FuncPtr func = move(deque_.front());
+    deque_.pop_front();
     return func;
   }
 }
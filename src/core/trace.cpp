@@ -0,0 +1,222 @@
+/*! \class Trace
+
+  \brief Records a timeline of spans for each thread and writes it as a Chrome
+  trace-event JSON file
+
+  Tracing is off by default, in which case creating a Trace::Span costs a
+  single atomic load. After Trace::Start(), each span is recorded when it ends
+  into a buffer owned by its thread, so threads do not contend for a lock.
+  Trace::Write() saves all spans in the format read by chrome://tracing and
+  Perfetto, with one row per thread.
+*/
+
+/*! \class Trace::Span
+
+  \brief Scoped span of time recorded by Trace
+
+  The span starts on construction and is recorded when End() is called or the
+  span goes out of scope, whichever comes first.
+*/
+#include "core/trace.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <unistd.h>
+
+#include "core/utilities.hpp"
+
+using namespace std;
+
+namespace{
+  using Clock = chrono::steady_clock;
+
+  //! Span recorded by Trace
+  struct Event{
+    const char *name_;//!<Name of span
+    string detail_;//!<Optional description
+    long start_;//!<Start time in microseconds since Trace::Start()
+    long duration_;//!<Duration in microseconds
+  };
+
+  //! Spans recorded by one thread
+  struct ThreadEvents{
+    explicit ThreadEvents(size_t thread):
+      thread_(thread),
+      mutex_(),
+      events_(){
+    }
+
+    size_t thread_;//!<Index of thread in order of first span
+    mutex mutex_;//!<Only contended while Trace::Write() copies events_
+    vector<Event> events_;//!<Spans recorded so far
+  };
+
+  atomic<bool> enabled(false);//!<Flag if spans are being recorded
+  Clock::time_point start_time;//!<Time of Trace::Start()
+  mutex threads_mutex;//!<Protects thread_events
+  vector<unique_ptr<ThreadEvents> > thread_events;//!<Buffers of all threads that recorded spans
+  thread_local ThreadEvents *this_thread_events = nullptr;//!<Buffer of the calling thread
+
+  /*!\brief Get the span buffer of the calling thread, creating it if needed
+
+    \return Buffer owned by the calling thread
+  */
+  ThreadEvents & GetThreadEvents(){
+    if(this_thread_events == nullptr){
+      lock_guard<mutex> lock(threads_mutex);
+      thread_events.emplace_back(new ThreadEvents(thread_events.size()));
+      this_thread_events = thread_events.back().get();
+    }
+    return *this_thread_events;
+  }
+
+  /*!\brief Escape a string for use in a JSON string literal
+
+    \param[in] text String to escape
+
+    \return Escaped string, without surrounding quotes
+  */
+  string JSONEscape(const string &text){
+    string out;
+    for(const auto &c: text){
+      switch(c){
+      case '"': out += "\\\""; break;
+      case '\\': out += "\\\\"; break;
+      case '\n': out += "\\n"; break;
+      case '\t': out += "\\t"; break;
+      default:
+        if(static_cast<unsigned char>(c) < 0x20){
+          out += ' ';
+        }else{
+          out += c;
+        }
+        break;
+      }
+    }
+    return out;
+  }
+}
+
+/*!\brief Start a span
+
+  \param[in] name Name of span. Must outlive the trace, e.g. a string literal.
+
+  \param[in] detail Optional description, e.g. the file being read
+*/
+Trace::Span::Span(const char *name, const string &detail):
+  name_(name),
+  detail_(),
+  start_(0),
+  active_(Trace::Enabled()){
+  if(!active_) return;
+  detail_ = detail;
+  start_ = Trace::Now();
+}
+
+Trace::Span::~Span(){
+  End();
+}
+
+/*!\brief End the span now instead of at the end of its scope
+*/
+void Trace::Span::End(){
+  if(!active_) return;
+  active_ = false;
+  Trace::Record(name_, detail_, start_, Trace::Now()-start_);
+}
+
+/*!\brief End the span without recording it
+
+  Used for spans only worth recording after the fact, e.g. a read that turned
+  out to open a new file.
+*/
+void Trace::Span::Discard(){
+  active_ = false;
+}
+
+/*!\brief Start recording spans, discarding any previously recorded
+*/
+void Trace::Start(){
+  lock_guard<mutex> lock(threads_mutex);
+  for(auto &events: thread_events){
+    lock_guard<mutex> events_lock(events->mutex_);
+    events->events_.clear();
+  }
+  start_time = Clock::now();
+  enabled = true;
+}
+
+/*!\brief Check if spans are being recorded
+
+  \return True between Trace::Start() and Trace::Write()
+*/
+bool Trace::Enabled(){
+  return enabled.load(memory_order_relaxed);
+}
+
+/*!\brief Stop recording spans and write them as Chrome trace-event JSON
+
+  \param[in] file_name Path of file to write
+*/
+void Trace::Write(const string &file_name){
+  enabled = false;
+  ofstream file(file_name);
+  if(!file){
+    DBG("Could not write trace to " << file_name);
+    return;
+  }
+  long pid = getpid();
+  file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+  bool first = true;
+  lock_guard<mutex> lock(threads_mutex);
+  for(const auto &events: thread_events){
+    lock_guard<mutex> events_lock(events->mutex_);
+    if(!first) file << ",\n";
+    first = false;
+    file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid
+         << ",\"tid\":" << events->thread_
+         << ",\"args\":{\"name\":\"thread " << events->thread_ << "\"}}";
+    for(const auto &event: events->events_){
+      file << ",\n{\"name\":\"" << JSONEscape(event.name_) << "\",\"cat\":\"wh_draw\",\"ph\":\"X\""
+           << ",\"ts\":" << event.start_ << ",\"dur\":" << event.duration_
+           << ",\"pid\":" << pid << ",\"tid\":" << events->thread_;
+      if(event.detail_ != ""){
+        file << ",\"args\":{\"detail\":\"" << JSONEscape(event.detail_) << "\"}";
+      }
+      file << '}';
+    }
+    events->events_.clear();
+  }
+  file << "\n]}\n";
+}
+
+/*!\brief Get time since Trace::Start()
+
+  \return Elapsed time in microseconds
+*/
+long Trace::Now(){
+  return chrono::duration_cast<chrono::microseconds>(Clock::now()-start_time).count();
+}
+
+/*!\brief Add a finished span to the buffer of the calling thread
+
+  \param[in] name Name of span
+
+  \param[in] detail Optional description
+
+  \param[in] start Start time in microseconds since Trace::Start()
+
+  \param[in] duration Duration in microseconds
+*/
+void Trace::Record(const char *name, const string &detail,
+                   long start, long duration){
+  if(!Enabled()) return;
+  ThreadEvents &events = GetThreadEvents();
+  lock_guard<mutex> lock(events.mutex_);
+  events.events_.push_back({name, detail, start, duration});
+}
@@ -358,7 +358,7 @@ vector<string> Tokenize(const string& input,
 
 string MakeDir(string prefix){
   prefix += "XXXXXX";
-  char *dir_name = new char[prefix.size()];
+  char *dir_name = new char[prefix.size()+1];
   if(dir_name == nullptr) ERROR("Could not allocate directory name");
   strcpy(dir_name, prefix.c_str());
   mkdtemp(dir_name);
@@ -369,7 +369,7 @@ string MakeDir(string prefix){
 
 string MakeTemp(string prefix){
   prefix += "XXXXXX";
-  char *file_name = new char[prefix.size()];
+  char *file_name = new char[prefix.size()+1];
   if(file_name == nullptr) ERROR("Could not allocate file name");
   strcpy(file_name, prefix.c_str());
   mkstemp(file_name);
@@ -447,6 +447,77 @@ void MergeOverflow(TH1D &h, bool merge_underflow, bool merge_overflow){
   }
 }
 
+namespace{
+  /*!\brief Number of statistics filled by TH1::GetStats()
+
+    \param[in] hist Histogram
+
+    \return 4, 7, or 11 for 1D, 2D, or 3D histograms
+  */
+  size_t NumHistStats(const TH1 &hist){
+    switch(hist.GetDimension()){
+    case 1: return 4;
+    case 2: return 7;
+    default: return 11;
+    }
+  }
+}
+
+/*!\brief Writes contents, squared errors, and statistics of a histogram as
+  text
+
+  \param[out] out Stream to write to
+
+  \param[in] hist Histogram to write
+*/
+void WriteHistContents(ostream &out, const TH1 &hist){
+  int num_cells = hist.GetNcells();
+  vector<double> stats(NumHistStats(hist), 0.);
+  hist.GetStats(stats.data());
+  out << num_cells << ' ' << hist.GetEntries();
+  for(const auto &stat: stats){
+    out << ' ' << stat;
+  }
+  out << '\n';
+  const TArrayD *sumw2 = hist.GetSumw2();
+  for(int cell = 0; cell < num_cells; ++cell){
+    double error = hist.GetBinError(cell);
+    out << hist.GetBinContent(cell) << ' '
+        << (cell < sumw2->GetSize() ? sumw2->At(cell) : error*error) << '\n';
+  }
+}
+
+/*!\brief Reads histogram written by WriteHistContents() into a histogram with
+  the same binning
+
+  \param[in] in Stream to read from
+
+  \param[in,out] hist Empty histogram with Sumw2() enabled
+
+  \return True if successful
+*/
+bool ReadHistContents(istream &in, TH1 &hist){
+  int num_cells = 0;
+  double entries = 0.;
+  vector<double> stats(NumHistStats(hist), 0.);
+  if(!(in >> num_cells >> entries)) return false;
+  for(auto &stat: stats){
+    if(!(in >> stat)) return false;
+  }
+  if(num_cells != hist.GetNcells()) return false;
+  TArrayD *sumw2 = hist.GetSumw2();
+  if(sumw2->GetSize() < num_cells) return false;
+  for(int cell = 0; cell < num_cells; ++cell){
+    double content = 0., error2 = 0.;
+    if(!(in >> content >> error2)) return false;
+    hist.SetBinContent(cell, content);
+    sumw2->GetArray()[cell] = error2;
+  }
+  hist.SetEntries(entries);
+  hist.PutStats(stats.data());
+  return true;
+}
+
 string FixedDigits(double x, int n_digits){
   int digits_left = max(floor(log10(x))+1., 0.);
   int digits_right = max(n_digits-digits_left, 0);
@@ -1,13 +1,16 @@
 #include "core/wh_functions.hpp"
 #include <algorithm> //std::min
+#include <map>
+#include <utility>
 #include <math.h>
 
-#include "TFile.h"
 #include "TVector2.h"
 #include "TLorentzVector.h"
 
 #include "core/utilities.hpp"
 #include "core/config_parser.hpp"
+#include "core/calibration_map.hpp"
+#include "core/function_parser.hpp"
 
 
 using namespace std;
@@ -24,17 +27,17 @@ float deepTag2016 = 0.8945;
 float deepTag2017 = 0.8695;
 float deepTag2018 = 0.8365;
 
-  const NamedFunc pass_any_mt_variation("pass_any_mt_variation",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc pass_any_mt_variation = FunctionParser::Register(NamedFunc("pass_any_mt_variation",[](const Baby &b) -> NamedFunc::ScalarType{
   if(b.mt_met_lep()>150. || b.mt_met_lep_jdown()>150. || b.mt_met_lep_jup()>150. || b.mt_met_lep_resdown()>150. || b.mt_met_lep_resup()>150.  ) return 1.;
   else return 0.;
-  });
+  }));
 
-  const NamedFunc pass_any_met_variation("pass_any_met_variation",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc pass_any_met_variation = FunctionParser::Register(NamedFunc("pass_any_met_variation",[](const Baby &b) -> NamedFunc::ScalarType{
   if(b.pfmet()>125. || b.pfmet_jdown()>125. || b.pfmet_jup()>125. || b.pfmet_resdown()>125. || b.pfmet_resup()>125.  ) return 1.;
   else return 0.;
-  });
+  }));
 
-  const NamedFunc pass_any_njets_variation("pass_any_njets_variation",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc pass_any_njets_variation = FunctionParser::Register(NamedFunc("pass_any_njets_variation",[](const Baby &b) -> NamedFunc::ScalarType{
   if( (b.ngoodjets()>=2 && b.ngoodjets()<=3)
       || (b.jup_ngoodjets()>=2 && b.jup_ngoodjets()<=3)
       || (b.jdown_ngoodjets()>=2 && b.jdown_ngoodjets()<=3)
@@ -42,10 +45,10 @@ float deepTag2018 = 0.8365;
       // || (b.resdown_ngoodjets()>=2 && b.resdown_ngoodjets()<=3)
     ) return 1.;
   else return 0.;
-  });
+  }));
 
   //Not really correct
-      const NamedFunc pass_any_nb_variation("pass_any_nb_variation",[](const Baby &b) -> NamedFunc::ScalarType{
+      const NamedFunc pass_any_nb_variation = FunctionParser::Register(NamedFunc("pass_any_nb_variation",[](const Baby &b) -> NamedFunc::ScalarType{
   if( (b.ngoodbtags()>=1)
       // || (b.jup_ngoodbtags()>=1)
       // || (b.jdown_ngoodbtags()>=1 )
@@ -53,9 +56,9 @@ float deepTag2018 = 0.8365;
       // || (b.resdown_ngoodbtags()>=1)
     ) return 1.;
   else return 0.;
-  });
+  }));
 
-  const NamedFunc nanoWeight("nanoWeight",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc nanoWeight = FunctionParser::Register(NamedFunc("nanoWeight",[](const Baby &b) -> NamedFunc::ScalarType{
     //For 06_12 production
     float weight=1;
     //w_lumi_scale1fb is a weight unique for each MC sample (formed from n_events and xsec)
@@ -66,34 +69,42 @@ float deepTag2018 = 0.8365;
     //TTJets_1lep_tbar_f17v2
     else if (abs(abs(b.w_lumi_scale1fb())-0.00324188)<0.00001) weight = 1.014;
     // in 2017, some mass points have no nano
-    else if (b.year()==2017 && b.mass_stop()==200  && b.mass_lsp()==25)  weight = 1/0.989598335734 ;
-    else if (b.year()==2017 && b.mass_stop()==275  && b.mass_lsp()==75)  weight = 1/0.957338965153 ;
-    else if (b.year()==2017 && b.mass_stop()==300  && b.mass_lsp()==50)  weight = 1/0.961527621195 ;
-    else if (b.year()==2017 && b.mass_stop()==375  && b.mass_lsp()==25)  weight = 1/0.951265229616 ;
-    else if (b.year()==2017 && b.mass_stop()==675  && b.mass_lsp()==1)   weight = 1/0.97484237468  ;
-    else if (b.year()==2017 && b.mass_stop()==675  && b.mass_lsp()==225) weight = 1/0.940583363342 ;
-    else if (b.year()==2017 && b.mass_stop()==725  && b.mass_lsp()==150) weight = 1/0.969029492202 ;
-    else if (b.year()==2017 && b.mass_stop()==725  && b.mass_lsp()==275) weight = 1/0.962572303505 ;
-    else if (b.year()==2017 && b.mass_stop()==725  && b.mass_lsp()==325) weight = 1/0.96882402384  ;
-    else if (b.year()==2017 && b.mass_stop()==725  && b.mass_lsp()==550) weight = 1/0.991338321477 ;
-    else if (b.year()==2017 && b.mass_stop()==725  && b.mass_lsp()==575) weight = 1/0.989381003202 ;
-    else if (b.year()==2017 && b.mass_stop()==825  && b.mass_lsp()==175) weight = 1/0.959898615009 ;
-    else if (b.year()==2017 && b.mass_stop()==875  && b.mass_lsp()==400) weight = 1/0.972290031009 ;
-    else if (b.year()==2017 && b.mass_stop()==900  && b.mass_lsp()==600) weight = 1/0.967833570056 ;
-    else if (b.year()==2017 && b.mass_stop()==925  && b.mass_lsp()==25)  weight = 1/0.972826712723 ;
-    else if (b.year()==2017 && b.mass_stop()==950  && b.mass_lsp()==550) weight = 1/0.972117321249 ;
-    else if (b.year()==2017 && b.mass_stop()==1000 && b.mass_lsp()==125) weight = 1/0.970782940802 ;
-    else if (b.year()==2017 && b.mass_stop()==1000 && b.mass_lsp()==425) weight = 1/0.974963353855 ;
+    else if (b.year()==2017){
+      //(mass_stop, mass_lsp) -> weight. Mass points vary within a signal scan file, so look them up per event.
+      static const map<pair<float, float>, float> missing_nano = {
+        {{200, 25}, 1/0.989598335734},
+        {{275, 75}, 1/0.957338965153},
+        {{300, 50}, 1/0.961527621195},
+        {{375, 25}, 1/0.951265229616},
+        {{675, 1}, 1/0.97484237468},
+        {{675, 225}, 1/0.940583363342},
+        {{725, 150}, 1/0.969029492202},
+        {{725, 275}, 1/0.962572303505},
+        {{725, 325}, 1/0.96882402384},
+        {{725, 550}, 1/0.991338321477},
+        {{725, 575}, 1/0.989381003202},
+        {{825, 175}, 1/0.959898615009},
+        {{875, 400}, 1/0.972290031009},
+        {{900, 600}, 1/0.967833570056},
+        {{925, 25}, 1/0.972826712723},
+        {{950, 550}, 1/0.972117321249},
+        {{1000, 125}, 1/0.970782940802},
+        {{1000, 425}, 1/0.974963353855}
+      };
+      auto point = missing_nano.find(make_pair(b.mass_stop(), b.mass_lsp()));
+      if (point != missing_nano.end()) weight = point->second;
+    }
 
     return weight;
-  });
+  }));
 
 
-  const NamedFunc failTauVetos("failTauVetos",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc failTauVetos = FunctionParser::Register(NamedFunc("failTauVetos",[](const Baby &b) -> NamedFunc::ScalarType{
     if(!b.PassTauVeto() || !b.PassTauVeto()) return 1.;
     else return 0.;
-    });
-  const NamedFunc yearWeight("yearWeight",[](const Baby &b) -> NamedFunc::ScalarType{
+    }));
+  //Only depends on the year and on whether the sample is data, so evaluate once per file
+  const NamedFunc yearWeight = FunctionParser::Register(NamedFunc("yearWeight",[](const Baby &b) -> NamedFunc::ScalarType{
     
     float weight=0;
     if(b.genmet()==-9999) weight =1.;//DATA
@@ -105,10 +116,10 @@ float deepTag2018 = 0.8365;
      else if(b.year()==2018)  weight = 59.7 / totalLumi;
     }
     return weight;
-    });
+    }).FileInvariant(true));
 
   //Temporary hack
-  const NamedFunc ST_up("ST_up",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc ST_up = FunctionParser::Register(NamedFunc("ST_up",[](const Baby &b) -> NamedFunc::ScalarType{
       if(b.genmet()==-9999) return 1.; //data
       int nTop = 0; 
       for(unsigned i(0); i<b.gen_id()->size(); i++){
@@ -116,8 +127,8 @@ float deepTag2018 = 0.8365;
       }
       if(nTop==1) return 1.5;
       else return 1.;
-  });
-  const NamedFunc ST_off("ST_off",[](const Baby &b) -> NamedFunc::ScalarType{
+  }));
+  const NamedFunc ST_off = FunctionParser::Register(NamedFunc("ST_off",[](const Baby &b) -> NamedFunc::ScalarType{
       if(b.genmet()==-9999) return 1.; //data
       int nTop = 0; 
       for(unsigned i(0); i<b.gen_id()->size(); i++){
@@ -125,8 +136,8 @@ float deepTag2018 = 0.8365;
       }
       if(nTop==1) return 0.;
       else return 1.;
-  });
-  const NamedFunc ST_down("ST_down",[](const Baby &b) -> NamedFunc::ScalarType{
+  }));
+  const NamedFunc ST_down = FunctionParser::Register(NamedFunc("ST_down",[](const Baby &b) -> NamedFunc::ScalarType{
       if(b.genmet()==-9999) return 1.; //data
       int nTop = 0; 
       for(unsigned i(0); i<b.gen_id()->size(); i++){
@@ -134,8 +145,8 @@ float deepTag2018 = 0.8365;
       }
       if(nTop==1) return 0.5;
       else return 1.;
-  });
-  const NamedFunc fake_up("fake_up",[](const Baby &b) -> NamedFunc::ScalarType{
+  }));
+  const NamedFunc fake_up = FunctionParser::Register(NamedFunc("fake_up",[](const Baby &b) -> NamedFunc::ScalarType{
       if(b.genmet()==-9999) return 1.; //data
       int ndeepfakes=0;
       for(unsigned i(0); i<b.ak4pfjets_deepCSV()->size(); i++){
@@ -144,9 +155,9 @@ float deepTag2018 = 0.8365;
       }
       if(ndeepfakes>0) return 1.5;
       else return 1.;
-  });
+  }));
 
-  const NamedFunc fake_down("fake_down",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc fake_down = FunctionParser::Register(NamedFunc("fake_down",[](const Baby &b) -> NamedFunc::ScalarType{
       if(b.genmet()==-9999) return 1.; //data
       int ndeepfakes=0;
       for(unsigned i(0); i<b.ak4pfjets_deepCSV()->size(); i++){
@@ -155,9 +166,9 @@ float deepTag2018 = 0.8365;
       }
       if(ndeepfakes>0) return 0.5;
       else return 1.;
-  });
+  }));
 
-  const NamedFunc VV_up("VV_up",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc VV_up = FunctionParser::Register(NamedFunc("VV_up",[](const Baby &b) -> NamedFunc::ScalarType{
       if(b.genmet()==-9999) return 1.; //data
       int nBoson = 0; 
       for(unsigned i(0); i<b.gen_id()->size(); i++){
@@ -165,8 +176,8 @@ float deepTag2018 = 0.8365;
       }
       if(nBoson>=2) return 1.25;
       else return 1.;
-  });
-  const NamedFunc VV_down("VV_down",[](const Baby &b) -> NamedFunc::ScalarType{
+  }));
+  const NamedFunc VV_down = FunctionParser::Register(NamedFunc("VV_down",[](const Baby &b) -> NamedFunc::ScalarType{
       if(b.genmet()==-9999) return 1.; //data
       int nBoson = 0; 
       for(unsigned i(0); i<b.gen_id()->size(); i++){
@@ -174,9 +185,9 @@ float deepTag2018 = 0.8365;
       }
       if(nBoson>=2) return 0.75;
       else return 1.;
-  });
+  }));
 
-    const NamedFunc ttbar_genmet_fix("ttbar_genmet_fix",[](const Baby &b) -> NamedFunc::ScalarType{
+    const NamedFunc ttbar_genmet_fix = FunctionParser::Register(NamedFunc("ttbar_genmet_fix",[](const Baby &b) -> NamedFunc::ScalarType{
       if(b.genmet()==-9999) return 1.; //data
       //genmet 200=1
       //genmet 540=1.4
@@ -187,8 +198,8 @@ float deepTag2018 = 0.8365;
         if(b.genmet() > 540) ratio_to_2016=1.4;
         return 1./ratio_to_2016;
       }
-  });
-      const NamedFunc ttbar_genmet_antifix("ttbar_genmet_antifix",[](const Baby &b) -> NamedFunc::ScalarType{
+  }));
+      const NamedFunc ttbar_genmet_antifix = FunctionParser::Register(NamedFunc("ttbar_genmet_antifix",[](const Baby &b) -> NamedFunc::ScalarType{
       if(b.genmet()==-9999) return 1.; //data
     //genmet 200=1
     //genmet 540=1.4
@@ -199,9 +210,9 @@ float deepTag2018 = 0.8365;
       if(b.genmet() > 540) ratio_to_2016=1.4;
       return ratio_to_2016;
     }
-});
+}));
 
-  const NamedFunc genmct("genmct",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc genmct = FunctionParser::Register(NamedFunc("genmct",[](const Baby &b) -> NamedFunc::ScalarType{
   float gen_mct=0;
     for (unsigned i(0); i<b.gen_pt()->size(); i++){
     if (abs(b.gen_id()->at(i)) == 5 && abs(b.gen_motherid()->at(i)) == 6 ){
@@ -215,9 +226,9 @@ float deepTag2018 = 0.8365;
     }
   }
   return gen_mct;
-  });
+  }));
 
-  const NamedFunc mct_genpt("mct_genpt",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc mct_genpt = FunctionParser::Register(NamedFunc("mct_genpt",[](const Baby &b) -> NamedFunc::ScalarType{
   float mctgenpt=0;
     for (unsigned i(0); i<b.ak4pfjets_pt()->size(); i++){
     if (abs(b.ak4pfjets_parton_flavor()->at(i)) == 5){
@@ -231,9 +242,9 @@ float deepTag2018 = 0.8365;
     }
   }
   return mctgenpt;
-  });
+  }));
 
-  const NamedFunc nTightb("nTightb",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc nTightb = FunctionParser::Register(NamedFunc("nTightb",[](const Baby &b) -> NamedFunc::ScalarType{
       int nb=0;
       for (unsigned i(0); i<b.ak4pfjets_deepCSV()->size(); i++){
         if (b.ak4pfjets_pt()->at(i)>30. && b.ak4pfjets_deepCSV()->at(i) > (0.8953*(b.year()==2016) + 0.8001*(b.year()==2017) + 0.7527*(b.year()==2018))){
@@ -241,8 +252,8 @@ float deepTag2018 = 0.8365;
         }
       }
       return nb;
-    });
-   const NamedFunc nTightb_jup("nTightb_jup",[](const Baby &b) -> NamedFunc::ScalarType{
+    }));
+   const NamedFunc nTightb_jup = FunctionParser::Register(NamedFunc("nTightb_jup",[](const Baby &b) -> NamedFunc::ScalarType{
       int nb=0;
       for (unsigned i(0); i<b.ak4pfjets_deepCSV()->size(); i++){
         if (b.ak4pfjets_pt_jup()->at(i)>30. && b.ak4pfjets_deepCSV()->at(i) > (0.8953*(b.year()==2016) + 0.8001*(b.year()==2017) + 0.7527*(b.year()==2018))){
@@ -250,8 +261,8 @@ float deepTag2018 = 0.8365;
         }
       }
       return nb;
-    });
-   const NamedFunc nTightb_jdown("nTightb_jdown",[](const Baby &b) -> NamedFunc::ScalarType{
+    }));
+   const NamedFunc nTightb_jdown = FunctionParser::Register(NamedFunc("nTightb_jdown",[](const Baby &b) -> NamedFunc::ScalarType{
       int nb=0;
       for (unsigned i(0); i<b.ak4pfjets_deepCSV()->size(); i++){
         if (b.ak4pfjets_pt_jdown()->at(i)>30. && b.ak4pfjets_deepCSV()->at(i) > (0.8953*(b.year()==2016) + 0.8001*(b.year()==2017) + 0.7527*(b.year()==2018))){
@@ -259,10 +270,10 @@ float deepTag2018 = 0.8365;
         }
       }
       return nb;
-    });
+    }));
 
 
-   const NamedFunc nMedb("nMedb",[](const Baby &b) -> NamedFunc::ScalarType{
+   const NamedFunc nMedb = FunctionParser::Register(NamedFunc("nMedb",[](const Baby &b) -> NamedFunc::ScalarType{
       int nb=0;
       for (unsigned i(0); i<b.ak4pfjets_deepCSV()->size(); i++){
         if (b.ak4pfjets_pt()->at(i)>30. && b.ak4pfjets_deepCSV()->at(i) > (0.6321*(b.year()==2016) + 0.4941*(b.year()==2017) + 0.4184*(b.year()==2018))){
@@ -270,9 +281,9 @@ float deepTag2018 = 0.8365;
         }
       }
       return nb;
-    });
+    }));
 
-   const NamedFunc nMedb_jup("nMedb_jup",[](const Baby &b) -> NamedFunc::ScalarType{
+   const NamedFunc nMedb_jup = FunctionParser::Register(NamedFunc("nMedb_jup",[](const Baby &b) -> NamedFunc::ScalarType{
       int nb=0;
       for (unsigned i(0); i<b.ak4pfjets_pt_jup()->size(); i++){
         if (b.ak4pfjets_pt_jup()->at(i)>30. && b.ak4pfjets_deepCSV()->at(i) > (0.6321*(b.year()==2016) + 0.4941*(b.year()==2017) + 0.4184*(b.year()==2018))){
@@ -280,9 +291,9 @@ float deepTag2018 = 0.8365;
         }
       }
       return nb;
-    });
+    }));
 
-   const NamedFunc nMedb_jdown("nMedb_jdown",[](const Baby &b) -> NamedFunc::ScalarType{
+   const NamedFunc nMedb_jdown = FunctionParser::Register(NamedFunc("nMedb_jdown",[](const Baby &b) -> NamedFunc::ScalarType{
       int nb=0;
       for (unsigned i(0); i<b.ak4pfjets_pt_jdown()->size(); i++){
         if (b.ak4pfjets_pt_jdown()->at(i)>30. && b.ak4pfjets_deepCSV()->at(i) > (0.6321*(b.year()==2016) + 0.4941*(b.year()==2017) + 0.4184*(b.year()==2018))){
@@ -290,9 +301,9 @@ float deepTag2018 = 0.8365;
         }
       }
       return nb;
-    });
+    }));
 
-   const NamedFunc nLooseb("nLooseb",[](const Baby &b) -> NamedFunc::ScalarType{
+   const NamedFunc nLooseb = FunctionParser::Register(NamedFunc("nLooseb",[](const Baby &b) -> NamedFunc::ScalarType{
       int nb=0;
       for (unsigned i(0); i<b.ak4pfjets_deepCSV()->size(); i++){
         if (b.ak4pfjets_pt()->at(i)>30. && b.ak4pfjets_deepCSV()->at(i) > (0.2217*(b.year()==2016) + 0.1522*(b.year()==2017) + 0.1241*(b.year()==2018))){
@@ -300,9 +311,9 @@ float deepTag2018 = 0.8365;
         }
       }
       return nb;
-    });
+    }));
 
-      const NamedFunc nLooseb_jup("nLooseb_jup",[](const Baby &b) -> NamedFunc::ScalarType{
+      const NamedFunc nLooseb_jup = FunctionParser::Register(NamedFunc("nLooseb_jup",[](const Baby &b) -> NamedFunc::ScalarType{
       int nb=0;
       for (unsigned i(0); i<b.ak4pfjets_deepCSV()->size(); i++){
         if (b.ak4pfjets_pt_jup()->at(i)>30. && b.ak4pfjets_deepCSV()->at(i) > (0.2217*(b.year()==2016) + 0.1522*(b.year()==2017) + 0.1241*(b.year()==2018))){
@@ -310,9 +321,9 @@ float deepTag2018 = 0.8365;
         }
       }
       return nb;
-    });
+    }));
 
-       const NamedFunc nLooseb_jdown("nLooseb_jdown",[](const Baby &b) -> NamedFunc::ScalarType{
+       const NamedFunc nLooseb_jdown = FunctionParser::Register(NamedFunc("nLooseb_jdown",[](const Baby &b) -> NamedFunc::ScalarType{
       int nb=0;
       for (unsigned i(0); i<b.ak4pfjets_deepCSV()->size(); i++){
         if (b.ak4pfjets_pt_jdown()->at(i)>30. && b.ak4pfjets_deepCSV()->at(i) > (0.2217*(b.year()==2016) + 0.1522*(b.year()==2017) + 0.1241*(b.year()==2018))){
@@ -320,9 +331,9 @@ float deepTag2018 = 0.8365;
         }
       }
       return nb;
-    });
+    }));
 
-  const NamedFunc nEventsGluonSplit("nEventsGluonSplit",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc nEventsGluonSplit = FunctionParser::Register(NamedFunc("nEventsGluonSplit",[](const Baby &b) -> NamedFunc::ScalarType{
     int nevent = 0;
 
     for(unsigned i(0); i<b.gen_id()->size(); i++){
@@ -336,9 +347,9 @@ float deepTag2018 = 0.8365;
     }//Close for loop over all particles in event
     return nevent;
 
-    });
+    }));
 
-  const NamedFunc nModEventsGluonSplit("nModEventsGluonSplit",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc nModEventsGluonSplit = FunctionParser::Register(NamedFunc("nModEventsGluonSplit",[](const Baby &b) -> NamedFunc::ScalarType{
     int nevent = 0;
     int ngenb = 0;
 
@@ -357,43 +368,43 @@ float deepTag2018 = 0.8365;
 
     return nevent;
 
-    });
+    }));
 
-  const NamedFunc NHighPtNu("NHighPtNu",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc NHighPtNu = FunctionParser::Register(NamedFunc("NHighPtNu",[](const Baby &b) -> NamedFunc::ScalarType{
       int nnu=0;
         for (unsigned i(0); i<b.gen_pt()->size(); i++){
         if (abs(b.gen_motherid()->at(i))==24 && ( abs(b.gen_id()->at(i)) == 12 || abs(b.gen_id()->at(i)) == 14 || abs(b.gen_id()->at(i)) == 16) && b.gen_pt()->at(i) > 200 ) nnu++;
       }
       return nnu;
-      });
+      }));
 
-  const NamedFunc HighNuPt("HighNuPt",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc HighNuPt = FunctionParser::Register(NamedFunc("HighNuPt",[](const Baby &b) -> NamedFunc::ScalarType{
       float max_nupt=0;
         for (unsigned i(0); i<b.gen_pt()->size(); i++){
          if (abs(b.gen_motherid()->at(i))==24 && ( abs(b.gen_id()->at(i)) == 12 || abs(b.gen_id()->at(i)) == 14 || abs(b.gen_id()->at(i)) == 16) &&  b.gen_pt()->at(i) > max_nupt) max_nupt = b.gen_pt()->at(i);
       }
       return max_nupt;
-      });
+      }));
 
 
-  const NamedFunc zpt("zpt",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc zpt = FunctionParser::Register(NamedFunc("zpt",[](const Baby &b) -> NamedFunc::ScalarType{
     float z_pt=0;
       for (unsigned i(0); i<b.gen_pt()->size(); i++){
       if ( abs(b.gen_id()->at(i)) == 23) z_pt = b.gen_pt()->at(i);
     }
     return z_pt;
-    });
+    }));
 
-  const NamedFunc wpt("wpt",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc wpt = FunctionParser::Register(NamedFunc("wpt",[](const Baby &b) -> NamedFunc::ScalarType{
     float w_pt=-1;
       for (unsigned i(0); i<b.gen_pt()->size(); i++){
       if ( abs(b.gen_id()->at(i)) == 24) w_pt = b.gen_pt()->at(i);
     }
     return w_pt;
-    });
+    }));
 
   
-  const NamedFunc wpt_lnu("wpt_lnu",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc wpt_lnu = FunctionParser::Register(NamedFunc("wpt_lnu",[](const Baby &b) -> NamedFunc::ScalarType{
     // this only works like this because the gen collection is so pruned. otherwise a more careful check of the lepton/neutrino history would be necessary
     float w_pt=-1;
     TLorentzVector n1;
@@ -408,18 +419,18 @@ float deepTag2018 = 0.8365;
     }
     w_pt = (l1+n1).Pt(); 
     return w_pt;
-    });
+    }));
 
-  const NamedFunc higgs_pt("higgs_pt",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc higgs_pt = FunctionParser::Register(NamedFunc("higgs_pt",[](const Baby &b) -> NamedFunc::ScalarType{
     float h_pt=0;
       for (unsigned i(0); i<b.gen_pt()->size(); i++){
       if ( abs(b.gen_id()->at(i)) == 25) h_pt = b.gen_pt()->at(i);
     }
     return h_pt;
-    });
+    }));
 
   // count the number of b's in the fat jet
-  const NamedFunc nBInFatJet("nBInFatJet",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc nBInFatJet = FunctionParser::Register(NamedFunc("nBInFatJet",[](const Baby &b) -> NamedFunc::ScalarType{
       int nBinFat=0;
       for (unsigned i(0); i<b.ak8pfjets_deepdisc_hbb()->size(); i++){
       	if (b.ak8pfjets_pt()->at(i) > 200){
@@ -433,9 +444,9 @@ float deepTag2018 = 0.8365;
         }
       }
       return nBinFat;
-    });
+    }));
 
-  const NamedFunc higgsMistagSF("higgsMistagSF",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc higgsMistagSF = FunctionParser::Register(NamedFunc("higgsMistagSF",[](const Baby &b) -> NamedFunc::ScalarType{
       // based on method 1a of https://twiki.cern.ch/twiki/bin/view/CMS/BTagSFMethods
       float PData=1.;
       float PMC=1.;
@@ -483,10 +494,10 @@ float deepTag2018 = 0.8365;
       }
       float weight=PData/PMC;
       return weight;
-    });
+    }).Pure(true));
 
 
-  const NamedFunc higgsMistagSFUp("higgsMistagSFUp",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc higgsMistagSFUp = FunctionParser::Register(NamedFunc("higgsMistagSFUp",[](const Baby &b) -> NamedFunc::ScalarType{
       // based on method 1a of https://twiki.cern.ch/twiki/bin/view/CMS/BTagSFMethods
       float PData=1.;
       float PMC=1.;
@@ -534,9 +545,9 @@ float deepTag2018 = 0.8365;
       }
       float weight=PData/PMC;
       return weight;
-    });
+    }));
 
-  const NamedFunc higgsMistagSFDown("higgsMistagSFDown",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc higgsMistagSFDown = FunctionParser::Register(NamedFunc("higgsMistagSFDown",[](const Baby &b) -> NamedFunc::ScalarType{
       // based on method 1a of https://twiki.cern.ch/twiki/bin/view/CMS/BTagSFMethods
       float PData=1.;
       float PMC=1.;
@@ -584,16 +595,16 @@ float deepTag2018 = 0.8365;
       }
       float weight=PData/PMC;
       return weight;
-    });
+    }));
 
 
   // get the mistag probablility for higgs
-  const NamedFunc higgsMistagProb("higgsMistagProb",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc higgsMistagProb = FunctionParser::Register(NamedFunc("higgsMistagProb",[](const Baby &b) -> NamedFunc::ScalarType{
       float prob=1;
       float mistag=0;
       bool lepsInFatJet=false;
-      // load the map. need to fix hardcoding the path
-      TFile *mapFile = new TFile("/home/users/dspitzba/WH/CMSSW_10_2_9/src/WH_studies/Analysis/python/eff_pt_mass_allYears_QCD_combined.root", "READ");
+      // get the maps, loaded from file only on first use. need to fix hardcoding the path
+      const string mapFile = "/home/users/dspitzba/WH/CMSSW_10_2_9/src/WH_studies/Analysis/python/eff_pt_mass_allYears_QCD_combined.root";
       TString eff_2b = "eff_pt_mass_2b";
       TString eff_1b = "eff_pt_mass_1b";
       TString eff_0b = "eff_pt_mass_0b";
@@ -612,12 +623,9 @@ float deepTag2018 = 0.8365;
         eff_1b += TString("_2018");
         eff_0b += TString("_2018");
       }
-      TH2* effMap_2b = 0;
-      TH2* effMap_1b = 0;
-      TH2* effMap_0b = 0;
-      mapFile->GetObject(eff_2b, effMap_2b);
-      mapFile->GetObject(eff_1b, effMap_1b);
-      mapFile->GetObject(eff_0b, effMap_0b);
+      const CalibrationMap &effMap_2b = CalibrationMap::Get(mapFile, eff_2b.Data());
+      const CalibrationMap &effMap_1b = CalibrationMap::Get(mapFile, eff_1b.Data());
+      const CalibrationMap &effMap_0b = CalibrationMap::Get(mapFile, eff_0b.Data());
       for (unsigned i(0); i<b.ak8pfjets_deepdisc_hbb()->size(); i++){
         lepsInFatJet=false;
         int nBInFat=0;
@@ -645,28 +653,25 @@ float deepTag2018 = 0.8365;
             }
             // get the rate for the fat jet
             if (nBInFat==2){
-                mistag = effMap_2b->GetBinContent(effMap_2b->GetXaxis()->FindBin(b.ak8pfjets_pt()->at(i)), effMap_2b->GetYaxis()->FindBin(b.ak8pfjets_m()->at(i)));
+                mistag = effMap_2b.Value(b.ak8pfjets_pt()->at(i), b.ak8pfjets_m()->at(i));
             }
             else if (nBInFat==1){
-                mistag = effMap_1b->GetBinContent(effMap_1b->GetXaxis()->FindBin(b.ak8pfjets_pt()->at(i)), effMap_1b->GetYaxis()->FindBin(b.ak8pfjets_m()->at(i)));
+                mistag = effMap_1b.Value(b.ak8pfjets_pt()->at(i), b.ak8pfjets_m()->at(i));
                 //mistag = 0;
             }
             else {
-                mistag = effMap_0b->GetBinContent(effMap_0b->GetXaxis()->FindBin(b.ak8pfjets_pt()->at(i)), effMap_0b->GetYaxis()->FindBin(b.ak8pfjets_m()->at(i)));
+                mistag = effMap_0b.Value(b.ak8pfjets_pt()->at(i), b.ak8pfjets_m()->at(i));
                 //mistag = 0;
             }
             prob = prob*(1-mistag);
         }
       }
-      // clean up
-      mapFile->Close();
-      delete mapFile;
       //std::cout << "prob: " << (1-prob) << std::endl;
       return 1-prob;
-    });
+    }));
 
   // get the number of b-tagged jets in fat jets
-  const NamedFunc nBTagInFat("nBTagInFat",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc nBTagInFat = FunctionParser::Register(NamedFunc("nBTagInFat",[](const Baby &b) -> NamedFunc::ScalarType{
       int nBInFat=0;
       bool lepsInFatJet=false;
       for (unsigned i(0); i<b.ak8pfjets_deepdisc_hbb()->size(); i++){
@@ -691,11 +696,11 @@ float deepTag2018 = 0.8365;
         }
       }
       return nBInFat;
-    });
+    }));
 
 
 
-  const NamedFunc OneDoubleBFat("OneDoubleBFat",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc OneDoubleBFat = FunctionParser::Register(NamedFunc("OneDoubleBFat",[](const Baby &b) -> NamedFunc::ScalarType{
       int nBInFat=0;
       int nDoubleBFat=0;
       bool lepsInFatJet=false;
@@ -724,9 +729,9 @@ float deepTag2018 = 0.8365;
         if (nBinThisFat==2) nDoubleBFat++;
       }
       return nDoubleBFat==1;
-    });
+    }));
 
-  const NamedFunc OneDoubleBFatNanoV0("OneDoubleBFatNanoV0",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc OneDoubleBFatNanoV0 = FunctionParser::Register(NamedFunc("OneDoubleBFatNanoV0",[](const Baby &b) -> NamedFunc::ScalarType{
       int nDoubleBFat=0;
       bool lepsInFatJet=false;
       for (unsigned i(0); i<b.FatJet_pt()->size(); i++){
@@ -753,9 +758,9 @@ float deepTag2018 = 0.8365;
         if (nBinThisFat==2) nDoubleBFat++;
       }
       return nDoubleBFat==1;
-    });
+    }));
 
-  const NamedFunc OneDoubleBFatNano("OneDoubleBFatNano",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc OneDoubleBFatNano = FunctionParser::Register(NamedFunc("OneDoubleBFatNano",[](const Baby &b) -> NamedFunc::ScalarType{
       int nDoubleBFat=0;
       bool lepsInFatJet=false;
       for (unsigned i(0); i<b.FatJet_pt()->size(); i++){
@@ -789,10 +794,10 @@ float deepTag2018 = 0.8365;
         if (nBinThisFat==2) nDoubleBFat++;
       }
       return nDoubleBFat==1;
-    });
+    }));
 
   // nFatJets with pt>250
-  const NamedFunc nFatJet250("nFatJet250",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc nFatJet250 = FunctionParser::Register(NamedFunc("nFatJet250",[](const Baby &b) -> NamedFunc::ScalarType{
       int nloose=0;
       //      for (unsigned i(0); i<b.FatJet_pt()->size(); i++){
       for (unsigned i(0); i<b.FatJet_pt_nom()->size(); i++){
@@ -800,7 +805,7 @@ float deepTag2018 = 0.8365;
 	if (b.FatJet_pt_nom()->at(i) > 250) nloose++;
       }
       return nloose;
-    });
+    }));
 
   std::vector<unsigned> binsSF = {200,300,400,500,600};
 //  std::vector<float> const signalSF2016 = {0.99, 1.00, 0.97, 0.91, 0.95};
@@ -851,7 +856,7 @@ float deepTag2018 = 0.8365;
   //  std::vector<float> const fullEff2017_750_1 = fullEff2018_750_1;//placeholder
   std::vector<float> const fullEff2017_750_1 = {0.7933, 0.88};//placeholder
 
-  const NamedFunc signalHiggsMistagSF("signalHiggsMistagSF",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc signalHiggsMistagSF = FunctionParser::Register(NamedFunc("signalHiggsMistagSF",[](const Baby &b) -> NamedFunc::ScalarType{
       // based on method 1a of https://twiki.cern.ch/twiki/bin/view/CMS/BTagSFMethods
       float PFast = 1.;
       float PFull = 1.;
@@ -1006,9 +1011,9 @@ float deepTag2018 = 0.8365;
       }
       float weight=(PFull/PFast)*(PData/PMC);
       return weight;
-    });
+    }));
 
-  const NamedFunc signalHiggsMistagSFUp("signalHiggsMistagSFUp",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc signalHiggsMistagSFUp = FunctionParser::Register(NamedFunc("signalHiggsMistagSFUp",[](const Baby &b) -> NamedFunc::ScalarType{
       // based on method 1a of https://twiki.cern.ch/twiki/bin/view/CMS/BTagSFMethods
       float PFast = 1.;
       float PFull = 1.;
@@ -1180,9 +1185,9 @@ float deepTag2018 = 0.8365;
       }
       float weight=(PFull/PFast)*(PData/PMC);
       return weight;
-    });
+    }));
 
-  const NamedFunc signalHiggsMistagSFDown("signalHiggsMistagSFDown",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc signalHiggsMistagSFDown = FunctionParser::Register(NamedFunc("signalHiggsMistagSFDown",[](const Baby &b) -> NamedFunc::ScalarType{
       // based on method 1a of https://twiki.cern.ch/twiki/bin/view/CMS/BTagSFMethods
       float PFast = 1.;
       float PFull = 1.;
@@ -1355,11 +1360,11 @@ float deepTag2018 = 0.8365;
       }
       float weight=(PFull/PFast)*(PData/PMC);
       return weight;
-    });
+    }));
 
   //%%%%%%%%%%%%%%%%%%%%%%%%%
   // nFatJets with pt>250 and 0 b jets
-  const NamedFunc nFatJet250b0("nFatJet250b0",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc nFatJet250b0 = FunctionParser::Register(NamedFunc("nFatJet250b0",[](const Baby &b) -> NamedFunc::ScalarType{
       int nFatJet250_0b = 0;
       unsigned highest_pt_idx = 0;
       float old_pt = 0;
@@ -1404,10 +1409,10 @@ float deepTag2018 = 0.8365;
       //    } 
       if(nFatJet250_0b > 1) printf("b0 fjerr: %d\n", nFatJet250_0b);
       return nFatJet250_0b;
-    });
+    }));
 
   // nFatJets with pt>250 and 1 b jet
-  const NamedFunc nFatJet250b1("nFatJet250b1",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc nFatJet250b1 = FunctionParser::Register(NamedFunc("nFatJet250b1",[](const Baby &b) -> NamedFunc::ScalarType{
       int nFatJet250_1b = 0;
       unsigned highest_pt_idx = 0;
       float old_pt = 0;
@@ -1452,10 +1457,10 @@ float deepTag2018 = 0.8365;
 	//      } 
       if(nFatJet250_1b > 1) printf("b1 fjerr: %d\n", nFatJet250_1b);
       return nFatJet250_1b;
-    });
+    }));
   
   // nFatJets with pt>250 and 2 b jets
-  const NamedFunc nFatJet250b2("nFatJet250b2",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc nFatJet250b2 = FunctionParser::Register(NamedFunc("nFatJet250b2",[](const Baby &b) -> NamedFunc::ScalarType{
       int nFatJet250_2b = 0;
       unsigned highest_pt_idx = 0;
       float old_pt = 0;      
@@ -1500,10 +1505,10 @@ float deepTag2018 = 0.8365;
       //    } 
       if(nFatJet250_2b > 1) printf("b2 fjerr: %d\n", nFatJet250_2b);
       return nFatJet250_2b;
-    });
+    }));
 
   // Higgs-tagged nFatJets with pt>250 and 0 b jets  
-  const NamedFunc nHiggsFatJet250b0("nHiggsFatJet250b0",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc nHiggsFatJet250b0 = FunctionParser::Register(NamedFunc("nHiggsFatJet250b0",[](const Baby &b) -> NamedFunc::ScalarType{
       int nHiggsFatJet250_0b = 0;
       unsigned highest_pt_idx = 0;
       float old_pt = 0;
@@ -1553,10 +1558,10 @@ float deepTag2018 = 0.8365;
       //    } 
       if(nHiggsFatJet250_0b > 1) printf("Higgs b0 fjerr: %d\n", nHiggsFatJet250_0b);
       return nHiggsFatJet250_0b;
-    });
+    }));
   
   // Higgs-tagged nFatJets with pt>250 and 1 b jet
-  const NamedFunc nHiggsFatJet250b1("nHiggsFatJet250b1",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc nHiggsFatJet250b1 = FunctionParser::Register(NamedFunc("nHiggsFatJet250b1",[](const Baby &b) -> NamedFunc::ScalarType{
       int nHiggsFatJet250_1b = 0;
       unsigned highest_pt_idx = 0;
       float old_pt = 0;      
@@ -1606,10 +1611,10 @@ float deepTag2018 = 0.8365;
       //    } 
       if(nHiggsFatJet250_1b > 1) printf("Higgs b1 fjerr: %d\n", nHiggsFatJet250_1b);
       return nHiggsFatJet250_1b;
-    });
+    }));
     
   // Higgs-tagged nFatJets with pt>250 and 2 b jets
-  const NamedFunc nHiggsFatJet250b2("nHiggsFatJet250b2",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc nHiggsFatJet250b2 = FunctionParser::Register(NamedFunc("nHiggsFatJet250b2",[](const Baby &b) -> NamedFunc::ScalarType{
       int nHiggsFatJet250_2b = 0;
       unsigned highest_pt_idx = 0;
       float old_pt = 0;      
@@ -1659,13 +1664,13 @@ float deepTag2018 = 0.8365;
       //    } 
       if(nHiggsFatJet250_2b > 1) printf("Higgs b2 fjerr: %d\n", nHiggsFatJet250_2b);
       return nHiggsFatJet250_2b;
-    });
+    }));
 
   //%%%%%%%%%%%%%%% 
   // Considering only Fat Jets with gen H
 
   // nFatJets (with gen H) with pt>250
-  const NamedFunc nGenHFatJet250("nGenHFatJet250",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc nGenHFatJet250 = FunctionParser::Register(NamedFunc("nGenHFatJet250",[](const Baby &b) -> NamedFunc::ScalarType{
       int nGenHFatJet250_ = 0;
       unsigned highest_pt_idx = 0;
       float old_pt = 0;      
@@ -1723,10 +1728,10 @@ float deepTag2018 = 0.8365;
 	}
       } //else {printf("No higgs\n");}
       return nGenHFatJet250_;
-    });
+    }));
   
   // Higgs-tagged nFatJets (with gen H) with pt>250 
-  const NamedFunc nGenHHiggsFatJet250("nGenHHiggsFatJet250",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc nGenHHiggsFatJet250 = FunctionParser::Register(NamedFunc("nGenHHiggsFatJet250",[](const Baby &b) -> NamedFunc::ScalarType{
       int nGenHHiggsFatJet250_ = 0;
       unsigned highest_pt_idx = 0;
       float old_pt = 0;
@@ -1789,10 +1794,10 @@ float deepTag2018 = 0.8365;
 	}
       } //else {printf("No higgs\n");}
       return nGenHHiggsFatJet250_;
-    });
+    }));
 
   // nFatJets (with gen H) with pt>250 and 0 b jets
-  const NamedFunc nGenHFatJet250b0("nGenHFatJet250b0",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc nGenHFatJet250b0 = FunctionParser::Register(NamedFunc("nGenHFatJet250b0",[](const Baby &b) -> NamedFunc::ScalarType{
       int nFatJet250_0b = 0;
       unsigned highest_pt_idx = 0;
       float old_pt = 0;
@@ -1852,10 +1857,10 @@ float deepTag2018 = 0.8365;
       //    } 
       if(nFatJet250_0b > 1) printf("b0 fjerr: %d\n", nFatJet250_0b);
       return nFatJet250_0b;
-    });
+    }));
 
   // nFatJets (with gen H) with pt>250 and 1 b jet
-  const NamedFunc nGenHFatJet250b1("nGenHFatJet250b1",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc nGenHFatJet250b1 = FunctionParser::Register(NamedFunc("nGenHFatJet250b1",[](const Baby &b) -> NamedFunc::ScalarType{
       int nFatJet250_1b = 0;
       unsigned highest_pt_idx = 0;
       float old_pt = 0;
@@ -1915,10 +1920,10 @@ float deepTag2018 = 0.8365;
       //      } 
       if(nFatJet250_1b > 1) printf("b1 fjerr: %d\n", nFatJet250_1b);
       return nFatJet250_1b;
-    });
+    }));
   
   // nFatJets (with gen H) with pt>250 and 2 b jets
-  const NamedFunc nGenHFatJet250b2("nGenHFatJet250b2",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc nGenHFatJet250b2 = FunctionParser::Register(NamedFunc("nGenHFatJet250b2",[](const Baby &b) -> NamedFunc::ScalarType{
       int nFatJet250_2b = 0;
       unsigned highest_pt_idx = 0;
       float old_pt = 0;      
@@ -1978,10 +1983,10 @@ float deepTag2018 = 0.8365;
       //    } 
       if(nFatJet250_2b > 1) printf("b2 fjerr: %d\n", nFatJet250_2b);
       return nFatJet250_2b;
-    });
+    }));
   
   // Higgs-tagged nFatJets (with gen H) with pt>250 and 0 b jets  
-  const NamedFunc nGenHHiggsFatJet250b0("nGenHHiggsFatJet250b0",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc nGenHHiggsFatJet250b0 = FunctionParser::Register(NamedFunc("nGenHHiggsFatJet250b0",[](const Baby &b) -> NamedFunc::ScalarType{
       int nHiggsFatJet250_0b = 0;
       unsigned highest_pt_idx = 0;
       float old_pt = 0;
@@ -2046,10 +2051,10 @@ float deepTag2018 = 0.8365;
       //    } 
       if(nHiggsFatJet250_0b > 1) printf("Higgs b0 fjerr: %d\n", nHiggsFatJet250_0b);
       return nHiggsFatJet250_0b;
-    });
+    }));
   
   // Higgs-tagged nFatJets (with gen H) with pt>250 and 1 b jet
-  const NamedFunc nGenHHiggsFatJet250b1("nGenHHiggsFatJet250b1",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc nGenHHiggsFatJet250b1 = FunctionParser::Register(NamedFunc("nGenHHiggsFatJet250b1",[](const Baby &b) -> NamedFunc::ScalarType{
       int nHiggsFatJet250_1b = 0;
       unsigned highest_pt_idx = 0;
       float old_pt = 0;      
@@ -2114,10 +2119,10 @@ float deepTag2018 = 0.8365;
       //    } 
       if(nHiggsFatJet250_1b > 1) printf("Higgs b1 fjerr: %d\n", nHiggsFatJet250_1b);
       return nHiggsFatJet250_1b;
-    });
+    }));
   
   // Higgs-tagged nFatJets (with Gen H) with pt>250 and 2 b jets
-  const NamedFunc nGenHHiggsFatJet250b2("nGenHHiggsFatJet250b2",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc nGenHHiggsFatJet250b2 = FunctionParser::Register(NamedFunc("nGenHHiggsFatJet250b2",[](const Baby &b) -> NamedFunc::ScalarType{
       int nHiggsFatJet250_2b = 0;
       unsigned highest_pt_idx = 0;
       float old_pt = 0;      
@@ -2182,10 +2187,10 @@ float deepTag2018 = 0.8365;
       //    } 
       if(nHiggsFatJet250_2b > 1) printf("Higgs b2 fjerr: %d\n", nHiggsFatJet250_2b);
       return nHiggsFatJet250_2b;
-    });
+    }));
 
   // returns highest fat jet pt
-  const NamedFunc highest_FatJet_pt("highest_FatJet_pt",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc highest_FatJet_pt = FunctionParser::Register(NamedFunc("highest_FatJet_pt",[](const Baby &b) -> NamedFunc::ScalarType{
       printf("in here\n");
       float highest_pt = 0;
       float new_highest_pt = 0;
@@ -2197,21 +2202,21 @@ float deepTag2018 = 0.8365;
       }
       printf("highest pt is %f\n", highest_pt);
       return highest_pt;
-    });
+    }));
 
   //%%%%%%%%%%%%%%%%%%%%%%%%%
 
   // first attempt for boosted higgs part
-  const NamedFunc nBoostedFatJet("nBoostedFatJet",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc nBoostedFatJet = FunctionParser::Register(NamedFunc("nBoostedFatJet",[](const Baby &b) -> NamedFunc::ScalarType{
       int nloose=0;
       for (unsigned i(0); i<b.ak8pfjets_deepdisc_hbb()->size(); i++){
       	if (b.ak8pfjets_pt()->at(i) > 200) nloose++;
       }
       return nloose;
-    });
+    }).Pure(true));
 
   // first attempt for boosted higgs part
-  const NamedFunc HasBoostedHiggs("HasBoostedHiggs",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc HasBoostedHiggs = FunctionParser::Register(NamedFunc("HasBoostedHiggs",[](const Baby &b) -> NamedFunc::ScalarType{
       int nloose=0;
       int nmedium=0;
       for (unsigned i(0); i<b.ak8pfjets_deepdisc_hbb()->size(); i++){
@@ -2220,20 +2225,20 @@ float deepTag2018 = 0.8365;
       }
       if(nloose>=1 && nmedium>=1) return 1;
       else return 0;
-    });
+    }));
 
   // first attempt for boosted higgs part
-  const NamedFunc HasOnHiggsJet("HasOnHiggsJet",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc HasOnHiggsJet = FunctionParser::Register(NamedFunc("HasOnHiggsJet",[](const Baby &b) -> NamedFunc::ScalarType{
       int nmedium=0;
       for (unsigned i(0); i<b.ak8pfjets_deepdisc_hbb()->size(); i++){
       	if (b.ak8pfjets_m()->at(i) > 90 && b.ak8pfjets_m()->at(i) < 150 && b.ak8pfjets_pt()->at(i) > 200) nmedium++;
       }
       if(nmedium>=1) return 1;
       else return 0;
-    });
+    }));
 
   // boosted AK8 jet, higgs-tagged, with now lepton overlap
-  const NamedFunc HasBoostedHiggsNoLepton("HasBoostedHiggsNoLepton",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc HasBoostedHiggsNoLepton = FunctionParser::Register(NamedFunc("HasBoostedHiggsNoLepton",[](const Baby &b) -> NamedFunc::ScalarType{
       int nmedium=0;
       bool lepsInFatJet=false;
       for (unsigned i(0); i<b.ak8pfjets_deepdisc_hbb()->size(); i++){
@@ -2248,36 +2253,36 @@ float deepTag2018 = 0.8365;
       }
       if(nmedium>=1) return 1;
       else return 0;
-    });
+    }));
 
-  const NamedFunc HasReallyBoostedHiggs("HasReallyBoostedHiggs",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc HasReallyBoostedHiggs = FunctionParser::Register(NamedFunc("HasReallyBoostedHiggs",[](const Baby &b) -> NamedFunc::ScalarType{
       int nmedium=0;
       for (unsigned i(0); i<b.ak8pfjets_deepdisc_hbb()->size(); i++){
       	if (b.ak8pfjets_deepdisc_hbb()->at(i) > 0.90 && b.ak8pfjets_pt()->at(i) > 400) nmedium++;
       }
       if(nmedium>=1) return 1;
       else return 0;
-    });
+    }));
 
   // first attempt for boosted higgs part
-  const NamedFunc nVLooseHiggsTags("nVLooseHiggsTags",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc nVLooseHiggsTags = FunctionParser::Register(NamedFunc("nVLooseHiggsTags",[](const Baby &b) -> NamedFunc::ScalarType{
       int nloose=0;
       for (unsigned i(0); i<b.ak8pfjets_deepdisc_hbb()->size(); i++){
       	if (b.ak8pfjets_deepdisc_hbb()->at(i) > 0.50) nloose++;
       }
       return nloose;
-    });
+    }));
 
   // first attempt for boosted higgs part
-  const NamedFunc nLooseHiggsTags("nLooseHiggsTags",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc nLooseHiggsTags = FunctionParser::Register(NamedFunc("nLooseHiggsTags",[](const Baby &b) -> NamedFunc::ScalarType{
       int nloose=0;
       for (unsigned i(0); i<b.ak8pfjets_deepdisc_hbb()->size(); i++){
       	if (b.ak8pfjets_deepdisc_hbb()->at(i) > 0.80) nloose++;
       }
       return nloose;
-    });
+    }));
 
-  const NamedFunc HasLooseBoostedHiggs("HasLooseBoostedHiggs",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc HasLooseBoostedHiggs = FunctionParser::Register(NamedFunc("HasLooseBoostedHiggs",[](const Baby &b) -> NamedFunc::ScalarType{
       int nloose=0;
       int nmedium=0;
       for (unsigned i(0); i<b.ak8pfjets_deepdisc_hbb()->size(); i++){
@@ -2286,26 +2291,26 @@ float deepTag2018 = 0.8365;
       }
       if(nloose>=1 && nmedium>=0) return 1;
       else return 0;
-    });
+    }).Pure(true));
 
-    const NamedFunc LeadingToppT("LeadingToppT",[](const Baby &b) -> NamedFunc::ScalarType{
+    const NamedFunc LeadingToppT = FunctionParser::Register(NamedFunc("LeadingToppT",[](const Baby &b) -> NamedFunc::ScalarType{
     float top_pt=0;
       for (unsigned i(0); i<b.gen_pt()->size(); i++){
       if ( abs(b.gen_id()->at(i)) == 6 && b.gen_pt()->at(i) > top_pt ) top_pt = b.gen_pt()->at(i);
     }
     return top_pt;
-    });
+    }));
 
 
-    const NamedFunc LeadingWpT("LeadingWpT",[](const Baby &b) -> NamedFunc::ScalarType{
+    const NamedFunc LeadingWpT = FunctionParser::Register(NamedFunc("LeadingWpT",[](const Baby &b) -> NamedFunc::ScalarType{
     float w_pt=0;
       for (unsigned i(0); i<b.gen_pt()->size(); i++){
       if ( abs(b.gen_id()->at(i)) == 24 && b.gen_pt()->at(i) > w_pt ) w_pt = b.gen_pt()->at(i);
     }
     return w_pt;
-    });
+    }));
 
-    const NamedFunc SubLeadingWpT("SubLeadingWpT",[](const Baby &b) -> NamedFunc::ScalarType{
+    const NamedFunc SubLeadingWpT = FunctionParser::Register(NamedFunc("SubLeadingWpT",[](const Baby &b) -> NamedFunc::ScalarType{
     float w_pt0=0;
     float w_pt1=0;
       for (unsigned i(0); i<b.gen_pt()->size(); i++){
@@ -2313,10 +2318,10 @@ float deepTag2018 = 0.8365;
       else if ( abs(b.gen_id()->at(i)) == 24 && b.gen_pt()->at(i) > w_pt1 ) {w_pt1= b.gen_pt()->at(i);}
     }
     return w_pt1;
-    });
+    }));
 
 
-    const NamedFunc HasHadronicTau("HasHadronicTau",[](const Baby &b) -> NamedFunc::ScalarType{
+    const NamedFunc HasHadronicTau = FunctionParser::Register(NamedFunc("HasHadronicTau",[](const Baby &b) -> NamedFunc::ScalarType{
     int nTau=0;
     int nLepFromTau=0;
       for (unsigned i(0); i<b.gen_pt()->size(); i++){
@@ -2325,34 +2330,34 @@ float deepTag2018 = 0.8365;
     }
     if(nTau - nLepFromTau > 0) return 1.;
     else return 0.;
-    });
+    }));
 
 
-    const NamedFunc n_true_emu("n_true_emu",[](const Baby &b) -> NamedFunc::ScalarType{
+    const NamedFunc n_true_emu = FunctionParser::Register(NamedFunc("n_true_emu",[](const Baby &b) -> NamedFunc::ScalarType{
     int nemu = 0;
 
      for (unsigned i(0); i<b.gen_id()->size(); i++){
         if ((abs(b.gen_id()->at(i))==11 || abs(b.gen_id()->at(i))==13) && (abs(b.gen_motherid()->at(i) == 24)|| abs(b.gen_motherid()->at(i))==15)) nemu++;
     }//Close if
     return nemu;
-    });
+    }));
 
       //Number of b-flavor jets in acceptance but failing tagger.
-      const NamedFunc HasBFailedTag("HasBFailedTag",[](const Baby &b) -> NamedFunc::ScalarType{
+      const NamedFunc HasBFailedTag = FunctionParser::Register(NamedFunc("HasBFailedTag",[](const Baby &b) -> NamedFunc::ScalarType{
       int nfail=0;
       for (unsigned i(0); i<b.ak4pfjets_deepCSV()->size(); i++){
         if (abs(b.ak4pfjets_hadron_flavor()->at(i))==5 && b.ak4pfjets_deepCSV()->at(i) < (0.4941*(b.year()==2017) + 0.6321*(b.year()==2016) + 0.4184*(b.year()==2018))) nfail++;
       }
       return nfail;
 
-    });
+    }));
 
 
    /*
    * returns 1 if there are two b jets with at least one Medium and one Loose score
    * returns 0 otherwise
    */
-  const NamedFunc HasMedLooseCSV("HasMedLooseCSV",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc HasMedLooseCSV = FunctionParser::Register(NamedFunc("HasMedLooseCSV",[](const Baby &b) -> NamedFunc::ScalarType{
       int nloose=0;
       int nmedium=0;
       for (unsigned i(0); i<b.ak4pfjets_deepCSV()->size(); i++){
@@ -2361,27 +2366,27 @@ float deepTag2018 = 0.8365;
       }
       if(nloose>=2 && nmedium>=1) return 1;
       else return 0;
-    });
+    }));
 
-  const NamedFunc HasMedMedDeepCSV("HasMedMedDeepCSV",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc HasMedMedDeepCSV = FunctionParser::Register(NamedFunc("HasMedMedDeepCSV",[](const Baby &b) -> NamedFunc::ScalarType{
       int ndeepmedium=0;
       for(unsigned i(0); i<b.ak4pfjets_deepCSV()->size(); i++){
         if (b.ak4pfjets_deepCSV()->at(i) > 0.6324) ndeepmedium++;
       }
       if(ndeepmedium>=2) return 1;
       else return 0;
-    });
+    }).Pure(true));
 
-  const NamedFunc HasLooseLooseDeepCSV("HasLooseLooseDeepCSV",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc HasLooseLooseDeepCSV = FunctionParser::Register(NamedFunc("HasLooseLooseDeepCSV",[](const Baby &b) -> NamedFunc::ScalarType{
       int ndeeploose=0;
       for(unsigned i(0); i<b.ak4pfjets_deepCSV()->size(); i++){
         if (b.ak4pfjets_deepCSV()->at(i) > 0.2219) ndeeploose++;
       }
       if(ndeeploose>=2) return 1;
       else return 0;
-    });
+    }));
 
-  const NamedFunc HasMedLooseDeepCSV("HasMedLooseDeepCSV",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc HasMedLooseDeepCSV = FunctionParser::Register(NamedFunc("HasMedLooseDeepCSV",[](const Baby &b) -> NamedFunc::ScalarType{
       int ndeeploose=0;
       int ndeepmedium=0;
       for(unsigned i(0); i<b.ak4pfjets_deepCSV()->size(); i++){
@@ -2390,111 +2395,112 @@ float deepTag2018 = 0.8365;
       }
       if(ndeeploose>=2 && ndeepmedium>=1) return 1;
       else return 0;
-    });
+    }).Pure(true));
 
-  const NamedFunc HasLooseNoMedDeepCSV("HasLooseNoMedDeepCSV",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc HasLooseNoMedDeepCSV = FunctionParser::Register(NamedFunc("HasLooseNoMedDeepCSV",[](const Baby &b) -> NamedFunc::ScalarType{
       int ndeeploose=0;
       for(unsigned i(0); i<b.ak4pfjets_deepCSV()->size(); i++){
         if ((b.ak4pfjets_deepCSV()->at(i) > 0.2219)&&(b.ak4pfjets_deepCSV()->at(i) < 0.6324)) ndeeploose++;
       }
       if(ndeeploose>=2) return 1;
       else return 0;
-    });
+    }).Pure(true));
 
-  const NamedFunc nDeepMedBTagged("nDeepMedBTagged",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc nDeepMedBTagged = FunctionParser::Register(NamedFunc("nDeepMedBTagged",[](const Baby &b) -> NamedFunc::ScalarType{
       int njets=0;
       for(unsigned i(0); i<b.ak4pfjets_deepCSV()->size(); i++){
         if (b.ak4pfjets_deepCSV()->at(i) > 0.6324) njets++;
       }
       return njets;
-    });
+    }));
 
-  const NamedFunc nDeepLooseBTagged("nDeepLooseBTagged",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc nDeepLooseBTagged = FunctionParser::Register(NamedFunc("nDeepLooseBTagged",[](const Baby &b) -> NamedFunc::ScalarType{
       int njets=0;
       for(unsigned i(0); i<b.ak4pfjets_deepCSV()->size(); i++){
         if (b.ak4pfjets_deepCSV()->at(i) > 0.2219) njets++;
       }
       return njets;
-    });
+    }));
 
-  const NamedFunc nDeepMedCTagged("nDeepMedCTagged",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc nDeepMedCTagged = FunctionParser::Register(NamedFunc("nDeepMedCTagged",[](const Baby &b) -> NamedFunc::ScalarType{
       int njets=0;
       for(unsigned i(0); i<b.ak4pfjets_deepCSVc()->size(); i++){
         if (b.ak4pfjets_deepCSVc()->at(i)/(b.ak4pfjets_deepCSVc()->at(i)+b.ak4pfjets_deepCSVl()->at(i)) > 0.155) njets++;
       }
       return njets;
-    });
-  const NamedFunc nDeepTightCTagged("nDeepTightCTagged",[](const Baby &b) -> NamedFunc::ScalarType{
+    }));
+  const NamedFunc nDeepTightCTagged = FunctionParser::Register(NamedFunc("nDeepTightCTagged",[](const Baby &b) -> NamedFunc::ScalarType{
       int njets=0;
       for(unsigned i(0); i<b.ak4pfjets_deepCSVc()->size(); i++){
         if (b.ak4pfjets_deepCSVc()->at(i)/(b.ak4pfjets_deepCSVc()->at(i)+b.ak4pfjets_deepCSVl()->at(i)) > 0.59) njets++;
       }
       return njets;
-    });
+    }));
 
-  const NamedFunc nDeepTightCvBTagged("nDeepTightCvBTagged",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc nDeepTightCvBTagged = FunctionParser::Register(NamedFunc("nDeepTightCvBTagged",[](const Baby &b) -> NamedFunc::ScalarType{
       int njets=0;
       for(unsigned i(0); i<b.ak4pfjets_deepCSVc()->size(); i++){
         if (b.ak4pfjets_deepCSVc()->at(i)/(b.ak4pfjets_deepCSVc()->at(i)+b.ak4pfjets_deepCSV()->at(i)) > 0.19) njets++;
       }
       return njets;
-    });
+    }));
 
-  const NamedFunc nDeepMedCvBTagged("nDeepMedCvBTagged",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc nDeepMedCvBTagged = FunctionParser::Register(NamedFunc("nDeepMedCvBTagged",[](const Baby &b) -> NamedFunc::ScalarType{
       int njets=0;
       for(unsigned i(0); i<b.ak4pfjets_deepCSVc()->size(); i++){
         if (b.ak4pfjets_deepCSVc()->at(i)/(b.ak4pfjets_deepCSVc()->at(i)+b.ak4pfjets_deepCSV()->at(i)) > 0.14) njets++;
       }
       return njets;
-    });
-  const NamedFunc nDeepLooseCvBTagged("nDeepLooseCvBTagged",[](const Baby &b) -> NamedFunc::ScalarType{
+    }));
+  const NamedFunc nDeepLooseCvBTagged = FunctionParser::Register(NamedFunc("nDeepLooseCvBTagged",[](const Baby &b) -> NamedFunc::ScalarType{
       int njets=0;
       for(unsigned i(0); i<b.ak4pfjets_deepCSVc()->size(); i++){
         if (b.ak4pfjets_deepCSVc()->at(i)/(b.ak4pfjets_deepCSVc()->at(i)+b.ak4pfjets_deepCSV()->at(i)) > 0.05) njets++;
       }
       return njets;
-    });
+    }));
 
-  const NamedFunc nAK8jets("nAK8jets",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc nAK8jets = FunctionParser::Register(NamedFunc("nAK8jets",[](const Baby &b) -> NamedFunc::ScalarType{
       int njets=0;
       for(unsigned i(0); i<b.ak8pfjets_pt()->size(); i++){
         njets++;
       }
       return njets;
-    });
-  const NamedFunc nHiggsTag("nHiggsTag",[](const Baby &b) -> NamedFunc::ScalarType{
+    }));
+  const NamedFunc nHiggsTag = FunctionParser::Register(NamedFunc("nHiggsTag",[](const Baby &b) -> NamedFunc::ScalarType{
       int njets=0;
       for(unsigned i(0); i<b.ak8pfjets_pt()->size(); i++){
         if(b.ak8pfjets_deepdisc_hbb()->at(i)>0.8)njets++;
       }
       return njets;
-    });
+    }).Pure(true));
 
 
-  const NamedFunc bJetPt("bJetPt",[](const Baby &b) -> NamedFunc::VectorType{
+  const NamedFunc bJetPt = FunctionParser::Register(NamedFunc("bJetPt",[](const Baby &b) -> NamedFunc::VectorType{
       vector<double> bjetpt;
       for(unsigned i(0); i<b.ak4pfjets_parton_flavor()->size(); i++){
         if(abs(b.ak4pfjets_parton_flavor()->at(i))==5) bjetpt.push_back(b.ak4pfjets_pt()->at(i));
       }
       return bjetpt;
-    });
+    }));
 
   /*
   * Returns number of >loose bjets
   */
-  const NamedFunc NBJets("NBJets",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc NBJets = FunctionParser::Register(NamedFunc("NBJets",[](const Baby &b) -> NamedFunc::ScalarType{
       int nloose=0;
       for (unsigned i(0); i<b.ak4pfjets_deepCSV()->size(); i++){
         if (b.ak4pfjets_deepCSV()->at(i) > 0.2217) nloose++;
       }
       return nloose;
-    });
+    }));
 
   /*
    * returns number of good, isolated leptons in event
    */
-  const NamedFunc WHLeptons("WHLeptons",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc WHLeptons = FunctionParser::Register(NamedFunc("WHLeptons",[](const Baby &b) -> NamedFunc::ScalarType{
       int nwhleptons=0;
+      if (b.leps_pt()->empty()) return nwhleptons;
       if (abs(b.lep1_pdgid())==11&&b.leps_pt()->at(0)>30&&b.lep1_relIso()*b.leps_pt()->at(0)<5) nwhleptons++;
       if (abs(b.lep1_pdgid())==13&&b.leps_pt()->at(0)>25&&b.lep1_relIso()*b.leps_pt()->at(0)<5&&abs(b.leps_eta()->at(0))<2.1) nwhleptons++;
 
@@ -2503,9 +2509,9 @@ float deepTag2018 = 0.8365;
 	       if (abs(b.lep2_pdgid())==13&&b.leps_pt()->at(1)>25&&b.lep2_relIso()*b.leps_pt()->at(1)<5&&abs(b.leps_eta()->at(1))<2.1) nwhleptons++;
       }
       return nwhleptons;
-    });
+    }).Pure(true));
 
-  const NamedFunc WHMuonSigEff("WHMuonSigEff",[](const Baby &b) -> NamedFunc::VectorType{
+  const NamedFunc WHMuonSigEff = FunctionParser::Register(NamedFunc("WHMuonSigEff",[](const Baby &b) -> NamedFunc::VectorType{
       double nMuonsBarrel = 0;
       double nMuonsEndcap = 0;
       double nMuons = 0;
@@ -2534,9 +2540,9 @@ float deepTag2018 = 0.8365;
       muonEtaCountsVector.push_back(nMuonsEndcap);
       
       return muonEtaCountsVector;
-    });
+    }));
 
-  const NamedFunc WHElSigEff("WHElSigEff",[](const Baby &b) -> NamedFunc::VectorType{
+  const NamedFunc WHElSigEff = FunctionParser::Register(NamedFunc("WHElSigEff",[](const Baby &b) -> NamedFunc::VectorType{
       double nElesBarrel = 0;
       double nElesEndcap = 0;
       double nEles = 0;
@@ -2565,17 +2571,17 @@ float deepTag2018 = 0.8365;
       EleEtaCountsVector.push_back(nElesEndcap);
       
       return EleEtaCountsVector;
-    });
+    }));
 
-  const NamedFunc nRealBs("nRealBs",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc nRealBs = FunctionParser::Register(NamedFunc("nRealBs",[](const Baby &b) -> NamedFunc::ScalarType{
       int nbquarks=0;
       for(unsigned i(0); i<b.ak4pfjets_parton_flavor()->size(); i++){
         if(abs(b.ak4pfjets_parton_flavor()->at(i))==5) nbquarks++;
       }
       return nbquarks;
-    }); 
+    })); 
 
-    const NamedFunc nRealBsfromTop("nRealBsfromTop",[](const Baby &b) -> NamedFunc::ScalarType{
+    const NamedFunc nRealBsfromTop = FunctionParser::Register(NamedFunc("nRealBsfromTop",[](const Baby &b) -> NamedFunc::ScalarType{
       int nbquarks=0;
       for(unsigned i(0); i<b.ak4pfjets_parton_flavor()->size(); i++){
         if(abs(b.ak4pfjets_parton_flavor()->at(i))==5 && b.ak4pfjets_deepCSV()->at(i)>(medDeepCSV2017*(b.year()==2017) + medDeepCSV2016*(b.year()==2016) + medDeepCSV2018*(b.year()==2018))){ //Then find closest gen b
@@ -2591,18 +2597,18 @@ float deepTag2018 = 0.8365;
       }//found b-flavor jet
       }
       return nbquarks;
-    });
+    }));
 
 
-    const NamedFunc nRealBtags("nRealBtags",[](const Baby &b) -> NamedFunc::ScalarType{
+    const NamedFunc nRealBtags = FunctionParser::Register(NamedFunc("nRealBtags",[](const Baby &b) -> NamedFunc::ScalarType{
       int nbquarks=0;
       for(unsigned i(0); i<b.ak4pfjets_parton_flavor()->size(); i++){
         if(abs(b.ak4pfjets_parton_flavor()->at(i))==5 && b.ak4pfjets_deepCSV()->at(i)>(medDeepCSV2017*(b.year()==2017) + medDeepCSV2016*(b.year()==2016) + medDeepCSV2018*(b.year()==2018))) nbquarks++;
       }
       return nbquarks;
-    });
+    }));
 
-    const NamedFunc max_genjet_bquark_pt_ratio("max_genjet_bquark_pt_ratio",[](const Baby &b) -> NamedFunc::ScalarType{
+    const NamedFunc max_genjet_bquark_pt_ratio = FunctionParser::Register(NamedFunc("max_genjet_bquark_pt_ratio",[](const Baby &b) -> NamedFunc::ScalarType{
       float max_ratio=-1;
       for(unsigned i(0); i<b.ak4pfjets_parton_flavor()->size(); i++){
         if(abs(b.ak4pfjets_parton_flavor()->at(i))==5 && b.ak4pfjets_deepCSV()->at(i)>(medDeepCSV2017*(b.year()==2017) + medDeepCSV2016*(b.year()==2016) + medDeepCSV2018*(b.year()==2018))){ //Then find closest gen b
@@ -2619,9 +2625,9 @@ float deepTag2018 = 0.8365;
       }//found b-flavor jet
       }
       return max_ratio;
-    });
+    }));
 
-    const NamedFunc dR_jet_bquark_max_pt_ratio("dR_genjet_bquark_max_pt_ratio",[](const Baby &b) -> NamedFunc::ScalarType{
+    const NamedFunc dR_jet_bquark_max_pt_ratio = FunctionParser::Register(NamedFunc("dR_genjet_bquark_max_pt_ratio",[](const Baby &b) -> NamedFunc::ScalarType{
       float max_ratio=-1;
       float dr_max_ratio=-1;
       for(unsigned i(0); i<b.ak4pfjets_parton_flavor()->size(); i++){
@@ -2639,12 +2645,12 @@ float deepTag2018 = 0.8365;
         }//found b-flavor jet
       }
       return dr_max_ratio;
-    });
+    }), "dR_jet_bquark_max_pt_ratio");
 
 
 
 
-  const NamedFunc nGenLightLeps("nGenLightLeps",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc nGenLightLeps = FunctionParser::Register(NamedFunc("nGenLightLeps",[](const Baby &b) -> NamedFunc::ScalarType{
       int nGenLeps=0;
 
       for(unsigned i(0); i<b.gen_id()->size(); i++){
@@ -2655,9 +2661,9 @@ float deepTag2018 = 0.8365;
 
       return nGenLeps;
       //if function returns 2, 1 is lost lepton, assuming single reco lepton
-    });
+    }));
 
-  const NamedFunc LostHadTaus("LostHadTaus",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc LostHadTaus = FunctionParser::Register(NamedFunc("LostHadTaus",[](const Baby &b) -> NamedFunc::ScalarType{
       int nGenLepsfromW=0;
       int nGenLepsfromTau=0;
 
@@ -2697,9 +2703,9 @@ float deepTag2018 = 0.8365;
       }
 
       return counter;
-    });
+    }));
 
-  const NamedFunc ptLostLeps("ptLostLeps",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc ptLostLeps = FunctionParser::Register(NamedFunc("ptLostLeps",[](const Baby &b) -> NamedFunc::ScalarType{
       float ptLostLep=0.;
 
       int lostLepChecker = 0;
@@ -2731,9 +2737,9 @@ float deepTag2018 = 0.8365;
 
       return ptLostLep;
       //returns pt of least energetic light lepton in gen-level event
-    });
+    }));
 
-  const NamedFunc etaLostLeps("etaLostLeps",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc etaLostLeps = FunctionParser::Register(NamedFunc("etaLostLeps",[](const Baby &b) -> NamedFunc::ScalarType{
       float etaLostLep=0.;
 
       int lostLepChecker = 0;
@@ -2765,9 +2771,9 @@ float deepTag2018 = 0.8365;
 
       return etaLostLep;
       //returns eta of least energetic light lepton in gen-level event
-    });
+    }));
 
-  const NamedFunc causeLostLeps("causeLostLeps",[](const Baby &b) -> NamedFunc::VectorType{
+  const NamedFunc causeLostLeps = FunctionParser::Register(NamedFunc("causeLostLeps",[](const Baby &b) -> NamedFunc::VectorType{
 
       int causeVar = 0;
         //causeVar==1 for low pT
@@ -2861,10 +2867,10 @@ float deepTag2018 = 0.8365;
 
       return causeVec;
       //returns cause of losing lepton in gen-level event
-    });
+    }));
 
 
-  const NamedFunc FatJet_HighestHScore("FatJet_HighestHScore",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc FatJet_HighestHScore = FunctionParser::Register(NamedFunc("FatJet_HighestHScore",[](const Baby &b) -> NamedFunc::ScalarType{
     //vector<float>* v = b.FatJet_deepTag_H();
     vector<float> v;
     for(unsigned i(0); i<b.FatJet_pt()->size(); i++){
@@ -2880,9 +2886,9 @@ float deepTag2018 = 0.8365;
     else {
         return 0;
     }
-  });
+  }));
 
-  const NamedFunc FatJet_HighestMDHScore("FatJet_HighestMDHScore",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc FatJet_HighestMDHScore = FunctionParser::Register(NamedFunc("FatJet_HighestMDHScore",[](const Baby &b) -> NamedFunc::ScalarType{
     //vector<float>* v = b.FatJet_deepTagMD_HbbvsQCD();
     vector<float> v;
     for(unsigned i(0); i<b.FatJet_pt()->size(); i++){
@@ -2898,9 +2904,9 @@ float deepTag2018 = 0.8365;
     else {
         return 0;
     }
-  });
+  }));
 
-  const NamedFunc MediumMDHiggsTag_m("MediumMDHiggsTag_m",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc MediumMDHiggsTag_m = FunctionParser::Register(NamedFunc("MediumMDHiggsTag_m",[](const Baby &b) -> NamedFunc::ScalarType{
     vector<float> v;
     for(unsigned i(0); i<b.FatJet_pt()->size(); i++){
         if(b.FatJet_pt()->at(i)>200 && b.FatJet_deepTagMD_HbbvsQCD()->at(i)>0.8365){
@@ -2915,9 +2921,9 @@ float deepTag2018 = 0.8365;
     else {
         return 0;
     }
-  });
+  }));
 
-  const NamedFunc MediumMDHiggsTag_msoftdrop("MediumMDHiggsTag_msoftdrop",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc MediumMDHiggsTag_msoftdrop = FunctionParser::Register(NamedFunc("MediumMDHiggsTag_msoftdrop",[](const Baby &b) -> NamedFunc::ScalarType{
     vector<float> v;
     for(unsigned i(0); i<b.FatJet_pt()->size(); i++){
         if(b.FatJet_pt()->at(i)>200 && b.FatJet_deepTagMD_HbbvsQCD()->at(i)>0.8365){
@@ -2932,9 +2938,9 @@ float deepTag2018 = 0.8365;
     else {
         return 0;
     }
-  });
+  }));
 
-  const NamedFunc MediumMDHiggsTag_mass("MediumMDHiggsTag_mass",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc MediumMDHiggsTag_mass = FunctionParser::Register(NamedFunc("MediumMDHiggsTag_mass",[](const Baby &b) -> NamedFunc::ScalarType{
     vector<float> v;
     for(unsigned i(0); i<b.FatJet_pt()->size(); i++){
         if(b.FatJet_pt()->at(i)>200 && b.FatJet_deepTagMD_HbbvsQCD()->at(i)>0.8365){
@@ -2949,9 +2955,9 @@ float deepTag2018 = 0.8365;
     else {
         return 0;
     }
-  });
+  }));
 
-  const NamedFunc LooseMDHiggsTag_msoftdrop("LooseMDHiggsTag_msoftdrop",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc LooseMDHiggsTag_msoftdrop = FunctionParser::Register(NamedFunc("LooseMDHiggsTag_msoftdrop",[](const Baby &b) -> NamedFunc::ScalarType{
     vector<float> v;
     for(unsigned i(0); i<b.FatJet_pt()->size(); i++){
         if(b.FatJet_pt()->at(i)>200 && b.FatJet_deepTagMD_HbbvsQCD()->at(i)>0.5165){
@@ -2966,11 +2972,11 @@ float deepTag2018 = 0.8365;
     else {
         return 0;
     }
-  });
+  }));
 
 
 
-  const NamedFunc MediumMDHiggsTag_pt("MediumMDHiggsTag_pt",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc MediumMDHiggsTag_pt = FunctionParser::Register(NamedFunc("MediumMDHiggsTag_pt",[](const Baby &b) -> NamedFunc::ScalarType{
     vector<float> v;
     for(unsigned i(0); i<b.FatJet_pt()->size(); i++){
         if(b.FatJet_pt()->at(i)>200 && b.FatJet_deepTagMD_HbbvsQCD()->at(i)>0.8365){
@@ -2985,9 +2991,9 @@ float deepTag2018 = 0.8365;
     else {
         return 0;
     }
-  });
+  }));
 
-  const NamedFunc MediumMDHiggsTag_MDHscore("MediumMDHiggsTag_MDHscore",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc MediumMDHiggsTag_MDHscore = FunctionParser::Register(NamedFunc("MediumMDHiggsTag_MDHscore",[](const Baby &b) -> NamedFunc::ScalarType{
     vector<float> v;
     for(unsigned i(0); i<b.FatJet_pt()->size(); i++){
         if(b.FatJet_pt()->at(i)>200 && b.FatJet_deepTagMD_HbbvsQCD()->at(i)>0.8365){
@@ -3002,9 +3008,9 @@ float deepTag2018 = 0.8365;
     else {
         return 0;
     }
-  });
+  }));
 
-  const NamedFunc MediumMDHiggsTag_Hscore("MediumMDHiggsTag_Hscore",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc MediumMDHiggsTag_Hscore = FunctionParser::Register(NamedFunc("MediumMDHiggsTag_Hscore",[](const Baby &b) -> NamedFunc::ScalarType{
     vector<float> v;
     for(unsigned i(0); i<b.FatJet_pt()->size(); i++){
         if(b.FatJet_pt()->at(i)>200 && b.FatJet_deepTagMD_HbbvsQCD()->at(i)>0.8365){
@@ -3019,9 +3025,9 @@ float deepTag2018 = 0.8365;
     else {
         return 0;
     }
-  });
+  }));
 
-  const NamedFunc nMediumMDHiggsTag("nMediumMDHiggsTag",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc nMediumMDHiggsTag = FunctionParser::Register(NamedFunc("nMediumMDHiggsTag",[](const Baby &b) -> NamedFunc::ScalarType{
     int nTags = 0;
     vector<float> v;
     for(unsigned i(0); i<b.FatJet_pt()->size(); i++){
@@ -3030,9 +3036,9 @@ float deepTag2018 = 0.8365;
         }
     }
     return nTags;
-  });
+  }));
 
-  const NamedFunc HasMediumMDHiggsTag("HasMediumMDHiggsTag",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc HasMediumMDHiggsTag = FunctionParser::Register(NamedFunc("HasMediumMDHiggsTag",[](const Baby &b) -> NamedFunc::ScalarType{
     int nTags = 0;
     vector<float> v;
     for(unsigned i(0); i<b.FatJet_pt()->size(); i++){
@@ -3041,9 +3047,9 @@ float deepTag2018 = 0.8365;
         }
     }
     return nTags>0;
-  });
+  }));
 
-  const NamedFunc HasMediumMDHiggsTag_medPt("HasMediumMDHiggsTag_medPt",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc HasMediumMDHiggsTag_medPt = FunctionParser::Register(NamedFunc("HasMediumMDHiggsTag_medPt",[](const Baby &b) -> NamedFunc::ScalarType{
     int nTags = 0;
     vector<float> v;
     for(unsigned i(0); i<b.FatJet_pt()->size(); i++){
@@ -3052,9 +3058,9 @@ float deepTag2018 = 0.8365;
         }
     }
     return nTags>0;
-  });
+  }));
 
-  const NamedFunc HasMediumMDBBTag_medPt("HasMediumMDBBTag_medPt",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc HasMediumMDBBTag_medPt = FunctionParser::Register(NamedFunc("HasMediumMDBBTag_medPt",[](const Baby &b) -> NamedFunc::ScalarType{
     int nTags = 0;
     vector<float> v;
     for(unsigned i(0); i<b.FatJet_pt()->size(); i++){
@@ -3063,10 +3069,10 @@ float deepTag2018 = 0.8365;
         }
     }
     return nTags>0;
-  });
+  }));
 
 
-  const NamedFunc HasHbbTag("HasHbbTag",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc HasHbbTag = FunctionParser::Register(NamedFunc("HasHbbTag",[](const Baby &b) -> NamedFunc::ScalarType{
     int nTags = 0;
     vector<float> v;
     for(unsigned i(0); i<b.FatJet_pt()->size(); i++){
@@ -3075,9 +3081,9 @@ float deepTag2018 = 0.8365;
         }
     }
     return nTags>0;
-  });
+  }));
 
-  const NamedFunc nMediumHiggsTag("nMediumHiggsTag",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc nMediumHiggsTag = FunctionParser::Register(NamedFunc("nMediumHiggsTag",[](const Baby &b) -> NamedFunc::ScalarType{
     int nTags = 0;
     vector<float> v;
     for(unsigned i(0); i<b.FatJet_pt()->size(); i++){
@@ -3086,9 +3092,9 @@ float deepTag2018 = 0.8365;
         }
     }
     return nTags;
-  });
+  }));
 
-  const NamedFunc HasMediumHiggsTag("HasMediumHiggsTag",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc HasMediumHiggsTag = FunctionParser::Register(NamedFunc("HasMediumHiggsTag",[](const Baby &b) -> NamedFunc::ScalarType{
     int nTags = 0;
     vector<float> v;
     for(unsigned i(0); i<b.FatJet_pt()->size(); i++){
@@ -3097,10 +3103,10 @@ float deepTag2018 = 0.8365;
         }
     }
     return nTags>0;
-  });
+  }));
 
 
-  const NamedFunc FatJet_ClosestMSD("FatJet_ClosestMSD",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc FatJet_ClosestMSD = FunctionParser::Register(NamedFunc("FatJet_ClosestMSD",[](const Baby &b) -> NamedFunc::ScalarType{
     //vector<float>* v = b.FatJet_msoftdrop();
     vector<float> masses;
 
@@ -3112,25 +3118,25 @@ float deepTag2018 = 0.8365;
     sort(masses.begin(), masses.end(), less<int>());
 
     return (masses.at(0)+125.);
-  });
+  }));
 
-  const NamedFunc sortedJetsPt_Leading("sortedJetsPt_Leading",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc sortedJetsPt_Leading = FunctionParser::Register(NamedFunc("sortedJetsPt_Leading",[](const Baby &b) -> NamedFunc::ScalarType{
     vector<float>* v = b.ak4pfjets_pt();
 
     sort(v->begin(), v->end(), greater<int>());
 
     return v->at(0);
-  });
+  }));
 
-  const NamedFunc sortedJetsPt_subLeading("sortedJetsPt_subLeading",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc sortedJetsPt_subLeading = FunctionParser::Register(NamedFunc("sortedJetsPt_subLeading",[](const Baby &b) -> NamedFunc::ScalarType{
     vector<float>* v = b.ak4pfjets_pt();
 
     sort(v->begin(), v->end(), greater<int>());
 
     return v->at(1);
-  });
+  }));
 
-  const NamedFunc sortedJetsCSV_Leading("sortedJetsCSV_Leading",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc sortedJetsCSV_Leading = FunctionParser::Register(NamedFunc("sortedJetsCSV_Leading",[](const Baby &b) -> NamedFunc::ScalarType{
     vector< pair <float,float> > v;
     for(unsigned i(0);i<b.ak4pfjets_deepCSV()->size();i++){
       v.push_back(make_pair(b.ak4pfjets_deepCSV()->at(i),b.ak4pfjets_pt()->at(i)));
@@ -3141,9 +3147,9 @@ float deepTag2018 = 0.8365;
     int n = v.size();
 
     return v[n-1].second;
-  });
+  }));
 
-  const NamedFunc sortedJetsCSV_subLeading("sortedJetsCSV_subLeading",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc sortedJetsCSV_subLeading = FunctionParser::Register(NamedFunc("sortedJetsCSV_subLeading",[](const Baby &b) -> NamedFunc::ScalarType{
     vector< pair <float,float> > v;
     for(unsigned i(0);i<b.ak4pfjets_deepCSV()->size();i++){
       v.push_back(make_pair(b.ak4pfjets_deepCSV()->at(i),b.ak4pfjets_pt()->at(i)));
@@ -3154,9 +3160,9 @@ float deepTag2018 = 0.8365;
     int n = v.size();
 
     return v[n-2].second;
-  });
+  }));
 
-  const NamedFunc sortedJetsCSV_deltaR("sortedJetsCSV_deltaR",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc sortedJetsCSV_deltaR = FunctionParser::Register(NamedFunc("sortedJetsCSV_deltaR",[](const Baby &b) -> NamedFunc::ScalarType{
     vector<pair <float,float> > v_etaPhi;
     vector<pair <float,pair<float,float> > > v_ptEtaPhi;
     vector<pair <float, pair<float, pair <float,float> > > > v_csvPtEtaPhi;
@@ -3173,10 +3179,10 @@ float deepTag2018 = 0.8365;
     float deltaR_leading = deltaR(v_csvPtEtaPhi[n-1].second.second.first,v_csvPtEtaPhi[n-1].second.second.second,v_csvPtEtaPhi[n-2].second.second.first,v_csvPtEtaPhi[n-2].second.second.second);
 
     return deltaR_leading;
-  });
+  }));
 
 
-  const NamedFunc deltaRLeadingJets("deltaRLeadingJets",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc deltaRLeadingJets = FunctionParser::Register(NamedFunc("deltaRLeadingJets",[](const Baby &b) -> NamedFunc::ScalarType{
   
     float maxpt=0; int maxindex=-1;
     float secondmaxpt=0; int secondindex=-1;
@@ -3193,9 +3199,9 @@ float deepTag2018 = 0.8365;
       }
     }
     return deltaR(b.ak4pfjets_eta()->at(maxindex),b.ak4pfjets_phi()->at(maxindex),b.ak4pfjets_eta()->at(secondindex),b.ak4pfjets_phi()->at(secondindex));
-  });
+  }));
 
-    const NamedFunc deltaPhiLeadingJets("deltaPhiLeadingJets",[](const Baby &b) -> NamedFunc::ScalarType{
+    const NamedFunc deltaPhiLeadingJets = FunctionParser::Register(NamedFunc("deltaPhiLeadingJets",[](const Baby &b) -> NamedFunc::ScalarType{
 
     float maxpt=0; int maxindex=-1;
     float secondmaxpt=0; int secondindex=-1;
@@ -3212,9 +3218,9 @@ float deepTag2018 = 0.8365;
       }
     }
     return deltaPhi(b.ak4pfjets_phi()->at(maxindex),b.ak4pfjets_phi()->at(secondindex));
-  });
+  }));
 
-  const NamedFunc bbmass("bbmass",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc bbmass = FunctionParser::Register(NamedFunc("bbmass",[](const Baby &b) -> NamedFunc::ScalarType{
     float mass = -1;
 
     for(unsigned i(0); i<b.gen_id()->size(); i++){
@@ -3234,92 +3240,92 @@ float deepTag2018 = 0.8365;
     }//Close for loop over all particles in event
     return mass;
 
-    });
+    }));
 
-  const NamedFunc hasGenBs("hasGenBs",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc hasGenBs = FunctionParser::Register(NamedFunc("hasGenBs",[](const Baby &b) -> NamedFunc::ScalarType{
       int nbquarks=0;
       for(unsigned i(0); i<b.gen_id()->size(); i++){
         if(abs(b.gen_id()->at(i))==5 && (abs(b.gen_motherid()->at(i))!=23) && (abs(b.gen_motherid()->at(i))!=24) && (abs(b.gen_motherid()->at(i))!=6) ) nbquarks++; // only care about b's from gluons/protons.
       }
       if (nbquarks>0) return 1;
       return 0;
-    });
+    }));
 
-  const NamedFunc nGenBs("nGenBs",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc nGenBs = FunctionParser::Register(NamedFunc("nGenBs",[](const Baby &b) -> NamedFunc::ScalarType{
       int nbquarks=0;
       for(unsigned i(0); i<b.gen_id()->size(); i++){
         if(abs(b.gen_id()->at(i))==5) nbquarks++;
       }
       return nbquarks;
-    });
+    }));
 
-  const NamedFunc nGenBsFromGluons("nGenBsFromGluons",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc nGenBsFromGluons = FunctionParser::Register(NamedFunc("nGenBsFromGluons",[](const Baby &b) -> NamedFunc::ScalarType{
       int nbquarks=0;
       for(unsigned i(0); i<b.gen_id()->size(); i++){
         if(abs(b.gen_id()->at(i))==5&&abs(b.gen_motherid()->at(i))==21) nbquarks++;
       }
       return nbquarks;
-    });
+    }));
 
-  const NamedFunc nGenBs_ptG15("nGenBs_ptG15",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc nGenBs_ptG15 = FunctionParser::Register(NamedFunc("nGenBs_ptG15",[](const Baby &b) -> NamedFunc::ScalarType{
       int nbquarks=0;
       for(unsigned i(0); i<b.gen_id()->size(); i++){
         if(abs(b.gen_id()->at(i))==5&&b.gen_pt()->at(i)>15) nbquarks++;
       }
       return nbquarks;
-    });
+    }));
 
-  const NamedFunc nGenBsFromGluons_ptG15("nGenBsFromGluons_ptG15",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc nGenBsFromGluons_ptG15 = FunctionParser::Register(NamedFunc("nGenBsFromGluons_ptG15",[](const Baby &b) -> NamedFunc::ScalarType{
       int nbquarks=0;
       for(unsigned i(0); i<b.gen_id()->size(); i++){
         if(abs(b.gen_id()->at(i))==5&&abs(b.gen_motherid()->at(i))==21&&b.gen_pt()->at(i)>15) nbquarks++;
       }
       return nbquarks;
-    });
+    }));
 
-  const NamedFunc nGenBs_ptG30("nGenBs_ptG30",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc nGenBs_ptG30 = FunctionParser::Register(NamedFunc("nGenBs_ptG30",[](const Baby &b) -> NamedFunc::ScalarType{
       int nbquarks=0;
       for(unsigned i(0); i<b.gen_id()->size(); i++){
         if(abs(b.gen_id()->at(i))==5&&b.gen_pt()->at(i)>30) nbquarks++;
       }
       return nbquarks;
-    });
+    }));
 
-  const NamedFunc nGenBs_forward("nGenBs_forward",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc nGenBs_forward = FunctionParser::Register(NamedFunc("nGenBs_forward",[](const Baby &b) -> NamedFunc::ScalarType{
     int nbquarks=0;
     for(unsigned i(0); i<b.gen_id()->size(); i++){
       if(abs(b.gen_id()->at(i))==5&&abs(b.gen_eta()->at(i))>2.4) nbquarks++;
     }
     return nbquarks;
-  });
+  }));
 
-  const NamedFunc nGenBs_central("nGenBs_central",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc nGenBs_central = FunctionParser::Register(NamedFunc("nGenBs_central",[](const Baby &b) -> NamedFunc::ScalarType{
     int nbquarks=0;
     for(unsigned i(0); i<b.gen_id()->size(); i++){
       if(abs(b.gen_id()->at(i))==5&&abs(b.gen_eta()->at(i))<2.4) nbquarks++;
     }
     return nbquarks;
-  });
+  }));
 
-  const NamedFunc nGenBs_ptG30_central("nGenBs_ptG30_central",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc nGenBs_ptG30_central = FunctionParser::Register(NamedFunc("nGenBs_ptG30_central",[](const Baby &b) -> NamedFunc::ScalarType{
     int nbquarks=0;
     for(unsigned i(0); i<b.gen_id()->size(); i++){
       if(abs(b.gen_id()->at(i))==5 && abs(b.gen_eta()->at(i))<2.4 && b.gen_pt()->at(i)>30) nbquarks++;
     }
     return nbquarks;
-  });
+  }));
 
 
 
-  const NamedFunc nGenBsFromGluons_ptG30("nGenBsFromGluons_ptG30",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc nGenBsFromGluons_ptG30 = FunctionParser::Register(NamedFunc("nGenBsFromGluons_ptG30",[](const Baby &b) -> NamedFunc::ScalarType{
       int nbquarks=0;
       for(unsigned i(0); i<b.gen_id()->size(); i++){
         if(abs(b.gen_id()->at(i))==5&&abs(b.gen_motherid()->at(i))==21&&b.gen_pt()->at(i)>30) nbquarks++;
       }
       return nbquarks;
-    });
+    }));
 
-  const NamedFunc genBpT("genBpT",[](const Baby &b) -> NamedFunc::VectorType{
+  const NamedFunc genBpT = FunctionParser::Register(NamedFunc("genBpT",[](const Baby &b) -> NamedFunc::VectorType{
       vector <double> bquarkpT;
       for(unsigned i(0); i<b.gen_id()->size(); i++){
         if(abs(b.gen_id()->at(i))==5){
@@ -3327,9 +3333,9 @@ float deepTag2018 = 0.8365;
         }
       }
       return bquarkpT;
-    });
+    }));
   
-  const NamedFunc genBeta("genBeta",[](const Baby &b) -> NamedFunc::VectorType{
+  const NamedFunc genBeta = FunctionParser::Register(NamedFunc("genBeta",[](const Baby &b) -> NamedFunc::VectorType{
       vector <double> bquarketa;
       for(unsigned i(0); i<b.gen_id()->size(); i++){
         if(abs(b.gen_id()->at(i))==5){
@@ -3337,9 +3343,9 @@ float deepTag2018 = 0.8365;
         }
       }
       return bquarketa;
-    });
+    }));
 
-    const NamedFunc genBeta_mostForward("genBeta_mostForward",[](const Baby &b) -> NamedFunc::ScalarType{
+    const NamedFunc genBeta_mostForward = FunctionParser::Register(NamedFunc("genBeta_mostForward",[](const Baby &b) -> NamedFunc::ScalarType{
       double bquarketa=0;
       for(unsigned i(0); i<b.gen_id()->size(); i++){
         if(abs(b.gen_id()->at(i))==5 && abs(b.gen_eta()->at(i))>abs(bquarketa)){
@@ -3347,10 +3353,10 @@ float deepTag2018 = 0.8365;
         }
       }
       return bquarketa;
-    });
+    }));
 
 
-  const NamedFunc genB_leadingpT("genB_leadingpT",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc genB_leadingpT = FunctionParser::Register(NamedFunc("genB_leadingpT",[](const Baby &b) -> NamedFunc::ScalarType{
     vector< pair <float,float> > v;
     for(unsigned i(0);i<b.gen_id()->size();i++){
       if(abs(b.gen_id()->at(i))==5){
@@ -3365,9 +3371,9 @@ float deepTag2018 = 0.8365;
     float bquarkpT = v[n-1].first;
 
     return bquarkpT;
-  });
+  }));
 
-  const NamedFunc genB_subleadingpT("genB_subleadingpT",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc genB_subleadingpT = FunctionParser::Register(NamedFunc("genB_subleadingpT",[](const Baby &b) -> NamedFunc::ScalarType{
     vector< pair <float,float> > v;
     for(unsigned i(0);i<b.gen_id()->size();i++){
       if(abs(b.gen_id()->at(i))==5){
@@ -3382,9 +3388,9 @@ float deepTag2018 = 0.8365;
     float bquarkpT = v[n-2].first;
 
     return bquarkpT;
-  });
+  }));
 
-  const NamedFunc bDeltaRGluonSplit("bDeltaRGluonSplit",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc bDeltaRGluonSplit = FunctionParser::Register(NamedFunc("bDeltaRGluonSplit",[](const Baby &b) -> NamedFunc::ScalarType{
     float delR = 0;
 
     for(unsigned i(0); i<b.gen_id()->size(); i++){
@@ -3398,9 +3404,9 @@ float deepTag2018 = 0.8365;
     }//Close for loop over all particles in event
     return delR;
 
-    });
+    }));
 
-  const NamedFunc bDeltaRHiggs("bDeltaRHiggs",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc bDeltaRHiggs = FunctionParser::Register(NamedFunc("bDeltaRHiggs",[](const Baby &b) -> NamedFunc::ScalarType{
     float delR = 0;
 
     for(unsigned i(0); i<b.gen_id()->size(); i++){
@@ -3414,9 +3420,9 @@ float deepTag2018 = 0.8365;
     }//Close for loop over all particles in event
     return delR;
 
-    });
+    }));
 
-  const NamedFunc bDeltaR("bDeltaR",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc bDeltaR = FunctionParser::Register(NamedFunc("bDeltaR",[](const Baby &b) -> NamedFunc::ScalarType{
     float delR = 0;
 
     for(unsigned i(0); i<b.gen_id()->size(); i++){
@@ -3430,9 +3436,9 @@ float deepTag2018 = 0.8365;
     }//Close for loop over all particles in event
     return delR;
 
-    });
+    }));
 
-  const NamedFunc bDeltaRfromtop("bDeltaRfromtop",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc bDeltaRfromtop = FunctionParser::Register(NamedFunc("bDeltaRfromtop",[](const Baby &b) -> NamedFunc::ScalarType{
     float delR = 0;
 
     for(unsigned i(0); i<b.gen_id()->size(); i++){
@@ -3447,9 +3453,9 @@ float deepTag2018 = 0.8365;
     }//Close for loop over all particles in event
     return delR;
 
-    });
+    }));
 
-  const NamedFunc minDR_lep_bquark("minDR_lep_bquark",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc minDR_lep_bquark = FunctionParser::Register(NamedFunc("minDR_lep_bquark",[](const Baby &b) -> NamedFunc::ScalarType{
     float delR = 999;
     for(unsigned i(0); i<b.gen_id()->size(); i++){
       if(abs(b.gen_id()->at(i))==5 && abs(b.gen_motherid()->at(i))==6){
@@ -3461,9 +3467,9 @@ float deepTag2018 = 0.8365;
     }//Close for loop over all particles in event
     return delR;
 
-    });
+    }));
 
-  const NamedFunc bMother("bMother",[](const Baby &b) -> NamedFunc::VectorType{
+  const NamedFunc bMother = FunctionParser::Register(NamedFunc("bMother",[](const Baby &b) -> NamedFunc::VectorType{
     vector <double> mother_id;
 
     for(unsigned i(0); i<b.gen_id()->size(); i++){
@@ -3477,9 +3483,9 @@ float deepTag2018 = 0.8365;
     }//Close for loop over all particles in event
     return mother_id;
 
-    });
+    }));
 
-  const NamedFunc bMother_pt15("bMother_pt15",[](const Baby &b) -> NamedFunc::VectorType{
+  const NamedFunc bMother_pt15 = FunctionParser::Register(NamedFunc("bMother_pt15",[](const Baby &b) -> NamedFunc::VectorType{
     vector <double> mother_id;
 
     for(unsigned i(0); i<b.gen_id()->size(); i++){
@@ -3493,9 +3499,9 @@ float deepTag2018 = 0.8365;
     }//Close for loop over all particles in event
     return mother_id;
 
-    });
+    }));
 
-  const NamedFunc bMother_pt30("bMother_pt30",[](const Baby &b) -> NamedFunc::VectorType{
+  const NamedFunc bMother_pt30 = FunctionParser::Register(NamedFunc("bMother_pt30",[](const Baby &b) -> NamedFunc::VectorType{
     vector <double> mother_id;
 
     for(unsigned i(0); i<b.gen_id()->size(); i++){
@@ -3509,9 +3515,9 @@ float deepTag2018 = 0.8365;
     }//Close for loop over all particles in event
     return mother_id;
 
-    });
+    }));
 
-  const NamedFunc leadingBMother_pt20("leadingBMother_pt20",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc leadingBMother_pt20 = FunctionParser::Register(NamedFunc("leadingBMother_pt20",[](const Baby &b) -> NamedFunc::ScalarType{
     vector< pair <float,float> > v;
     int ngenb = 0;
 
@@ -3539,9 +3545,9 @@ float deepTag2018 = 0.8365;
     }
 
     return bmom;
-  });
+  }));
 
-  const NamedFunc subleadingBMother_pt20("subleadingBMother_pt20",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc subleadingBMother_pt20 = FunctionParser::Register(NamedFunc("subleadingBMother_pt20",[](const Baby &b) -> NamedFunc::ScalarType{
     vector< pair <float,float> > v;
     int ngenb = 0;
 
@@ -3569,9 +3575,9 @@ float deepTag2018 = 0.8365;
     }
 
     return bmom;
-  });
+  }));
 
-  const NamedFunc bDeltaPhi("bDeltaPhi",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc bDeltaPhi = FunctionParser::Register(NamedFunc("bDeltaPhi",[](const Baby &b) -> NamedFunc::ScalarType{
       float delphi=0;
       vector < pair < float,float > > v_csvPhi;
       
@@ -3590,9 +3596,9 @@ float deepTag2018 = 0.8365;
         return delphi;
       }else return 0;
 
-    });
+    }));
 
-  const NamedFunc bmetMinDeltaPhi("bmetMinDeltaPhi",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc bmetMinDeltaPhi = FunctionParser::Register(NamedFunc("bmetMinDeltaPhi",[](const Baby &b) -> NamedFunc::ScalarType{
       float delphi=10;
       
       for(unsigned i(0); i<b.ak4pfjets_parton_flavor()->size(); i++){
@@ -3603,9 +3609,9 @@ float deepTag2018 = 0.8365;
 
       return delphi;
 
-    });
+    }));
 
-  const NamedFunc nHeavy("nHeavy",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc nHeavy = FunctionParser::Register(NamedFunc("nHeavy",[](const Baby &b) -> NamedFunc::ScalarType{
       float njets=0;
       
       for(unsigned i(0); i<b.ak4pfjets_parton_flavor()->size(); i++){
@@ -3616,9 +3622,9 @@ float deepTag2018 = 0.8365;
 
       return njets;
 
-    });
+    }));
 
-  const NamedFunc nLight("nLight",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc nLight = FunctionParser::Register(NamedFunc("nLight",[](const Baby &b) -> NamedFunc::ScalarType{
       float njets=0;
       
       for(unsigned i(0); i<b.ak4pfjets_parton_flavor()->size(); i++){
@@ -3629,9 +3635,9 @@ float deepTag2018 = 0.8365;
 
       return njets;
 
-    });
+    }));
 
-  const NamedFunc gluBTagged("gluBTagged",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc gluBTagged = FunctionParser::Register(NamedFunc("gluBTagged",[](const Baby &b) -> NamedFunc::ScalarType{
     vector <pair <float, float> > gen_bs;
 
     for(unsigned i(0); i<b.gen_id()->size(); i++){
@@ -3679,9 +3685,9 @@ float deepTag2018 = 0.8365;
 
     return ntagged;
 
-    });
+    }));
 
-  const NamedFunc outsideHiggsWindow("outsideHiggsWindow",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc outsideHiggsWindow = FunctionParser::Register(NamedFunc("outsideHiggsWindow",[](const Baby &b) -> NamedFunc::ScalarType{
 
     int outsideWindow = 0.;
 
@@ -3690,9 +3696,9 @@ float deepTag2018 = 0.8365;
     }
 
     return outsideWindow;
-  });
+  }));
 
-  const NamedFunc passTriggers("passTriggers",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc passTriggers = FunctionParser::Register(NamedFunc("passTriggers",[](const Baby &b) -> NamedFunc::ScalarType{
 
     int pass = 0.;
 
@@ -3701,17 +3707,17 @@ float deepTag2018 = 0.8365;
     }
 
     return pass;
-  });
+  }));
 
-  const NamedFunc nJetsGood("nJetsGood",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc nJetsGood = FunctionParser::Register(NamedFunc("nJetsGood",[](const Baby &b) -> NamedFunc::ScalarType{
 
     int pass = 0.;
     pass = b.ngoodjets();
 
     return pass;
-  });
+  }));
 
-  const NamedFunc mht("mht",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc mht = FunctionParser::Register(NamedFunc("mht",[](const Baby &b) -> NamedFunc::ScalarType{
     double mht_var = 0;
     double x = 0;
     double y = 0;
@@ -3734,9 +3740,9 @@ float deepTag2018 = 0.8365;
 
     return mht_var;
 
-    });
+    }));
 
-  const NamedFunc mht_phi("mht_phi",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc mht_phi = FunctionParser::Register(NamedFunc("mht_phi",[](const Baby &b) -> NamedFunc::ScalarType{
     double mht_var = 0;
     double x = 0;
     double y = 0;
@@ -3758,9 +3764,9 @@ float deepTag2018 = 0.8365;
     mht_var = atan2(x, y);
     return mht_var;
 
-    });
+    }));
 
-  const NamedFunc W_pt_lep_met("W_pt_lep_met",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc W_pt_lep_met = FunctionParser::Register(NamedFunc("W_pt_lep_met",[](const Baby &b) -> NamedFunc::ScalarType{
     double W_pt_var = 0;
 
     TLorentzVector lep;
@@ -3775,9 +3781,9 @@ float deepTag2018 = 0.8365;
     W_pt_var = W_cand.Pt();
     return W_pt_var;
 
-    });
+    }));
 
-  const NamedFunc W_pt_lep_mht("W_pt_lep_mht",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc W_pt_lep_mht = FunctionParser::Register(NamedFunc("W_pt_lep_mht",[](const Baby &b) -> NamedFunc::ScalarType{
     double W_pt_var = 0;
 
     TLorentzVector lep;
@@ -3814,9 +3820,9 @@ float deepTag2018 = 0.8365;
     W_pt_var = W_cand.Pt();
     return W_pt_var;
 
-    });
+    }));
 
-  const NamedFunc mt_lep_mht("mt_lep_mht",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc mt_lep_mht = FunctionParser::Register(NamedFunc("mt_lep_mht",[](const Baby &b) -> NamedFunc::ScalarType{
     double mt_var = 0;
 
     double var_mht_pt = 0;
@@ -3844,17 +3850,17 @@ float deepTag2018 = 0.8365;
     mt_var = sqrt(2*b.leps_pt()->at(0)*var_mht_pt * (1-(cos(b.leps_phi()->at(0)-var_mht_phi))));
     return mt_var;
 
-    });
+    }));
 
-  const NamedFunc mt_lep_met_rec("mt_lep_met_rec",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc mt_lep_met_rec = FunctionParser::Register(NamedFunc("mt_lep_met_rec",[](const Baby &b) -> NamedFunc::ScalarType{
     double mt_var = 0;
 
     mt_var = sqrt(2*b.leps_pt()->at(0)*b.pfmet() * (1-(cos(b.leps_phi()->at(0)-b.pfmet_phi()))));
     return mt_var;
 
-    });
+    }));
 
-  const NamedFunc dijet_mass("dijet_mass",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc dijet_mass = FunctionParser::Register(NamedFunc("dijet_mass",[](const Baby &b) -> NamedFunc::ScalarType{
     float mass = -1;
     if (b.ak4pfjets_pt()->size()>1){
         TLorentzVector v1,v2,sum;
@@ -3864,9 +3870,9 @@ float deepTag2018 = 0.8365;
         mass = sum.M();
         }
     return mass;
-    });
+    }));
 
-  const NamedFunc dilepton_mass("dilepton_mass",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc dilepton_mass = FunctionParser::Register(NamedFunc("dilepton_mass",[](const Baby &b) -> NamedFunc::ScalarType{
     float mass = -1;
     float newmass = -1;
     for(unsigned i(0); i<b.leps_pt()->size(); i++){
@@ -3883,9 +3889,9 @@ float deepTag2018 = 0.8365;
     }//Close for loop over all particles in event
     return newmass;
 
-    });
+    }));
 
-  const NamedFunc dilepton_pt("dilepton_pt",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc dilepton_pt = FunctionParser::Register(NamedFunc("dilepton_pt",[](const Baby &b) -> NamedFunc::ScalarType{
     float mass = -1;
     float newmass = -1;
     float dl_pt = -1;
@@ -3906,7 +3912,7 @@ float deepTag2018 = 0.8365;
     }//Close for loop over all particles in event
     return dl_pt;
 
-    });
+    }));
 
   //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
   // Basic Jet Pt
@@ -3914,19 +3920,19 @@ float deepTag2018 = 0.8365;
   /*
    * returns pt of highest pt jet
    */
-  const NamedFunc LeadingJetPt("LeadingJetPt",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc LeadingJetPt = FunctionParser::Register(NamedFunc("LeadingJetPt",[](const Baby &b) -> NamedFunc::ScalarType{
       float maxpt=0;
       for (unsigned i(0); i<b.ak4pfjets_deepCSV()->size(); i++){
         if (b.ak4pfjets_pt()->at(i) > maxpt) maxpt =  b.ak4pfjets_pt()->at(i);
       }
       return maxpt;
-    });
+    }));
   
 
   /*
    * returns pt of second highest pt jet
    */
-  const NamedFunc SubLeadingJetPt("SubLeadingJetPt",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc SubLeadingJetPt = FunctionParser::Register(NamedFunc("SubLeadingJetPt",[](const Baby &b) -> NamedFunc::ScalarType{
       float maxpt=0;
       float secondmaxpt=0;
       for (unsigned i(0); i<b.ak4pfjets_deepCSV()->size(); i++){
@@ -3939,12 +3945,12 @@ float deepTag2018 = 0.8365;
         }
       }
       return secondmaxpt;
-    });
+    }));
 
   /*
    * returns pt of the third highest pt jet
    */
-  const NamedFunc SubSubLeadingJetPt("SubSubLeadingJetPt",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc SubSubLeadingJetPt = FunctionParser::Register(NamedFunc("SubSubLeadingJetPt",[](const Baby &b) -> NamedFunc::ScalarType{
       float maxpt=0;
       float secondmaxpt=0;
       float thirdmaxpt=0;
@@ -3963,7 +3969,7 @@ float deepTag2018 = 0.8365;
         }
       }
       return thirdmaxpt;
-    });
+    }));
 
 
   //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -3972,7 +3978,7 @@ float deepTag2018 = 0.8365;
   /*
    * Pt of the non-bjet with the highest pt
    */
-  const NamedFunc LeadingNonBJetPt("LeadingNonBJetPt",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc LeadingNonBJetPt = FunctionParser::Register(NamedFunc("LeadingNonBJetPt",[](const Baby &b) -> NamedFunc::ScalarType{
       float maxpt=0;
       for (unsigned i(0); i<b.ak4pfjets_deepCSV()->size(); i++){
         if (b.ak4pfjets_pt()->at(i) > maxpt && b.ak4pfjets_deepCSV()->at(i) < 0.2217){
@@ -3980,9 +3986,9 @@ float deepTag2018 = 0.8365;
         }
       }
       return maxpt;
-    });
+    }));
 
-  const NamedFunc LeadingFakeNonBJetPt("LeadingFakeNonBJetPt",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc LeadingFakeNonBJetPt = FunctionParser::Register(NamedFunc("LeadingFakeNonBJetPt",[](const Baby &b) -> NamedFunc::ScalarType{
       float maxpt=0;
       for (unsigned i(0); i<b.ak4pfjets_deepCSV()->size(); i++){
         if (b.ak4pfjets_pt()->at(i) > maxpt && abs(b.ak4pfjets_hadron_flavor()->at(i))==5 && b.ak4pfjets_deepCSV()->at(i) < 0.2217){
@@ -3990,9 +3996,9 @@ float deepTag2018 = 0.8365;
         }
       }
       return maxpt;
-    });
+    }));
 
-   const NamedFunc LeadingRealNonBJetPt("LeadingRealNonBJetPt",[](const Baby &b) -> NamedFunc::ScalarType{
+   const NamedFunc LeadingRealNonBJetPt = FunctionParser::Register(NamedFunc("LeadingRealNonBJetPt",[](const Baby &b) -> NamedFunc::ScalarType{
       float maxpt=0;
       for (unsigned i(0); i<b.ak4pfjets_deepCSV()->size(); i++){
         if (b.ak4pfjets_pt()->at(i) > maxpt && abs(b.ak4pfjets_hadron_flavor()->at(i))!=5 && b.ak4pfjets_deepCSV()->at(i) < 0.2217){
@@ -4000,9 +4006,9 @@ float deepTag2018 = 0.8365;
         }
       }
       return maxpt;
-    });
+    }));
 
-   const NamedFunc LeadingNonBJetPt_med("LeadingNonBJetPt_med",[](const Baby &b) -> NamedFunc::ScalarType{
+   const NamedFunc LeadingNonBJetPt_med = FunctionParser::Register(NamedFunc("LeadingNonBJetPt_med",[](const Baby &b) -> NamedFunc::ScalarType{
       float maxpt=0;
       for (unsigned i(0); i<b.ak4pfjets_deepCSV()->size(); i++){
         if (b.ak4pfjets_pt()->at(i) > maxpt && b.ak4pfjets_deepCSV()->at(i) < (0.6321*(b.year()==2016) + 0.4941*(b.year()==2017) + 0.4184*(b.year()==2018))){
@@ -4010,8 +4016,8 @@ float deepTag2018 = 0.8365;
         }
       }
       return maxpt;
-    });
-   const NamedFunc LeadingNonBJetPt_med_jup("LeadingNonBJetPt_med_jup",[](const Baby &b) -> NamedFunc::ScalarType{
+    }));
+   const NamedFunc LeadingNonBJetPt_med_jup = FunctionParser::Register(NamedFunc("LeadingNonBJetPt_med_jup",[](const Baby &b) -> NamedFunc::ScalarType{
     float maxpt=0;
     for (unsigned i(0); i<b.ak4pfjets_pt_jup()->size(); i++){
       if (b.ak4pfjets_pt_jup()->at(i) > maxpt && b.ak4pfjets_deepCSV()->at(i) < (0.6321*(b.year()==2016) + 0.4941*(b.year()==2017) + 0.4184*(b.year()==2018))){
@@ -4019,8 +4025,8 @@ float deepTag2018 = 0.8365;
       }
     }
     return maxpt;
-  });
-    const NamedFunc LeadingNonBJetPt_med_jdown("LeadingNonBJetPt_med_jdown",[](const Baby &b) -> NamedFunc::ScalarType{
+  }));
+    const NamedFunc LeadingNonBJetPt_med_jdown = FunctionParser::Register(NamedFunc("LeadingNonBJetPt_med_jdown",[](const Baby &b) -> NamedFunc::ScalarType{
     float maxpt=0;
     for (unsigned i(0); i<b.ak4pfjets_pt_jdown()->size(); i++){
       if (b.ak4pfjets_pt_jdown()->at(i) > maxpt && b.ak4pfjets_deepCSV()->at(i) < (0.6321*(b.year()==2016) + 0.4941*(b.year()==2017) + 0.4184*(b.year()==2018))){
@@ -4028,9 +4034,9 @@ float deepTag2018 = 0.8365;
       }
     }
     return maxpt;
-  });
+  }));
 
-   const NamedFunc max_ak8pfjets_deepdisc_hbb("max_ak8pfjets_deepdisc_hbb",[](const Baby &b) -> NamedFunc::ScalarType{
+   const NamedFunc max_ak8pfjets_deepdisc_hbb = FunctionParser::Register(NamedFunc("max_ak8pfjets_deepdisc_hbb",[](const Baby &b) -> NamedFunc::ScalarType{
       float max_disc= -0.05;
       for (unsigned i(0); i<b.ak8pfjets_deepdisc_hbb()->size(); i++){
         if (b.ak8pfjets_deepdisc_hbb()->at(i) > max_disc){
@@ -4038,9 +4044,9 @@ float deepTag2018 = 0.8365;
         }
       }
       return max_disc;
-    });
+    }));
 
-   const NamedFunc PassThirdJetHighpTVeto("PassThirdJetHighpTVeto",[](const Baby &b) -> NamedFunc::ScalarType{
+   const NamedFunc PassThirdJetHighpTVeto = FunctionParser::Register(NamedFunc("PassThirdJetHighpTVeto",[](const Baby &b) -> NamedFunc::ScalarType{
       float maxpt=0;
       for (unsigned i(0); i<b.ak4pfjets_deepCSV()->size(); i++){
         if (b.ak4pfjets_pt()->at(i) > maxpt && b.ak4pfjets_deepCSV()->at(i) < 0.6321){
@@ -4049,9 +4055,9 @@ float deepTag2018 = 0.8365;
       }
       if(b.ak4pfjets_deepCSV()->size() <3 || maxpt<100) return true;
       else return false;
-    });
+    }));
 
-  const NamedFunc LeadingFakeNonBJetPt_med("LeadingFakeNonBJetPt_med",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc LeadingFakeNonBJetPt_med = FunctionParser::Register(NamedFunc("LeadingFakeNonBJetPt_med",[](const Baby &b) -> NamedFunc::ScalarType{
       float maxpt=0;
       for (unsigned i(0); i<b.ak4pfjets_deepCSV()->size(); i++){
         if (b.ak4pfjets_pt()->at(i) > maxpt && abs(b.ak4pfjets_hadron_flavor()->at(i))==5 && b.ak4pfjets_deepCSV()->at(i) < 0.6321){
@@ -4059,9 +4065,9 @@ float deepTag2018 = 0.8365;
         }
       }
       return maxpt;
-    });
+    }));
 
-   const NamedFunc LeadingRealNonBJetPt_med("LeadingRealNonBJetPt_med",[](const Baby &b) -> NamedFunc::ScalarType{
+   const NamedFunc LeadingRealNonBJetPt_med = FunctionParser::Register(NamedFunc("LeadingRealNonBJetPt_med",[](const Baby &b) -> NamedFunc::ScalarType{
       float maxpt=0;
       for (unsigned i(0); i<b.ak4pfjets_deepCSV()->size(); i++){
         if (b.ak4pfjets_pt()->at(i) > maxpt && abs(b.ak4pfjets_hadron_flavor()->at(i))!=5 && b.ak4pfjets_deepCSV()->at(i) < 0.6321){
@@ -4069,9 +4075,9 @@ float deepTag2018 = 0.8365;
         }
       }
       return maxpt;
-    });
+    }));
 
-   const NamedFunc nNonBTagJets("nNonBTagJets",[](const Baby &b) -> NamedFunc::ScalarType{
+   const NamedFunc nNonBTagJets = FunctionParser::Register(NamedFunc("nNonBTagJets",[](const Baby &b) -> NamedFunc::ScalarType{
       float njet=0;
       for (unsigned i(0); i<b.ak4pfjets_deepCSV()->size(); i++){
         if (b.ak4pfjets_deepCSV()->at(i) < (0.6321*(b.year()==2016) + 0.4941*(b.year()==2017) + 0.4184*(b.year()==2018))){
@@ -4079,9 +4085,9 @@ float deepTag2018 = 0.8365;
         }
       }
       return njet;
-    });
+    }));
   
-   const NamedFunc signature_pT("signature_pT",[](const Baby &b) -> NamedFunc::ScalarType{
+   const NamedFunc signature_pT = FunctionParser::Register(NamedFunc("signature_pT",[](const Baby &b) -> NamedFunc::ScalarType{
       TLorentzVector jet1;
       TLorentzVector jet2;
       TLorentzVector lep1;
@@ -4113,13 +4119,13 @@ float deepTag2018 = 0.8365;
       sum = (jet1+jet2+lep1+lep2);
 
       return sum.Pt();
-    });
+    }));
 
 
    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
    // Funcs to look at number of B-tags which are fakes
 
-   const NamedFunc LeadingBJetPt("LeadingBJetPt",[](const Baby &b) -> NamedFunc::ScalarType{
+   const NamedFunc LeadingBJetPt = FunctionParser::Register(NamedFunc("LeadingBJetPt",[](const Baby &b) -> NamedFunc::ScalarType{
       float maxCSV=0;
       float maxpt=0;
       for (unsigned i(0); i<b.ak4pfjets_deepCSV()->size(); i++){
@@ -4130,9 +4136,9 @@ float deepTag2018 = 0.8365;
         }
       }
       return maxpt;
-    });
+    }));
 
-  const NamedFunc LeadingRealBJetPt("LeadingRealBJetPt",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc LeadingRealBJetPt = FunctionParser::Register(NamedFunc("LeadingRealBJetPt",[](const Baby &b) -> NamedFunc::ScalarType{
       float maxCSV=0;
       float maxpt=0;
       float output=0;
@@ -4145,9 +4151,9 @@ float deepTag2018 = 0.8365;
         }
       }
       return output;
-    });
+    }));
 
-   const NamedFunc LeadingFakeBJetPt("LeadingFakeBJetPt",[](const Baby &b) -> NamedFunc::ScalarType{
+   const NamedFunc LeadingFakeBJetPt = FunctionParser::Register(NamedFunc("LeadingFakeBJetPt",[](const Baby &b) -> NamedFunc::ScalarType{
       float maxCSV=0;
       float maxpt=0;
       float output=0;
@@ -4160,12 +4166,12 @@ float deepTag2018 = 0.8365;
         }
       }
       return output;
-    });
+    }));
 
     /*
    * returns sub-leading b jet pt
    */
-  const NamedFunc SubLeadingBJetPt("SubLeadingBJetPt",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc SubLeadingBJetPt = FunctionParser::Register(NamedFunc("SubLeadingBJetPt",[](const Baby &b) -> NamedFunc::ScalarType{
       float maxCSV=0;
       float maxpt=0;
       float secondmaxCSV=0;
@@ -4183,9 +4189,9 @@ float deepTag2018 = 0.8365;
         }
       }
       return secondmaxpt;
-    });
+    }));
 
-  const NamedFunc SubLeadingRealBJetPt("SubLeadingRealBJetPt",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc SubLeadingRealBJetPt = FunctionParser::Register(NamedFunc("SubLeadingRealBJetPt",[](const Baby &b) -> NamedFunc::ScalarType{
       float maxCSV=0;
       float maxpt=0;
       bool maxisb=false;
@@ -4211,9 +4217,9 @@ float deepTag2018 = 0.8365;
         }
       }
       return output;
-    });
+    }));
 
-  const NamedFunc SubLeadingFakeBJetPt("SubLeadingFakeBJetPt",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc SubLeadingFakeBJetPt = FunctionParser::Register(NamedFunc("SubLeadingFakeBJetPt",[](const Baby &b) -> NamedFunc::ScalarType{
       float maxCSV=0;
       float maxpt=0;
       bool maxisb=false;
@@ -4239,7 +4245,7 @@ float deepTag2018 = 0.8365;
         }
       }
       return output;
-    });
+    }));
 
 
    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -4248,7 +4254,7 @@ float deepTag2018 = 0.8365;
     /*
     * Pt ISR using truth info
     */
-    const NamedFunc genISRPt("genISRPt",[](const Baby &b) -> NamedFunc::ScalarType{
+    const NamedFunc genISRPt = FunctionParser::Register(NamedFunc("genISRPt",[](const Baby &b) -> NamedFunc::ScalarType{
       TLorentzVector *obj1 = new TLorentzVector();
       TLorentzVector *obj2 = new TLorentzVector();
       TLorentzVector ISR;
@@ -4270,9 +4276,9 @@ float deepTag2018 = 0.8365;
       delete obj1;
       delete obj2;
       return ISRpt;
-    });
+    }));
 
-    const NamedFunc genISRgenMETdPhi("genISRMETdPhi",[](const Baby &b) -> NamedFunc::ScalarType{
+    const NamedFunc genISRgenMETdPhi = FunctionParser::Register(NamedFunc("genISRMETdPhi",[](const Baby &b) -> NamedFunc::ScalarType{
       TLorentzVector *obj1 = new TLorentzVector();
       TLorentzVector *obj2 = new TLorentzVector();
       TLorentzVector ISR;
@@ -4304,9 +4310,9 @@ float deepTag2018 = 0.8365;
       delete obj1;
       delete obj2;
       return dR_ISR_MET;
-    });
+    }), "genISRgenMETdPhi");
 
-    const NamedFunc genISRrecoMETdPhi("genISRrecoMETdPhi",[](const Baby &b) -> NamedFunc::ScalarType{
+    const NamedFunc genISRrecoMETdPhi = FunctionParser::Register(NamedFunc("genISRrecoMETdPhi",[](const Baby &b) -> NamedFunc::ScalarType{
       TLorentzVector *obj1 = new TLorentzVector();
       TLorentzVector *obj2 = new TLorentzVector();
       TLorentzVector ISR;
@@ -4338,10 +4344,10 @@ float deepTag2018 = 0.8365;
       delete obj1;
       delete obj2;
       return dR_ISR_MET;
-    });
+    }));
 
 
-    const NamedFunc genISRrecoISRdPhi("genISRrecoISRdPhi",[](const Baby &b) -> NamedFunc::ScalarType{
+    const NamedFunc genISRrecoISRdPhi = FunctionParser::Register(NamedFunc("genISRrecoISRdPhi",[](const Baby &b) -> NamedFunc::ScalarType{
       TLorentzVector *obj1 = new TLorentzVector();
       TLorentzVector *obj2 = new TLorentzVector();
       TLorentzVector gISR;
@@ -4376,10 +4382,10 @@ float deepTag2018 = 0.8365;
       delete obj1;
       delete obj2;
       return gISR_rISR_dPhi;
-    });
+    }));
 
 
-    const NamedFunc genISRrecoISRDeltaPt("genISRrecoISRDeltaPt",[](const Baby &b) -> NamedFunc::ScalarType{
+    const NamedFunc genISRrecoISRDeltaPt = FunctionParser::Register(NamedFunc("genISRrecoISRDeltaPt",[](const Baby &b) -> NamedFunc::ScalarType{
       TLorentzVector *obj1 = new TLorentzVector();
       TLorentzVector *obj2 = new TLorentzVector();
       TLorentzVector gISR;
@@ -4414,9 +4420,9 @@ float deepTag2018 = 0.8365;
       delete obj1;
       delete obj2;
       return gISR_rISR_DeltaPt;
-    });
+    }));
 
-    const NamedFunc truthOrigin3rdJet("truthOrigin3rdJet",[](const Baby &b) -> NamedFunc::ScalarType{
+    const NamedFunc truthOrigin3rdJet = FunctionParser::Register(NamedFunc("truthOrigin3rdJet",[](const Baby &b) -> NamedFunc::ScalarType{
         TLorentzVector *gOBJ = new TLorentzVector();
         TLorentzVector *rISR = new TLorentzVector();
         int jet_origin=0;
@@ -4461,11 +4467,11 @@ float deepTag2018 = 0.8365;
         delete rISR;
 
         return jet_origin;
-    });
+    }));
 
 
 //Functions for Data Quality Checks
-      const NamedFunc pfmet_uncorr_func("pfmet_uncorr_func",[](const Baby &b) -> NamedFunc::ScalarType{
+      const NamedFunc pfmet_uncorr_func = FunctionParser::Register(NamedFunc("pfmet_uncorr_func",[](const Baby &b) -> NamedFunc::ScalarType{
       float pfmet_uncorr_var = 0;
       if(b.pfmet_uncorr()!= -9999){
         pfmet_uncorr_var  = b.pfmet_uncorr();
@@ -4473,9 +4479,9 @@ float deepTag2018 = 0.8365;
         pfmet_uncorr_var = b.pfmet();
       }
       return pfmet_uncorr_var;
-    });
+    }));
 
-  const NamedFunc mt_met_lep_uncorr("mt_met_lep_uncorr",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc mt_met_lep_uncorr = FunctionParser::Register(NamedFunc("mt_met_lep_uncorr",[](const Baby &b) -> NamedFunc::ScalarType{
       float mt_met_lep_uncorr_var = 0;
       if(b.pfmet_uncorr()!= -9999){
         float phi1 = b.leps_phi()->at(0);
@@ -4488,17 +4494,17 @@ float deepTag2018 = 0.8365;
         mt_met_lep_uncorr_var = b.mt_met_lep();
       }
       return mt_met_lep_uncorr_var;
-    });
+    }));
 
-  const NamedFunc noPrefireWeight("noPrefireWeight",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc noPrefireWeight = FunctionParser::Register(NamedFunc("noPrefireWeight",[](const Baby &b) -> NamedFunc::ScalarType{
       float noPrefireCuts = 0;
 
       noPrefireCuts = b.pass()/b.w_L1();
 
       return noPrefireCuts;
-    });
+    }));
 
-  const NamedFunc HasHEMjet("HasHEMjet",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc HasHEMjet = FunctionParser::Register(NamedFunc("HasHEMjet",[](const Baby &b) -> NamedFunc::ScalarType{
       int njet=0;
 
       for (unsigned i(0); i<b.ak4pfjets_phi()->size(); i++){
@@ -4507,9 +4513,9 @@ float deepTag2018 = 0.8365;
         }
       }
       return njet;
-    });
+    }));
 
-  const NamedFunc HasHEMevent("HasHEMevent",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc HasHEMevent = FunctionParser::Register(NamedFunc("HasHEMevent",[](const Baby &b) -> NamedFunc::ScalarType{
       int nevent=0;
 
       for (unsigned i(0); i<b.vetoleps_pdgid()->size(); i++){
@@ -4518,9 +4524,9 @@ float deepTag2018 = 0.8365;
         }
       }
       return nevent;
-    });
+    }));
 
-  const NamedFunc mcHEMWeight("mcHEMWeight",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc mcHEMWeight = FunctionParser::Register(NamedFunc("mcHEMWeight",[](const Baby &b) -> NamedFunc::ScalarType{
       float weight=0.;
       int nEls = 0;
       int nJets = 0;
@@ -4547,9 +4553,9 @@ float deepTag2018 = 0.8365;
           weight = 1.;
         }
       return weight;
-    });
+    }));
 
-  const NamedFunc muPt("muPt",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc muPt = FunctionParser::Register(NamedFunc("muPt",[](const Baby &b) -> NamedFunc::ScalarType{
     float pt = 0;
 
     if(abs(b.lep1_pdgid())==13){
@@ -4557,9 +4563,9 @@ float deepTag2018 = 0.8365;
     }//Close if
     return pt;
 
-    });
+    }));
 
-  const NamedFunc elPt("elPt",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc elPt = FunctionParser::Register(NamedFunc("elPt",[](const Baby &b) -> NamedFunc::ScalarType{
     float pt = 0;
 
     if(abs(b.lep1_pdgid())==11){
@@ -4567,63 +4573,63 @@ float deepTag2018 = 0.8365;
     }//Close if
     return pt;
 
-    });
+    }));
 
-  const NamedFunc pfmet_div_genmet("pfmet_div_genmet",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc pfmet_div_genmet = FunctionParser::Register(NamedFunc("pfmet_div_genmet",[](const Baby &b) -> NamedFunc::ScalarType{
       float met_var=0.;
 
       met_var = b.pfmet()/b.genmet();
 
       return met_var;
 
-  });
+  }));
 
-  const NamedFunc pfmet_resup_div_genmet("pfmet_resup_div_genmet",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc pfmet_resup_div_genmet = FunctionParser::Register(NamedFunc("pfmet_resup_div_genmet",[](const Baby &b) -> NamedFunc::ScalarType{
       float met_var=0.;
 
       met_var = b.pfmet_resup()/b.genmet();
 
       return met_var;
 
-  });
+  }));
 
-  const NamedFunc pfmet_resdown_div_genmet("pfmet_resdown_div_genmet",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc pfmet_resdown_div_genmet = FunctionParser::Register(NamedFunc("pfmet_resdown_div_genmet",[](const Baby &b) -> NamedFunc::ScalarType{
       float met_var=0.;
 
       met_var = b.pfmet_resdown()/b.genmet();
 
       return met_var;
 
-  });
+  }));
 
-  const NamedFunc pfmet_subt_resup("pfmet_subt_resup",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc pfmet_subt_resup = FunctionParser::Register(NamedFunc("pfmet_subt_resup",[](const Baby &b) -> NamedFunc::ScalarType{
       float met_var=0.;
 
       met_var = b.pfmet()-b.pfmet_resup();
 
       return met_var;
 
-  });
+  }));
 
-  const NamedFunc pfmet_subt_resdown("pfmet_subt_resdown",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc pfmet_subt_resdown = FunctionParser::Register(NamedFunc("pfmet_subt_resdown",[](const Baby &b) -> NamedFunc::ScalarType{
       float met_var=0.;
 
       met_var = b.pfmet()-b.pfmet_resdown();
 
       return met_var;
 
-  });
+  }));
 
-  const NamedFunc pfmet_subt_genmet("pfmet_subt_genmet",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc pfmet_subt_genmet = FunctionParser::Register(NamedFunc("pfmet_subt_genmet",[](const Baby &b) -> NamedFunc::ScalarType{
       float met_var=0.;
 
       met_var = b.pfmet()-b.genmet();
 
       return met_var;
 
-  });
+  }));
 
-  const NamedFunc pfmet_subt_genmet_subt_lepPt("pfmet_subt_genmet_subt_lepPt",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc pfmet_subt_genmet_subt_lepPt = FunctionParser::Register(NamedFunc("pfmet_subt_genmet_subt_lepPt",[](const Baby &b) -> NamedFunc::ScalarType{
       float met_var=0.;
       float pt_var1=0.;
       float pt_var2=0.;
@@ -4641,117 +4647,117 @@ float deepTag2018 = 0.8365;
 
       return met_var;
 
-  });
+  }));
 
-  const NamedFunc pfmet_subt_jup("pfmet_subt_jup",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc pfmet_subt_jup = FunctionParser::Register(NamedFunc("pfmet_subt_jup",[](const Baby &b) -> NamedFunc::ScalarType{
       float met_var=0.;
 
       met_var = b.pfmet()-b.pfmet_jup();
 
       return met_var;
 
-  });
+  }));
 
-  const NamedFunc pfmet_subt_jdown("pfmet_subt_jdown",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc pfmet_subt_jdown = FunctionParser::Register(NamedFunc("pfmet_subt_jdown",[](const Baby &b) -> NamedFunc::ScalarType{
       float met_var=0.;
 
       met_var = b.pfmet()-b.pfmet_jdown();
 
       return met_var;
 
-  });
+  }));
 
-  const NamedFunc mt_subt_jup("mt_subt_jup",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc mt_subt_jup = FunctionParser::Register(NamedFunc("mt_subt_jup",[](const Baby &b) -> NamedFunc::ScalarType{
       float mt_var=0.;
 
       mt_var = b.mt_met_lep()-b.mt_met_lep_jup();
 
       return mt_var;
 
-  });
+  }));
 
-  const NamedFunc mt_subt_jdown("mt_subt_jdown",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc mt_subt_jdown = FunctionParser::Register(NamedFunc("mt_subt_jdown",[](const Baby &b) -> NamedFunc::ScalarType{
       float mt_var=0.;
 
       mt_var = b.mt_met_lep()-b.mt_met_lep_jdown();
 
       return mt_var;
 
-  });
+  }));
 
-  const NamedFunc mct_subt_jup("mct_subt_jup",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc mct_subt_jup = FunctionParser::Register(NamedFunc("mct_subt_jup",[](const Baby &b) -> NamedFunc::ScalarType{
       float mct_var=0.;
 
       mct_var = b.mct()-b.jup_mct();
 
       return mct_var;
 
-  });
+  }));
 
-  const NamedFunc mct_subt_jdown("mct_subt_jdown",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc mct_subt_jdown = FunctionParser::Register(NamedFunc("mct_subt_jdown",[](const Baby &b) -> NamedFunc::ScalarType{
       float mct_var=0.;
 
       mct_var = b.mct()-b.jdown_mct();
 
       return mct_var;
 
-  });
+  }));
 
-  const NamedFunc mbb_subt_jup("mbb_subt_jup",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc mbb_subt_jup = FunctionParser::Register(NamedFunc("mbb_subt_jup",[](const Baby &b) -> NamedFunc::ScalarType{
       float mbb_var=0.;
 
       mbb_var = b.mbb()-b.jup_mbb();
 
       return mbb_var;
 
-  });
+  }));
 
-  const NamedFunc mbb_subt_jdown("mbb_subt_jdown",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc mbb_subt_jdown = FunctionParser::Register(NamedFunc("mbb_subt_jdown",[](const Baby &b) -> NamedFunc::ScalarType{
       float mbb_var=0.;
 
       mbb_var = b.mbb()-b.jdown_mbb();
 
       return mbb_var;
 
-  });
+  }));
 
-  const NamedFunc mct_subt_jerup("mct_subt_jerup",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc mct_subt_jerup = FunctionParser::Register(NamedFunc("mct_subt_jerup",[](const Baby &b) -> NamedFunc::ScalarType{
       float mct_var=0.;
 
       mct_var = b.mct()-b.jerup_mct();
 
       return mct_var;
 
-  });
+  }));
 
-  const NamedFunc mct_subt_jerdown("mct_subt_jerdown",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc mct_subt_jerdown = FunctionParser::Register(NamedFunc("mct_subt_jerdown",[](const Baby &b) -> NamedFunc::ScalarType{
       float mct_var=0.;
 
       mct_var = b.mct()-b.jerdown_mct();
 
       return mct_var;
 
-  });
+  }));
 
-  const NamedFunc mbb_subt_jerup("mbb_subt_jerup",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc mbb_subt_jerup = FunctionParser::Register(NamedFunc("mbb_subt_jerup",[](const Baby &b) -> NamedFunc::ScalarType{
       float mbb_var=0.;
 
       mbb_var = b.mbb()-b.jerup_mbb();
 
       return mbb_var;
 
-  });
+  }));
 
-  const NamedFunc mbb_subt_jerdown("mbb_subt_jerdown",[](const Baby &b) -> NamedFunc::ScalarType{
+  const NamedFunc mbb_subt_jerdown = FunctionParser::Register(NamedFunc("mbb_subt_jerdown",[](const Baby &b) -> NamedFunc::ScalarType{
       float mbb_var=0.;
 
       mbb_var = b.mbb()-b.jerdown_mbb();
 
       return mbb_var;
 
-  });
+  }));
 
-   const NamedFunc genPt_ak8_higgsTagger("genPt_ak8_higgsTagger",[](const Baby &b) -> NamedFunc::ScalarType{
+   const NamedFunc genPt_ak8_higgsTagger = FunctionParser::Register(NamedFunc("genPt_ak8_higgsTagger",[](const Baby &b) -> NamedFunc::ScalarType{
       float nHiggs=0;
       int year = b.year();
       float higgsWP = 0;
@@ -4773,9 +4779,9 @@ float deepTag2018 = 0.8365;
       }
 
       return nHiggs;
-    });
+    }));
 
-   const NamedFunc reduced_MET("reduced_MET",[](const Baby &b) -> NamedFunc::ScalarType{
+   const NamedFunc reduced_MET = FunctionParser::Register(NamedFunc("reduced_MET",[](const Baby &b) -> NamedFunc::ScalarType{
       float met_var=0;
       int year = b.year();
 
@@ -4786,9 +4792,9 @@ float deepTag2018 = 0.8365;
       }
 
       return met_var;
-    });
+    }));
 
-   const NamedFunc reducedMET_mT("reducedMET_mT",[](const Baby &b) -> NamedFunc::ScalarType{
+   const NamedFunc reducedMET_mT = FunctionParser::Register(NamedFunc("reducedMET_mT",[](const Baby &b) -> NamedFunc::ScalarType{
       float met_var=0;
       float mt_var=0;
       int year = b.year();
@@ -4802,9 +4808,9 @@ float deepTag2018 = 0.8365;
       mt_var = sqrt(2*b.leps_pt()->at(0)*met_var * (1-(cos(b.leps_phi()->at(0)-b.pfmet_phi()))));
       return mt_var;
 
-    });
+    }));
 
-   const NamedFunc fastsim_MET("fastsim_MET",[](const Baby &b) -> NamedFunc::ScalarType{
+   const NamedFunc fastsim_MET = FunctionParser::Register(NamedFunc("fastsim_MET",[](const Baby &b) -> NamedFunc::ScalarType{
       float met_var=0;
       double x = 0;
       double y = 0;
@@ -4834,9 +4840,9 @@ float deepTag2018 = 0.8365;
       }
 
       return met_var;
-    });
+    }));
 
-   const NamedFunc fastsim_MT("fastsim_MT",[](const Baby &b) -> NamedFunc::ScalarType{
+   const NamedFunc fastsim_MT = FunctionParser::Register(NamedFunc("fastsim_MT",[](const Baby &b) -> NamedFunc::ScalarType{
       float met_var=0;
       float mt_var=0;
       double x = 0;
@@ -4869,10 +4875,10 @@ float deepTag2018 = 0.8365;
       mt_var = sqrt(2*b.leps_pt()->at(0)*met_var * (1-(cos(b.leps_phi()->at(0)-b.pfmet_phi()))));
 
       return mt_var;
-    });
+    }));
 
 
-    const NamedFunc fastsim_MCT("fastsim_MCT",[](const Baby &b) -> NamedFunc::ScalarType{
+    const NamedFunc fastsim_MCT = FunctionParser::Register(NamedFunc("fastsim_MCT",[](const Baby &b) -> NamedFunc::ScalarType{
   
     float mct_var=0;
     int year = b.year();
@@ -4892,7 +4898,7 @@ float deepTag2018 = 0.8365;
     }
 
     return mct_var;
-    });
+    }));
 
  
 }
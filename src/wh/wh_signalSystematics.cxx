@@ -72,8 +72,8 @@ int main(){
   int ini_y = mass_plane->FindFirstBinAbove(0,2);
   int last_y = mass_plane->FindLastBinAbove(0,2);
 
-  //load all pairs as cuts into vector
-  vector<TString> pair_cuts;
+  //load all pairs as grid points into vector
+  vector<Grid::Point> mass_points;
   vector<TString> mass_tag;
   vector<float> v_mchi;
   vector<float> v_mlsp;
@@ -85,7 +85,7 @@ int main(){
         int mchi = static_cast<int>(mass_plane->GetYaxis()->GetBinCenter(iy));
         int mlsp = static_cast<int>(mass_plane->GetXaxis()->GetBinCenter(ix));
         //if(mchi!=175) continue;
-        pair_cuts.push_back(Form("mass_stop==%i&&mass_lsp==%i",mchi,mlsp));
+        mass_points.push_back({static_cast<double>(mchi), static_cast<double>(mlsp)});
         mass_tag.push_back(Form("mChi-%i_mLSP-%i_",mchi,mlsp));
         v_mchi.push_back(mchi);
         v_mlsp.push_back(mlsp);
@@ -95,14 +95,10 @@ int main(){
     }
   }
 
-  //DEFINE A PROCESS FOR EACH SIGNAL MASS POINT FOUND
-  vector<shared_ptr<Process> > sample_list_comb;
-  for(unsigned iSig(0); iSig<mass_tag.size(); iSig++){
-
-    auto signal_var = Process::MakeShared<Baby_full>("2016-2018 Signal", Process::Type::signal, colors("t1tttt"),{signal_dir+"slim_SMS_TChiWH*.root"},"pass&&"+pair_cuts[iSig]);
-    sample_list_comb.push_back(signal_var);
-
-  }//close for loop over mass_tag vector
+  //ONE PROCESS SPLIT INTO ALL SIGNAL MASS POINTS FOUND
+  auto signal_grid = Process::MakeShared<Baby_full>("2016-2018 Signal", Process::Type::signal, colors("t1tttt"),{signal_dir+"slim_SMS_TChiWH*.root"},"pass");
+  signal_grid->Grid({"mass_stop", "mass_lsp"});
+  vector<shared_ptr<Process> > sample_list_comb = {signal_grid};
 
   auto signal_comb_600_300 = Process::MakeShared<Baby_full>("TChi WH (600,300)", Process::Type::signal, colors("t1tttt"),{signal_dir+"slim_*.root"},"pass&&mass_stop==600&&mass_lsp==300");
   auto signal_comb_800_1 = Process::MakeShared<Baby_full>("TChi WH (800,1)", Process::Type::signal, colors("t1tttt"),{signal_dir+"slim_*.root"},"pass&&mass_stop==800&&mass_lsp==1");
@@ -518,7 +514,7 @@ if(single_thread) pmcomb->multithreaded_ = false;
   ofstream outFile;
   outFile.open("signalSystematics.txt");
 
-  int nSignals = sample_list_comb.size();
+  int nSignals = mass_points.size();
   
   for(int iProc = 0; iProc < nSignals; iProc++){
     for(unsigned iTable(0); iTable < 12; iTable++){
@@ -529,7 +525,7 @@ if(single_thread) pmcomb->multithreaded_ = false;
         double resultYield = 0;
 
         Table * yield_table = static_cast<Table*>(pmcomb->Figures()[iTable].get());
-        yields[iProc] = yield_table->Yield(sample_list_comb[iProc].get(), lumicomb);
+        yields[iProc] = yield_table->Yield(signal_grid.get(), lumicomb, mass_points[iProc]);
         resultYield = 1.0+((yields[iProc][iVar].Yield()-yields[iProc][0].Yield())/(yields[iProc][0].Yield()));
 
         if(resultYield>=2.0){
@@ -171,6 +171,7 @@ int main(){
   {signal_dir2016+"slim*TChiWH*s16v3*.root",signal_dir2017+"slim*TChiWH*f17v2*.root",signal_dir2018+"slim*TChiWH*a18v1*.root"},"mass_stop==350&&mass_lsp==150"&&baselinef);
 
   auto proc_sig_all = Process::MakeShared<Baby_full>("2016-2018 TChiWH", Process::Type::signal, colors("t1tttt"), all_sig, baselinef);
+  proc_sig_all->Grid({"mass_stop", "mass_lsp"}); // one pass gives the yields at every mass point
 
 
   vector<shared_ptr<Process> > all_procs_bkg = {proc_data,proc_top,proc_wjets,proc_other};
@@ -195,20 +196,18 @@ int main(){
   int ini_y = mass_plane->FindFirstBinAbove(0,2);
   int last_y = mass_plane->FindLastBinAbove(0,2);
 
-  //load all pairs as cuts into vector
-  vector<TString> pair_cuts;
+  //load all pairs as grid points into vector
+  vector<Grid::Point> mass_points;
   vector<TString> mass_tag;
-  int Npoints=0;
   for(int iy=ini_y; iy<=last_y; iy++){
     for(int ix=ini_x; ix<=last_x; ix++){
       if(mass_plane->GetBinContent(ix,iy) > 0){
         int mchi = static_cast<int>(mass_plane->GetYaxis()->GetBinCenter(iy));
         int mlsp = static_cast<int>(mass_plane->GetXaxis()->GetBinCenter(ix));
         //if (mchi!=800) continue;
-        pair_cuts.push_back(Form("mass_stop==%i&&mass_lsp==%i",mchi,mlsp));
+        mass_points.push_back({static_cast<double>(mchi), static_cast<double>(mlsp)});
         mass_tag.push_back(Form("mChi-%i_mLSP-%i_",mchi,mlsp));
         cout<<"Found mass point "<<mass_tag.back()<<endl;
-  Npoints++;
       }
     }
   }
@@ -298,17 +297,14 @@ int main(){
   cout<<"Boosted met bin size "<<boosted_metbins.size()<<endl;
   PlotMaker pm;
   vector<NamedFunc> allcuts;
-  vector<NamedFunc> allcuts_sig;
   vector<TableRow> table_rows;
   vector<TableRow> table_rows_sig;
   vector<string> bin_names;
-  vector<string> bin_names_sig;
   for(uint inj=0;inj<njetbins.size();inj++){
 		for(uint imet=0;imet<metbins.size();imet++){
 			for(uint ideepAK8=0;ideepAK8<deepAK8bins.size();ideepAK8++){
 			if(!boosted && ideepAK8>0) continue;
       NamedFunc totcut = "1";
-			NamedFunc totcut_sig = "1";
 			string bin_name="";
 
 			if(boosted){
@@ -328,12 +324,8 @@ int main(){
 			table_rows.push_back(TableRow("", totcut,0,0,weights[0]));
       bin_names.push_back(bin_name);
 
-      for(int isig=0;isig<Npoints;isig++){
-        totcut_sig = pair_cuts[isig] && totcut; 
-        allcuts_sig.push_back(totcut_sig);
-        bin_names_sig.push_back(mass_tag[isig].Data()+bin_name);
-        table_rows_sig.push_back(TableRow("", totcut_sig,0,0,weights[0]));
-      }
+      // signal yields for each mass point are split by the grid of proc_sig_all
+      table_rows_sig.push_back(TableRow("", totcut,0,0,weights[0]));
 			
       // now taking care of the MCT control region
 			if(boosted){
@@ -389,20 +381,18 @@ int main(){
   size_t nrows= table_rows.size();
 	size_t nrows_sig= table_rows_sig.size();
   int nsig = mass_tag.size();
-  int nbins = nrows_sig/nsig;
+  int nbins = nrows_sig;
     // allyields: [0] All bkg, [1] tt1l, [2] tt2l, [3] other
    
-  vector<GammaParams>  sigyields;
   vector<vector<GammaParams> > sig_by_mass(nsig,vector<GammaParams> (3*nbins));
   Table * yield_table_sig = static_cast<Table*>(pm.Figures()[0].get());
-  sigyields = yield_table_sig->Yield(proc_sig_all.get(), lumi);
-
-  for(size_t irow=0; irow<nrows_sig; irow++){ 
-    // cout<<"signal, "<<bin_names_sig[irow]<<": "<<setw(7)<<RoundNumber(sigyields[irow].Yield(), 2)<<endl;
-    int bin_num = 3*(irow/nsig); //hack to skip CR bins
-    int sig_num = irow - bin_num*nsig/3;
-    // cout<<"bin_num, sig_num: "<<bin_num<<" "<<sig_num<<endl;
-    sig_by_mass[sig_num][bin_num] = sigyields[irow];
+
+  for(int isig=0; isig<nsig; isig++){
+    vector<GammaParams> sigyields = yield_table_sig->Yield(proc_sig_all.get(), lumi, mass_points[isig]);
+    for(size_t irow=0; irow<nrows_sig; irow++){ 
+      // cout<<"signal, "<<mass_tag[isig]<<": "<<setw(7)<<RoundNumber(sigyields[irow].Yield(), 2)<<endl;
+      sig_by_mass[isig][3*irow] = sigyields[irow]; //hack to skip CR bins
+    }
   }
 
   for(int isig =0;isig<nsig;isig++){